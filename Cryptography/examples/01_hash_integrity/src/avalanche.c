@@ -1,52 +1,116 @@
 /**
- * avalanche.c - 눈사태 효과(Avalanche Effect) 시연
+ * avalanche.c - 눈사태 효과(Avalanche Effect) 시연 및 SAC 통계 검정
  * 
  * 입력의 1비트 변화가 해시 출력에 미치는 영향을 분석한다.
  * 
+ * 인자 없이 실행하면 SHA-256에 대한 간단한 시연을 보여주고,
+ * --sac 모드에서는 임의의 EVP 다이제스트 또는 MAC에 대해 수억 회의
+ * 1비트 반전 시행을 모든 코어에서 수행하여 엄격한 눈사태 기준(SAC,
+ * Strict Avalanche Criterion)을 통계적으로 검정한다.
+ * 
  * 빌드: make
  * 실행: ./bin/avalanche
+ *       ./bin/avalanche --sac -a sha256 -n 100000000
+ *       ./bin/avalanche --sac -m HMAC:sha256
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <openssl/core_names.h>
 #include <openssl/evp.h>
+#include <openssl/rand.h>
+#include "cpu_features.h"
+#include "digest_ctx.h"
+
+#define SAC_DEFAULT_TRIALS (1UL << 24)
+#define SAC_DEFAULT_INPUT_LEN 32
+#define SAC_MAX_INPUT_LEN 64
+#define SAC_MAX_OUTPUT_LEN 64
+#define SAC_MAX_WORKERS 256
+#define SAC_FLUSH_INTERVAL 255        // 8비트 카운터가 넘치기 전에 비우는 메시지 수
+#define SAC_PASS_P_VALUE 0.001        // 이보다 작은 p-값이면 편향으로 판정
 
 /**
- * SHA-256 해시를 계산한다.
+ * SHA-256 해시를 계산한다 (캐시된 알고리즘과 스레드별 컨텍스트 재사용).
  */
 int sha256(const unsigned char *data, size_t len, unsigned char *hash) {
-    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
-    if (ctx == NULL) return -1;
-    
-    EVP_DigestInit_ex(ctx, EVP_sha256(), NULL);
-    EVP_DigestUpdate(ctx, data, len);
-    
-    unsigned int hash_len;
-    EVP_DigestFinal_ex(ctx, hash, &hash_len);
-    EVP_MD_CTX_free(ctx);
-    
-    return 0;
+    return digest_sha256(data, len, hash);
 }
 
 /**
- * 두 해시의 비트 차이 수를 계산한다.
+ * 8바이트 단위 해밍 거리 (일반 경로, 컴파일러 내장 비트 세기)
  */
-int count_bit_differences(const unsigned char *hash1, 
-                          const unsigned char *hash2, 
-                          size_t len) {
+int hamming_distance_generic(const unsigned char *a, const unsigned char *b, size_t len) {
     int diff_count = 0;
+    size_t i = 0;
     
-    for (size_t i = 0; i < len; i++) {
-        unsigned char xor_val = hash1[i] ^ hash2[i];
-        // 해밍 가중치 계산 (1인 비트 수)
-        while (xor_val) {
-            diff_count += xor_val & 1;
-            xor_val >>= 1;
-        }
+    for (; i + 8 <= len; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        diff_count += __builtin_popcountll(x ^ y);
     }
+    for (; i < len; i++) {
+        diff_count += __builtin_popcount((unsigned int)(a[i] ^ b[i]));
+    }
+    return diff_count;
+}
+
+#if defined(CPU_FEATURES_X86)
+/**
+ * 8바이트 단위 해밍 거리 (x86 POPCNT 명령)
+ */
+__attribute__((target("popcnt")))
+int hamming_distance_popcnt(const unsigned char *a, const unsigned char *b, size_t len) {
+    int diff_count = 0;
+    size_t i = 0;
     
+    for (; i + 8 <= len; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        diff_count += __builtin_popcountll(x ^ y);
+    }
+    for (; i < len; i++) {
+        diff_count += __builtin_popcount((unsigned int)(a[i] ^ b[i]));
+    }
     return diff_count;
 }
+#endif
+
+typedef int (*HammingFn)(const unsigned char *, const unsigned char *, size_t);
+
+/**
+ * CPU 기능에 맞는 해밍 거리 구현을 선택한다.
+ */
+HammingFn select_hamming_distance(const char **name) {
+#if defined(CPU_FEATURES_X86)
+    if (cpu_features_get()->popcnt) {
+        *name = "POPCNT";
+        return hamming_distance_popcnt;
+    }
+    *name = "일반 (컴파일러 내장 popcount)";
+#else
+    *name = "일반 (NEON/컴파일러 내장)";
+#endif
+    return hamming_distance_generic;
+}
+
+/**
+ * 두 해시의 비트 차이 수를 계산한다.
+ */
+int count_bit_differences(const unsigned char *hash1,
+                          const unsigned char *hash2,
+                          size_t len) {
+    const char *name;
+    return select_hamming_distance(&name)(hash1, hash2, len);
+}
 
 /**
  * 해시를 16진수로 출력한다.
@@ -69,7 +133,708 @@ void print_bits(const unsigned char *data, size_t bytes) {
     }
 }
 
-int main(void) {
+/* ===== SAC 통계 검정 ===== */
+
+/**
+ * 검정 대상: EVP 다이제스트 또는 EVP MAC
+ */
+typedef struct {
+    char label[96];
+    const EVP_MD *md;                 // 다이제스트 대상이면 NULL이 아님
+    EVP_MAC *mac;                     // MAC 대상이면 NULL이 아님
+    OSSL_PARAM params[3];             // MAC 하위 알고리즘 (HMAC 다이제스트, CMAC 암호 등), GMAC IV
+    char param_value[64];
+    unsigned char key[64];
+    unsigned char iv[12];             // GMAC 전용 고정 IV
+    size_t key_len;
+    int mac_reinit;                   // 키를 다시 넣지 않고 재초기화 가능한지
+    size_t out_len;
+} SacTarget;
+
+/**
+ * 작업자별 상태. 비트 카운터는 스레드마다 따로 두어 잠금 없이 누적한다.
+ * 
+ * counts8은 (입력 비트 × 출력 비트) 8비트 카운터 행렬로, 16개씩 SIMD 벡터로
+ * 더한다. SAC_FLUSH_INTERVAL 메시지마다 counts32로 옮겨 넘침을 막는다.
+ */
+typedef unsigned char u8x16 __attribute__((vector_size(16)));
+
+typedef struct {
+    const SacTarget *target;
+    HammingFn hamming;
+    size_t input_len;
+    size_t messages;
+    uint64_t seed;                    // 모든 작업자가 같은 시드를 쓴다
+    unsigned stream;                  // 작업자 번호: 시드 상태에서 jump()를 적용할 횟수
+    size_t row_vectors;               // 한 입력 비트 행의 u8x16 벡터 수
+    u8x16 *counts8;
+    uint32_t *counts32;
+    uint64_t *histogram;              // 해밍 거리 분포 [0..출력 비트]
+    int failed;
+} SacWorker;
+
+/**
+ * xoshiro256** 의사난수 생성기 (작업자별 입력 생성용)
+ */
+typedef struct {
+    uint64_t s[4];
+} Xoshiro256;
+
+static inline uint64_t rotl64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+uint64_t xoshiro_next(Xoshiro256 *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl64(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+    return result;
+}
+
+void xoshiro_seed(Xoshiro256 *rng, uint64_t seed) {
+    // splitmix64로 상태를 채운다
+    for (int i = 0; i < 4; i++) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        rng->s[i] = z ^ (z >> 31);
+    }
+}
+
+/**
+ * 상태를 2^128단계 앞으로 옮긴다.
+ * 
+ * 같은 시드에서 작업자마다 jump()를 번호만큼 적용하면 서로 겹치지 않는
+ * 부분 수열을 얻는다. (시드를 작업자마다 다르게 주면 splitmix64 상태가
+ * 같은 상수만큼 어긋나 이웃 작업자의 상태 워드가 한 칸씩 겹친다.)
+ */
+void xoshiro_jump(Xoshiro256 *rng) {
+    static const uint64_t jump[4] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+    uint64_t s[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (jump[i] & (1ULL << b)) {
+                s[0] ^= rng->s[0];
+                s[1] ^= rng->s[1];
+                s[2] ^= rng->s[2];
+                s[3] ^= rng->s[3];
+            }
+            xoshiro_next(rng);
+        }
+    }
+    memcpy(rng->s, s, sizeof(s));
+}
+
+/**
+ * 다이제스트 이름 또는 "MAC[:하위 알고리즘]" 형식으로 검정 대상을 준비한다.
+ * 
+ * MAC 키는 난수로 한 번 생성하여 모든 시행에 같은 키를 사용한다. GMAC은 IV가
+ * 없으면 계산할 수 없으므로 난수 96비트 IV도 한 번 생성하여 고정한다.
+ * 
+ * @return 성공 시 0, 실패 시 -1
+ */
+int sac_target_init(SacTarget *t, const char *digest_name, const char *mac_spec) {
+    memset(t, 0, sizeof(*t));
+    
+    if (digest_name != NULL) {
+        t->md = digest_fetch(digest_name);
+        if (t->md == NULL) {
+            fprintf(stderr, "알 수 없는 다이제스트: %s\n", digest_name);
+            return -1;
+        }
+        t->out_len = (size_t)EVP_MD_get_size(t->md);
+        snprintf(t->label, sizeof(t->label), "%s (다이제스트)", EVP_MD_get0_name(t->md));
+    } else {
+        char name[32];
+        const char *colon = strchr(mac_spec, ':');
+        size_t name_len = colon ? (size_t)(colon - mac_spec) : strlen(mac_spec);
+        if (name_len == 0 || name_len >= sizeof(name)) {
+            fprintf(stderr, "잘못된 MAC 지정: %s\n", mac_spec);
+            return -1;
+        }
+        memcpy(name, mac_spec, name_len);
+        name[name_len] = '\0';
+        
+        t->mac = EVP_MAC_fetch(NULL, name, NULL);
+        if (t->mac == NULL) {
+            fprintf(stderr, "알 수 없는 MAC: %s\n", name);
+            return -1;
+        }
+        
+        t->key_len = 32;
+        t->params[0] = OSSL_PARAM_construct_end();
+        if (colon != NULL) {
+            snprintf(t->param_value, sizeof(t->param_value), "%s", colon + 1);
+            int use_cipher = EVP_MAC_is_a(t->mac, "CMAC") || EVP_MAC_is_a(t->mac, "GMAC");
+            t->params[0] = OSSL_PARAM_construct_utf8_string(
+                use_cipher ? OSSL_MAC_PARAM_CIPHER : OSSL_MAC_PARAM_DIGEST,
+                t->param_value, 0);
+            if (use_cipher) {
+                const EVP_CIPHER *cipher = EVP_get_cipherbyname(t->param_value);
+                if (cipher == NULL) {
+                    fprintf(stderr, "알 수 없는 암호: %s\n", t->param_value);
+                    EVP_MAC_free(t->mac);
+                    return -1;
+                }
+                t->key_len = (size_t)EVP_CIPHER_get_key_length(cipher);
+            }
+        }
+        t->params[1] = OSSL_PARAM_construct_end();
+        if (EVP_MAC_is_a(t->mac, "SIPHASH")) {
+            t->key_len = 16;
+        }
+        if (EVP_MAC_is_a(t->mac, "GMAC")) {
+            if (colon == NULL) {
+                fprintf(stderr, "GMAC은 암호를 지정해야 합니다 (예: GMAC:aes-128-gcm)\n");
+                EVP_MAC_free(t->mac);
+                return -1;
+            }
+            if (RAND_bytes(t->iv, (int)sizeof(t->iv)) != 1) {
+                EVP_MAC_free(t->mac);
+                return -1;
+            }
+            t->params[1] = OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_IV,
+                                                             t->iv, sizeof(t->iv));
+            t->params[2] = OSSL_PARAM_construct_end();
+        }
+        if (RAND_bytes(t->key, (int)t->key_len) != 1) {
+            EVP_MAC_free(t->mac);
+            return -1;
+        }
+        
+        // 출력 길이와 키 없는 재초기화 가능 여부를 한 번 확인한다
+        EVP_MAC_CTX *ctx = EVP_MAC_CTX_new(t->mac);
+        unsigned char out[EVP_MAX_MD_SIZE];
+        size_t out_len = 0;
+        if (ctx == NULL ||
+            EVP_MAC_init(ctx, t->key, t->key_len, t->params) != 1 ||
+            EVP_MAC_update(ctx, (const unsigned char *)"", 0) != 1 ||
+            EVP_MAC_final(ctx, out, &out_len, sizeof(out)) != 1) {
+            fprintf(stderr, "MAC 초기화 실패: %s\n", mac_spec);
+            EVP_MAC_CTX_free(ctx);
+            EVP_MAC_free(t->mac);
+            return -1;
+        }
+        t->mac_reinit = (EVP_MAC_init(ctx, NULL, 0, t->params + 1) == 1 &&
+                         EVP_MAC_update(ctx, (const unsigned char *)"", 0) == 1 &&
+                         EVP_MAC_final(ctx, out, &out_len, sizeof(out)) == 1);
+        EVP_MAC_CTX_free(ctx);
+        t->out_len = out_len;
+        snprintf(t->label, sizeof(t->label), "%s (MAC, %zu바이트 난수 키)", mac_spec, t->key_len);
+    }
+    
+    if (t->out_len == 0 || t->out_len > SAC_MAX_OUTPUT_LEN) {
+        fprintf(stderr, "지원하지 않는 출력 길이: %zu바이트 (최대 %d)\n",
+                t->out_len, SAC_MAX_OUTPUT_LEN);
+        EVP_MAC_free(t->mac);
+        return -1;
+    }
+    return 0;
+}
+
+void sac_target_free(SacTarget *t) {
+    EVP_MAC_free(t->mac);
+}
+
+/**
+ * 작업자 컨텍스트로 대상 함수를 한 번 계산한다.
+ */
+static inline int sac_compute(const SacTarget *t, EVP_MD_CTX *md_ctx, EVP_MAC_CTX *mac_ctx,
+                              const unsigned char *data, size_t len, unsigned char *out) {
+    if (t->md != NULL) {
+        unsigned int out_len;
+        return (EVP_DigestInit_ex(md_ctx, t->md, NULL) == 1 &&
+                EVP_DigestUpdate(md_ctx, data, len) == 1 &&
+                EVP_DigestFinal_ex(md_ctx, out, &out_len) == 1) ? 0 : -1;
+    }
+    
+    // params[1..]은 시행마다 다시 넣어야 하는 값 (GMAC IV, 그 외에는 비어 있음)
+    size_t out_len;
+    int ok = t->mac_reinit ? EVP_MAC_init(mac_ctx, NULL, 0, t->params + 1)
+                           : EVP_MAC_init(mac_ctx, t->key, t->key_len, t->params + 1);
+    return (ok == 1 &&
+            EVP_MAC_update(mac_ctx, data, len) == 1 &&
+            EVP_MAC_final(mac_ctx, out, &out_len, SAC_MAX_OUTPUT_LEN) == 1) ? 0 : -1;
+}
+
+/**
+ * 출력 차이(diff)의 각 비트를 한 행의 8비트 카운터에 더한다.
+ * 
+ * 벡터 하나가 출력 2바이트(16비트)를 담당한다. 바이트를 8개 레인에 복제한 뒤
+ * 레인별 비트 마스크와 AND하여 0이 아닌 레인(-1)을 빼는 방식으로 분기 없이 센다.
+ * 비트 번호는 바이트 내 최상위 비트부터 (출력 비트 0 = 첫 바이트의 MSB).
+ */
+static inline void sac_accumulate_row(u8x16 *row, const unsigned char *diff, size_t vectors) {
+    const u8x16 mask = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                         0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+    for (size_t v = 0; v < vectors; v++) {
+        unsigned char a = diff[2 * v], b = diff[2 * v + 1];
+        u8x16 bytes = { a, a, a, a, a, a, a, a, b, b, b, b, b, b, b, b };
+        row[v] -= (u8x16)((bytes & mask) != 0);
+    }
+}
+
+/**
+ * 8비트 카운터 행렬을 32비트 누적 행렬로 옮기고 0으로 비운다.
+ */
+void sac_flush_counts(SacWorker *w, size_t input_bits) {
+    size_t cells = input_bits * w->row_vectors * 16;
+    const unsigned char *c8 = (const unsigned char *)w->counts8;
+    for (size_t i = 0; i < cells; i++) {
+        w->counts32[i] += c8[i];
+    }
+    memset(w->counts8, 0, cells);
+}
+
+/**
+ * SAC 작업자: 무작위 입력마다 기준 출력을 구한 뒤, 모든 입력 비트를
+ * 하나씩 반전하여 출력 차이를 누적한다 (메시지 1개 = 입력 비트 수만큼의 시행).
+ */
+void *sac_worker(void *arg) {
+    SacWorker *w = (SacWorker *)arg;
+    const SacTarget *t = w->target;
+    size_t input_bits = w->input_len * 8;
+    
+    EVP_MD_CTX *md_ctx = NULL;
+    EVP_MAC_CTX *mac_ctx = NULL;
+    if (t->md != NULL) {
+        md_ctx = digest_thread_ctx(t->md);   // 스레드 종료 시 자동 해제
+        if (md_ctx == NULL) {
+            w->failed = 1;
+        }
+    } else {
+        mac_ctx = EVP_MAC_CTX_new(t->mac);
+        if (mac_ctx == NULL || EVP_MAC_init(mac_ctx, t->key, t->key_len, t->params) != 1) {
+            w->failed = 1;
+        }
+    }
+    
+    Xoshiro256 rng;
+    xoshiro_seed(&rng, w->seed);
+    for (unsigned j = 0; j < w->stream; j++) {
+        xoshiro_jump(&rng);
+    }
+    
+    unsigned char input[SAC_MAX_INPUT_LEN + 8];
+    unsigned char base[SAC_MAX_OUTPUT_LEN];
+    unsigned char flipped[SAC_MAX_OUTPUT_LEN];
+    unsigned char diff[SAC_MAX_OUTPUT_LEN + 2] = { 0 };   // 홀수 길이 출력을 위한 여유
+    size_t pending = 0;
+    
+    for (size_t m = 0; m < w->messages && !w->failed; m++) {
+        for (size_t i = 0; i < w->input_len; i += 8) {
+            uint64_t r = xoshiro_next(&rng);
+            memcpy(input + i, &r, 8);
+        }
+        if (sac_compute(t, md_ctx, mac_ctx, input, w->input_len, base) != 0) {
+            w->failed = 1;
+            break;
+        }
+        
+        for (size_t bit = 0; bit < input_bits; bit++) {
+            unsigned char flip = (unsigned char)(0x80 >> (bit & 7));
+            input[bit >> 3] ^= flip;
+            int ret = sac_compute(t, md_ctx, mac_ctx, input, w->input_len, flipped);
+            input[bit >> 3] ^= flip;
+            if (ret != 0) {
+                w->failed = 1;
+                break;
+            }
+            
+            w->histogram[w->hamming(base, flipped, t->out_len)]++;
+            for (size_t i = 0; i < t->out_len; i++) {
+                diff[i] = base[i] ^ flipped[i];
+            }
+            sac_accumulate_row(w->counts8 + bit * w->row_vectors, diff, w->row_vectors);
+        }
+        
+        if (++pending == SAC_FLUSH_INTERVAL) {
+            sac_flush_counts(w, input_bits);
+            pending = 0;
+        }
+    }
+    sac_flush_counts(w, input_bits);
+    
+    EVP_MAC_CTX_free(mac_ctx);
+    return NULL;
+}
+
+/**
+ * 정규화된 상위 불완전 감마 함수 Q(a, x) (카이제곱 p-값 계산용)
+ */
+double upper_incomplete_gamma(double a, double x) {
+    if (x <= 0.0) {
+        return 1.0;
+    }
+    double log_prefix = -x + a * log(x) - lgamma(a);
+    
+    if (x < a + 1.0) {
+        // 급수 전개로 P(a, x)를 구한 뒤 1 - P
+        double sum = 1.0 / a, term = sum;
+        for (int n = 1; n < 10000; n++) {
+            term *= x / (a + n);
+            sum += term;
+            if (term < sum * 1e-15) break;
+        }
+        return 1.0 - sum * exp(log_prefix);
+    }
+    
+    // 연분수 전개 (수정 Lentz 방법)
+    double b = x + 1.0 - a, c = 1.0 / 1e-300, d = 1.0 / b, h = d;
+    for (int n = 1; n < 10000; n++) {
+        double an = -n * (n - a);
+        b += 2.0;
+        d = an * d + b;
+        if (fabs(d) < 1e-300) d = 1e-300;
+        c = b + an / c;
+        if (fabs(c) < 1e-300) c = 1e-300;
+        d = 1.0 / d;
+        double delta = d * c;
+        h *= delta;
+        if (fabs(delta - 1.0) < 1e-15) break;
+    }
+    return exp(log_prefix) * h;
+}
+
+/**
+ * 카이제곱 통계량의 p-값 (자유도 df)
+ */
+double chi_square_p_value(double chi2, int df) {
+    return upper_incomplete_gamma(df / 2.0, chi2 / 2.0);
+}
+
+/**
+ * 해밍 거리 분포를 이항분포 B(n, 1/2)와 비교하는 카이제곱 통계량.
+ * 기대 빈도가 5 미만인 양 끝 구간은 하나로 합친다.
+ */
+double hamming_chi_square(const uint64_t *histogram, int out_bits, uint64_t trials, int *df) {
+    double chi2 = 0.0;
+    double tail_observed = 0.0, tail_expected = 0.0;
+    int bins = 0;
+    
+    for (int k = 0; k <= out_bits; k++) {
+        // log C(n, k) - n log 2
+        double log_p = lgamma(out_bits + 1.0) - lgamma(k + 1.0) - lgamma(out_bits - k + 1.0)
+                       - out_bits * log(2.0);
+        double expected = (double)trials * exp(log_p);
+        if (expected < 5.0) {
+            tail_observed += (double)histogram[k];
+            tail_expected += expected;
+            continue;
+        }
+        double delta = (double)histogram[k] - expected;
+        chi2 += delta * delta / expected;
+        bins++;
+    }
+    if (tail_expected > 0.0) {
+        double delta = tail_observed - tail_expected;
+        chi2 += delta * delta / tail_expected;
+        bins++;
+    }
+    *df = bins - 1;
+    return chi2;
+}
+
+double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * SAC 검정을 실행하고 결과를 보고한다.
+ * 
+ * 보고 항목:
+ *   - 처리량 (trials/s)
+ *   - 출력 비트별 반전 확률 P(bit j 반전)과 그 카이제곱 (자유도 = 출력 비트 수)
+ *   - 해밍 거리 분포의 이항분포 적합도 카이제곱
+ *   - (입력 비트 i, 출력 비트 j) SAC 행렬의 최대 편차
+ * 
+ * @return 검정 통과 시 0, 편향 발견 시 2, 실행 실패 시 -1
+ */
+int run_sac(const SacTarget *t, size_t input_len, uint64_t trials,
+            int threads, uint64_t seed) {
+    const char *hamming_name;
+    HammingFn hamming = select_hamming_distance(&hamming_name);
+    
+    size_t input_bits = input_len * 8;
+    size_t out_bits = t->out_len * 8;
+    size_t row_vectors = (t->out_len + 1) / 2;
+    size_t cells = input_bits * row_vectors * 16;
+    size_t messages = (size_t)((trials + input_bits - 1) / input_bits);
+    if ((size_t)threads > messages) {
+        threads = (int)messages;
+    }
+    
+    printf("=== 엄격한 눈사태 기준(SAC) 검정 ===\n\n");
+    printf("대상:        %s\n", t->label);
+    printf("입력/출력:   %zu비트 / %zu비트\n", input_bits, out_bits);
+    printf("시행:        %llu회 (무작위 입력 %zu개 × 입력 비트 %zu개 반전)\n",
+           (unsigned long long)messages * input_bits, messages, input_bits);
+    printf("스레드:      %d\n", threads);
+    printf("비트 세기:   %s, 카운터 누적: 16레인 SIMD\n", hamming_name);
+    printf("시드:        0x%016llx\n\n", (unsigned long long)seed);
+    
+    SacWorker workers[SAC_MAX_WORKERS];
+    pthread_t tids[SAC_MAX_WORKERS];
+    int ret = -1;
+    int started = 0;
+    
+    memset(workers, 0, sizeof(workers));
+    for (int i = 0; i < threads; i++) {
+        SacWorker *w = &workers[i];
+        w->target = t;
+        w->hamming = hamming;
+        w->input_len = input_len;
+        w->messages = messages / threads + ((size_t)i < messages % threads ? 1 : 0);
+        w->seed = seed;
+        w->stream = (unsigned)i;
+        w->row_vectors = row_vectors;
+        w->counts8 = aligned_alloc(64, (cells + 63) & ~(size_t)63);
+        w->counts32 = calloc(cells, sizeof(uint32_t));
+        w->histogram = calloc(out_bits + 1, sizeof(uint64_t));
+        if (w->counts8 == NULL || w->counts32 == NULL || w->histogram == NULL) {
+            fprintf(stderr, "메모리 할당 실패\n");
+            goto cleanup;
+        }
+        memset(w->counts8, 0, cells);
+    }
+    
+    double start = now_seconds();
+    for (; started < threads; started++) {
+        if (pthread_create(&tids[started], NULL, sac_worker, &workers[started]) != 0) {
+            fprintf(stderr, "스레드 생성 실패\n");
+            break;
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    double elapsed = now_seconds() - start;
+    if (started < threads) {
+        goto cleanup;
+    }
+    
+    // 작업자 결과 병합
+    uint64_t *cell_counts = calloc(cells, sizeof(uint64_t));
+    uint64_t *histogram = calloc(out_bits + 1, sizeof(uint64_t));
+    if (cell_counts == NULL || histogram == NULL) {
+        free(cell_counts);
+        free(histogram);
+        goto cleanup;
+    }
+    for (int i = 0; i < threads; i++) {
+        if (workers[i].failed) {
+            fprintf(stderr, "작업자 %d: 해시 계산 실패\n", i);
+            free(cell_counts);
+            free(histogram);
+            goto cleanup;
+        }
+        for (size_t c = 0; c < cells; c++) {
+            cell_counts[c] += workers[i].counts32[c];
+        }
+        for (size_t k = 0; k <= out_bits; k++) {
+            histogram[k] += workers[i].histogram[k];
+        }
+    }
+    
+    uint64_t total_trials = (uint64_t)messages * input_bits;
+    size_t stride = row_vectors * 16;
+    printf("경과 시간:   %.2f초\n", elapsed);
+    printf("처리량:      %.0f trials/s\n\n", (double)total_trials / elapsed);
+    
+    // 해밍 거리 평균/표준편차
+    double mean = 0.0, var = 0.0;
+    for (size_t k = 0; k <= out_bits; k++) {
+        mean += (double)k * (double)histogram[k];
+    }
+    mean /= (double)total_trials;
+    for (size_t k = 0; k <= out_bits; k++) {
+        var += ((double)k - mean) * ((double)k - mean) * (double)histogram[k];
+    }
+    var /= (double)total_trials;
+    printf("평균 비트 차이: %.4f / %zu (이상값 %.1f)\n", mean, out_bits, out_bits / 2.0);
+    printf("표준편차:       %.4f (이상값 %.4f)\n\n", sqrt(var), sqrt((double)out_bits) / 2.0);
+    
+    // 출력 비트별 반전 확률과 카이제곱
+    printf("=== 출력 비트별 반전 확률 (이상값 0.5) ===\n\n");
+    double half = (double)total_trials / 2.0;
+    double bit_chi2 = 0.0;
+    double worst_bias = 0.0;
+    size_t worst_bit = 0;
+    for (size_t j = 0; j < out_bits; j++) {
+        uint64_t flips = 0;
+        for (size_t i = 0; i < input_bits; i++) {
+            flips += cell_counts[i * stride + j];
+        }
+        double p = (double)flips / (double)total_trials;
+        double delta = (double)flips - half;
+        bit_chi2 += delta * delta / (half / 2.0);
+        if (fabs(p - 0.5) > worst_bias) {
+            worst_bias = fabs(p - 0.5);
+            worst_bit = j;
+        }
+        printf("  %4zu:%.5f", j, p);
+        if (j % 8 == 7 || j + 1 == out_bits) {
+            printf("\n");
+        }
+    }
+    double bit_sigma = 0.5 / sqrt((double)total_trials);
+    double bit_p = chi_square_p_value(bit_chi2, (int)out_bits);
+    printf("\n최대 편향: 비트 %zu, |p - 0.5| = %.2e (%.2f σ)\n",
+           worst_bit, worst_bias, worst_bias / bit_sigma);
+    printf("카이제곱 (출력 비트): %.2f, 자유도 %zu, p-값 %.4f\n", bit_chi2, out_bits, bit_p);
+    
+    // 해밍 거리 분포 적합도
+    int hamming_df;
+    double hamming_chi2 = hamming_chi_square(histogram, (int)out_bits, total_trials, &hamming_df);
+    double hamming_p = chi_square_p_value(hamming_chi2, hamming_df);
+    printf("카이제곱 (해밍 거리 vs B(%zu, 1/2)): %.2f, 자유도 %d, p-값 %.4f\n",
+           out_bits, hamming_chi2, hamming_df, hamming_p);
+    
+    // SAC 행렬 (입력 비트 i → 출력 비트 j) 최대 편차
+    double cell_trials = (double)messages;
+    double cell_sigma = 0.5 / sqrt(cell_trials);
+    double worst_cell = 0.0;
+    size_t worst_i = 0, worst_j = 0;
+    for (size_t i = 0; i < input_bits; i++) {
+        for (size_t j = 0; j < out_bits; j++) {
+            double dev = fabs((double)cell_counts[i * stride + j] / cell_trials - 0.5);
+            if (dev > worst_cell) {
+                worst_cell = dev;
+                worst_i = i;
+                worst_j = j;
+            }
+        }
+    }
+    // 셀 수만큼의 다중 비교를 고려한 기대 최대 편차 ≈ σ × sqrt(2 ln(셀 수))
+    double expected_max = cell_sigma * sqrt(2.0 * log((double)(input_bits * out_bits)));
+    printf("SAC 행렬 최대 편차: 입력 비트 %zu → 출력 비트 %zu, %.2e (%.2f σ, 무작위 기대 최대 ≈ %.2f σ)\n\n",
+           worst_i, worst_j, worst_cell, worst_cell / cell_sigma, expected_max / cell_sigma);
+    
+    if (bit_p < SAC_PASS_P_VALUE || hamming_p < SAC_PASS_P_VALUE) {
+        printf("✗ 편향 발견 (p < %g)\n", SAC_PASS_P_VALUE);
+        ret = 2;
+    } else {
+        printf("✓ 통계적으로 유의한 편향 없음 (p ≥ %g)\n", SAC_PASS_P_VALUE);
+        ret = 0;
+    }
+    free(cell_counts);
+    free(histogram);
+
+cleanup:
+    for (int i = 0; i < threads; i++) {
+        free(workers[i].counts8);
+        free(workers[i].counts32);
+        free(workers[i].histogram);
+    }
+    return ret;
+}
+
+void print_usage(const char *program_name) {
+    printf("사용법:\n");
+    printf("  %s                      - SHA-256 눈사태 효과 시연\n", program_name);
+    printf("  %s --sac [옵션]         - SAC 통계 검정 (모든 코어 사용)\n", program_name);
+    printf("\nSAC 옵션:\n");
+    printf("  -a <다이제스트>    EVP 다이제스트 (기본 sha256, 예: sha512, sha3-256, blake2b512)\n");
+    printf("  -m <MAC[:알고리즘]> EVP MAC (예: HMAC:sha256, CMAC:aes-128-cbc, GMAC:aes-128-gcm, KMAC128, SIPHASH)\n");
+    printf("  -n <시행 수>       1비트 반전 시행 수 (기본 %lu)\n", SAC_DEFAULT_TRIALS);
+    printf("  -l <바이트>        입력 길이 (기본 %d, 최대 %d, 8의 배수)\n",
+           SAC_DEFAULT_INPUT_LEN, SAC_MAX_INPUT_LEN);
+    printf("  -t <스레드>        작업자 수 (기본: 온라인 코어 수)\n");
+    printf("  -s <시드>          입력 생성 시드 (기본: 난수, 재현 시 지정)\n");
+    printf("\n예시:\n");
+    printf("  %s --sac -a sha256 -n 300000000\n", program_name);
+    printf("  %s --sac -m HMAC:sha256 -l 64\n", program_name);
+}
+
+/**
+ * --sac 모드의 옵션을 해석하고 검정을 실행한다.
+ */
+int sac_main(int argc, char *argv[]) {
+    const char *digest_name = NULL;
+    const char *mac_spec = NULL;
+    uint64_t trials = SAC_DEFAULT_TRIALS;
+    size_t input_len = SAC_DEFAULT_INPUT_LEN;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = (cores > 0) ? (int)cores : 1;
+    uint64_t seed;
+    int seed_given = 0;
+    
+    for (int i = 2; i < argc; i++) {
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        const char *opt = argv[i];
+        const char *val = argv[++i];
+        if (strcmp(opt, "-a") == 0) {
+            digest_name = val;
+        } else if (strcmp(opt, "-m") == 0) {
+            mac_spec = val;
+        } else if (strcmp(opt, "-n") == 0) {
+            trials = strtoull(val, NULL, 0);
+        } else if (strcmp(opt, "-l") == 0) {
+            input_len = (size_t)strtoul(val, NULL, 10);
+        } else if (strcmp(opt, "-t") == 0) {
+            threads = atoi(val);
+        } else if (strcmp(opt, "-s") == 0) {
+            seed = strtoull(val, NULL, 0);
+            seed_given = 1;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (digest_name != NULL && mac_spec != NULL) {
+        fprintf(stderr, "-a와 -m은 함께 지정할 수 없습니다.\n");
+        return 1;
+    }
+    if (input_len == 0 || input_len > SAC_MAX_INPUT_LEN || input_len % 8 != 0) {
+        fprintf(stderr, "입력 길이는 8의 배수로 8 ~ %d바이트여야 합니다.\n", SAC_MAX_INPUT_LEN);
+        return 1;
+    }
+    if (trials == 0) {
+        fprintf(stderr, "시행 수는 1 이상이어야 합니다.\n");
+        return 1;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > SAC_MAX_WORKERS) threads = SAC_MAX_WORKERS;
+    if (!seed_given && RAND_bytes((unsigned char *)&seed, sizeof(seed)) != 1) {
+        return 1;
+    }
+    
+    SacTarget target;
+    if (sac_target_init(&target, (mac_spec == NULL && digest_name == NULL) ? "sha256" : digest_name,
+                        mac_spec) != 0) {
+        return 1;
+    }
+    int ret = run_sac(&target, input_len, trials, threads, seed);
+    sac_target_free(&target);
+    return (ret < 0) ? 1 : ret;
+}
+
+int main(int argc, char *argv[]) {
+    cpu_features_apply_override(argv);
+    
+    if (argc >= 2 && strcmp(argv[1], "--sac") == 0) {
+        return sac_main(argc, argv);
+    }
+    if (argc >= 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
     printf("=== SHA-256 눈사태 효과(Avalanche Effect) 시연 ===\n\n");
     
     // 원본 데이터
@@ -103,7 +868,7 @@ int main(void) {
         int bit_diff = count_bit_differences(hash_original, hash_modified, 32);
         double percent = (bit_diff / 256.0) * 100.0;
         
-        printf("비트 %d 반전 ('%c'→'%c'):\n", 
+        printf("비트 %d 반전 ('%c'→'%c'):\n",
                bit, original[0], modified[0]);
         printf("  변경 해시: ");
         print_hash(hash_modified, 32);
@@ -146,6 +911,7 @@ int main(void) {
     
     printf("→ 1비트 입력 변화가 출력의 약 50%%를 변화시킴\n");
     printf("→ 이것이 '눈사태 효과'이며, 좋은 해시 함수의 특성이다.\n");
+    printf("→ 통계적 검정은 --sac 모드로 수백만~수억 회 시행하라.\n");
     
     return 0;
 }
@@ -0,0 +1,375 @@
+/**
+ * event_log.c - 해시 체인 이벤트 로그 기록/검증 도구
+ *
+ * event_log.h의 추가 전용 로그에 cFE EVS 형식의 모의 이벤트를 기록하고,
+ * 체크포인트 구간별 병렬 검증과 변조 탐지를 보여준다.
+ *
+ * 빌드: make
+ * 실행: ./bin/event_log keygen hmac|ecdsa <키 파일>
+ *       ./bin/event_log write <로그> <키 파일> [-c 이벤트 수] [-n N] [-T ms]
+ *       ./bin/event_log verify <로그> <키 파일> [-t 스레드]
+ *       ./bin/event_log bench [-c 이벤트 수] [-t 스레드]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/ec.h>
+#include <openssl/pem.h>
+#include "event_log.h"
+
+#define DEFAULT_EVENTS 200000
+#define DEFAULT_EVERY_N 1024
+#define DEFAULT_EVERY_MS 100
+#define HMAC_KEY_FILE_SIZE 32
+
+static const char *sample_apps[] = { "CFE_ES", "CFE_EVS", "CFE_SB", "SAMPLE_APP", "SCH_LAB", "HK" };
+
+/**
+ * 모의 이벤트 i를 기록한다 (앱/종류/ID/메시지를 i로부터 결정).
+ */
+static int append_sample_event(EventLog *log, uint64_t i) {
+    char message[EVLOG_MESSAGE_MAX + 1];
+    const char *app = sample_apps[i % (sizeof(sample_apps) / sizeof(sample_apps[0]))];
+    EvlogEventType type = (i % 97 == 0) ? EVLOG_ERROR :
+                          (i % 13 == 0) ? EVLOG_DEBUG : EVLOG_INFORMATION;
+
+    snprintf(message, sizeof(message), "%s: HK request processed, cmd_count=%llu err_count=%llu",
+             app, (unsigned long long)i, (unsigned long long)(i / 97));
+    return evlog_append(log, app, (uint16_t)(i % 64 + 1), type, message);
+}
+
+/**
+ * 키 파일을 읽는다. PEM이면 ECDSA, 32바이트 원시 파일이면 HMAC 키로 본다.
+ *
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int load_key(const char *path, EvlogKey *key) {
+    memset(key, 0, sizeof(*key));
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror("키 파일 열기 실패");
+        return -1;
+    }
+    unsigned char buf[HMAC_KEY_FILE_SIZE + 1];
+    size_t n = fread(buf, 1, sizeof(buf), f);
+
+    if (n >= 10 && memcmp(buf, "-----BEGIN", 10) == 0) {
+        rewind(f);
+        key->kind = EVLOG_CHECKPOINT_ECDSA;
+        key->pkey = PEM_read_PrivateKey(f, NULL, NULL, NULL);
+        if (key->pkey == NULL) {
+            rewind(f);
+            key->pkey = PEM_read_PUBKEY(f, NULL, NULL, NULL);   // 검증 전용
+        }
+        fclose(f);
+        return (key->pkey != NULL) ? 0 : -1;
+    }
+    fclose(f);
+
+    if (n != HMAC_KEY_FILE_SIZE) {
+        fprintf(stderr, "HMAC 키 파일은 정확히 %d바이트여야 합니다\n", HMAC_KEY_FILE_SIZE);
+        return -1;
+    }
+    key->kind = EVLOG_CHECKPOINT_HMAC;
+    hmac_key_init(&key->hmac, buf, n);
+    hmac_key_wipe(buf, sizeof(buf));
+    return 0;
+}
+
+static void free_key(EvlogKey *key) {
+    hmac_key_clear(&key->hmac);
+    EVP_PKEY_free(key->pkey);
+    key->pkey = NULL;
+}
+
+/**
+ * 메모리 안에서 키를 만든다 (벤치마크용).
+ */
+static int generate_key(EvlogCheckpointKind kind, EvlogKey *key) {
+    memset(key, 0, sizeof(*key));
+    key->kind = kind;
+
+    if (kind == EVLOG_CHECKPOINT_HMAC) {
+        unsigned char secret[HMAC_KEY_FILE_SIZE];
+        if (RAND_bytes(secret, sizeof(secret)) != 1) {
+            return -1;
+        }
+        hmac_key_init(&key->hmac, secret, sizeof(secret));
+        hmac_key_wipe(secret, sizeof(secret));
+        return 0;
+    }
+
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL);
+    int ok = ctx != NULL &&
+             EVP_PKEY_keygen_init(ctx) == 1 &&
+             EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx, NID_X9_62_prime256v1) == 1 &&
+             EVP_PKEY_keygen(ctx, &key->pkey) == 1;
+    EVP_PKEY_CTX_free(ctx);
+    return ok ? 0 : -1;
+}
+
+static int cmd_keygen(const char *kind, const char *path) {
+    EvlogKey key;
+
+    if (strcmp(kind, "hmac") == 0) {
+        unsigned char secret[HMAC_KEY_FILE_SIZE];
+        if (RAND_bytes(secret, sizeof(secret)) != 1) {
+            return 1;
+        }
+        int fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+        int ok = fd >= 0 && write(fd, secret, sizeof(secret)) == (ssize_t)sizeof(secret);
+        if (fd >= 0) close(fd);
+        hmac_key_wipe(secret, sizeof(secret));
+        if (!ok) {
+            perror("키 파일 쓰기 실패");
+            return 1;
+        }
+    } else if (strcmp(kind, "ecdsa") == 0) {
+        if (generate_key(EVLOG_CHECKPOINT_ECDSA, &key) != 0) {
+            return 1;
+        }
+        int fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+        FILE *f = (fd >= 0) ? fdopen(fd, "w") : NULL;
+        int ok = f != NULL && PEM_write_PrivateKey(f, key.pkey, NULL, NULL, 0, NULL, NULL) == 1;
+        if (f != NULL) fclose(f);
+        else if (fd >= 0) close(fd);
+        free_key(&key);
+        if (!ok) {
+            perror("키 파일 쓰기 실패");
+            return 1;
+        }
+    } else {
+        fprintf(stderr, "키 종류는 hmac 또는 ecdsa\n");
+        return 1;
+    }
+    printf("✓ %s 키 생성: %s\n", kind, path);
+    return 0;
+}
+
+/**
+ * count개 이벤트를 기록하고 기록 속도를 돌려준다.
+ *
+ * @return events/s, 실패 시 -1
+ */
+static double write_events(const char *path, EvlogKey *key, uint64_t count,
+                           uint32_t every_n, uint32_t every_ms, uint64_t *checkpoints) {
+    EventLog log;
+    if (evlog_create(&log, path, key, every_n, every_ms) != 0) {
+        return -1;
+    }
+
+    double start = evlog_now();
+    for (uint64_t i = 0; i < count; i++) {
+        if (append_sample_event(&log, i) != 0) {
+            evlog_close(&log);
+            return -1;
+        }
+    }
+    if (evlog_close(&log) != 0) {
+        return -1;
+    }
+    double elapsed = evlog_now() - start;
+
+    if (checkpoints != NULL) {
+        *checkpoints = log.checkpoints;
+    }
+    return (double)count / (elapsed > 0 ? elapsed : 1e-9);
+}
+
+static void print_report(const EvlogVerifyReport *r, int ok, double elapsed) {
+    if (r->format_error) {
+        printf("✗ 로그 구조 오류 (헤더/레코드 손상 또는 키 종류 불일치)\n");
+        return;
+    }
+    printf("이벤트: %llu, 체크포인트: %llu, 작업자: %d, 검증 시간: %.3f초 (%.0f events/s)\n",
+           (unsigned long long)r->events, (unsigned long long)r->checkpoints,
+           r->workers, elapsed, elapsed > 0 ? (double)r->events / elapsed : 0.0);
+    if (ok) {
+        printf("✓ 인증된 이벤트: %llu\n", (unsigned long long)r->authenticated);
+    } else {
+        printf("✗ 변조 탐지: 실패 구간 %llu개, 첫 실패 구간 시작 순번 %llu "
+               "(그 앞 %llu개만 신뢰 가능)\n",
+               (unsigned long long)r->failed_segments, (unsigned long long)r->first_bad_event,
+               (unsigned long long)r->authenticated);
+    }
+    if (r->unauthenticated_tail > 0) {
+        printf("⚠ 마지막 체크포인트 뒤 미인증 꼬리: %llu개 이벤트\n",
+               (unsigned long long)r->unauthenticated_tail);
+    }
+}
+
+static int cmd_write(const char *path, const char *key_path, uint64_t count,
+                     uint32_t every_n, uint32_t every_ms) {
+    EvlogKey key;
+    if (load_key(key_path, &key) != 0) {
+        fprintf(stderr, "키 로드 실패: %s\n", key_path);
+        return 1;
+    }
+    uint64_t checkpoints = 0;
+    double rate = write_events(path, &key, count, every_n, every_ms, &checkpoints);
+    free_key(&key);
+    if (rate < 0) {
+        fprintf(stderr, "로그 기록 실패: %s\n", path);
+        return 1;
+    }
+    printf("✓ %llu개 이벤트 기록: %s\n", (unsigned long long)count, path);
+    printf("  체크포인트 %llu개 (N=%u, T=%ums, %s)\n", (unsigned long long)checkpoints,
+           every_n, every_ms, key.kind == EVLOG_CHECKPOINT_HMAC ? "HMAC-SHA256" : "ECDSA P-256");
+    printf("  기록 속도: %.0f events/s\n", rate);
+    return 0;
+}
+
+static int cmd_verify(const char *path, const char *key_path, int threads) {
+    EvlogKey key;
+    if (load_key(key_path, &key) != 0) {
+        fprintf(stderr, "키 로드 실패: %s\n", key_path);
+        return 1;
+    }
+    EvlogVerifyReport report;
+    double start = evlog_now();
+    int ret = evlog_verify(path, &key, threads, &report);
+    double elapsed = evlog_now() - start;
+    free_key(&key);
+
+    print_report(&report, ret == 0, elapsed);
+    return (ret == 0) ? 0 : 1;
+}
+
+/**
+ * 파일의 offset 위치 바이트 하나를 뒤집는다 (변조 시뮬레이션).
+ */
+static int flip_byte(const char *path, off_t offset) {
+    int fd = open(path, O_RDWR);
+    unsigned char b;
+    int ok = fd >= 0 && pread(fd, &b, 1, offset) == 1;
+    b ^= 0x01;
+    ok = ok && pwrite(fd, &b, 1, offset) == 1;
+    if (fd >= 0) close(fd);
+    return ok ? 0 : -1;
+}
+
+/**
+ * 체크포인트 간격(N)과 방식별 기록 속도, 병렬 검증 속도, 변조 탐지를 측정한다.
+ */
+static int cmd_bench(uint64_t count, int threads) {
+    static const uint32_t intervals[] = { 1, 16, 256, 4096 };
+    static const EvlogCheckpointKind kinds[] = { EVLOG_CHECKPOINT_HMAC, EVLOG_CHECKPOINT_ECDSA };
+    char path[] = "/tmp/evlog_bench_XXXXXX";
+    int failures = 0;
+
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("임시 파일 생성 실패");
+        return 1;
+    }
+    close(fd);
+
+    printf("=== 이벤트 로그 벤치마크 (%llu개 이벤트) ===\n\n", (unsigned long long)count);
+    printf("%-12s %6s %14s %12s %16s\n", "체크포인트", "N", "기록 events/s", "체크포인트", "검증 events/s");
+
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        EvlogKey key;
+        if (generate_key(kinds[k], &key) != 0) {
+            unlink(path);
+            return 1;
+        }
+        for (size_t i = 0; i < sizeof(intervals) / sizeof(intervals[0]); i++) {
+            uint64_t n = count;
+            if (kinds[k] == EVLOG_CHECKPOINT_ECDSA && intervals[i] == 1 && n > 20000) {
+                n = 20000;   // 이벤트마다 서명은 느리므로 표본만 측정
+            }
+            unlink(path);
+            uint64_t checkpoints = 0;
+            double rate = write_events(path, &key, n, intervals[i], 0, &checkpoints);
+
+            EvlogVerifyReport report;
+            double start = evlog_now();
+            int ret = evlog_verify(path, &key, threads, &report);
+            double elapsed = evlog_now() - start;
+
+            if (rate < 0 || ret != 0 || report.authenticated != n) {
+                failures++;
+            }
+            printf("%-12s %6u %14.0f %12llu %16.0f\n",
+                   kinds[k] == EVLOG_CHECKPOINT_HMAC ? "HMAC" : "ECDSA",
+                   intervals[i], rate, (unsigned long long)checkpoints,
+                   elapsed > 0 ? (double)n / elapsed : 0.0);
+        }
+
+        // 변조 탐지: 가운데 이벤트 근처 한 바이트를 뒤집으면 해당 구간만 실패해야 한다
+        struct stat st;
+        if (stat(path, &st) == 0 && flip_byte(path, st.st_size / 2) == 0) {
+            EvlogVerifyReport report;
+            int ret = evlog_verify(path, &key, threads, &report);
+            int detected = (ret != 0 && (report.format_error || report.failed_segments > 0));
+            printf("  변조 탐지 (%s): %s\n", kinds[k] == EVLOG_CHECKPOINT_HMAC ? "HMAC" : "ECDSA",
+                   detected ? "✓ 탐지됨" : "✗ 놓침");
+            failures += !detected;
+        }
+        free_key(&key);
+    }
+    unlink(path);
+
+    printf("\n→ 체크포인트 간격 N을 키우면 MAC/서명 비용이 N개 이벤트에 분산되어\n");
+    printf("  이벤트당 비용이 체인 해시 한 번으로 수렴한다.\n");
+    return failures == 0 ? 0 : 1;
+}
+
+static void usage(const char *prog) {
+    printf("사용법:\n");
+    printf("  %s keygen hmac|ecdsa <키 파일>\n", prog);
+    printf("  %s write <로그> <키 파일> [-c 이벤트 수] [-n N] [-T ms]\n", prog);
+    printf("  %s verify <로그> <키 파일> [-t 스레드]\n", prog);
+    printf("  %s bench [-c 이벤트 수] [-t 스레드]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t count = DEFAULT_EVENTS;
+    uint32_t every_n = DEFAULT_EVERY_N;
+    uint32_t every_ms = DEFAULT_EVERY_MS;
+    int threads = 0;
+
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // 공통 옵션 파싱 (위치 인자 뒤)
+    int positional = 1;
+    while (positional < argc && argv[positional][0] != '-') {
+        positional++;
+    }
+    for (int i = positional; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-c") == 0) {
+            count = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-n") == 0) {
+            every_n = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-T") == 0) {
+            every_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-t") == 0) {
+            threads = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const char *cmd = argv[1];
+    if (strcmp(cmd, "keygen") == 0 && positional == 4) {
+        return cmd_keygen(argv[2], argv[3]);
+    } else if (strcmp(cmd, "write") == 0 && positional == 4) {
+        return cmd_write(argv[2], argv[3], count, every_n, every_ms);
+    } else if (strcmp(cmd, "verify") == 0 && positional == 4) {
+        return cmd_verify(argv[2], argv[3], threads);
+    } else if (strcmp(cmd, "bench") == 0 && positional == 2) {
+        return cmd_bench(count, threads);
+    }
+    usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,584 @@
+/**
+ * event_log.h - 해시 체인 + 주기적 MAC/서명 체크포인트 기반 변조 탐지 이벤트 로그
+ *
+ * cFE EVS 로그처럼 고속으로 쌓이는 이벤트를 추가 전용(append-only) 파일에
+ * 기록하면서 변조/삭제/순서 변경을 탐지한다.
+ *
+ *   chain_0 = SHA256(파일 헤더)
+ *   chain_i = SHA256(chain_{i-1} || 이벤트 레코드 i)
+ *
+ * 이벤트마다 MAC을 붙이는 대신, N개 이벤트 또는 T밀리초마다 한 번
+ * 체크포인트 레코드에 (이벤트 수, chain) 쌍과 그 HMAC-SHA256 또는
+ * ECDSA P-256 서명을 기록한다. 체인 덕분에 체크포인트 하나가 그 이전의
+ * 모든 이벤트를 보증하므로, 무결성 비용은 이벤트당 해시 한 번(1~3블록)과
+ * N개당 MAC/서명 한 번이다.
+ *
+ * 검증은 체크포인트 경계로 로그를 구간으로 나누어 병렬로 수행한다.
+ * 구간 k의 시작 chain은 체크포인트 k-1에 기록된 값이며, 그 값은 구간 k-1의
+ * 작업자가 인증하므로 모든 구간이 통과하면 로그 전체가 인증된다.
+ *
+ * 파일 형식 (evlog-v1, 정수는 빅엔디언):
+ *   헤더 (64바이트):
+ *     "EVLOG1\0\0" | u32 버전(1) | u32 체크포인트 종류(1: HMAC, 2: ECDSA)
+ *     | u32 N | u32 T(ms) | u8 nonce[32] | u8 예약[8]
+ *   이벤트 레코드:
+ *     'E' | u8 종류 | u16 이벤트 ID | u64 순번 | u64 시각(ns)
+ *     | u8 앱 이름 길이 | u8 메시지 길이 | u8 예약(0) | 앱 이름 | 메시지
+ *   체크포인트 레코드:
+ *     'C' | u8 태그 길이 | u64 이벤트 수 | u8 chain[32] | 태그
+ *   태그 = HMAC 또는 ECDSA(SHA-256) over "EVLOG1CP" | u64 이벤트 수 | chain
+ *
+ * 마지막 체크포인트 뒤의 이벤트는 인증되지 않으므로 검증 보고서에
+ * "미인증 꼬리"로 따로 표시한다. evlog_close()는 닫기 전에 체크포인트를 쓴다.
+ */
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include "digest_ctx.h"
+#include "hmac_key.h"
+
+#define EVLOG_MAGIC "EVLOG1\0\0"
+#define EVLOG_VERSION 1
+#define EVLOG_HEADER_SIZE 64
+#define EVLOG_EVENT_FIXED 23             // 'E' + 종류 + ID + 순번 + 시각 + 길이 2개 + 예약
+#define EVLOG_CHECKPOINT_FIXED 42        // 'C' + 태그 길이 + 이벤트 수 + chain
+#define EVLOG_APP_NAME_MAX 20            // cFE OS_MAX_API_NAME
+#define EVLOG_MESSAGE_MAX 122            // CFE_MISSION_EVS_MAX_MESSAGE_LENGTH
+#define EVLOG_TAG_MAX 80                 // ECDSA P-256 DER 서명 최대 72바이트
+#define EVLOG_MAX_WORKERS 256
+
+/**
+ * 이벤트 종류 (cFE CFE_EVS_EventType)
+ */
+typedef enum {
+    EVLOG_DEBUG = 1,
+    EVLOG_INFORMATION = 2,
+    EVLOG_ERROR = 3,
+    EVLOG_CRITICAL = 4
+} EvlogEventType;
+
+/**
+ * 체크포인트 인증 방식
+ */
+typedef enum {
+    EVLOG_CHECKPOINT_HMAC = 1,          // HMAC-SHA256 (대칭 키, 빠름)
+    EVLOG_CHECKPOINT_ECDSA = 2          // ECDSA P-256 (공개 키로 누구나 검증)
+} EvlogCheckpointKind;
+
+/**
+ * 체크포인트 키. ECDSA는 쓰기에 개인 키, 검증에 공개 키(또는 개인 키)가 필요하다.
+ */
+typedef struct {
+    EvlogCheckpointKind kind;
+    HmacSha256Key hmac;
+    EVP_PKEY *pkey;
+} EvlogKey;
+
+/**
+ * 로그 작성기
+ */
+typedef struct {
+    FILE *file;
+    EvlogKey *key;
+    uint32_t every_n;                   // N개 이벤트마다 체크포인트 (0: 사용 안 함)
+    uint32_t every_ms;                  // T밀리초마다 체크포인트 (0: 사용 안 함)
+    unsigned char chain[32];
+    uint64_t seq;                       // 지금까지 기록한 이벤트 수
+    uint64_t pending;                   // 마지막 체크포인트 이후 이벤트 수
+    uint64_t checkpoints;
+    double last_checkpoint;
+} EventLog;
+
+/**
+ * 검증 결과
+ */
+typedef struct {
+    uint64_t events;                    // 파싱한 이벤트 수
+    uint64_t authenticated;             // 체크포인트로 인증된 이벤트 수
+    uint64_t checkpoints;
+    uint64_t unauthenticated_tail;      // 마지막 체크포인트 뒤의 이벤트 수
+    uint64_t failed_segments;
+    uint64_t first_bad_event;           // 첫 실패 구간의 시작 순번 (실패 시)
+    int format_error;                   // 헤더/레코드 구조 오류
+    int workers;
+} EvlogVerifyReport;
+
+static inline void evlog_put_be16(unsigned char *p, uint16_t v) {
+    p[0] = (unsigned char)(v >> 8);
+    p[1] = (unsigned char)v;
+}
+
+static inline void evlog_put_be32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(v >> (24 - 8 * i));
+    }
+}
+
+static inline void evlog_put_be64(unsigned char *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)(v >> (56 - 8 * i));
+    }
+}
+
+static inline uint32_t evlog_get_be32(const unsigned char *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t evlog_get_be64(const unsigned char *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline double evlog_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * chain = SHA256(chain || record)
+ */
+static inline int evlog_chain_update(unsigned char *chain, const unsigned char *record, size_t len) {
+    EVP_MD_CTX *ctx = digest_stream_begin(digest_sha256_md());
+    if (ctx == NULL ||
+        digest_stream_update(ctx, chain, 32) != 0 ||
+        digest_stream_update(ctx, record, len) != 0) {
+        return -1;
+    }
+    return digest_stream_final(ctx, chain, NULL);
+}
+
+/**
+ * 체크포인트 태그가 덮는 메시지: "EVLOG1CP" | u64 이벤트 수 | chain
+ */
+static inline void evlog_checkpoint_message(uint64_t count, const unsigned char *chain,
+                                            unsigned char msg[48]) {
+    memcpy(msg, "EVLOG1CP", 8);
+    evlog_put_be64(msg + 8, count);
+    memcpy(msg + 16, chain, 32);
+}
+
+/**
+ * 체크포인트 태그를 만든다.
+ *
+ * @return 태그 길이, 실패 시 -1
+ */
+static inline int evlog_sign_checkpoint(const EvlogKey *key, uint64_t count,
+                                        const unsigned char *chain, unsigned char *tag) {
+    unsigned char msg[48];
+    evlog_checkpoint_message(count, chain, msg);
+
+    if (key->kind == EVLOG_CHECKPOINT_HMAC) {
+        hmac_key_mac(&key->hmac, msg, sizeof(msg), tag);
+        return HMAC_KEY_MAC_SIZE;
+    }
+
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    size_t sig_len = EVLOG_TAG_MAX;
+    int ok = ctx != NULL &&
+             EVP_DigestSignInit(ctx, NULL, digest_sha256_md(), NULL, key->pkey) == 1 &&
+             EVP_DigestSign(ctx, tag, &sig_len, msg, sizeof(msg)) == 1;
+    EVP_MD_CTX_free(ctx);
+    return ok ? (int)sig_len : -1;
+}
+
+/**
+ * 체크포인트 태그를 검증한다.
+ *
+ * @return 유효하면 0, 아니면 -1
+ */
+static inline int evlog_verify_checkpoint(const EvlogKey *key, uint64_t count,
+                                          const unsigned char *chain,
+                                          const unsigned char *tag, size_t tag_len) {
+    unsigned char msg[48];
+    evlog_checkpoint_message(count, chain, msg);
+
+    if (key->kind == EVLOG_CHECKPOINT_HMAC) {
+        if (tag_len != HMAC_KEY_MAC_SIZE) {
+            return -1;
+        }
+        return hmac_key_verify(&key->hmac, msg, sizeof(msg), tag);
+    }
+
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    int ok = ctx != NULL &&
+             EVP_DigestVerifyInit(ctx, NULL, digest_sha256_md(), NULL, key->pkey) == 1 &&
+             EVP_DigestVerify(ctx, tag, tag_len, msg, sizeof(msg)) == 1;
+    EVP_MD_CTX_free(ctx);
+    return ok ? 0 : -1;
+}
+
+/**
+ * 체크포인트 레코드를 기록하고 파일을 플러시한다.
+ *
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int evlog_checkpoint(EventLog *log) {
+    unsigned char record[EVLOG_CHECKPOINT_FIXED + EVLOG_TAG_MAX];
+    int tag_len = evlog_sign_checkpoint(log->key, log->seq, log->chain,
+                                        record + EVLOG_CHECKPOINT_FIXED);
+    if (tag_len < 0) {
+        return -1;
+    }
+    record[0] = 'C';
+    record[1] = (unsigned char)tag_len;
+    evlog_put_be64(record + 2, log->seq);
+    memcpy(record + 10, log->chain, 32);
+
+    size_t len = EVLOG_CHECKPOINT_FIXED + (size_t)tag_len;
+    if (fwrite(record, 1, len, log->file) != len || fflush(log->file) != 0) {
+        return -1;
+    }
+    log->pending = 0;
+    log->checkpoints++;
+    log->last_checkpoint = evlog_now();
+    return 0;
+}
+
+/**
+ * 새 로그 파일을 만든다 (이미 있으면 실패, 추가 전용).
+ *
+ * @param every_n N개 이벤트마다 체크포인트 (0: 사용 안 함)
+ * @param every_ms T밀리초마다 체크포인트 (0: 사용 안 함, append 시점에 확인)
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int evlog_create(EventLog *log, const char *path, EvlogKey *key,
+                               uint32_t every_n, uint32_t every_ms) {
+    memset(log, 0, sizeof(*log));
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644);
+    if (fd < 0) {
+        perror("로그 파일 생성 실패");
+        return -1;
+    }
+    log->file = fdopen(fd, "ab");
+    if (log->file == NULL) {
+        close(fd);
+        return -1;
+    }
+
+    unsigned char header[EVLOG_HEADER_SIZE] = { 0 };
+    memcpy(header, EVLOG_MAGIC, 8);
+    evlog_put_be32(header + 8, EVLOG_VERSION);
+    evlog_put_be32(header + 12, (uint32_t)key->kind);
+    evlog_put_be32(header + 16, every_n);
+    evlog_put_be32(header + 20, every_ms);
+    if (RAND_bytes(header + 24, 32) != 1 ||
+        fwrite(header, 1, sizeof(header), log->file) != sizeof(header) ||
+        digest_sha256(header, sizeof(header), log->chain) != 0) {
+        fclose(log->file);
+        log->file = NULL;
+        return -1;
+    }
+
+    log->key = key;
+    log->every_n = every_n;
+    log->every_ms = every_ms;
+    log->last_checkpoint = evlog_now();
+    return 0;
+}
+
+/**
+ * 이벤트 하나를 기록한다. 체인을 갱신하고 필요하면 체크포인트를 쓴다.
+ *
+ * @param app 앱 이름 (최대 20바이트, 넘으면 자름)
+ * @param message 메시지 (최대 122바이트, 넘으면 자름)
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int evlog_append(EventLog *log, const char *app, uint16_t event_id,
+                               EvlogEventType type, const char *message) {
+    unsigned char record[EVLOG_EVENT_FIXED + EVLOG_APP_NAME_MAX + EVLOG_MESSAGE_MAX];
+    size_t app_len = strnlen(app, EVLOG_APP_NAME_MAX);
+    size_t msg_len = strnlen(message, EVLOG_MESSAGE_MAX);
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    record[0] = 'E';
+    record[1] = (unsigned char)type;
+    evlog_put_be16(record + 2, event_id);
+    evlog_put_be64(record + 4, log->seq);
+    evlog_put_be64(record + 12, (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+    record[20] = (unsigned char)app_len;
+    record[21] = (unsigned char)msg_len;
+    record[22] = 0;
+    memcpy(record + EVLOG_EVENT_FIXED, app, app_len);
+    memcpy(record + EVLOG_EVENT_FIXED + app_len, message, msg_len);
+
+    size_t len = EVLOG_EVENT_FIXED + app_len + msg_len;
+    if (evlog_chain_update(log->chain, record, len) != 0 ||
+        fwrite(record, 1, len, log->file) != len) {
+        return -1;
+    }
+    log->seq++;
+    log->pending++;
+
+    int due = (log->every_n > 0 && log->pending >= log->every_n);
+    if (!due && log->every_ms > 0 &&
+        (evlog_now() - log->last_checkpoint) * 1000.0 >= log->every_ms) {
+        due = 1;
+    }
+    return due ? evlog_checkpoint(log) : 0;
+}
+
+/**
+ * 마지막 체크포인트를 쓰고 로그를 닫는다.
+ *
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int evlog_close(EventLog *log) {
+    int ret = 0;
+    if (log->file == NULL) {
+        return -1;
+    }
+    if (log->pending > 0 && evlog_checkpoint(log) != 0) {
+        ret = -1;
+    }
+    if (fclose(log->file) != 0) {
+        ret = -1;
+    }
+    log->file = NULL;
+    return ret;
+}
+
+/* ===== 병렬 검증 ===== */
+
+/**
+ * 체크포인트로 끝나는 검증 구간
+ */
+typedef struct {
+    size_t start;                        // 첫 이벤트 레코드 오프셋
+    size_t checkpoint;                   // 구간을 닫는 체크포인트 오프셋
+    uint64_t first_seq;                  // 구간 첫 이벤트 순번
+    const unsigned char *start_chain;    // 이전 체크포인트(또는 헤더)의 chain
+    int failed;
+} EvlogSegment;
+
+typedef struct {
+    const unsigned char *map;
+    const EvlogKey *key;
+    EvlogSegment *segments;
+    size_t segment_count;
+    atomic_size_t next;
+} EvlogVerifyJob;
+
+/**
+ * 레코드 하나의 길이를 구한다 (구조 검사 포함).
+ *
+ * @return 레코드 길이, 잘못된 레코드면 0
+ */
+static inline size_t evlog_record_length(const unsigned char *p, size_t remaining) {
+    if (remaining >= EVLOG_EVENT_FIXED && p[0] == 'E') {
+        size_t len = EVLOG_EVENT_FIXED + p[20] + p[21];
+        if (p[20] > EVLOG_APP_NAME_MAX || p[21] > EVLOG_MESSAGE_MAX || len > remaining) {
+            return 0;
+        }
+        return len;
+    }
+    if (remaining >= EVLOG_CHECKPOINT_FIXED && p[0] == 'C') {
+        size_t len = EVLOG_CHECKPOINT_FIXED + p[1];
+        if (p[1] > EVLOG_TAG_MAX || len > remaining) {
+            return 0;
+        }
+        return len;
+    }
+    return 0;
+}
+
+/**
+ * 검증 작업자: 구간을 원자적으로 하나씩 가져와 체인을 다시 계산하고
+ * 체크포인트의 chain/이벤트 수/태그와 비교한다.
+ */
+static inline void *evlog_verify_worker(void *arg) {
+    EvlogVerifyJob *job = (EvlogVerifyJob *)arg;
+
+    for (;;) {
+        size_t idx = atomic_fetch_add(&job->next, 1);
+        if (idx >= job->segment_count) {
+            break;
+        }
+        EvlogSegment *seg = &job->segments[idx];
+        unsigned char chain[32];
+        memcpy(chain, seg->start_chain, 32);
+
+        uint64_t seq = seg->first_seq;
+        size_t off = seg->start;
+        int ok = 1;
+        while (off < seg->checkpoint) {
+            const unsigned char *rec = job->map + off;
+            size_t len = EVLOG_EVENT_FIXED + rec[20] + rec[21];
+            if (evlog_get_be64(rec + 4) != seq ||
+                evlog_chain_update(chain, rec, len) != 0) {
+                ok = 0;
+                break;
+            }
+            seq++;
+            off += len;
+        }
+
+        const unsigned char *cp = job->map + seg->checkpoint;
+        if (ok) {
+            ok = evlog_get_be64(cp + 2) == seq &&
+                 hmac_key_equal(cp + 10, chain) == 0 &&
+                 evlog_verify_checkpoint(job->key, seq, cp + 10,
+                                         cp + EVLOG_CHECKPOINT_FIXED, cp[1]) == 0;
+        }
+        seg->failed = !ok;
+    }
+    return NULL;
+}
+
+/**
+ * 로그 전체를 병렬로 검증한다.
+ *
+ * 1) 레코드 길이만 따라가며 체크포인트 위치로 구간을 나누고 (순차, 가벼움)
+ * 2) 구간마다 체인 재계산과 태그 검증을 작업자 스레드에 나눈다.
+ *
+ * @param threads 작업자 수 (0: 온라인 코어 수)
+ * @return 모든 구간이 인증되면 0, 변조/구조 오류가 있으면 -1
+ */
+static inline int evlog_verify(const char *path, const EvlogKey *key, int threads,
+                               EvlogVerifyReport *report) {
+    memset(report, 0, sizeof(*report));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("로그 파일 열기 실패");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < EVLOG_HEADER_SIZE) {
+        close(fd);
+        report->format_error = 1;
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    const unsigned char *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    madvise((void *)map, size, MADV_SEQUENTIAL);
+
+    int ret = -1;
+    EvlogSegment *segments = NULL;
+    unsigned char header_chain[32];
+
+    if (memcmp(map, EVLOG_MAGIC, 8) != 0 || evlog_get_be32(map + 8) != EVLOG_VERSION ||
+        evlog_get_be32(map + 12) != (uint32_t)key->kind) {
+        report->format_error = 1;
+        goto cleanup;
+    }
+    digest_sha256(map, EVLOG_HEADER_SIZE, header_chain);
+
+    // 1단계: 구간 나누기
+    size_t capacity = 1024, count = 0;
+    segments = malloc(capacity * sizeof(*segments));
+    if (segments == NULL) {
+        goto cleanup;
+    }
+    size_t off = EVLOG_HEADER_SIZE, seg_start = off;
+    uint64_t events = 0, seg_first = 0;
+    const unsigned char *prev_chain = header_chain;
+    while (off < size) {
+        size_t len = evlog_record_length(map + off, size - off);
+        if (len == 0) {
+            report->format_error = 1;
+            goto cleanup;
+        }
+        if (map[off] == 'E') {
+            events++;
+        } else {
+            if (count == capacity) {
+                capacity *= 2;
+                EvlogSegment *grown = realloc(segments, capacity * sizeof(*segments));
+                if (grown == NULL) {
+                    goto cleanup;
+                }
+                segments = grown;
+            }
+            segments[count].start = seg_start;
+            segments[count].checkpoint = off;
+            segments[count].first_seq = seg_first;
+            segments[count].start_chain = prev_chain;
+            segments[count].failed = 0;
+            count++;
+            prev_chain = map + off + 10;
+            seg_start = off + len;
+            seg_first = events;
+        }
+        off += len;
+    }
+    report->events = events;
+    report->checkpoints = count;
+    report->unauthenticated_tail = events - seg_first;
+    report->authenticated = seg_first;
+
+    // 2단계: 구간 병렬 검증
+    if (threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cores > 0) ? (int)cores : 1;
+    }
+    if (threads > EVLOG_MAX_WORKERS) threads = EVLOG_MAX_WORKERS;
+    if ((size_t)threads > count) threads = (count > 0) ? (int)count : 1;
+    report->workers = threads;
+
+    EvlogVerifyJob job;
+    job.map = map;
+    job.key = key;
+    job.segments = segments;
+    job.segment_count = count;
+    atomic_init(&job.next, 0);
+
+    pthread_t tids[EVLOG_MAX_WORKERS];
+    int started = 0;
+    for (; started < threads; started++) {
+        if (pthread_create(&tids[started], NULL, evlog_verify_worker, &job) != 0) {
+            break;
+        }
+    }
+    if (started == 0) {
+        evlog_verify_worker(&job);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (segments[i].failed) {
+            if (report->failed_segments == 0) {
+                report->first_bad_event = segments[i].first_seq;
+            }
+            report->failed_segments++;
+        }
+    }
+    if (report->failed_segments > 0) {
+        report->authenticated = report->first_bad_event;   // 첫 실패 구간 앞까지만 신뢰
+    }
+    ret = (report->failed_segments == 0) ? 0 : -1;
+
+cleanup:
+    free(segments);
+    munmap((void *)map, size);
+    return ret;
+}
+
+#endif /* EVENT_LOG_H */
@@ -5,37 +5,186 @@
  * 
  * 빌드: make
  * 실행: ./bin/file_integrity <파일경로>
+ *       ./bin/file_integrity --bench <파일경로>
+ *       ./bin/file_integrity -r <디렉터리> [매니페스트]
+ *       ./bin/file_integrity -c <매니페스트>
+ *       ./bin/file_integrity --tree <파일경로> [리프크기KB]
+ *       ./bin/file_integrity --cache <캐시파일> <파일경로>...
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
 #include <openssl/evp.h>
+#include "digest_ctx.h"
+#include "sha256_mb.h"
 
 #define BUFFER_SIZE 4096
+#define MMAP_WINDOW_SIZE (64UL * 1024 * 1024)   // 한 번에 매핑하는 창 크기
+#define BENCH_ROUNDS 3
+#define DIGEST_SET_MAX 8                         // 한 번에 계산할 수 있는 최대 알고리즘 수
+#define DIGEST_SET_SLICE (64 * 1024)             // 모든 컨텍스트에 차례로 넣는 조각 크기
+#define DEFAULT_DIGESTS "sha256,sha512,sha3-256,blake2b512"
+#define MAX_WORKERS 256
+#define MANIFEST_LINE_MAX 8192
+#define MANIFEST_BATCH 32                        // 작업자가 한 번에 가져가는 항목 수
+#define SMALL_FILE_MAX (16 * 1024)               // 다중 버퍼 해시로 처리할 최대 파일 크기
 
 /**
- * 파일의 SHA-256 해시를 계산한다.
+ * 매니페스트 항목 (파일 하나)
+ */
+typedef struct {
+    char *path;
+    unsigned long long size;
+    unsigned char hash[32];       // 계산된 해시
+    unsigned char expected[32];   // 검증 모드: 매니페스트에 기록된 해시
+    int status;                   // 0: 성공, -1: 읽기 실패, 1: 해시 불일치
+} ManifestEntry;
+
+/**
+ * 작업자 스레드가 공유하는 작업 큐
+ * 
+ * 각 작업자는 next를 원자적으로 증가시켜 다음 항목을 가져간다.
+ */
+typedef struct {
+    ManifestEntry *entries;
+    size_t count;
+    int verify;
+    atomic_size_t next;
+} ManifestJob;
+
+/**
+ * 한 번의 읽기로 여러 다이제스트를 동시에 계산하기 위한 집합
+ * 
+ * 읽은 버퍼를 DIGEST_SET_SLICE 크기 조각으로 나누어 조각마다 모든 컨텍스트에
+ * 차례로 넣는다. 조각이 캐시에 남아 있는 동안 모든 알고리즘이 처리하므로
+ * 큰 mmap 창을 알고리즘 수만큼 메모리에서 다시 읽지 않는다.
+ */
+typedef struct {
+    int count;
+    const char *names[DIGEST_SET_MAX];
+    const EVP_MD *md[DIGEST_SET_MAX];
+    EVP_MD_CTX *ctx[DIGEST_SET_MAX];
+    unsigned char digest[DIGEST_SET_MAX][EVP_MAX_MD_SIZE];
+    unsigned int digest_len[DIGEST_SET_MAX];
+} DigestSet;
+
+void digest_set_free(DigestSet *set) {
+    for (int i = 0; i < set->count; i++) {
+        EVP_MD_CTX_free(set->ctx[i]);
+        free((char *)set->names[i]);
+    }
+    set->count = 0;
+}
+
+/**
+ * 쉼표로 구분된 알고리즘 이름 목록으로 다이제스트 집합을 만든다.
+ * 
+ * @param names 예: "sha256,sha512,sha3-256,blake2b512" (OpenSSL 이름)
+ * @return 성공 시 0, 알 수 없는 알고리즘이거나 너무 많으면 -1
+ */
+int digest_set_init(DigestSet *set, const char *names) {
+    memset(set, 0, sizeof(*set));
+    
+    const char *p = names;
+    while (*p != '\0') {
+        size_t len = strcspn(p, ",");
+        if (len > 0) {
+            if (set->count == DIGEST_SET_MAX) {
+                fprintf(stderr, "알고리즘은 최대 %d개까지 지정할 수 있습니다.\n", DIGEST_SET_MAX);
+                digest_set_free(set);
+                return -1;
+            }
+            char *name = strndup(p, len);
+            const EVP_MD *md = (name != NULL) ? digest_fetch(name) : NULL;
+            EVP_MD_CTX *ctx = (md != NULL) ? EVP_MD_CTX_new() : NULL;
+            if (ctx == NULL) {
+                fprintf(stderr, "알 수 없는 해시 알고리즘: %.*s\n", (int)len, p);
+                free(name);
+                digest_set_free(set);
+                return -1;
+            }
+            set->names[set->count] = name;
+            set->md[set->count] = md;
+            set->ctx[set->count] = ctx;
+            set->count++;
+        }
+        p += len;
+        if (*p == ',') {
+            p++;
+        }
+    }
+    
+    if (set->count == 0) {
+        fprintf(stderr, "해시 알고리즘이 지정되지 않았습니다.\n");
+        return -1;
+    }
+    return 0;
+}
+
+int digest_set_begin(DigestSet *set) {
+    for (int i = 0; i < set->count; i++) {
+        if (EVP_DigestInit_ex(set->ctx[i], set->md[i], NULL) != 1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int digest_set_update(DigestSet *set, const unsigned char *data, size_t len) {
+    while (len > 0) {
+        size_t slice = (len > DIGEST_SET_SLICE) ? DIGEST_SET_SLICE : len;
+        for (int i = 0; i < set->count; i++) {
+            if (EVP_DigestUpdate(set->ctx[i], data, slice) != 1) {
+                return -1;
+            }
+        }
+        data += slice;
+        len -= slice;
+    }
+    return 0;
+}
+
+int digest_set_finish(DigestSet *set) {
+    for (int i = 0; i < set->count; i++) {
+        if (EVP_DigestFinal_ex(set->ctx[i], set->digest[i], &set->digest_len[i]) != 1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 파일을 fread() 버퍼 경로로 읽어 집합의 모든 다이제스트를 계산한다.
+ * 
+ * 파이프, 특수 파일 등 mmap이 불가능한 입력에 대한 대체 경로이다.
  * 
  * @param filepath 파일 경로
- * @param hash 해시 결과를 저장할 버퍼 (최소 32바이트)
+ * @param set 다이제스트 집합 (결과는 set->digest에 저장)
  * @return 성공 시 0, 실패 시 -1
  */
-int calculate_file_hash(const char *filepath, unsigned char *hash) {
+int digest_file_buffered(const char *filepath, DigestSet *set) {
     FILE *file = fopen(filepath, "rb");
     if (file == NULL) {
         perror("파일 열기 실패");
         return -1;
     }
     
-    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
-    if (ctx == NULL) {
-        fclose(file);
-        return -1;
-    }
-    
-    if (EVP_DigestInit_ex(ctx, EVP_sha256(), NULL) != 1) {
-        EVP_MD_CTX_free(ctx);
+    if (digest_set_begin(set) != 0) {
         fclose(file);
         return -1;
     }
@@ -45,23 +194,516 @@ int calculate_file_hash(const char *filepath, unsigned char *hash) {
     
     // 파일을 청크 단위로 읽으며 해시 업데이트
     while ((bytes_read = fread(buffer, 1, BUFFER_SIZE, file)) > 0) {
-        if (EVP_DigestUpdate(ctx, buffer, bytes_read) != 1) {
-            EVP_MD_CTX_free(ctx);
+        if (digest_set_update(set, buffer, bytes_read) != 0) {
             fclose(file);
             return -1;
         }
     }
     
-    unsigned int hash_len = 0;
-    if (EVP_DigestFinal_ex(ctx, hash, &hash_len) != 1) {
-        EVP_MD_CTX_free(ctx);
-        fclose(file);
+    int ret = (ferror(file) || digest_set_finish(set) != 0) ? -1 : 0;
+    fclose(file);
+    return ret;
+}
+
+/**
+ * 파일을 메모리 매핑(mmap) 경로로 읽어 집합의 모든 다이제스트를 계산한다.
+ * 
+ * 파일을 MMAP_WINDOW_SIZE 단위 창으로 매핑하여 사용자 공간 복사 없이
+ * 페이지 캐시를 직접 해시한다. 커널에 순차 접근을 알리고, 현재 창을
+ * 해시하는 동안 다음 창의 미리 읽기(readahead)를 요청한다.
+ * 
+ * @param filepath 파일 경로
+ * @param set 다이제스트 집합 (결과는 set->digest에 저장)
+ * @return 성공 시 0, 실패 시 -1, mmap 불가 시 -2 (버퍼 경로로 대체 필요)
+ */
+int digest_file_mmap(const char *filepath, DigestSet *set) {
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        perror("파일 열기 실패");
         return -1;
     }
     
-    EVP_MD_CTX_free(ctx);
-    fclose(file);
-    return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        // 일반 파일이 아니거나 빈 파일은 매핑할 수 없음
+        close(fd);
+        return -2;
+    }
+    
+    size_t file_size = (size_t)st.st_size;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    
+    if (digest_set_begin(set) != 0) {
+        close(fd);
+        return -1;
+    }
+    
+    int ret = 0;
+    for (size_t offset = 0; offset < file_size; offset += MMAP_WINDOW_SIZE) {
+        size_t window = file_size - offset;
+        if (window > MMAP_WINDOW_SIZE) {
+            window = MMAP_WINDOW_SIZE;
+        }
+        
+        // 다음 창을 미리 읽도록 커널에 요청 (현재 창 해시와 I/O 중첩)
+        if (offset + window < file_size) {
+            posix_fadvise(fd, (off_t)(offset + window), MMAP_WINDOW_SIZE,
+                          POSIX_FADV_WILLNEED);
+        }
+        
+        void *map = mmap(NULL, window, PROT_READ, MAP_PRIVATE, fd, (off_t)offset);
+        if (map == MAP_FAILED) {
+            // 첫 창부터 실패하면 버퍼 경로로 대체할 수 있도록 -2 반환
+            ret = (offset == 0) ? -2 : -1;
+            break;
+        }
+        // advice 값은 비트 플래그가 아닌 열거값이므로 하나씩 호출
+        madvise(map, window, MADV_SEQUENTIAL);
+        madvise(map, window, MADV_WILLNEED);
+        
+        int ok = digest_set_update(set, map, window);
+        munmap(map, window);
+        if (ok != 0) {
+            ret = -1;
+            break;
+        }
+    }
+    
+    if (ret == 0 && digest_set_finish(set) != 0) {
+        ret = -1;
+    }
+    
+    close(fd);
+    return ret;
+}
+
+/**
+ * io_uring 비동기 읽기 경로
+ * 
+ * URING_QUEUE_DEPTH개의 읽기를 동시에 제출해 두고, 가장 오래된 블록이 완료되는
+ * 대로 순서대로 다이제스트 집합에 넣은 뒤 그 버퍼로 다음 읽기를 다시 제출한다.
+ * 해시 계산과 디스크 I/O가 겹치므로 읽기 시스템 콜마다 CPU가 멈추지 않는다.
+ * 
+ * liburing 없이 io_uring_setup/io_uring_enter 시스템 콜을 직접 사용한다.
+ * 링과 버퍼는 스레드마다 한 번만 만들어 재사용하므로 작은 파일이 많은
+ * 매니페스트 모드에서도 파일당 설정 비용이 없다. 커널이 io_uring을 지원하지
+ * 않거나 정책으로 막혀 있으면 mmap/fread 경로로 자동 대체한다. io_uring_setup은
+ * 있어도 IORING_OP_READ가 없는 커널(5.1~5.5)은 링 생성 직후 IORING_REGISTER_PROBE로
+ * 걸러내고, 그래도 첫 읽기가 -EINVAL/-EOPNOTSUPP로 끝나면 같은 방식으로 대체한다.
+ */
+#define URING_QUEUE_DEPTH 8
+#define URING_BLOCK_SIZE (1024UL * 1024)
+
+/**
+ * 스레드별 io_uring 링과 읽기 버퍼
+ */
+typedef struct {
+    int ring_fd;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr;
+    size_t sq_len;
+    void *cq_ptr;
+    size_t cq_len;
+    size_t sqes_len;
+    unsigned char *buffers;   // URING_QUEUE_DEPTH * URING_BLOCK_SIZE
+} UringReader;
+
+/**
+ * 읽기 슬롯 하나의 상태
+ */
+typedef struct {
+    unsigned long long offset;
+    size_t len;
+    size_t filled;
+    int pending;
+} UringSlot;
+
+static pthread_key_t uring_key;
+static pthread_once_t uring_key_once = PTHREAD_ONCE_INIT;
+static atomic_int uring_unsupported = 0;   // 한 번 실패하면 다시 시도하지 않음
+
+static void uring_reader_destroy(void *arg) {
+    UringReader *reader = (UringReader *)arg;
+    if (reader == NULL) {
+        return;
+    }
+    if (reader->sqes != NULL && reader->sqes != MAP_FAILED) {
+        munmap(reader->sqes, reader->sqes_len);
+    }
+    if (reader->cq_ptr != NULL && reader->cq_ptr != MAP_FAILED &&
+        reader->cq_ptr != reader->sq_ptr) {
+        munmap(reader->cq_ptr, reader->cq_len);
+    }
+    if (reader->sq_ptr != NULL && reader->sq_ptr != MAP_FAILED) {
+        munmap(reader->sq_ptr, reader->sq_len);
+    }
+    if (reader->ring_fd >= 0) {
+        close(reader->ring_fd);
+    }
+    free(reader->buffers);
+    free(reader);
+}
+
+static void uring_key_init(void) {
+    pthread_key_create(&uring_key, uring_reader_destroy);
+}
+
+/**
+ * 링이 IORING_OP_READ를 지원하는지 확인한다.
+ * 
+ * IORING_REGISTER_PROBE와 IORING_OP_READ는 같은 커널(5.6)에서 추가되었으므로
+ * 프로브 자체가 실패하면 읽기 연산도 없는 것으로 본다.
+ */
+static int uring_supports_read(int ring_fd) {
+    size_t len = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, len);
+    if (probe == NULL) {
+        return 0;
+    }
+    int supported = 0;
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, 256) >= 0 &&
+        probe->last_op >= IORING_OP_READ &&
+        (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED)) {
+        supported = 1;
+    }
+    free(probe);
+    return supported;
+}
+
+/**
+ * 현재 스레드의 io_uring 리더를 가져온다 (처음 호출 시 생성).
+ * 
+ * @return 리더, io_uring을 사용할 수 없으면 NULL
+ */
+UringReader *uring_reader_get(void) {
+    if (atomic_load(&uring_unsupported)) {
+        return NULL;
+    }
+    pthread_once(&uring_key_once, uring_key_init);
+    
+    UringReader *reader = pthread_getspecific(uring_key);
+    if (reader != NULL) {
+        return reader;
+    }
+    
+    reader = calloc(1, sizeof(*reader));
+    if (reader == NULL) {
+        return NULL;
+    }
+    reader->ring_fd = -1;
+    
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int ring_fd = (int)syscall(__NR_io_uring_setup, URING_QUEUE_DEPTH, &params);
+    if (ring_fd < 0) {
+        atomic_store(&uring_unsupported, 1);
+        free(reader);
+        return NULL;
+    }
+    reader->ring_fd = ring_fd;
+    
+    if (!uring_supports_read(ring_fd)) {
+        uring_reader_destroy(reader);
+        atomic_store(&uring_unsupported, 1);
+        return NULL;
+    }
+    
+    reader->sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    reader->cq_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (reader->cq_len > reader->sq_len) {
+            reader->sq_len = reader->cq_len;
+        }
+        reader->cq_len = reader->sq_len;
+    }
+    
+    reader->sq_ptr = mmap(NULL, reader->sq_len, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (reader->sq_ptr == MAP_FAILED) {
+        uring_reader_destroy(reader);
+        atomic_store(&uring_unsupported, 1);
+        return NULL;
+    }
+    
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        reader->cq_ptr = reader->sq_ptr;
+    } else {
+        reader->cq_ptr = mmap(NULL, reader->cq_len, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (reader->cq_ptr == MAP_FAILED) {
+            uring_reader_destroy(reader);
+            atomic_store(&uring_unsupported, 1);
+            return NULL;
+        }
+    }
+    
+    reader->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+    reader->sqes = mmap(NULL, reader->sqes_len, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (reader->sqes == MAP_FAILED) {
+        uring_reader_destroy(reader);
+        atomic_store(&uring_unsupported, 1);
+        return NULL;
+    }
+    
+    unsigned char *sq = reader->sq_ptr;
+    unsigned char *cq = reader->cq_ptr;
+    reader->sq_head = (unsigned *)(sq + params.sq_off.head);
+    reader->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    reader->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    reader->sq_array = (unsigned *)(sq + params.sq_off.array);
+    reader->cq_head = (unsigned *)(cq + params.cq_off.head);
+    reader->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    reader->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    reader->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    
+    if (posix_memalign((void **)&reader->buffers, 4096,
+                       URING_QUEUE_DEPTH * URING_BLOCK_SIZE) != 0) {
+        reader->buffers = NULL;
+        uring_reader_destroy(reader);
+        return NULL;
+    }
+    
+    pthread_setspecific(uring_key, reader);
+    return reader;
+}
+
+/**
+ * 슬롯의 남은 부분에 대한 읽기 요청을 제출 큐에 넣는다 (아직 커널에 알리지 않음).
+ */
+static void uring_queue_read(UringReader *reader, int fd, unsigned slot_index,
+                             UringSlot *slot) {
+    unsigned tail = *reader->sq_tail;
+    unsigned index = tail & *reader->sq_mask;
+    struct io_uring_sqe *sqe = &reader->sqes[index];
+    
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->off = slot->offset + slot->filled;
+    sqe->addr = (unsigned long long)(uintptr_t)
+                (reader->buffers + slot_index * URING_BLOCK_SIZE + slot->filled);
+    sqe->len = (unsigned)(slot->len - slot->filled);
+    sqe->user_data = slot_index;
+    
+    reader->sq_array[index] = index;
+    __atomic_store_n(reader->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    slot->pending = 1;
+}
+
+/**
+ * 큐에 넣은 요청을 제출하고, min_complete개 이상 완료될 때까지 기다린다.
+ */
+static int uring_submit_and_wait(UringReader *reader, unsigned to_submit,
+                                 unsigned min_complete) {
+    for (;;) {
+        long ret = syscall(__NR_io_uring_enter, reader->ring_fd, to_submit,
+                           min_complete, min_complete ? IORING_ENTER_GETEVENTS : 0,
+                           NULL, 0);
+        if (ret >= 0) {
+            return 0;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * 파일을 io_uring 비동기 읽기 경로로 읽어 집합의 모든 다이제스트를 계산한다.
+ * 
+ * @param filepath 파일 경로
+ * @param set 다이제스트 집합 (결과는 set->digest에 저장)
+ * @return 성공 시 0, 실패 시 -1, io_uring 불가 시 -2 (다른 경로로 대체 필요)
+ */
+int digest_file_uring(const char *filepath, DigestSet *set) {
+    UringReader *reader = uring_reader_get();
+    if (reader == NULL) {
+        return -2;
+    }
+    
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        perror("파일 열기 실패");
+        return -1;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return -2;
+    }
+    unsigned long long file_size = (unsigned long long)st.st_size;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    
+    if (digest_set_begin(set) != 0) {
+        close(fd);
+        return -1;
+    }
+    
+    UringSlot slots[URING_QUEUE_DEPTH];
+    memset(slots, 0, sizeof(slots));
+    unsigned long long next_offset = 0;
+    unsigned inflight = 0;
+    unsigned queued = 0;
+    
+    // 처음 URING_QUEUE_DEPTH개 블록을 한꺼번에 제출
+    for (unsigned i = 0; i < URING_QUEUE_DEPTH && next_offset < file_size; i++) {
+        slots[i].offset = next_offset;
+        slots[i].len = (file_size - next_offset > URING_BLOCK_SIZE)
+                       ? URING_BLOCK_SIZE : (size_t)(file_size - next_offset);
+        next_offset += slots[i].len;
+        uring_queue_read(reader, fd, i, &slots[i]);
+        inflight++;
+        queued++;
+    }
+    
+    int ret = 0;
+    unsigned head = 0;   // 다음에 해시할 슬롯 (파일 순서)
+    
+    while (inflight > 0 && ret == 0) {
+        if (uring_submit_and_wait(reader, queued, 1) != 0) {
+            ret = -1;
+            break;
+        }
+        queued = 0;
+        
+        // 완료 큐 수거
+        unsigned cq_head = *reader->cq_head;
+        unsigned cq_tail = __atomic_load_n(reader->cq_tail, __ATOMIC_ACQUIRE);
+        for (; cq_head != cq_tail; cq_head++) {
+            struct io_uring_cqe *cqe = &reader->cqes[cq_head & *reader->cq_mask];
+            UringSlot *slot = &slots[cqe->user_data];
+            slot->pending = 0;
+            if (cqe->res <= 0) {
+                if ((cqe->res == -EINVAL || cqe->res == -EOPNOTSUPP) &&
+                    next_offset <= URING_QUEUE_DEPTH * URING_BLOCK_SIZE && head == 0) {
+                    // 첫 제출분에서 읽기 연산이 거부됨: io_uring을 끄고 다른 경로로 대체
+                    atomic_store(&uring_unsupported, 1);
+                    if (ret == 0) {
+                        ret = -2;
+                    }
+                } else if (ret == 0 || ret == -2) {
+                    // 오류 또는 예상치 못한 EOF (읽는 중 파일이 줄어듦)
+                    ret = -1;
+                }
+                continue;
+            }
+            slot->filled += (size_t)cqe->res;
+            if (slot->filled < slot->len) {
+                // 짧은 읽기: 나머지를 다시 제출
+                uring_queue_read(reader, fd, (unsigned)cqe->user_data, slot);
+                queued++;
+            }
+        }
+        __atomic_store_n(reader->cq_head, cq_head, __ATOMIC_RELEASE);
+        
+        // 순서대로 완료된 블록을 해시하고 버퍼를 다음 블록에 재사용
+        while (ret == 0 && inflight > 0 &&
+               !slots[head].pending && slots[head].filled == slots[head].len) {
+            if (digest_set_update(set, reader->buffers + head * URING_BLOCK_SIZE,
+                                  slots[head].len) != 0) {
+                ret = -1;
+                break;
+            }
+            inflight--;
+            
+            if (next_offset < file_size) {
+                slots[head].offset = next_offset;
+                slots[head].len = (file_size - next_offset > URING_BLOCK_SIZE)
+                                  ? URING_BLOCK_SIZE : (size_t)(file_size - next_offset);
+                slots[head].filled = 0;
+                next_offset += slots[head].len;
+                uring_queue_read(reader, fd, head, &slots[head]);
+                inflight++;
+                queued++;
+            } else {
+                slots[head].len = slots[head].filled = 0;
+                slots[head].pending = 1;   // 더 이상 사용하지 않는 슬롯
+            }
+            head = (head + 1) % URING_QUEUE_DEPTH;
+        }
+    }
+    
+    // 오류로 빠져나온 경우 남은 요청이 끝날 때까지 기다려 버퍼 재사용을 안전하게 함
+    if (ret != 0) {
+        if (queued > 0) {
+            uring_submit_and_wait(reader, queued, 0);
+        }
+        for (unsigned i = 0; i < URING_QUEUE_DEPTH; i++) {
+            while (slots[i].pending && slots[i].len > 0) {
+                if (uring_submit_and_wait(reader, 0, 1) != 0) {
+                    break;
+                }
+                unsigned cq_head = *reader->cq_head;
+                unsigned cq_tail = __atomic_load_n(reader->cq_tail, __ATOMIC_ACQUIRE);
+                for (; cq_head != cq_tail; cq_head++) {
+                    slots[reader->cqes[cq_head & *reader->cq_mask].user_data].pending = 0;
+                }
+                __atomic_store_n(reader->cq_head, cq_head, __ATOMIC_RELEASE);
+            }
+        }
+    }
+    
+    if (ret == 0 && digest_set_finish(set) != 0) {
+        ret = -1;
+    }
+    
+    close(fd);
+    return ret;
+}
+
+/**
+ * 파일을 한 번 읽으면서 집합의 모든 다이제스트를 계산한다.
+ * 
+ * 일반 파일은 io_uring 경로를 우선 사용하고, io_uring을 쓸 수 없으면
+ * mmap 경로로, 매핑할 수 없는 입력은 fread() 버퍼 경로로 자동 대체한다.
+ * 
+ * @param filepath 파일 경로
+ * @param set 다이제스트 집합 (결과는 set->digest에 저장)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int calculate_file_digests(const char *filepath, DigestSet *set) {
+    int ret = digest_file_uring(filepath, set);
+    if (ret == -2) {
+        ret = digest_file_mmap(filepath, set);
+    }
+    if (ret == -2) {
+        ret = digest_file_buffered(filepath, set);
+    }
+    return ret;
+}
+
+/**
+ * 파일의 SHA-256 해시를 계산한다.
+ * 
+ * @param filepath 파일 경로
+ * @param hash 해시 결과를 저장할 버퍼 (최소 32바이트)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int calculate_file_hash(const char *filepath, unsigned char *hash) {
+    // 캐시된 SHA-256 핸들과 스레드별 컨텍스트를 빌려 쓰므로 호출마다
+    // 이름 복사나 EVP_MD_CTX 할당이 없다 (digest_set_free()를 부르지 않음)
+    DigestSet set = { .count = 1, .names = { "sha256" } };
+    set.md[0] = digest_sha256_md();
+    set.ctx[0] = (set.md[0] != NULL) ? digest_thread_ctx(set.md[0]) : NULL;
+    if (set.ctx[0] == NULL) {
+        return -1;
+    }
+    
+    int ret = calculate_file_digests(filepath, &set);
+    if (ret == 0) {
+        memcpy(hash, set.digest[0], 32);
+    }
+    return ret;
 }
 
 /**
@@ -88,25 +730,1395 @@ int compare_hashes(const unsigned char *hash1, const unsigned char *hash2, size_
     return (result == 0) ? 0 : -1;
 }
 
-void print_usage(const char *program_name) {
-    printf("사용법:\n");
-    printf("  %s <파일>              - 파일의 SHA-256 해시 계산\n", program_name);
-    printf("  %s -c <파일> <해시>    - 파일 해시를 기대값과 비교\n", program_name);
-    printf("\n예시:\n");
-    printf("  %s myfile.bin\n", program_name);
-    printf("  %s -c myfile.bin a1b2c3d4...\n", program_name);
+/**
+ * 16진수 문자열을 해시 바이트 배열로 변환한다.
+ * 
+ * @return 성공 시 0, 형식 오류 시 -1
+ */
+int hex_to_hash(const char *hex_str, unsigned char *hash, size_t hash_len) {
+    for (size_t i = 0; i < hash_len; i++) {
+        unsigned int byte;
+        if (sscanf(hex_str + (i * 2), "%2x", &byte) != 1) {
+            return -1;
+        }
+        hash[i] = (unsigned char)byte;
+    }
+    return 0;
 }
 
-int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        print_usage(argv[0]);
-        return 1;
+/**
+ * 단조 증가 시계를 초 단위로 반환한다.
+ */
+double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * 파일의 페이지 캐시를 비우도록 커널에 요청한다.
+ * 
+ * 벤치마크 각 회차를 가능한 한 동일한 (콜드 캐시) 조건에서 시작하기 위함이다.
+ * 더티 페이지나 다른 프로세스가 매핑한 페이지는 남을 수 있다.
+ */
+void drop_file_cache(const char *filepath) {
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        return;
     }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+/**
+ * 한 경로로 파일을 BENCH_ROUNDS회 해시하여 최고 처리량(MB/s)을 구한다.
+ * 
+ * @return 최고 MB/s, 경로 사용 불가 시 0.0과 *available = 0, 실패 시 음수
+ */
+double bench_digest_path(const char *filepath, double mb, DigestSet *set,
+                         int (*fn)(const char *, DigestSet *), int *available) {
+    double best_mbps = 0.0;
+    *available = 1;
     
-    unsigned char hash[32];
-    char hex_hash[65];
-    
-    if (strcmp(argv[1], "-c") == 0) {
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        drop_file_cache(filepath);
+        
+        double start = now_seconds();
+        int ret = fn(filepath, set);
+        if (ret == -2) {
+            *available = 0;
+            return 0.0;
+        }
+        if (ret != 0) {
+            return -1.0;
+        }
+        double elapsed = now_seconds() - start;
+        
+        double mbps = (elapsed > 0.0) ? mb / elapsed : 0.0;
+        if (mbps > best_mbps) {
+            best_mbps = mbps;
+        }
+    }
+    return best_mbps;
+}
+
+/**
+ * 동일 파일에 대해 읽기 경로별, 다이제스트별 처리량을 측정한다.
+ * 
+ * 1) buffered / mmap / io_uring 경로로 지정한 다이제스트 집합 전체를
+ *    계산하여 최고 MB/s와 경로 간 결과 일치를 확인하고,
+ * 2) 다이제스트가 둘 이상이면 각 알고리즘을 단독으로 한 번씩 읽어 계산한
+ *    처리량과, 한 번 읽기로 모두 계산한 처리량을 비교한다.
+ * 
+ * @param algorithms 쉼표로 구분된 알고리즘 목록
+ * @return 성공 시 0, 실패 시 -1
+ */
+int run_benchmark(const char *filepath, const char *algorithms) {
+    struct stat st;
+    if (stat(filepath, &st) != 0) {
+        perror("파일 정보 조회 실패");
+        return -1;
+    }
+    
+    DigestSet set;
+    if (digest_set_init(&set, algorithms) != 0) {
+        return -1;
+    }
+    
+    double mb = (double)st.st_size / (1024.0 * 1024.0);
+    printf("파일: %s (%.1f MB)\n", filepath, mb);
+    printf("다이제스트: %s\n", algorithms);
+    printf("회차: %d (각 회차 전 페이지 캐시 비우기 요청)\n\n", BENCH_ROUNDS);
+    
+    const struct {
+        const char *name;
+        int (*fn)(const char *, DigestSet *);
+    } paths[] = {
+        { "buffered (fread 4KB)", digest_file_buffered },
+        { "mmap (64MB 창)",       digest_file_mmap },
+        { "io_uring (QD8 x 1MB)", digest_file_uring },
+    };
+    const int path_count = (int)(sizeof(paths) / sizeof(paths[0]));
+    
+    unsigned char results[3][DIGEST_SET_MAX][EVP_MAX_MD_SIZE];
+    double best_mbps[3] = { 0.0, 0.0, 0.0 };
+    int available[3] = { 1, 1, 1 };
+    int ret = -1;
+    
+    for (int p = 0; p < path_count; p++) {
+        best_mbps[p] = bench_digest_path(filepath, mb, &set, paths[p].fn, &available[p]);
+        if (best_mbps[p] < 0.0) {
+            printf("%s: 해시 계산 실패\n", paths[p].name);
+            goto cleanup;
+        }
+        if (available[p]) {
+            memcpy(results[p], set.digest, sizeof(results[p]));
+            printf("%-22s %10.1f MB/s\n", paths[p].name, best_mbps[p]);
+        } else {
+            printf("%-22s %10s (이 시스템에서 사용 불가)\n", paths[p].name, "-");
+        }
+    }
+    
+    printf("\n");
+    for (int d = 0; d < set.count; d++) {
+        char hex[EVP_MAX_MD_SIZE * 2 + 1];
+        hash_to_hex(results[0][d], set.digest_len[d], hex);
+        printf("%s: %s\n", set.names[d], hex);
+    }
+    
+    for (int p = 1; p < path_count; p++) {
+        if (!available[p]) {
+            continue;
+        }
+        for (int d = 0; d < set.count; d++) {
+            if (compare_hashes(results[0][d], results[p][d], set.digest_len[d]) != 0) {
+                printf("✗ %s 경로의 %s 해시가 불일치합니다!\n", paths[p].name, set.names[d]);
+                goto cleanup;
+            }
+        }
+    }
+    
+    printf("✓ 모든 경로의 해시 일치\n");
+    for (int p = 1; p < path_count; p++) {
+        if (available[p] && best_mbps[0] > 0.0) {
+            printf("  %s: buffered 대비 %.2f배\n", paths[p].name,
+                   best_mbps[p] / best_mbps[0]);
+        }
+    }
+    
+    if (set.count > 1) {
+        printf("\n=== 다이제스트별 처리량 (calculate_file_digests) ===\n\n");
+        
+        // 알고리즘마다 따로 읽는 경우의 총 소요 시간 = 각 처리 시간의 합
+        double separate_seconds = 0.0;
+        for (int d = 0; d < set.count; d++) {
+            DigestSet single;
+            if (digest_set_init(&single, set.names[d]) != 0) {
+                goto cleanup;
+            }
+            int avail;
+            double mbps = bench_digest_path(filepath, mb, &single,
+                                            calculate_file_digests, &avail);
+            digest_set_free(&single);
+            if (mbps <= 0.0) {
+                printf("%s: 해시 계산 실패\n", set.names[d]);
+                goto cleanup;
+            }
+            separate_seconds += mb / mbps;
+            printf("%-22s %10.1f MB/s\n", set.names[d], mbps);
+        }
+        
+        int avail;
+        double combined = bench_digest_path(filepath, mb, &set,
+                                            calculate_file_digests, &avail);
+        if (combined <= 0.0) {
+            printf("단일 패스 해시 계산 실패\n");
+            goto cleanup;
+        }
+        double separate = mb / separate_seconds;
+        printf("%-22s %10.1f MB/s\n", "단일 패스 (전체)", combined);
+        printf("%-22s %10.1f MB/s\n", "알고리즘별 개별 패스", separate);
+        printf("\n단일 패스가 개별 패스 대비 %.2f배 (파일 읽기 %d회 → 1회)\n",
+               combined / separate, set.count);
+    }
+    ret = 0;
+    
+cleanup:
+    digest_set_free(&set);
+    return ret;
+}
+
+/**
+ * JSON 문자열 값으로 경로를 출력한다 (따옴표, 역슬래시, 제어 문자 이스케이프).
+ */
+void print_json_string(FILE *out, const char *str) {
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char *)str; *p != '\0'; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(out, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(out, "\\u%04x", *p);
+        } else {
+            fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+/**
+ * 여러 파일을 한 번씩만 읽어 지정한 모든 다이제스트를 계산한다.
+ * 
+ * 파일마다 한 줄의 JSON 객체(JSON Lines)를 표준 출력으로 내보낸다:
+ *   {"path":"a.img","size":1048576,"sha256":"…","sha512":"…"}
+ * 
+ * @param algorithms 쉼표로 구분된 알고리즘 목록 (예: "sha256,sha3-256")
+ * @return 모든 파일 성공 시 0, 하나라도 실패하면 -1
+ */
+int run_multi_digest(const char *algorithms, char **files, int file_count) {
+    DigestSet set;
+    if (digest_set_init(&set, algorithms) != 0) {
+        return -1;
+    }
+    
+    int failures = 0;
+    for (int i = 0; i < file_count; i++) {
+        struct stat st;
+        if (stat(files[i], &st) != 0 || calculate_file_digests(files[i], &set) != 0) {
+            fprintf(stderr, "%s: 해시 계산 실패\n", files[i]);
+            failures++;
+            continue;
+        }
+        
+        printf("{\"path\":");
+        print_json_string(stdout, files[i]);
+        printf(",\"size\":%llu", (unsigned long long)st.st_size);
+        for (int d = 0; d < set.count; d++) {
+            char hex[EVP_MAX_MD_SIZE * 2 + 1];
+            hash_to_hex(set.digest[d], set.digest_len[d], hex);
+            printf(",");
+            print_json_string(stdout, set.names[d]);
+            printf(":\"%s\"", hex);
+        }
+        printf("}\n");
+    }
+    
+    digest_set_free(&set);
+    return (failures == 0) ? 0 : -1;
+}
+
+/**
+ * 작업자 스레드 수를 결정한다 (온라인 코어 수, 항목 수 이하).
+ */
+size_t worker_count(size_t items) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t workers = (cores > 0) ? (size_t)cores : 1;
+    if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+    if (workers > items) workers = items;
+    return (workers > 0) ? workers : 1;
+}
+
+/**
+ * 작은 파일을 통째로 버퍼에 읽는다.
+ * 
+ * @return 읽은 바이트 수, 작은 파일이 아니면(또는 읽는 중 커졌으면) -2, 실패 시 -1
+ */
+ssize_t read_small_file(const char *filepath, unsigned char *buffer,
+                        unsigned long long *size) {
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        perror("파일 열기 실패");
+        return -1;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    *size = (unsigned long long)st.st_size;
+    if (!S_ISREG(st.st_mode) || st.st_size > SMALL_FILE_MAX) {
+        close(fd);
+        return -2;
+    }
+    
+    // SMALL_FILE_MAX + 1까지 읽어 그 사이 파일이 커졌는지 확인
+    size_t got = 0;
+    while (got <= SMALL_FILE_MAX) {
+        ssize_t n = read(fd, buffer + got, SMALL_FILE_MAX + 1 - got);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            close(fd);
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        got += (size_t)n;
+    }
+    close(fd);
+    
+    if (got > SMALL_FILE_MAX) {
+        return -2;
+    }
+    *size = got;
+    return (ssize_t)got;
+}
+
+/**
+ * 매니페스트 작업자: 큐에서 MANIFEST_BATCH개씩 항목을 가져와 해시를 계산한다.
+ * 
+ * SMALL_FILE_MAX 이하의 파일은 메모리로 읽어 다중 버퍼 SHA-256
+ * (sha256_mb_hash)으로 한꺼번에 해시하고, 큰 파일은 calculate_file_hash()로
+ * 스트리밍 해시한다.
+ */
+void *manifest_worker(void *arg) {
+    ManifestJob *job = (ManifestJob *)arg;
+    
+    // 슬롯마다 SMALL_FILE_MAX + 1 바이트 (커짐 감지용 1바이트 포함)
+    unsigned char *buffers = malloc(MANIFEST_BATCH * (SMALL_FILE_MAX + 1));
+    
+    for (;;) {
+        size_t first = atomic_fetch_add(&job->next, MANIFEST_BATCH);
+        if (first >= job->count) {
+            break;
+        }
+        size_t last = first + MANIFEST_BATCH;
+        if (last > job->count) {
+            last = job->count;
+        }
+        
+        const unsigned char *small_data[MANIFEST_BATCH];
+        size_t small_lens[MANIFEST_BATCH];
+        unsigned char small_digests[MANIFEST_BATCH][32];
+        ManifestEntry *small_entries[MANIFEST_BATCH];
+        size_t small_count = 0;
+        
+        for (size_t idx = first; idx < last; idx++) {
+            ManifestEntry *entry = &job->entries[idx];
+            
+            if (buffers != NULL) {
+                unsigned char *slot = buffers + small_count * (SMALL_FILE_MAX + 1);
+                ssize_t n = read_small_file(entry->path, slot, &entry->size);
+                if (n == -1) {
+                    entry->status = -1;
+                    continue;
+                }
+                if (n >= 0) {
+                    small_data[small_count] = slot;
+                    small_lens[small_count] = (size_t)n;
+                    small_entries[small_count] = entry;
+                    small_count++;
+                    continue;
+                }
+            } else {
+                struct stat st;
+                if (stat(entry->path, &st) == 0) {
+                    entry->size = (unsigned long long)st.st_size;
+                }
+            }
+            
+            entry->status = (calculate_file_hash(entry->path, entry->hash) == 0) ? 0 : -1;
+        }
+        
+        sha256_mb_hash(small_data, small_lens, small_digests, small_count);
+        for (size_t i = 0; i < small_count; i++) {
+            memcpy(small_entries[i]->hash, small_digests[i], 32);
+            small_entries[i]->status = 0;
+        }
+        
+        if (job->verify) {
+            for (size_t idx = first; idx < last; idx++) {
+                ManifestEntry *entry = &job->entries[idx];
+                if (entry->status == 0 &&
+                    compare_hashes(entry->hash, entry->expected, 32) != 0) {
+                    entry->status = 1;
+                }
+            }
+        }
+    }
+    
+    free(buffers);
+    return NULL;
+}
+
+/**
+ * 작업자 풀로 모든 항목의 해시를 계산하고 처리량을 출력한다.
+ * 
+ * @param out 통계 출력 스트림
+ * @return 성공 시 0, 스레드 생성 실패 시 -1
+ */
+int run_manifest_job(ManifestEntry *entries, size_t count, int verify, FILE *out) {
+    ManifestJob job = { .entries = entries, .count = count, .verify = verify };
+    atomic_init(&job.next, 0);
+    
+    size_t workers = worker_count(count);
+    pthread_t threads[MAX_WORKERS];
+    size_t started = 0;
+    
+    double start = now_seconds();
+    for (; started < workers; started++) {
+        if (pthread_create(&threads[started], NULL, manifest_worker, &job) != 0) {
+            break;
+        }
+    }
+    if (started == 0) {
+        fprintf(stderr, "작업자 스레드 생성 실패\n");
+        return -1;
+    }
+    for (size_t t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = now_seconds() - start;
+    
+    unsigned long long total_bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        total_bytes += entries[i].size;
+    }
+    if (elapsed <= 0.0) elapsed = 1e-9;
+    
+    fprintf(out, "\n파일 %zu개, %.1f MB, 작업자 %zu개, %.3f초\n",
+            count, (double)total_bytes / (1024.0 * 1024.0), started, elapsed);
+    fprintf(out, "처리량: %.1f files/s, %.1f MB/s\n",
+            (double)count / elapsed,
+            (double)total_bytes / (1024.0 * 1024.0) / elapsed);
+    return 0;
+}
+
+/**
+ * 디렉터리 순회 중 일반 파일 경로를 수집하기 위한 상태
+ * (nftw 콜백은 사용자 인자를 받지 않으므로 파일 범위 변수로 둔다)
+ */
+static ManifestEntry *walk_entries = NULL;
+static size_t walk_count = 0;
+static size_t walk_capacity = 0;
+
+static int collect_file(const char *fpath, const struct stat *sb,
+                        int typeflag, struct FTW *ftwbuf) {
+    (void)ftwbuf;
+    if (typeflag != FTW_F || !S_ISREG(sb->st_mode)) {
+        return 0;
+    }
+    
+    if (walk_count == walk_capacity) {
+        size_t new_capacity = walk_capacity ? walk_capacity * 2 : 1024;
+        ManifestEntry *grown = realloc(walk_entries, new_capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return -1;
+        }
+        walk_entries = grown;
+        walk_capacity = new_capacity;
+    }
+    
+    ManifestEntry *entry = &walk_entries[walk_count];
+    memset(entry, 0, sizeof(*entry));
+    entry->path = strdup(fpath);
+    if (entry->path == NULL) {
+        return -1;
+    }
+    walk_count++;
+    return 0;
+}
+
+static int compare_entry_path(const void *a, const void *b) {
+    return strcmp(((const ManifestEntry *)a)->path, ((const ManifestEntry *)b)->path);
+}
+
+void free_entries(ManifestEntry *entries, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        free(entries[i].path);
+    }
+    free(entries);
+}
+
+/**
+ * 디렉터리 트리의 모든 일반 파일을 해시하여 매니페스트를 생성한다.
+ * 
+ * 매니페스트는 "해시  경로" 형식이며 sha256sum -c와 호환된다.
+ * 심볼릭 링크는 따라가지 않으며, 출력은 경로 순으로 정렬된다.
+ * 
+ * @param dirpath 순회할 디렉터리
+ * @param manifest_path 매니페스트 파일 경로 (NULL이면 표준 출력)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int generate_manifest(const char *dirpath, const char *manifest_path) {
+    walk_entries = NULL;
+    walk_count = walk_capacity = 0;
+    
+    if (nftw(dirpath, collect_file, 64, FTW_PHYS) != 0) {
+        perror("디렉터리 순회 실패");
+        free_entries(walk_entries, walk_count);
+        return -1;
+    }
+    
+    ManifestEntry *entries = walk_entries;
+    size_t count = walk_count;
+    qsort(entries, count, sizeof(*entries), compare_entry_path);
+    
+    if (run_manifest_job(entries, count, 0, stderr) != 0) {
+        free_entries(entries, count);
+        return -1;
+    }
+    
+    FILE *out = stdout;
+    if (manifest_path != NULL) {
+        out = fopen(manifest_path, "w");
+        if (out == NULL) {
+            perror("매니페스트 생성 실패");
+            free_entries(entries, count);
+            return -1;
+        }
+    }
+    
+    int failures = 0;
+    char hex_hash[65];
+    for (size_t i = 0; i < count; i++) {
+        if (entries[i].status != 0) {
+            fprintf(stderr, "✗ 해시 실패: %s\n", entries[i].path);
+            failures++;
+            continue;
+        }
+        hash_to_hex(entries[i].hash, 32, hex_hash);
+        fprintf(out, "%s  %s\n", hex_hash, entries[i].path);
+    }
+    
+    if (out != stdout) {
+        fclose(out);
+    }
+    free_entries(entries, count);
+    return (failures == 0) ? 0 : -1;
+}
+
+/**
+ * 매니페스트의 모든 항목을 병렬로 재계산하여 검증한다.
+ * 
+ * @param manifest_path 매니페스트 파일 경로
+ * @return 모두 일치하면 0, 하나라도 실패하면 -1
+ */
+int verify_manifest(const char *manifest_path) {
+    FILE *in = fopen(manifest_path, "r");
+    if (in == NULL) {
+        perror("매니페스트 열기 실패");
+        return -1;
+    }
+    
+    ManifestEntry *entries = NULL;
+    size_t count = 0, capacity = 0;
+    char line[MANIFEST_LINE_MAX];
+    size_t line_no = 0;
+    int malformed = 0;
+    
+    while (fgets(line, sizeof(line), in) != NULL) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+        
+        // 형식: <64자리 16진수><공백><공백 또는 '*'><경로>
+        unsigned char expected[32];
+        if (strlen(line) < 67 || line[64] != ' ' ||
+            (line[65] != ' ' && line[65] != '*') ||
+            hex_to_hash(line, expected, 32) != 0) {
+            fprintf(stderr, "매니페스트 %zu행 형식 오류\n", line_no);
+            malformed++;
+            continue;
+        }
+        
+        if (count == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 1024;
+            ManifestEntry *grown = realloc(entries, new_capacity * sizeof(*grown));
+            if (grown == NULL) {
+                fclose(in);
+                free_entries(entries, count);
+                return -1;
+            }
+            entries = grown;
+            capacity = new_capacity;
+        }
+        
+        ManifestEntry *entry = &entries[count];
+        memset(entry, 0, sizeof(*entry));
+        memcpy(entry->expected, expected, 32);
+        entry->path = strdup(line + 66);
+        if (entry->path == NULL) {
+            fclose(in);
+            free_entries(entries, count);
+            return -1;
+        }
+        count++;
+    }
+    fclose(in);
+    
+    printf("매니페스트: %s (%zu개 항목)\n", manifest_path, count);
+    
+    if (run_manifest_job(entries, count, 1, stdout) != 0) {
+        free_entries(entries, count);
+        return -1;
+    }
+    
+    size_t mismatched = 0, unreadable = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (entries[i].status == 1) {
+            printf("✗ 불일치: %s\n", entries[i].path);
+            mismatched++;
+        } else if (entries[i].status == -1) {
+            printf("✗ 읽기 실패: %s\n", entries[i].path);
+            unreadable++;
+        }
+    }
+    free_entries(entries, count);
+    
+    if (mismatched == 0 && unreadable == 0 && malformed == 0) {
+        printf("\n✓ 무결성 검증 성공: %zu개 파일 모두 일치\n", count);
+        return 0;
+    }
+    printf("\n✗ 무결성 검증 실패: 불일치 %zu, 읽기 실패 %zu, 형식 오류 %d\n",
+           mismatched, unreadable, malformed);
+    return -1;
+}
+
+/**
+ * 트리 해시(Merkle) 형식 - 버전 1 ("fi-tree-v1")
+ * 
+ *   리프:   L[i] = SHA-256(0x00 || 파일[i*leaf_size .. (i+1)*leaf_size))
+ *   노드:   N    = SHA-256(0x01 || 왼쪽 || 오른쪽)
+ *           각 레벨에서 짝이 없는 마지막 노드는 그대로 상위 레벨로 올라간다.
+ *   루트:   R    = SHA-256(0x02 || "fi-tree-v1" || u64be(file_size)
+ *                          || u32be(leaf_size) || 최상위 노드)
+ * 
+ * 빈 파일은 빈 리프 하나로 취급한다. 리프 크기와 파일 크기가 루트에
+ * 포함되므로, 같은 내용이라도 파라미터가 다르면 루트가 달라진다.
+ * 출력 행: fi-tree-v1 sha256 leaf=<바이트> size=<바이트> leaves=<개수> root=<16진수>  <경로>
+ */
+#define TREE_FORMAT_VERSION "fi-tree-v1"
+#define TREE_DEFAULT_LEAF_SIZE (4UL * 1024 * 1024)
+#define TREE_MIN_LEAF_SIZE 4096UL
+#define TREE_MAX_LEAF_SIZE (1024UL * 1024 * 1024)
+
+/**
+ * 트리 해시 작업자가 공유하는 작업 정보
+ */
+typedef struct {
+    int fd;
+    unsigned long long file_size;
+    size_t leaf_size;
+    size_t leaf_count;
+    unsigned char *leaf_hashes;   // leaf_count * 32 바이트
+    atomic_size_t next;
+    atomic_int failed;
+} TreeJob;
+
+/**
+ * 도메인 구분 바이트를 앞에 붙여 SHA-256을 계산한다.
+ */
+int sha256_prefixed(EVP_MD_CTX *ctx, unsigned char prefix,
+                    const unsigned char *a, size_t a_len,
+                    const unsigned char *b, size_t b_len,
+                    unsigned char *out) {
+    unsigned int out_len = 0;
+    if (EVP_DigestInit_ex(ctx, digest_sha256_md(), NULL) != 1 ||
+        EVP_DigestUpdate(ctx, &prefix, 1) != 1 ||
+        (a_len > 0 && EVP_DigestUpdate(ctx, a, a_len) != 1) ||
+        (b_len > 0 && EVP_DigestUpdate(ctx, b, b_len) != 1) ||
+        EVP_DigestFinal_ex(ctx, out, &out_len) != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * 트리 해시 작업자: 리프 번호를 원자적으로 가져와 pread()로 읽고 해시한다.
+ */
+void *tree_worker(void *arg) {
+    TreeJob *job = (TreeJob *)arg;
+    
+    unsigned char *buffer = malloc(job->leaf_size);
+    EVP_MD_CTX *ctx = digest_thread_ctx(digest_sha256_md());
+    if (buffer == NULL || ctx == NULL) {
+        atomic_store(&job->failed, 1);
+        free(buffer);
+        return NULL;
+    }
+    
+    for (;;) {
+        size_t leaf = atomic_fetch_add(&job->next, 1);
+        if (leaf >= job->leaf_count || atomic_load(&job->failed)) {
+            break;
+        }
+        
+        unsigned long long offset = (unsigned long long)leaf * job->leaf_size;
+        size_t want = job->leaf_size;
+        if (offset + want > job->file_size) {
+            want = (size_t)(job->file_size - offset);
+        }
+        
+        size_t got = 0;
+        while (got < want) {
+            ssize_t n = pread(job->fd, buffer + got, want - got, (off_t)(offset + got));
+            if (n <= 0) {
+                break;
+            }
+            got += (size_t)n;
+        }
+        
+        if (got != want ||
+            sha256_prefixed(ctx, 0x00, buffer, want, NULL, 0,
+                            job->leaf_hashes + leaf * 32) != 0) {
+            atomic_store(&job->failed, 1);
+            break;
+        }
+    }
+    
+    free(buffer);
+    return NULL;
+}
+
+/**
+ * 열린 파일의 모든 리프 해시를 코어 수만큼의 작업자로 계산한다.
+ * 
+ * @param fd 읽기용 파일 디스크립터
+ * @param file_size 파일 크기
+ * @param leaf_size 리프 크기 (바이트)
+ * @param leaf_hashes 리프 해시 출력 (leaf_count * 32 바이트)
+ * @param leaf_count 리프 개수
+ * @return 성공 시 0, 실패 시 -1
+ */
+int hash_file_leaves(int fd, unsigned long long file_size, size_t leaf_size,
+                     unsigned char *leaf_hashes, size_t leaf_count) {
+    TreeJob job = {
+        .fd = fd,
+        .file_size = file_size,
+        .leaf_size = leaf_size,
+        .leaf_count = leaf_count,
+        .leaf_hashes = leaf_hashes,
+    };
+    atomic_init(&job.next, 0);
+    atomic_init(&job.failed, 0);
+    
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    
+    size_t workers = worker_count(leaf_count);
+    pthread_t threads[MAX_WORKERS];
+    size_t started = 0;
+    for (; started < workers; started++) {
+        if (pthread_create(&threads[started], NULL, tree_worker, &job) != 0) {
+            break;
+        }
+    }
+    if (started == 0) {
+        tree_worker(&job);
+    }
+    for (size_t t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    
+    return atomic_load(&job.failed) ? -1 : 0;
+}
+
+/**
+ * 리프 해시 목록으로부터 트리 해시 루트를 계산한다.
+ * 
+ * 리프를 다시 읽지 않으므로, 캐시된 리프 해시만으로 루트를 재구성할 수 있다.
+ * 
+ * @return 성공 시 0, 실패 시 -1
+ */
+int tree_root_from_leaves(const unsigned char *leaf_hashes, size_t leaf_count,
+                          unsigned long long file_size, size_t leaf_size,
+                          unsigned char *root) {
+    unsigned char *level = malloc(leaf_count * 32);
+    EVP_MD_CTX *ctx = digest_thread_ctx(digest_sha256_md());
+    if (level == NULL || ctx == NULL) {
+        free(level);
+        return -1;
+    }
+    memcpy(level, leaf_hashes, leaf_count * 32);
+    
+    int ret = 0;
+    
+    // 내부 노드 결합 (리프 수가 적으므로 순차 처리)
+    size_t level_count = leaf_count;
+    while (ret == 0 && level_count > 1) {
+        size_t parents = 0;
+        for (size_t i = 0; i < level_count; i += 2) {
+            unsigned char *dst = level + parents * 32;
+            if (i + 1 < level_count) {
+                unsigned char node[32];
+                if (sha256_prefixed(ctx, 0x01,
+                                    level + i * 32, 32,
+                                    level + (i + 1) * 32, 32,
+                                    node) != 0) {
+                    ret = -1;
+                    break;
+                }
+                memcpy(dst, node, 32);
+            } else {
+                memmove(dst, level + i * 32, 32);
+            }
+            parents++;
+        }
+        level_count = parents;
+    }
+    
+    // 파라미터를 묶은 최종 루트
+    if (ret == 0) {
+        unsigned char params[sizeof(TREE_FORMAT_VERSION) - 1 + 12];
+        size_t p = 0;
+        memcpy(params, TREE_FORMAT_VERSION, sizeof(TREE_FORMAT_VERSION) - 1);
+        p += sizeof(TREE_FORMAT_VERSION) - 1;
+        for (int b = 7; b >= 0; b--) {
+            params[p++] = (unsigned char)(file_size >> (b * 8));
+        }
+        for (int b = 3; b >= 0; b--) {
+            params[p++] = (unsigned char)((unsigned long long)leaf_size >> (b * 8));
+        }
+        ret = sha256_prefixed(ctx, 0x02, params, p, level, 32, root);
+    }
+    
+    free(level);
+    return ret;
+}
+
+/**
+ * 파일 크기에 대한 리프 개수를 반환한다 (빈 파일은 빈 리프 1개).
+ */
+size_t tree_leaf_count(unsigned long long file_size, size_t leaf_size) {
+    size_t count = (size_t)((file_size + leaf_size - 1) / leaf_size);
+    return (count > 0) ? count : 1;
+}
+
+/**
+ * 파일의 트리 해시 루트를 계산한다.
+ * 
+ * @param filepath 파일 경로
+ * @param leaf_size 리프 크기 (바이트)
+ * @param root 루트 해시를 저장할 버퍼 (32바이트)
+ * @param file_size 파일 크기 출력 (NULL 허용)
+ * @param leaf_count 리프 개수 출력 (NULL 허용)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int calculate_tree_hash(const char *filepath, size_t leaf_size, unsigned char *root,
+                        unsigned long long *file_size, size_t *leaf_count) {
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        perror("파일 열기 실패");
+        return -1;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        fprintf(stderr, "트리 해시는 일반 파일만 지원합니다: %s\n", filepath);
+        close(fd);
+        return -1;
+    }
+    
+    unsigned long long size = (unsigned long long)st.st_size;
+    size_t count = tree_leaf_count(size, leaf_size);
+    unsigned char *leaf_hashes = malloc(count * 32);
+    if (leaf_hashes == NULL) {
+        close(fd);
+        return -1;
+    }
+    
+    int ret = hash_file_leaves(fd, size, leaf_size, leaf_hashes, count);
+    close(fd);
+    if (ret == 0) {
+        ret = tree_root_from_leaves(leaf_hashes, count, size, leaf_size, root);
+    }
+    
+    if (ret == 0) {
+        if (file_size) *file_size = size;
+        if (leaf_count) *leaf_count = count;
+    } else {
+        fprintf(stderr, "트리 해시 계산 실패: %s\n", filepath);
+    }
+    
+    free(leaf_hashes);
+    return ret;
+}
+
+/**
+ * 트리 해시를 계산하여 파라미터와 함께 한 행으로 출력한다.
+ * 
+ * @return 성공 시 0, 실패 시 -1
+ */
+int run_tree_hash(const char *filepath, size_t leaf_size) {
+    unsigned char root[32];
+    char hex_root[65];
+    unsigned long long file_size = 0;
+    size_t leaf_count = 0;
+    
+    double start = now_seconds();
+    if (calculate_tree_hash(filepath, leaf_size, root, &file_size, &leaf_count) != 0) {
+        return -1;
+    }
+    double elapsed = now_seconds() - start;
+    if (elapsed <= 0.0) elapsed = 1e-9;
+    
+    hash_to_hex(root, 32, hex_root);
+    printf("%s sha256 leaf=%zu size=%llu leaves=%zu root=%s  %s\n",
+           TREE_FORMAT_VERSION, leaf_size, file_size, leaf_count, hex_root, filepath);
+    fprintf(stderr, "작업자 %zu개, %.3f초, %.1f MB/s\n",
+            worker_count(leaf_count), elapsed,
+            (double)file_size / (1024.0 * 1024.0) / elapsed);
+    return 0;
+}
+
+/**
+ * 증분 재해시 캐시 형식 - 버전 1 ("fi-cache-v1")
+ * 
+ *   fi-cache-v1 leaf=<청크 크기>
+ *   F <dev> <inode> <size> <mtime_s> <mtime_ns> <ctime_s> <ctime_ns> <청크 수> <경로>
+ *   <청크 0의 SHA-256 리프 해시 (fi-tree-v1 리프)>
+ *   ...
+ * 
+ * 파일 메타데이터(장치, inode, 크기, mtime, ctime)가 모두 같으면 파일을 읽지 않고
+ * 캐시된 청크 해시로부터 fi-tree-v1 루트를 재구성한다. 다르면 파일을 다시 읽어
+ * 모든 청크를 해시하고, 이전 청크 해시와 비교하여 변경된 청크 수를 보고한다.
+ * (청크 내용이 바뀌었는지는 데이터를 읽어야만 알 수 있으므로, 메타데이터가
+ * 바뀐 파일은 항상 전체를 다시 읽는다.)
+ */
+#define CACHE_FORMAT_VERSION "fi-cache-v1"
+
+/**
+ * 캐시 항목 (파일 하나)
+ */
+typedef struct {
+    char *path;
+    unsigned long long dev;
+    unsigned long long ino;
+    unsigned long long size;
+    long long mtime_sec;
+    long mtime_nsec;
+    long long ctime_sec;
+    long ctime_nsec;
+    size_t chunk_count;
+    unsigned char *chunks;   // chunk_count * 32 바이트
+} CacheEntry;
+
+/**
+ * 메모리에 적재된 캐시
+ */
+typedef struct {
+    size_t leaf_size;
+    CacheEntry *entries;
+    size_t count;
+    size_t capacity;
+} HashCache;
+
+static int compare_cache_path(const void *a, const void *b) {
+    return strcmp(((const CacheEntry *)a)->path, ((const CacheEntry *)b)->path);
+}
+
+void free_cache(HashCache *cache) {
+    for (size_t i = 0; i < cache->count; i++) {
+        free(cache->entries[i].path);
+        free(cache->entries[i].chunks);
+    }
+    free(cache->entries);
+    memset(cache, 0, sizeof(*cache));
+}
+
+/**
+ * 경로로 캐시 항목을 찾는다 (캐시는 경로 순으로 정렬되어 있어야 함).
+ */
+CacheEntry *find_cache_entry(HashCache *cache, const char *path) {
+    CacheEntry key = { .path = (char *)path };
+    return bsearch(&key, cache->entries, cache->count, sizeof(CacheEntry),
+                   compare_cache_path);
+}
+
+/**
+ * 캐시 파일을 읽는다. 파일이 없으면 빈 캐시로 시작한다.
+ * 
+ * @param cache_path 캐시 파일 경로
+ * @param cache 적재 결과 (leaf_size는 파일이 없을 때의 기본값으로 미리 설정)
+ * @return 성공 시 0, 형식 오류 시 -1
+ */
+int load_cache(const char *cache_path, HashCache *cache) {
+    FILE *in = fopen(cache_path, "r");
+    if (in == NULL) {
+        return 0;   // 첫 실행
+    }
+    
+    char line[MANIFEST_LINE_MAX];
+    if (fgets(line, sizeof(line), in) == NULL ||
+        sscanf(line, CACHE_FORMAT_VERSION " leaf=%zu", &cache->leaf_size) != 1 ||
+        cache->leaf_size < TREE_MIN_LEAF_SIZE || cache->leaf_size > TREE_MAX_LEAF_SIZE) {
+        fprintf(stderr, "캐시 헤더 형식 오류: %s\n", cache_path);
+        fclose(in);
+        return -1;
+    }
+    
+    int ret = 0;
+    while (ret == 0 && fgets(line, sizeof(line), in) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        
+        CacheEntry entry = { 0 };
+        int path_offset = 0;
+        if (sscanf(line, "F %llu %llu %llu %lld %ld %lld %ld %zu %n",
+                   &entry.dev, &entry.ino, &entry.size,
+                   &entry.mtime_sec, &entry.mtime_nsec,
+                   &entry.ctime_sec, &entry.ctime_nsec,
+                   &entry.chunk_count, &path_offset) != 8 ||
+            path_offset == 0 || line[path_offset] == '\0' ||
+            entry.chunk_count != tree_leaf_count(entry.size, cache->leaf_size)) {
+            ret = -1;
+            break;
+        }
+        
+        entry.path = strdup(line + path_offset);
+        entry.chunks = malloc(entry.chunk_count * 32);
+        if (entry.path == NULL || entry.chunks == NULL) {
+            free(entry.path);
+            free(entry.chunks);
+            ret = -1;
+            break;
+        }
+        
+        for (size_t c = 0; c < entry.chunk_count; c++) {
+            if (fgets(line, sizeof(line), in) == NULL ||
+                hex_to_hash(line, entry.chunks + c * 32, 32) != 0) {
+                ret = -1;
+                break;
+            }
+        }
+        
+        if (ret == 0 && cache->count == cache->capacity) {
+            size_t new_capacity = cache->capacity ? cache->capacity * 2 : 256;
+            CacheEntry *grown = realloc(cache->entries, new_capacity * sizeof(*grown));
+            if (grown == NULL) {
+                ret = -1;
+            } else {
+                cache->entries = grown;
+                cache->capacity = new_capacity;
+            }
+        }
+        if (ret != 0) {
+            free(entry.path);
+            free(entry.chunks);
+            break;
+        }
+        cache->entries[cache->count++] = entry;
+    }
+    fclose(in);
+    
+    if (ret != 0) {
+        fprintf(stderr, "캐시 형식 오류: %s (캐시를 무시하고 전체 재해시)\n", cache_path);
+        size_t leaf_size = cache->leaf_size;
+        free_cache(cache);
+        cache->leaf_size = leaf_size;
+        return -1;
+    }
+    
+    qsort(cache->entries, cache->count, sizeof(CacheEntry), compare_cache_path);
+    
+    // 같은 경로가 여러 번 기록된 캐시(이전 버전)는 마지막 항목만 남긴다
+    size_t kept = 0;
+    for (size_t i = 0; i < cache->count; i++) {
+        if (i + 1 < cache->count &&
+            strcmp(cache->entries[i].path, cache->entries[i + 1].path) == 0) {
+            free(cache->entries[i].path);
+            free(cache->entries[i].chunks);
+            continue;
+        }
+        cache->entries[kept++] = cache->entries[i];
+    }
+    cache->count = kept;
+    return 0;
+}
+
+/**
+ * 캐시를 임시 파일에 쓴 뒤 rename()으로 원자적으로 교체한다.
+ * 
+ * @return 성공 시 0, 실패 시 -1
+ */
+int save_cache(const char *cache_path, const HashCache *cache) {
+    size_t tmp_len = strlen(cache_path) + 5;
+    char *tmp_path = malloc(tmp_len);
+    if (tmp_path == NULL) {
+        return -1;
+    }
+    snprintf(tmp_path, tmp_len, "%s.tmp", cache_path);
+    
+    FILE *out = fopen(tmp_path, "w");
+    if (out == NULL) {
+        perror("캐시 저장 실패");
+        free(tmp_path);
+        return -1;
+    }
+    
+    char hex_hash[65];
+    fprintf(out, CACHE_FORMAT_VERSION " leaf=%zu\n", cache->leaf_size);
+    for (size_t i = 0; i < cache->count; i++) {
+        const CacheEntry *e = &cache->entries[i];
+        fprintf(out, "F %llu %llu %llu %lld %ld %lld %ld %zu %s\n",
+                e->dev, e->ino, e->size, e->mtime_sec, e->mtime_nsec,
+                e->ctime_sec, e->ctime_nsec, e->chunk_count, e->path);
+        for (size_t c = 0; c < e->chunk_count; c++) {
+            hash_to_hex(e->chunks + c * 32, 32, hex_hash);
+            fprintf(out, "%s\n", hex_hash);
+        }
+    }
+    
+    int ret = (fclose(out) == 0) ? 0 : -1;
+    if (ret == 0 && rename(tmp_path, cache_path) != 0) {
+        perror("캐시 교체 실패");
+        ret = -1;
+    }
+    if (ret != 0) {
+        unlink(tmp_path);
+    }
+    free(tmp_path);
+    return ret;
+}
+
+/**
+ * 캐시 통계
+ */
+typedef struct {
+    size_t file_hits;
+    size_t file_misses;
+    size_t chunks_skipped;     // 메타데이터 적중으로 읽지 않은 청크
+    size_t chunks_unchanged;   // 다시 읽어 해시했지만 내용이 같았던 청크
+    size_t chunks_changed;
+    unsigned long long bytes_read;
+} CacheStats;
+
+/**
+ * 캐시를 이용해 파일 하나의 트리 해시 루트를 계산하고 캐시를 갱신한다.
+ * 
+ * @param entry 기존 캐시 항목 (없으면 NULL), 갱신된 내용이 기록됨
+ * @param new_entry entry가 NULL일 때 새 항목을 채울 곳
+ * @return 성공 시 0, 실패 시 -1
+ */
+int cached_tree_hash(const char *filepath, HashCache *cache, CacheEntry *entry,
+                     CacheEntry *new_entry, unsigned char *root, CacheStats *stats) {
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        perror("파일 열기 실패");
+        return -1;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        fprintf(stderr, "일반 파일만 지원합니다: %s\n", filepath);
+        close(fd);
+        return -1;
+    }
+    
+    unsigned long long size = (unsigned long long)st.st_size;
+    size_t count = tree_leaf_count(size, cache->leaf_size);
+    
+    // 메타데이터가 모두 같으면 파일을 읽지 않는다
+    if (entry != NULL &&
+        entry->dev == (unsigned long long)st.st_dev &&
+        entry->ino == (unsigned long long)st.st_ino &&
+        entry->size == size &&
+        entry->mtime_sec == (long long)st.st_mtim.tv_sec &&
+        entry->mtime_nsec == st.st_mtim.tv_nsec &&
+        entry->ctime_sec == (long long)st.st_ctim.tv_sec &&
+        entry->ctime_nsec == st.st_ctim.tv_nsec &&
+        entry->chunk_count == count) {
+        close(fd);
+        stats->file_hits++;
+        stats->chunks_skipped += count;
+        return tree_root_from_leaves(entry->chunks, count, size, cache->leaf_size, root);
+    }
+    
+    unsigned char *chunks = malloc(count * 32);
+    if (chunks == NULL) {
+        close(fd);
+        return -1;
+    }
+    
+    int ret = hash_file_leaves(fd, size, cache->leaf_size, chunks, count);
+    close(fd);
+    if (ret != 0) {
+        fprintf(stderr, "해시 계산 실패: %s\n", filepath);
+        free(chunks);
+        return -1;
+    }
+    
+    stats->file_misses++;
+    stats->bytes_read += size;
+    for (size_t c = 0; c < count; c++) {
+        if (entry != NULL && c < entry->chunk_count &&
+            compare_hashes(entry->chunks + c * 32, chunks + c * 32, 32) == 0) {
+            stats->chunks_unchanged++;
+        } else {
+            stats->chunks_changed++;
+        }
+    }
+    
+    if (entry == NULL) {
+        entry = new_entry;
+        entry->path = strdup(filepath);
+        if (entry->path == NULL) {
+            free(chunks);
+            return -1;
+        }
+    } else {
+        free(entry->chunks);
+    }
+    entry->dev = (unsigned long long)st.st_dev;
+    entry->ino = (unsigned long long)st.st_ino;
+    entry->size = size;
+    entry->mtime_sec = (long long)st.st_mtim.tv_sec;
+    entry->mtime_nsec = st.st_mtim.tv_nsec;
+    entry->ctime_sec = (long long)st.st_ctim.tv_sec;
+    entry->ctime_nsec = st.st_ctim.tv_nsec;
+    entry->chunk_count = count;
+    entry->chunks = chunks;
+    
+    return tree_root_from_leaves(chunks, count, size, cache->leaf_size, root);
+}
+
+/**
+ * 캐시를 사용해 여러 파일의 트리 해시를 계산하고 적중/미스를 보고한다.
+ * 
+ * @return 모두 성공하면 0, 하나라도 실패하면 -1
+ */
+int run_cached_hash(const char *cache_path, char **files, int file_count) {
+    HashCache cache = { .leaf_size = TREE_DEFAULT_LEAF_SIZE };
+    load_cache(cache_path, &cache);
+    
+    CacheEntry *added = calloc((size_t)file_count, sizeof(CacheEntry));
+    if (added == NULL) {
+        free_cache(&cache);
+        return -1;
+    }
+    size_t added_count = 0;
+    
+    CacheStats stats = { 0 };
+    int failures = 0;
+    unsigned char root[32];
+    char hex_root[65];
+    
+    double start = now_seconds();
+    for (int i = 0; i < file_count; i++) {
+        CacheEntry *entry = find_cache_entry(&cache, files[i]);
+        if (entry == NULL) {
+            // 같은 경로를 두 번 준 경우 이번 실행에서 추가한 항목을 재사용
+            for (size_t a = 0; a < added_count; a++) {
+                if (strcmp(added[a].path, files[i]) == 0) {
+                    entry = &added[a];
+                    break;
+                }
+            }
+        }
+        CacheEntry *slot = &added[added_count];
+        if (cached_tree_hash(files[i], &cache, entry, slot, root, &stats) != 0) {
+            failures++;
+            continue;
+        }
+        if (entry == NULL) {
+            added_count++;
+        }
+        
+        hash_to_hex(root, 32, hex_root);
+        printf("%s sha256 leaf=%zu size=%llu leaves=%zu root=%s  %s\n",
+               TREE_FORMAT_VERSION, cache.leaf_size,
+               entry ? entry->size : slot->size,
+               entry ? entry->chunk_count : slot->chunk_count,
+               hex_root, files[i]);
+    }
+    double elapsed = now_seconds() - start;
+    
+    // 새 항목을 병합하고 정렬 상태 유지
+    if (added_count > 0) {
+        CacheEntry *grown = realloc(cache.entries,
+                                    (cache.count + added_count) * sizeof(CacheEntry));
+        if (grown != NULL) {
+            memcpy(grown + cache.count, added, added_count * sizeof(CacheEntry));
+            cache.entries = grown;
+            cache.count += added_count;
+            cache.capacity = cache.count;
+            qsort(cache.entries, cache.count, sizeof(CacheEntry), compare_cache_path);
+        } else {
+            for (size_t i = 0; i < added_count; i++) {
+                free(added[i].path);
+                free(added[i].chunks);
+            }
+        }
+    }
+    free(added);
+    
+    if (save_cache(cache_path, &cache) != 0) {
+        failures++;
+    }
+    free_cache(&cache);
+    
+    fprintf(stderr, "\n캐시: 파일 적중 %zu / 미스 %zu\n", stats.file_hits, stats.file_misses);
+    fprintf(stderr, "청크: 읽지 않음(적중) %zu / 다시 해시-변경 없음 %zu / 변경 %zu\n",
+            stats.chunks_skipped, stats.chunks_unchanged, stats.chunks_changed);
+    fprintf(stderr, "읽은 데이터 %.1f MB, %.3f초\n",
+            (double)stats.bytes_read / (1024.0 * 1024.0), elapsed);
+    return (failures == 0) ? 0 : -1;
+}
+
+void print_usage(const char *program_name) {
+    printf("사용법:\n");
+    printf("  %s <파일>              - 파일의 SHA-256 해시 계산\n", program_name);
+    printf("  %s -c <파일> <해시>    - 파일 해시를 기대값과 비교\n", program_name);
+    printf("  %s --bench <파일> [알고리즘,...] - 읽기 경로별/다이제스트별 처리량(MB/s) 비교\n", program_name);
+    printf("  %s -a <알고리즘,...> <파일>... - 한 번 읽기로 여러 다이제스트 계산 (JSON Lines 출력)\n", program_name);
+    printf("  %s -r <디렉터리> [출력] - 디렉터리 전체의 매니페스트 생성 (병렬)\n", program_name);
+    printf("  %s -c <매니페스트>     - 매니페스트의 모든 파일 검증 (병렬)\n", program_name);
+    printf("  %s --tree <파일> [KB]  - 트리 해시(Merkle) 루트 계산 (병렬, 기본 리프 4096KB)\n", program_name);
+    printf("  %s --cache <캐시> <파일>... - 캐시로 변경된 파일만 재해시 (트리 해시 루트 출력)\n", program_name);
+    printf("\n예시:\n");
+    printf("  %s myfile.bin\n", program_name);
+    printf("  %s -c myfile.bin a1b2c3d4...\n", program_name);
+    printf("  %s --bench ecu_image.bin\n", program_name);
+    printf("  %s --bench ecu_image.bin %s\n", program_name, DEFAULT_DIGESTS);
+    printf("  %s -a %s ecu_image.bin\n", program_name, DEFAULT_DIGESTS);
+    printf("  %s -r /mnt/rootfs rootfs.sha256\n", program_name);
+    printf("  %s -c rootfs.sha256\n", program_name);
+    printf("  %s --tree firmware.img 1024\n", program_name);
+    printf("  %s --cache nightly.ficache images/*.img\n", program_name);
+}
+
+int main(int argc, char *argv[]) {
+    cpu_features_apply_override(argv);
+    
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    unsigned char hash[32];
+    char hex_hash[65];
+    
+    if (strcmp(argv[1], "--bench") == 0) {
+        // 벤치마크 모드
+        if (argc != 3 && argc != 4) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return (run_benchmark(argv[2], (argc == 4) ? argv[3] : "sha256") == 0) ? 0 : 1;
+    } else if (strcmp(argv[1], "-a") == 0) {
+        // 다중 다이제스트 모드
+        if (argc < 4) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return (run_multi_digest(argv[2], argv + 3, argc - 3) == 0) ? 0 : 1;
+    } else if (strcmp(argv[1], "--tree") == 0) {
+        // 트리 해시 모드
+        if (argc != 3 && argc != 4) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        size_t leaf_size = TREE_DEFAULT_LEAF_SIZE;
+        if (argc == 4) {
+            leaf_size = (size_t)strtoul(argv[3], NULL, 10) * 1024;
+            if (leaf_size < TREE_MIN_LEAF_SIZE || leaf_size > TREE_MAX_LEAF_SIZE) {
+                printf("리프 크기는 %lu KB ~ %lu KB 범위여야 합니다.\n",
+                       TREE_MIN_LEAF_SIZE / 1024, TREE_MAX_LEAF_SIZE / 1024);
+                return 1;
+            }
+        }
+        return (run_tree_hash(argv[2], leaf_size) == 0) ? 0 : 1;
+    } else if (strcmp(argv[1], "--cache") == 0) {
+        // 증분 재해시 모드
+        if (argc < 4) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return (run_cached_hash(argv[2], argv + 3, argc - 3) == 0) ? 0 : 1;
+    } else if (strcmp(argv[1], "-r") == 0) {
+        // 매니페스트 생성 모드
+        if (argc != 3 && argc != 4) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return (generate_manifest(argv[2], (argc == 4) ? argv[3] : NULL) == 0) ? 0 : 1;
+    } else if (strcmp(argv[1], "-c") == 0 && argc == 3) {
+        // 매니페스트 검증 모드
+        return (verify_manifest(argv[2]) == 0) ? 0 : 1;
+    } else if (strcmp(argv[1], "-c") == 0) {
         // 검증 모드
         if (argc != 4) {
             print_usage(argv[0]);
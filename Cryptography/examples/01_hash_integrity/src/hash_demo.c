@@ -5,21 +5,51 @@
  * 
  * 빌드: make
  * 실행: ./bin/hash_demo
+ *       ./bin/hash_demo --mb-test    (다중 버퍼 엔진 기지 답 테스트)
+ *       ./bin/hash_demo --mb-bench   (다중 버퍼 vs 하나씩 처리 messages/s)
+ *       ./bin/hash_demo --ctx-bench  (컨텍스트 재사용 전후 ns/op)
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <openssl/evp.h>
+#include "digest_ctx.h"
+#include "sha256_mb.h"
+
+#define MB_TEST_BATCH 333
+#define MB_TEST_MAX_LEN 1100
+#define MB_BENCH_MESSAGES 4096
+#define MB_BENCH_SECONDS 0.5
+#define CTX_BENCH_SECONDS 0.3
 
 /**
  * 데이터의 SHA-256 해시를 계산한다.
  * 
+ * digest_ctx.h의 캐시된 알고리즘과 스레드별 컨텍스트를 재사용하므로
+ * 호출마다 EVP_MD_CTX를 할당하거나 알고리즘을 다시 찾지 않는다.
+ * 
  * @param data 해시할 데이터
  * @param len 데이터 길이
  * @param hash 해시 결과를 저장할 버퍼 (최소 32바이트)
  * @return 성공 시 0, 실패 시 -1
  */
 int calculate_sha256(const unsigned char *data, size_t len, unsigned char *hash) {
+    return digest_sha256(data, len, hash);
+}
+
+/**
+ * 데이터의 SHA-256 해시를 호출마다 새 EVP_MD_CTX로 계산한다.
+ * 
+ * digest_ctx.h 도입 전의 구현으로, --ctx-bench의 비교 기준으로 남겨 둔다.
+ * 
+ * @param data 해시할 데이터
+ * @param len 데이터 길이
+ * @param hash 해시 결과를 저장할 버퍼 (최소 32바이트)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int calculate_sha256_alloc(const unsigned char *data, size_t len, unsigned char *hash) {
     EVP_MD_CTX *ctx = EVP_MD_CTX_new();
     if (ctx == NULL) {
         return -1;
@@ -55,7 +85,258 @@ void print_hash(const unsigned char *hash, size_t len) {
     printf("\n");
 }
 
-int main(void) {
+/**
+ * 단조 증가 시계를 초 단위로 반환한다.
+ */
+double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * 다중 버퍼 엔진의 결과를 공개 테스트 벡터 및 EVP 경로와 비교한다.
+ * 
+ * @return 모두 일치하면 0, 하나라도 불일치하면 -1
+ */
+int run_mb_selftest(void) {
+    printf("=== 다중 버퍼 SHA-256 기지 답 테스트 (KAT) ===\n\n");
+    
+    // FIPS 180-2 테스트 벡터
+    static const struct {
+        const char *msg;
+        size_t repeat;
+        const char *digest;
+    } vectors[] = {
+        { "", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+        { "abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+        { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+          "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+        { "a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+    };
+    const size_t vector_count = sizeof(vectors) / sizeof(vectors[0]);
+    
+    // 길이가 제각각인 무작위 메시지 (블록 경계 55/56/63/64 포함)
+    unsigned char *pool = malloc(MB_TEST_BATCH * MB_TEST_MAX_LEN + 1000000);
+    const unsigned char *data[MB_TEST_BATCH + 4];
+    size_t lens[MB_TEST_BATCH + 4];
+    unsigned char (*digests)[32] = malloc((MB_TEST_BATCH + 4) * 32);
+    unsigned char (*expected)[32] = malloc((MB_TEST_BATCH + 4) * 32);
+    if (pool == NULL || digests == NULL || expected == NULL) {
+        free(pool);
+        free(digests);
+        free(expected);
+        return -1;
+    }
+    
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < MB_TEST_BATCH; i++) {
+        unsigned char *msg = pool + i * MB_TEST_MAX_LEN;
+        lens[i] = (i < 130) ? i : (size_t)rand_r(&seed) % MB_TEST_MAX_LEN;
+        for (size_t j = 0; j < lens[i]; j++) {
+            msg[j] = (unsigned char)rand_r(&seed);
+        }
+        data[i] = msg;
+        calculate_sha256(msg, lens[i], expected[i]);
+    }
+    
+    unsigned char *million_a = pool + MB_TEST_BATCH * MB_TEST_MAX_LEN;
+    memset(million_a, 'a', 1000000);
+    
+    int failures = 0;
+    for (int e = 0; e < SHA256_MB_ENGINE_COUNT; e++) {
+        Sha256MbEngine engine = (Sha256MbEngine)e;
+        printf("[%-10s] ", sha256_mb_engine_name(engine));
+        if (!sha256_mb_engine_supported(engine)) {
+            printf("이 CPU에서 지원하지 않음 (건너뜀)\n");
+            continue;
+        }
+        
+        int engine_failures = 0;
+        
+        // 1. 공개 테스트 벡터를 한 배치로
+        const unsigned char *vdata[4];
+        size_t vlens[4];
+        for (size_t v = 0; v < vector_count; v++) {
+            vdata[v] = (vectors[v].repeat > 1) ? million_a
+                                               : (const unsigned char *)vectors[v].msg;
+            vlens[v] = strlen(vectors[v].msg) * vectors[v].repeat;
+        }
+        sha256_mb_hash_engine(engine, vdata, vlens, digests, vector_count);
+        for (size_t v = 0; v < vector_count; v++) {
+            char hex[65];
+            for (int i = 0; i < 32; i++) {
+                sprintf(hex + i * 2, "%02x", digests[v][i]);
+            }
+            if (strcmp(hex, vectors[v].digest) != 0) {
+                engine_failures++;
+            }
+        }
+        
+        // 2. 무작위 길이 메시지를 EVP 경로(calculate_sha256)와 비교
+        sha256_mb_hash_engine(engine, data, lens, digests, MB_TEST_BATCH);
+        for (size_t i = 0; i < MB_TEST_BATCH; i++) {
+            if (memcmp(digests[i], expected[i], 32) != 0) {
+                engine_failures++;
+            }
+        }
+        
+        if (engine_failures == 0) {
+            printf("✓ 테스트 벡터 %zu개, EVP 비교 %d개 일치\n",
+                   vector_count, MB_TEST_BATCH);
+        } else {
+            printf("✗ 불일치 %d개\n", engine_failures);
+        }
+        failures += engine_failures;
+    }
+    
+    free(pool);
+    free(digests);
+    free(expected);
+    return (failures == 0) ? 0 : -1;
+}
+
+/**
+ * 짧은 메시지 묶음에 대해 하나씩 처리(EVP)와 다중 버퍼 엔진의 처리량을 비교한다.
+ */
+int run_mb_benchmark(void) {
+    static const size_t sizes[] = { 64, 256, 1024 };
+    
+    printf("=== 다중 버퍼 SHA-256 벤치마크 (메시지 %d개 묶음) ===\n\n",
+           MB_BENCH_MESSAGES);
+    printf("%-8s %-18s %14s %10s\n", "크기", "경로", "messages/s", "배율");
+    
+    unsigned char *pool = malloc(MB_BENCH_MESSAGES * 1024);
+    const unsigned char **data = malloc(MB_BENCH_MESSAGES * sizeof(*data));
+    size_t *lens = malloc(MB_BENCH_MESSAGES * sizeof(*lens));
+    unsigned char (*digests)[32] = malloc(MB_BENCH_MESSAGES * 32);
+    if (pool == NULL || data == NULL || lens == NULL || digests == NULL) {
+        free(pool);
+        free(data);
+        free(lens);
+        free(digests);
+        return -1;
+    }
+    for (size_t i = 0; i < MB_BENCH_MESSAGES * 1024; i++) {
+        pool[i] = (unsigned char)(i * 131 + 7);
+    }
+    
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        char label[16];
+        snprintf(label, sizeof(label), "%zuB", sizes[s]);
+        for (size_t i = 0; i < MB_BENCH_MESSAGES; i++) {
+            data[i] = pool + i * sizes[s];
+            lens[i] = sizes[s];
+        }
+        
+        // 기준: 메시지마다 EVP 컨텍스트 하나씩 (calculate_sha256)
+        size_t done = 0;
+        double start = now_seconds(), elapsed;
+        do {
+            for (size_t i = 0; i < MB_BENCH_MESSAGES; i++) {
+                calculate_sha256(data[i], lens[i], digests[i]);
+            }
+            done += MB_BENCH_MESSAGES;
+            elapsed = now_seconds() - start;
+        } while (elapsed < MB_BENCH_SECONDS);
+        double baseline = (double)done / elapsed;
+        printf("%-8s %-18s %14.0f %9.2fx\n", label, "EVP 하나씩", baseline, 1.0);
+        
+        for (int e = 0; e < SHA256_MB_ENGINE_COUNT; e++) {
+            Sha256MbEngine engine = (Sha256MbEngine)e;
+            if (!sha256_mb_engine_supported(engine)) {
+                continue;
+            }
+            done = 0;
+            start = now_seconds();
+            do {
+                sha256_mb_hash_engine(engine, data, lens, digests, MB_BENCH_MESSAGES);
+                done += MB_BENCH_MESSAGES;
+                elapsed = now_seconds() - start;
+            } while (elapsed < MB_BENCH_SECONDS);
+            double rate = (double)done / elapsed;
+            printf("%-8s %-18s %14.0f %9.2fx\n", label,
+                   sha256_mb_engine_name(engine), rate, rate / baseline);
+        }
+        printf("\n");
+    }
+    
+    free(pool);
+    free(data);
+    free(lens);
+    free(digests);
+    return 0;
+}
+
+/**
+ * 16B~4KB 입력에 대해 SHA-256 한 번 호출의 ns/op를 경로별로 비교한다.
+ * 
+ *   - 매 호출 EVP_MD_CTX 생성 + EVP_sha256() (기존 calculate_sha256)
+ *   - EVP_Digest() + EVP_sha256() (OpenSSL 한 번 호출 API)
+ *   - digest_oneshot() (fetch 캐시 + 스레드 컨텍스트 재사용)
+ */
+int run_ctx_benchmark(void) {
+    static const size_t sizes[] = { 16, 64, 256, 1024, 4096 };
+    unsigned char data[4096];
+    unsigned char hash[32];
+    
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (unsigned char)(i * 131 + 7);
+    }
+    
+    printf("=== SHA-256 한 번 호출 비용 (ns/op, 단일 스레드) ===\n\n");
+    printf("%-8s %14s %14s %14s %8s\n", "크기", "CTX 매번 생성", "EVP_Digest", "digest_ctx", "개선");
+    
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        double ns[3];
+        for (int path = 0; path < 3; path++) {
+            size_t done = 0;
+            double start = now_seconds(), elapsed;
+            do {
+                for (int i = 0; i < 1000; i++) {
+                    if (path == 0) {
+                        calculate_sha256_alloc(data, sizes[s], hash);
+                    } else if (path == 1) {
+                        EVP_Digest(data, sizes[s], hash, NULL, EVP_sha256(), NULL);
+                    } else {
+                        calculate_sha256(data, sizes[s], hash);
+                    }
+                }
+                done += 1000;
+                elapsed = now_seconds() - start;
+            } while (elapsed < CTX_BENCH_SECONDS);
+            ns[path] = elapsed * 1e9 / (double)done;
+        }
+        char label[16];
+        snprintf(label, sizeof(label), "%zuB", sizes[s]);
+        printf("%-8s %14.1f %14.1f %14.1f %7.2fx\n", label, ns[0], ns[1], ns[2], ns[0] / ns[2]);
+    }
+    
+    // 두 경로의 결과가 같은지 확인
+    unsigned char expected[32];
+    calculate_sha256_alloc(data, sizeof(data), expected);
+    calculate_sha256(data, sizeof(data), hash);
+    if (memcmp(expected, hash, 32) != 0) {
+        printf("\n✗ digest_ctx 결과가 기존 경로와 다릅니다!\n");
+        return -1;
+    }
+    printf("\n✓ 기존 경로와 결과 일치\n");
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    cpu_features_apply_override(argv);
+    
+    if (argc > 1 && strcmp(argv[1], "--mb-test") == 0) {
+        return (run_mb_selftest() == 0) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--mb-bench") == 0) {
+        return (run_mb_benchmark() == 0) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--ctx-bench") == 0) {
+        return (run_ctx_benchmark() == 0) ? 0 : 1;
+    }
+    
     printf("=== SHA-256 해시 계산 데모 ===\n\n");
     
     // 테스트 문자열들
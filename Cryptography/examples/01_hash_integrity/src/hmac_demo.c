@@ -5,12 +5,22 @@
  * 
  * 빌드: make
  * 실행: ./bin/hmac_demo
+ *       ./bin/hmac_demo --test    (키 객체/배치 API를 RFC 4231 및 HMAC()과 비교)
+ *       ./bin/hmac_demo --bench   (일회성 HMAC() vs 키 객체 vs 배치 messages/s)
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <openssl/core_names.h>
 #include <openssl/hmac.h>
 #include <openssl/evp.h>
+#include "hmac_key.h"
+
+#define HMAC_TEST_MESSAGES 301
+#define HMAC_BENCH_MESSAGES 1024
+#define HMAC_BENCH_SECONDS 0.3
 
 /**
  * HMAC-SHA256을 계산한다.
@@ -59,7 +69,247 @@ void print_mac(const unsigned char *mac, size_t len) {
     printf("\n");
 }
 
-int main(void) {
+/**
+ * 단조 증가 시계를 초 단위로 반환한다.
+ */
+double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * 16진수 문자열을 바이트로 변환한다 (테스트 벡터용).
+ */
+void hex_decode(const char *hex, unsigned char *out) {
+    for (size_t i = 0; hex[2 * i] != '\0'; i++) {
+        unsigned int byte;
+        sscanf(hex + 2 * i, "%2x", &byte);
+        out[i] = (unsigned char)byte;
+    }
+}
+
+/**
+ * 키 객체와 배치 API를 RFC 4231 테스트 벡터 및 일회성 HMAC()과 비교한다.
+ * 
+ * @return 모두 일치하면 0, 하나라도 불일치하면 -1
+ */
+int run_hmac_selftest(void) {
+    static const struct {
+        unsigned char key_byte;
+        size_t key_len;
+        const char *data;
+        const char *mac_hex;
+    } vectors[] = {
+        // RFC 4231 테스트 케이스 1, 2, 6 (6: 블록보다 긴 키)
+        { 0x0b, 20, "Hi There",
+          "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7" },
+        { 0, 4, "what do ya want for nothing?",
+          "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843" },
+        { 0xaa, 131, "Test Using Larger Than Block-Size Key - Hash Key First",
+          "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54" },
+    };
+    int failures = 0;
+    
+    printf("=== HMAC 키 객체 / 배치 API 기지 답 테스트 ===\n\n");
+    
+    for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++) {
+        unsigned char key[131];
+        if (vectors[v].key_byte == 0) {
+            memcpy(key, "Jefe", 4);
+        } else {
+            memset(key, vectors[v].key_byte, vectors[v].key_len);
+        }
+        unsigned char expected[32], mac[32];
+        hex_decode(vectors[v].mac_hex, expected);
+        
+        HmacSha256Key k;
+        hmac_key_init(&k, key, vectors[v].key_len);
+        hmac_key_mac(&k, (const unsigned char *)vectors[v].data, strlen(vectors[v].data), mac);
+        hmac_key_clear(&k);
+        if (memcmp(mac, expected, 32) != 0) {
+            printf("✗ RFC 4231 벡터 %zu 불일치\n", v + 1);
+            failures++;
+        }
+    }
+    
+    // 키 길이 0~130바이트, 메시지 길이 0~300바이트를 일회성 HMAC()과 비교
+    unsigned char *pool = malloc(HMAC_TEST_MESSAGES * 2);
+    const unsigned char *data[HMAC_TEST_MESSAGES];
+    size_t lens[HMAC_TEST_MESSAGES];
+    unsigned char (*macs)[32] = malloc(HMAC_TEST_MESSAGES * 32);
+    unsigned char (*expected)[32] = malloc(HMAC_TEST_MESSAGES * 32);
+    int results[HMAC_TEST_MESSAGES];
+    if (pool == NULL || macs == NULL || expected == NULL) {
+        free(pool);
+        free(macs);
+        free(expected);
+        return -1;
+    }
+    srand(4231);
+    for (size_t i = 0; i < HMAC_TEST_MESSAGES * 2; i++) {
+        pool[i] = (unsigned char)rand();
+    }
+    for (size_t i = 0; i < HMAC_TEST_MESSAGES; i++) {
+        data[i] = pool + (i * 7) % HMAC_TEST_MESSAGES;
+        lens[i] = i;
+    }
+    
+    for (size_t key_len = 0; key_len <= 130; key_len += 13) {
+        HmacSha256Key k;
+        hmac_key_init(&k, pool, key_len);
+        for (size_t i = 0; i < HMAC_TEST_MESSAGES; i++) {
+            calculate_hmac_sha256(pool, key_len, data[i], lens[i], expected[i]);
+        }
+        
+        for (int e = 0; e < SHA256_MB_ENGINE_COUNT; e++) {
+            Sha256MbEngine engine = (Sha256MbEngine)e;
+            if (!sha256_mb_engine_supported(engine)) {
+                continue;
+            }
+            hmac_key_mac_batch_engine(&k, engine, data, lens, macs, HMAC_TEST_MESSAGES);
+            for (size_t i = 0; i < HMAC_TEST_MESSAGES; i++) {
+                if (memcmp(macs[i], expected[i], 32) != 0) {
+                    printf("✗ [%s] 키 %zu바이트, 메시지 %zu바이트 불일치\n",
+                           sha256_mb_engine_name(engine), key_len, lens[i]);
+                    failures++;
+                    break;
+                }
+            }
+        }
+        
+        // 배치 검증: 하나를 변조하여 정확히 그 메시지만 실패하는지 확인
+        expected[HMAC_TEST_MESSAGES / 2][0] ^= 1;
+        size_t bad = hmac_key_verify_batch(&k, data, lens,
+                                           (const unsigned char (*)[32])expected,
+                                           results, HMAC_TEST_MESSAGES);
+        if (bad != 1 || results[HMAC_TEST_MESSAGES / 2] == 0) {
+            printf("✗ 키 %zu바이트: 배치 검증이 변조를 정확히 찾지 못함 (불일치 %zu개)\n",
+                   key_len, bad);
+            failures++;
+        }
+        hmac_key_clear(&k);
+    }
+    
+    free(pool);
+    free(macs);
+    free(expected);
+    
+    if (failures == 0) {
+        printf("✓ RFC 4231 벡터 3개, 키 길이 11종 × 메시지 %d개 × 엔진별 HMAC() 비교 일치\n",
+               HMAC_TEST_MESSAGES);
+        printf("✓ 배치 검증이 변조된 메시지 하나만 정확히 거부\n");
+        return 0;
+    }
+    return -1;
+}
+
+/**
+ * 같은 키로 짧은 메시지 묶음을 인증하는 처리량(messages/s)을 비교한다.
+ * 
+ *   - HMAC() 일회성 (calculate_hmac_sha256, 기존 경로)
+ *   - EVP_MAC (키 설정 1회 후 EVP_MAC_init(NULL 키) 재초기화)
+ *   - HmacSha256Key 하나씩 (hmac_key_mac)
+ *   - HmacSha256Key 배치 (hmac_key_mac_batch, SIMD 다중 버퍼)
+ */
+int run_hmac_benchmark(void) {
+    static const size_t sizes[] = { 8, 16, 64, 256 };
+    static const unsigned char key[32] = "gateway-secoc-key-0123456789abc";
+    
+    unsigned char *pool = malloc(HMAC_BENCH_MESSAGES * 256);
+    const unsigned char **data = malloc(HMAC_BENCH_MESSAGES * sizeof(*data));
+    size_t *lens = malloc(HMAC_BENCH_MESSAGES * sizeof(*lens));
+    unsigned char (*macs)[32] = malloc(HMAC_BENCH_MESSAGES * 32);
+    EVP_MAC *mac = EVP_MAC_fetch(NULL, "HMAC", NULL);
+    EVP_MAC_CTX *mac_ctx = (mac != NULL) ? EVP_MAC_CTX_new(mac) : NULL;
+    int ret = -1;
+    if (pool == NULL || data == NULL || lens == NULL || macs == NULL || mac_ctx == NULL) {
+        goto cleanup;
+    }
+    
+    OSSL_PARAM params[2] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, "SHA256", 0),
+        OSSL_PARAM_construct_end()
+    };
+    if (EVP_MAC_init(mac_ctx, key, sizeof(key), params) != 1) {
+        goto cleanup;
+    }
+    
+    HmacSha256Key k;
+    hmac_key_init(&k, key, sizeof(key));
+    
+    for (size_t i = 0; i < HMAC_BENCH_MESSAGES * 256; i++) {
+        pool[i] = (unsigned char)(i * 131 + 7);
+    }
+    
+    printf("=== HMAC-SHA256 처리량 (같은 키, 메시지 %d개 묶음, 단일 스레드) ===\n\n",
+           HMAC_BENCH_MESSAGES);
+    printf("배치 엔진: %s\n\n", sha256_mb_engine_name(hmac_key_engine_for(HMAC_BENCH_MESSAGES)));
+    printf("%-6s %14s %14s %14s %14s %8s\n", "크기", "HMAC() 일회성", "EVP_MAC 재사용",
+           "키 객체", "키 객체 배치", "배율");
+    
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (size_t i = 0; i < HMAC_BENCH_MESSAGES; i++) {
+            data[i] = pool + i * sizes[s];
+            lens[i] = sizes[s];
+        }
+        
+        double rates[4];
+        for (int path = 0; path < 4; path++) {
+            size_t done = 0;
+            double start = now_seconds(), elapsed;
+            do {
+                if (path == 3) {
+                    hmac_key_mac_batch(&k, data, lens, macs, HMAC_BENCH_MESSAGES);
+                } else {
+                    for (size_t i = 0; i < HMAC_BENCH_MESSAGES; i++) {
+                        if (path == 0) {
+                            calculate_hmac_sha256(key, sizeof(key), data[i], lens[i], macs[i]);
+                        } else if (path == 1) {
+                            size_t out_len;
+                            EVP_MAC_init(mac_ctx, NULL, 0, NULL);
+                            EVP_MAC_update(mac_ctx, data[i], lens[i]);
+                            EVP_MAC_final(mac_ctx, macs[i], &out_len, 32);
+                        } else {
+                            hmac_key_mac(&k, data[i], lens[i], macs[i]);
+                        }
+                    }
+                }
+                done += HMAC_BENCH_MESSAGES;
+                elapsed = now_seconds() - start;
+            } while (elapsed < HMAC_BENCH_SECONDS);
+            rates[path] = (double)done / elapsed;
+        }
+        
+        char label[16];
+        snprintf(label, sizeof(label), "%zuB", sizes[s]);
+        printf("%-6s %14.0f %14.0f %14.0f %14.0f %7.1fx\n", label,
+               rates[0], rates[1], rates[2], rates[3], rates[3] / rates[0]);
+    }
+    printf("\n(배율: 키 객체 배치 / HMAC() 일회성)\n");
+    hmac_key_clear(&k);
+    ret = 0;
+    
+cleanup:
+    EVP_MAC_CTX_free(mac_ctx);
+    EVP_MAC_free(mac);
+    free(pool);
+    free(data);
+    free(lens);
+    free(macs);
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    cpu_features_apply_override(argv);
+    
+    if (argc > 1 && strcmp(argv[1], "--test") == 0) {
+        return (run_hmac_selftest() == 0) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return (run_hmac_benchmark() == 0) ? 0 : 1;
+    }
+    
     printf("=== HMAC-SHA256 메시지 인증 코드 데모 ===\n\n");
     
     // 비밀 키 (실제로는 안전하게 생성/저장해야 함)
@@ -0,0 +1,166 @@
+/**
+ * aead_iov.h - 분산 버퍼(iovec) 제자리 AEAD 봉인/열기
+ *
+ * aes_gcm_encrypt() 등은 연속된 평문 하나를 별도 출력 배열(ciphertext[256])에
+ * 쓰고 길이를 int로 변환하므로, 헤더/페이로드/트레일러를 먼저 한 버퍼로
+ * 이어 붙여야 하고 2GB를 넘는 메시지는 처리할 수 없다.
+ *
+ * 이 헤더는 키 핸들(cipher_key.h)로
+ *   - AAD 세그먼트 목록과 데이터 세그먼트 목록을 따로 받아,
+ *   - 데이터 세그먼트를 제자리에서 암호화/복호화하고,
+ *   - 세그먼트 경계와 무관하게 연속 버퍼와 똑같은 암호문/태그를 만든다.
+ *
+ * 길이는 모두 size_t로 다루며, EVP의 int 인자에는 AEAD_IOV_MAX_UPDATE 이하
+ * 조각으로 나누어 넘긴다. 알고리즘별 메시지 한도(GCM 2^36 - 32바이트,
+ * ChaCha20-Poly1305 2^38 - 64바이트)를 넘으면 처리하지 않는다.
+ *
+ * 열기가 인증에 실패하면 이미 제자리에서 복호화된 데이터를 0으로 지운다
+ * (인증되지 않은 평문을 남기지 않는다). 원래 암호문이 필요하면 복사본을 두라.
+ *
+ * 사용 예 (헤더와 트레일러는 AAD, 페이로드 두 조각은 제자리 암호화):
+ *   struct iovec aad[2] = { { hdr, hdr_len }, { trailer, trailer_len } };
+ *   struct iovec data[2] = { { part1, len1 }, { part2, len2 } };
+ *   aead_iov_seal(&k, nonce, aad, 2, data, 2, tag);
+ */
+
+#ifndef AEAD_IOV_H
+#define AEAD_IOV_H
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include "cipher_key.h"
+
+#define AEAD_IOV_MAX_UPDATE (1 << 30)                      // EVP 호출 한 번의 최대 길이
+#define AEAD_IOV_GCM_MAX ((UINT64_C(1) << 36) - 32)        // NIST SP 800-38D 평문 한도
+#define AEAD_IOV_CHACHA_MAX ((UINT64_C(1) << 38) - 64)     // RFC 8439 (블록 카운터 32비트)
+
+/**
+ * 세그먼트 목록의 전체 길이를 구한다.
+ *
+ * @return 전체 길이, size_t를 넘치면 SIZE_MAX
+ */
+static inline size_t aead_iov_total(const struct iovec *iov, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (iov[i].iov_len > SIZE_MAX - total) {
+            return SIZE_MAX;
+        }
+        total += iov[i].iov_len;
+    }
+    return total;
+}
+
+/**
+ * 핸들 알고리즘의 메시지 길이 한도
+ */
+static inline uint64_t aead_iov_limit(const CipherKey *k) {
+    const EVP_CIPHER *cipher = EVP_CIPHER_CTX_get0_cipher(k->enc);
+    return (cipher != NULL && EVP_CIPHER_is_a(cipher, "ChaCha20-Poly1305"))
+               ? AEAD_IOV_CHACHA_MAX : AEAD_IOV_GCM_MAX;
+}
+
+/**
+ * 세그먼트 목록을 EVP_CipherUpdate에 조각으로 넘긴다.
+ *
+ * @param aad 1이면 AAD로 넣고(출력 없음), 0이면 제자리 암호화/복호화
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int aead_iov_update(EVP_CIPHER_CTX *ctx, const struct iovec *iov, size_t count,
+                                  int aad) {
+    for (size_t i = 0; i < count; i++) {
+        unsigned char *p = (unsigned char *)iov[i].iov_base;
+        size_t left = iov[i].iov_len;
+        while (left > 0) {
+            int n = (left > AEAD_IOV_MAX_UPDATE) ? AEAD_IOV_MAX_UPDATE : (int)left;
+            int outl;
+            if (EVP_CipherUpdate(ctx, aad ? NULL : p, &outl, p, n) != 1 ||
+                (!aad && outl != n)) {
+                return -1;
+            }
+            p += n;
+            left -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 데이터 세그먼트를 0으로 지운다.
+ */
+static inline void aead_iov_wipe(const struct iovec *data, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (data[i].iov_len > 0) {
+            OPENSSL_cleanse(data[i].iov_base, data[i].iov_len);
+        }
+    }
+}
+
+/**
+ * 분산 버퍼를 제자리에서 봉인한다.
+ *
+ * @param k         AEAD 키 핸들 (AES-256-GCM 또는 ChaCha20-Poly1305)
+ * @param nonce     96비트 nonce (같은 키로 절대 재사용 금지)
+ * @param aad       인증만 하는 세그먼트 (NULL/0 가능)
+ * @param data      평문 세그먼트 → 같은 자리에 암호문
+ * @param tag       16바이트 태그 출력
+ * @return 성공 시 0, 실패/길이 한도 초과 시 -1
+ */
+static inline int aead_iov_seal(CipherKey *k, const unsigned char *nonce,
+                                const struct iovec *aad, size_t aad_count,
+                                const struct iovec *data, size_t data_count,
+                                unsigned char *tag) {
+    unsigned char final_block[16];
+    int outl;
+    size_t total = aead_iov_total(data, data_count);
+
+    if (!k->aead || total == SIZE_MAX || (uint64_t)total > aead_iov_limit(k) ||
+        aead_iov_total(aad, aad_count) == SIZE_MAX ||
+        EVP_EncryptInit_ex(k->enc, NULL, NULL, NULL, nonce) != 1 ||
+        aead_iov_update(k->enc, aad, aad_count, 1) != 0 ||
+        aead_iov_update(k->enc, data, data_count, 0) != 0 ||
+        EVP_EncryptFinal_ex(k->enc, final_block, &outl) != 1 ||
+        EVP_CIPHER_CTX_ctrl(k->enc, EVP_CTRL_AEAD_GET_TAG, CIPHER_KEY_TAG_SIZE, tag) != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * 분산 버퍼를 제자리에서 열고 태그를 검증한다.
+ *
+ * 인증에 실패하면 데이터 세그먼트를 0으로 지운다.
+ *
+ * @param data 암호문 세그먼트 → 같은 자리에 평문
+ * @return 성공 시 0, 실패 시 -1, 인증 실패 시 -2
+ */
+static inline int aead_iov_open(CipherKey *k, const unsigned char *nonce,
+                                const struct iovec *aad, size_t aad_count,
+                                const struct iovec *data, size_t data_count,
+                                const unsigned char *tag) {
+    unsigned char final_block[16];
+    int outl;
+    size_t total = aead_iov_total(data, data_count);
+
+    if (!k->aead || total == SIZE_MAX || (uint64_t)total > aead_iov_limit(k) ||
+        aead_iov_total(aad, aad_count) == SIZE_MAX ||
+        EVP_DecryptInit_ex(k->dec, NULL, NULL, NULL, nonce) != 1 ||
+        aead_iov_update(k->dec, aad, aad_count, 1) != 0) {
+        return -1;
+    }
+    if (aead_iov_update(k->dec, data, data_count, 0) != 0 ||
+        EVP_CIPHER_CTX_ctrl(k->dec, EVP_CTRL_AEAD_SET_TAG, CIPHER_KEY_TAG_SIZE,
+                            (void *)tag) != 1) {
+        aead_iov_wipe(data, data_count);
+        return -1;
+    }
+    if (EVP_DecryptFinal_ex(k->dec, final_block, &outl) != 1) {
+        aead_iov_wipe(data, data_count);
+        return -2;
+    }
+    return 0;
+}
+
+#endif /* AEAD_IOV_H */
@@ -0,0 +1,222 @@
+/**
+ * aead_select.h - ChaCha20-Poly1305와 CPU에 맞는 AEAD 자동 선택
+ *
+ * AES-NI/PMULL이 없는 저가형 x86/ARM 장비에서는 AES-256-GCM이 비트 슬라이스나
+ * 테이블 구현으로 떨어져 ChaCha20-Poly1305보다 몇 배 느리다. 두 AEAD는 키
+ * 32바이트, nonce 12바이트, 태그 16바이트로 모양이 같으므로, 이 헤더는
+ *   - aes_gcm_encrypt()/aes_gcm_decrypt()와 같은 인터페이스의
+ *     chacha20_poly1305_encrypt()/chacha20_poly1305_decrypt()와
+ *   - 시작 시 한 번 빠른 쪽을 고르는 정책(aead_select())을 제공한다.
+ *
+ * 정책:
+ *   auto   CPU 기능으로 판단 (x86: AES-NI + PCLMULQDQ, ARM: AES + PMULL이면 GCM)
+ *   bench  두 AEAD를 16KB 버퍼로 잠깐 측정하여 빠른 쪽
+ *   gcm / chacha20  고정
+ *
+ * 선택 결과는 알고리즘 ID(AEAD_ALG_*)로 출력 형식에 기록하여 수신 측이
+ * 협상 없이 같은 알고리즘으로 열 수 있게 한다 (gcm_stream.h 헤더 참고).
+ * CRYPTO_FORCE_GENERIC=1이면 cpu_features.h가 가속 기능을 "없음"으로 보고하므로
+ * auto는 ChaCha20-Poly1305를 고른다.
+ */
+
+#ifndef AEAD_SELECT_H
+#define AEAD_SELECT_H
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <openssl/evp.h>
+#include "cipher_key.h"
+#include "cpu_features.h"
+
+#define AEAD_ALG_AES_256_GCM 1           // 출력 형식에 기록하는 알고리즘 ID
+#define AEAD_ALG_CHACHA20_POLY1305 2
+#define AEAD_KEY_SIZE 32
+#define AEAD_NONCE_SIZE 12
+#define AEAD_TAG_SIZE 16
+#define AEAD_BENCH_BUFFER (16 * 1024)
+#define AEAD_BENCH_SECONDS 0.02          // 알고리즘당 측정 시간 (시작 지연 최소화)
+
+typedef enum {
+    AEAD_POLICY_AUTO,                    // CPU 기능으로 판단
+    AEAD_POLICY_BENCH,                   // 짧은 자체 측정
+    AEAD_POLICY_GCM,
+    AEAD_POLICY_CHACHA20,
+} AeadPolicy;
+
+/**
+ * 선택 결과
+ */
+typedef struct {
+    int alg;                             // AEAD_ALG_*
+    const char *reason;                  // 선택 근거 (사람이 읽는 설명)
+    double gcm_mbps;                     // bench 정책일 때만 채워짐
+    double chacha_mbps;
+} AeadSelection;
+
+/**
+ * 알고리즘 ID의 OpenSSL 이름 (알 수 없는 ID면 NULL)
+ */
+static inline const char *aead_alg_name(int alg) {
+    switch (alg) {
+    case AEAD_ALG_AES_256_GCM: return "AES-256-GCM";
+    case AEAD_ALG_CHACHA20_POLY1305: return "ChaCha20-Poly1305";
+    default: return NULL;
+    }
+}
+
+/**
+ * 정책 이름("auto", "bench", "gcm", "chacha20")을 해석한다.
+ *
+ * @return 성공 시 0, 알 수 없는 이름이면 -1
+ */
+static inline int aead_policy_parse(const char *name, AeadPolicy *policy) {
+    if (strcmp(name, "auto") == 0) {
+        *policy = AEAD_POLICY_AUTO;
+    } else if (strcmp(name, "bench") == 0) {
+        *policy = AEAD_POLICY_BENCH;
+    } else if (strcmp(name, "gcm") == 0) {
+        *policy = AEAD_POLICY_GCM;
+    } else if (strcmp(name, "chacha20") == 0) {
+        *policy = AEAD_POLICY_CHACHA20;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * ChaCha20-Poly1305로 인증 암호화를 수행한다 (aes_gcm_encrypt()와 같은 인터페이스).
+ *
+ * @param key 256비트 키
+ * @param iv 96비트 nonce (같은 키로 절대 재사용 금지)
+ * @param tag 인증 태그 출력 (16바이트)
+ * @return 암호문 길이, 실패 시 -1
+ */
+static inline int chacha20_poly1305_encrypt(const unsigned char *key,
+                                            const unsigned char *iv,
+                                            const unsigned char *aad, size_t aad_len,
+                                            const unsigned char *plaintext, size_t plaintext_len,
+                                            unsigned char *ciphertext,
+                                            unsigned char *tag) {
+    const EVP_CIPHER *cipher = cipher_key_fetch("ChaCha20-Poly1305");
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int len, ciphertext_len = -1;
+
+    if (cipher != NULL && ctx != NULL &&
+        EVP_EncryptInit_ex(ctx, cipher, NULL, key, iv) == 1 &&
+        (aad == NULL || aad_len == 0 ||
+         EVP_EncryptUpdate(ctx, NULL, &len, aad, (int)aad_len) == 1) &&
+        EVP_EncryptUpdate(ctx, ciphertext, &len, plaintext, (int)plaintext_len) == 1) {
+        ciphertext_len = len;
+        if (EVP_EncryptFinal_ex(ctx, ciphertext + len, &len) == 1 &&
+            EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, AEAD_TAG_SIZE, tag) == 1) {
+            ciphertext_len += len;
+        } else {
+            ciphertext_len = -1;
+        }
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return ciphertext_len;
+}
+
+/**
+ * ChaCha20-Poly1305로 인증 복호화를 수행한다 (aes_gcm_decrypt()와 같은 인터페이스).
+ *
+ * @return 평문 길이, 실패 시 -1, 인증 실패 시 -2
+ */
+static inline int chacha20_poly1305_decrypt(const unsigned char *key,
+                                            const unsigned char *iv,
+                                            const unsigned char *aad, size_t aad_len,
+                                            const unsigned char *ciphertext, size_t ciphertext_len,
+                                            const unsigned char *tag,
+                                            unsigned char *plaintext) {
+    const EVP_CIPHER *cipher = cipher_key_fetch("ChaCha20-Poly1305");
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int len, plaintext_len = -1;
+
+    if (cipher != NULL && ctx != NULL &&
+        EVP_DecryptInit_ex(ctx, cipher, NULL, key, iv) == 1 &&
+        (aad == NULL || aad_len == 0 ||
+         EVP_DecryptUpdate(ctx, NULL, &len, aad, (int)aad_len) == 1) &&
+        EVP_DecryptUpdate(ctx, plaintext, &len, ciphertext, (int)ciphertext_len) == 1 &&
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, AEAD_TAG_SIZE, (void *)tag) == 1) {
+        int update_len = len;
+        // 태그 검증
+        plaintext_len = (EVP_DecryptFinal_ex(ctx, plaintext + len, &len) == 1)
+                            ? update_len + len : -2;
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return plaintext_len;
+}
+
+/**
+ * 알고리즘 하나의 16KB 봉인 처리량(MB/s)을 잰다.
+ */
+static inline double aead_bench_one(int alg) {
+    static unsigned char buffer[AEAD_BENCH_BUFFER];
+    unsigned char key[AEAD_KEY_SIZE] = { 0 }, nonce[AEAD_NONCE_SIZE] = { 0 };
+    unsigned char tag[AEAD_TAG_SIZE];
+    struct timespec t0, t1;
+    CipherKey k;
+    size_t rounds = 0;
+    double elapsed;
+
+    if (cipher_key_init(&k, aead_alg_name(alg), key) != 0) {
+        return 0.0;
+    }
+    cipher_key_seal(&k, nonce, NULL, 0, buffer, sizeof(buffer), buffer, tag);   // 예열
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    do {
+        nonce[0] = (unsigned char)rounds;
+        cipher_key_seal(&k, nonce, NULL, 0, buffer, sizeof(buffer), buffer, tag);
+        rounds++;
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        elapsed = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    } while (elapsed < AEAD_BENCH_SECONDS);
+    cipher_key_free(&k);
+    return (double)rounds * sizeof(buffer) / (1024.0 * 1024.0) / elapsed;
+}
+
+/**
+ * 정책에 따라 AEAD를 고른다. 시작 시 한 번 호출하여 결과를 재사용한다.
+ */
+static inline void aead_select(AeadPolicy policy, AeadSelection *sel) {
+    const CpuFeatures *f = cpu_features_get();
+
+    memset(sel, 0, sizeof(*sel));
+    switch (policy) {
+    case AEAD_POLICY_GCM:
+        sel->alg = AEAD_ALG_AES_256_GCM;
+        sel->reason = "고정 정책 (gcm)";
+        return;
+    case AEAD_POLICY_CHACHA20:
+        sel->alg = AEAD_ALG_CHACHA20_POLY1305;
+        sel->reason = "고정 정책 (chacha20)";
+        return;
+    case AEAD_POLICY_BENCH:
+        sel->gcm_mbps = aead_bench_one(AEAD_ALG_AES_256_GCM);
+        sel->chacha_mbps = aead_bench_one(AEAD_ALG_CHACHA20_POLY1305);
+        sel->alg = (sel->gcm_mbps >= sel->chacha_mbps) ? AEAD_ALG_AES_256_GCM
+                                                       : AEAD_ALG_CHACHA20_POLY1305;
+        sel->reason = "자체 측정, 16KB 봉인";
+        return;
+    case AEAD_POLICY_AUTO:
+    default:
+        break;
+    }
+#if defined(CPU_FEATURES_X86)
+    int accelerated = f->aesni && f->pclmulqdq;
+    sel->reason = accelerated ? "AES-NI + PCLMULQDQ 있음" : "AES-NI/PCLMULQDQ 없음";
+#elif defined(CPU_FEATURES_ARM64)
+    int accelerated = f->arm_aes && f->arm_pmull;
+    sel->reason = accelerated ? "ARMv8 AES + PMULL 있음" : "ARMv8 AES/PMULL 없음";
+#else
+    int accelerated = 0;
+    (void)f;
+    sel->reason = "하드웨어 AES 탐지 불가";
+#endif
+    sel->alg = accelerated ? AEAD_ALG_AES_256_GCM : AEAD_ALG_CHACHA20_POLY1305;
+}
+
+#endif /* AEAD_SELECT_H */
@@ -5,16 +5,35 @@
  * 
  * 빌드: make
  * 실행: ./bin/aes_cbc
+ *       ./bin/aes_cbc --encrypt-file <입력> <출력> <키 파일>   (IV || 암호문)
+ *       ./bin/aes_cbc --decrypt-file <입력> <출력> <키 파일> [스레드]
+ *       ./bin/aes_cbc --bench [크기MB] [스레드]   (단일 스레드 대비 병렬 복호화 배율)
+ *       ./bin/aes_cbc --ctx-bench   (메시지당 CTX 생성 vs 키 핸들, 16B~1KB ns/op)
  */
 
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <openssl/evp.h>
 #include <openssl/rand.h>
+#include "cipher_key.h"
 
 #define AES_BLOCK_SIZE 16
 #define AES_KEY_SIZE 32   // 256 bits
 #define AES_IV_SIZE 16
+#define CBC_SEGMENT_SIZE (1024 * 1024)  // 병렬 복호화 세그먼트 (블록 크기의 배수)
+#define CBC_MAX_THREADS 256
+#define CBC_IO_BUFFER (64 * 1024)
+#define CBC_BENCH_MB 256
+#define CTX_BENCH_SECONDS 0.3
 
 /**
  * PKCS#7 패딩을 적용한다.
@@ -107,6 +126,403 @@ int aes_cbc_decrypt(const unsigned char *key,
     return 0;
 }
 
+/**
+ * PKCS#7 패딩을 엄격하게 검사한다 (마지막 블록의 패딩 바이트 전체 확인).
+ *
+ * @return 패딩 길이 (1~16), 잘못된 패딩이면 -1
+ */
+int check_pkcs7_padding(const unsigned char *last_block) {
+    unsigned char padding = last_block[AES_BLOCK_SIZE - 1];
+    unsigned char bad = (unsigned char)((padding == 0) | (padding > AES_BLOCK_SIZE));
+    
+    for (int i = 0; i < AES_BLOCK_SIZE; i++) {
+        unsigned char in_pad = (unsigned char)(i >= AES_BLOCK_SIZE - padding);
+        bad |= (unsigned char)(in_pad & (last_block[i] != padding));
+    }
+    return bad ? -1 : padding;
+}
+
+/**
+ * 병렬 복호화 작업 (세그먼트 단위로 원자적으로 분배)
+ */
+typedef struct {
+    const unsigned char *key;
+    const unsigned char *iv;
+    const unsigned char *ciphertext;
+    unsigned char *plaintext;
+    size_t ciphertext_len;
+    size_t segment_size;                // 블록 크기의 배수
+    size_t segment_count;
+    atomic_size_t next;
+    atomic_int failed;
+} CbcDecryptJob;
+
+/**
+ * 작업자: 세그먼트 i는 직전 암호문 블록(세그먼트 0은 원래 IV)을 IV로 삼아
+ * 다른 세그먼트와 독립적으로 복호화한다. 패딩은 여기서 처리하지 않는다.
+ */
+static void *cbc_decrypt_worker(void *arg) {
+    CbcDecryptJob *job = (CbcDecryptJob *)arg;
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    
+    if (ctx == NULL ||
+        EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, job->key, NULL) != 1) {
+        atomic_store(&job->failed, 1);
+        EVP_CIPHER_CTX_free(ctx);
+        return NULL;
+    }
+    EVP_CIPHER_CTX_set_padding(ctx, 0);
+    
+    while (!atomic_load(&job->failed)) {
+        size_t idx = atomic_fetch_add(&job->next, 1);
+        if (idx >= job->segment_count) {
+            break;
+        }
+        size_t start = idx * job->segment_size;
+        size_t len = job->ciphertext_len - start;
+        if (len > job->segment_size) {
+            len = job->segment_size;
+        }
+        const unsigned char *iv = (idx == 0) ? job->iv : job->ciphertext + start - AES_BLOCK_SIZE;
+    
+        // 키 확장은 유지하고 IV만 다시 설정
+        int out_len;
+        if (EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, iv) != 1 ||
+            EVP_DecryptUpdate(ctx, job->plaintext + start, &out_len,
+                              job->ciphertext + start, (int)len) != 1) {
+            atomic_store(&job->failed, 1);
+        }
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return NULL;
+}
+
+/**
+ * AES-256-CBC를 여러 스레드로 복호화한다.
+ *
+ * CBC 복호화는 P_i = D(C_i) XOR C_{i-1}이므로 암호문만 있으면 블록마다
+ * 독립적으로 계산할 수 있다. 암호문을 세그먼트로 나누고 각 세그먼트의
+ * 직전 암호문 블록을 IV로 사용한다. 패딩은 모든 세그먼트가 끝난 뒤
+ * 마지막 블록에서 한 번 검사한다.
+ *
+ * @param threads 작업자 수 (0: 온라인 코어 수)
+ * @param plaintext 출력 (최소 ciphertext_len 바이트, 입력과 겹치면 안 됨)
+ * @return 성공 시 0, 실패/패딩 오류 시 -1
+ */
+int aes_cbc_decrypt_parallel(const unsigned char *key,
+                             const unsigned char *iv,
+                             const unsigned char *ciphertext, size_t ciphertext_len,
+                             unsigned char *plaintext, size_t *plaintext_len,
+                             int threads) {
+    if (ciphertext_len == 0 || ciphertext_len % AES_BLOCK_SIZE != 0) {
+        return -1;
+    }
+    if (threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cores > 0) ? (int)cores : 1;
+    }
+    if (threads > CBC_MAX_THREADS) {
+        threads = CBC_MAX_THREADS;
+    }
+
+    CbcDecryptJob job;
+    job.key = key;
+    job.iv = iv;
+    job.ciphertext = ciphertext;
+    job.plaintext = plaintext;
+    job.ciphertext_len = ciphertext_len;
+    job.segment_size = CBC_SEGMENT_SIZE;
+    job.segment_count = (ciphertext_len + CBC_SEGMENT_SIZE - 1) / CBC_SEGMENT_SIZE;
+    atomic_init(&job.next, 0);
+    atomic_init(&job.failed, 0);
+    if ((size_t)threads > job.segment_count) {
+        threads = (int)job.segment_count;
+    }
+
+    pthread_t tids[CBC_MAX_THREADS];
+    int started = 0;
+    for (; started < threads - 1; started++) {
+        if (pthread_create(&tids[started], NULL, cbc_decrypt_worker, &job) != 0) {
+            break;
+        }
+    }
+    cbc_decrypt_worker(&job);           // 호출 스레드도 작업에 참여
+    for (int i = 0; i < started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    if (atomic_load(&job.failed)) {
+        return -1;
+    }
+
+    int padding = check_pkcs7_padding(plaintext + ciphertext_len - AES_BLOCK_SIZE);
+    if (padding < 0) {
+        return -1;
+    }
+    *plaintext_len = ciphertext_len - (size_t)padding;
+    return 0;
+}
+
+/**
+ * 32바이트 원시 키 파일을 읽는다.
+ */
+static int load_key_file(const char *path, unsigned char *key) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror("키 파일 열기 실패");
+        return -1;
+    }
+    unsigned char extra;
+    int ok = fread(key, 1, AES_KEY_SIZE, f) == AES_KEY_SIZE && fread(&extra, 1, 1, f) == 0;
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "키 파일은 정확히 %d바이트여야 합니다\n", AES_KEY_SIZE);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * 파일을 AES-256-CBC로 암호화한다 (출력 = IV 16바이트 || 암호문, 공급사 아카이브 형식).
+ */
+int aes_cbc_encrypt_file(const char *in_path, const char *out_path, const unsigned char *key) {
+    FILE *in = fopen(in_path, "rb");
+    FILE *out = fopen(out_path, "wb");
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    unsigned char iv[AES_IV_SIZE];
+    unsigned char inbuf[CBC_IO_BUFFER], outbuf[CBC_IO_BUFFER + AES_BLOCK_SIZE];
+    int ok = in != NULL && out != NULL && ctx != NULL &&
+             RAND_bytes(iv, AES_IV_SIZE) == 1 &&
+             EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, key, iv) == 1 &&
+             fwrite(iv, 1, AES_IV_SIZE, out) == AES_IV_SIZE;
+    int out_len;
+    
+    while (ok) {
+        size_t n = fread(inbuf, 1, sizeof(inbuf), in);
+        if (n == 0) {
+            break;
+        }
+        ok = EVP_EncryptUpdate(ctx, outbuf, &out_len, inbuf, (int)n) == 1 &&
+             fwrite(outbuf, 1, (size_t)out_len, out) == (size_t)out_len;
+    }
+    ok = ok && !ferror(in) &&
+         EVP_EncryptFinal_ex(ctx, outbuf, &out_len) == 1 &&
+         fwrite(outbuf, 1, (size_t)out_len, out) == (size_t)out_len;
+    
+    EVP_CIPHER_CTX_free(ctx);
+    if (in) fclose(in);
+    if (out && fclose(out) != 0) ok = 0;
+    if (!ok) {
+        unlink(out_path);
+    }
+    return ok ? 0 : -1;
+}
+
+/**
+ * IV || 암호문 형식의 파일을 병렬로 복호화한다.
+ *
+ * 입력은 mmap으로 읽고, 출력 파일을 암호문 크기로 늘려 매핑한 뒤 작업자들이
+ * 각자 세그먼트를 직접 기록한다. 패딩 검사 후 평문 길이로 자른다.
+ *
+ * @return 성공 시 0, 실패/패딩 오류 시 -1 (출력 파일 삭제)
+ */
+int aes_cbc_decrypt_file(const char *in_path, const char *out_path,
+                         const unsigned char *key, int threads, double *seconds) {
+    int in_fd = open(in_path, O_RDONLY);
+    if (in_fd < 0) {
+        perror("입력 파일 열기 실패");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(in_fd, &st) != 0 || st.st_size < 2 * AES_BLOCK_SIZE ||
+        (st.st_size - AES_IV_SIZE) % AES_BLOCK_SIZE != 0) {
+        fprintf(stderr, "CBC 아카이브 크기가 잘못됨: %s\n", in_path);
+        close(in_fd);
+        return -1;
+    }
+    size_t in_size = (size_t)st.st_size;
+    size_t ct_len = in_size - AES_IV_SIZE;
+
+    int out_fd = open(out_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        perror("출력 파일 열기 실패");
+        close(in_fd);
+        return -1;
+    }
+
+    int ret = -1;
+    unsigned char *in_map = MAP_FAILED, *out_map = MAP_FAILED;
+    if (ftruncate(out_fd, (off_t)ct_len) == 0) {
+        in_map = mmap(NULL, in_size, PROT_READ, MAP_PRIVATE, in_fd, 0);
+        out_map = mmap(NULL, ct_len, PROT_READ | PROT_WRITE, MAP_SHARED, out_fd, 0);
+    }
+    if (in_map != MAP_FAILED && out_map != MAP_FAILED) {
+        madvise(in_map, in_size, MADV_SEQUENTIAL);
+        size_t pt_len = 0;
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        ret = aes_cbc_decrypt_parallel(key, in_map, in_map + AES_IV_SIZE, ct_len,
+                                       out_map, &pt_len, threads);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        if (seconds != NULL) {
+            *seconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+        }
+        munmap(out_map, ct_len);
+        out_map = MAP_FAILED;
+        if (ret == 0 && ftruncate(out_fd, (off_t)pt_len) != 0) {
+            ret = -1;
+        }
+    }
+    if (in_map != MAP_FAILED) munmap(in_map, in_size);
+    if (out_map != MAP_FAILED) munmap(out_map, ct_len);
+    close(in_fd);
+    if (close(out_fd) != 0) ret = -1;
+    if (ret != 0) {
+        unlink(out_path);
+    }
+    return ret;
+}
+
+static double elapsed_since(const struct timespec *t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (double)(t1.tv_sec - t0->tv_sec) + (double)(t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+/**
+ * 단일 스레드 aes_cbc_decrypt()와 병렬 복호화(스레드 수별)의 MB/s를 비교한다.
+ */
+int run_cbc_benchmark(size_t size_mb, int max_threads) {
+    size_t len = size_mb * 1024 * 1024;
+    unsigned char key[AES_KEY_SIZE], iv[AES_IV_SIZE];
+    unsigned char *plain = malloc(len);
+    unsigned char *cipher = malloc(len + AES_BLOCK_SIZE);
+    unsigned char *out = malloc(len + AES_BLOCK_SIZE);
+    size_t ct_len = 0, pt_len = 0;
+    int failures = 0;
+    
+    if (plain == NULL || cipher == NULL || out == NULL || len > INT_MAX - AES_BLOCK_SIZE) {
+        free(plain);
+        free(cipher);
+        free(out);
+        return -1;
+    }
+    if (max_threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        max_threads = (cores > 0) ? (int)cores : 1;
+    }
+    RAND_bytes(key, AES_KEY_SIZE);
+    RAND_bytes(iv, AES_IV_SIZE);
+    RAND_bytes(plain, (int)len);
+    aes_cbc_encrypt(key, iv, plain, len, cipher, &ct_len);
+    
+    printf("=== AES-256-CBC 복호화 확장성 (%zu MB, 세그먼트 %d KB) ===\n\n",
+           size_mb, CBC_SEGMENT_SIZE / 1024);
+    printf("%-28s %10s %10s\n", "경로", "MB/s", "배율");
+    
+    struct timespec t0;
+    memset(out, 0, len);                // 첫 측정이 페이지 폴트 비용을 떠안지 않도록
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int ret = aes_cbc_decrypt(key, iv, cipher, ct_len, out, &pt_len);
+    double base = elapsed_since(&t0);
+    failures += (ret != 0 || pt_len != len || memcmp(plain, out, len) != 0);
+    printf("%-28s %10.1f %9.2fx\n", "aes_cbc_decrypt (1 스레드)", (double)size_mb / base, 1.0);
+    
+    for (int t = 1; t <= max_threads; t *= 2) {
+        memset(out, 0, len);
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        ret = aes_cbc_decrypt_parallel(key, iv, cipher, ct_len, out, &pt_len, t);
+        double sec = elapsed_since(&t0);
+        failures += (ret != 0 || pt_len != len || memcmp(plain, out, len) != 0);
+    
+        char label[48];
+        snprintf(label, sizeof(label), "병렬 복호화 (%d 스레드)", t);
+        printf("%-28s %10.1f %9.2fx\n", label, (double)size_mb / sec, base / sec);
+        if (t < max_threads && t * 2 > max_threads) {
+            t = max_threads / 2;        // 마지막에 최대 스레드 수도 측정
+        }
+    }
+    
+    // 패딩 변조: 마지막 블록 직전 블록을 바꾸면 패딩 검사에서 거부되어야 한다
+    cipher[ct_len - AES_BLOCK_SIZE - 1] ^= 0x01;
+    ret = aes_cbc_decrypt_parallel(key, iv, cipher, ct_len, out, &pt_len, max_threads);
+    printf("\n패딩 변조 거부: %s\n", ret != 0 ? "✓" : "✗");
+    failures += (ret == 0);
+    
+    OPENSSL_cleanse(key, sizeof(key));
+    free(plain);
+    free(cipher);
+    free(out);
+    printf("%s\n", failures == 0 ? "✓ 모든 경로 결과 일치" : "✗ 결과 불일치");
+    return failures == 0 ? 0 : -1;
+}
+
+/**
+ * 메시지당 CTX 생성 + 키 확장(aes_cbc_encrypt/decrypt)과 키 핸들(IV만 재설정)의
+ * ns/op를 비교한다.
+ */
+int run_ctx_benchmark(void) {
+    static const size_t sizes[] = { 16, 64, 256, 1024 };
+    unsigned char key[AES_KEY_SIZE], iv[AES_IV_SIZE];
+    unsigned char data[1024], ct[1024 + AES_BLOCK_SIZE], ct2[1024 + AES_BLOCK_SIZE];
+    unsigned char pt[1024 + AES_BLOCK_SIZE];
+    size_t ct_len = 0, ct2_len = 0, pt_len = 0;
+    CipherKey handle;
+    
+    RAND_bytes(key, AES_KEY_SIZE);
+    RAND_bytes(iv, AES_IV_SIZE);
+    RAND_bytes(data, sizeof(data));
+    if (cipher_key_init(&handle, "AES-256-CBC", key) != 0) {
+        return -1;
+    }
+    
+    printf("=== AES-256-CBC 메시지당 비용 (ns/op, 단일 스레드) ===\n\n");
+    printf("%-8s %14s %14s %8s %14s %14s %8s\n", "크기",
+           "encrypt()", "cipher_key", "개선", "decrypt()", "cipher_key", "개선");
+    
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        double ns[4];
+        aes_cbc_encrypt(key, iv, data, sizes[s], ct, &ct_len);
+        for (int path = 0; path < 4; path++) {
+            size_t done = 0;
+            struct timespec t0;
+            double elapsed;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            do {
+                for (int i = 0; i < 1000; i++) {
+                    if (path == 0) {
+                        aes_cbc_encrypt(key, iv, data, sizes[s], ct2, &ct2_len);
+                    } else if (path == 1) {
+                        cipher_key_encrypt(&handle, iv, data, sizes[s], ct2, &ct2_len);
+                    } else if (path == 2) {
+                        aes_cbc_decrypt(key, iv, ct, ct_len, pt, &pt_len);
+                    } else {
+                        cipher_key_decrypt(&handle, iv, ct, ct_len, pt, &pt_len);
+                    }
+                }
+                done += 1000;
+                elapsed = elapsed_since(&t0);
+            } while (elapsed < CTX_BENCH_SECONDS);
+            ns[path] = elapsed * 1e9 / (double)done;
+        }
+        char label[16];
+        snprintf(label, sizeof(label), "%zuB", sizes[s]);
+        printf("%-8s %14.1f %14.1f %7.2fx %14.1f %14.1f %7.2fx\n", label,
+               ns[0], ns[1], ns[0] / ns[1], ns[2], ns[3], ns[2] / ns[3]);
+    }
+    
+    // 두 경로의 결과가 같은지 확인
+    int ok = aes_cbc_encrypt(key, iv, data, sizeof(data), ct, &ct_len) == 0 &&
+             cipher_key_encrypt(&handle, iv, data, sizeof(data), ct2, &ct2_len) == 0 &&
+             ct_len == ct2_len && memcmp(ct, ct2, ct_len) == 0 &&
+             cipher_key_decrypt(&handle, iv, ct, ct_len, pt, &pt_len) == 0 &&
+             pt_len == sizeof(data) && memcmp(pt, data, sizeof(data)) == 0;
+    cipher_key_free(&handle);
+    OPENSSL_cleanse(key, sizeof(key));
+    
+    printf("\n%s\n", ok ? "✓ 기존 경로와 결과 일치" : "✗ cipher_key 결과가 기존 경로와 다릅니다!");
+    return ok ? 0 : -1;
+}
+
 void print_hex(const char *label, const unsigned char *data, size_t len) {
     printf("%s: ", label);
     for (size_t i = 0; i < len; i++) {
@@ -115,7 +531,39 @@ void print_hex(const char *label, const unsigned char *data, size_t len) {
     printf("\n");
 }
 
-int main(void) {
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--ctx-bench") == 0) {
+        return (run_ctx_benchmark() == 0) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        size_t size_mb = (argc > 2) ? (size_t)strtoul(argv[2], NULL, 10) : CBC_BENCH_MB;
+        int threads = (argc > 3) ? atoi(argv[3]) : 0;
+        return (run_cbc_benchmark(size_mb > 0 ? size_mb : 1, threads) == 0) ? 0 : 1;
+    }
+    if (argc >= 5 && (strcmp(argv[1], "--encrypt-file") == 0 ||
+                      strcmp(argv[1], "--decrypt-file") == 0)) {
+        unsigned char file_key[AES_KEY_SIZE];
+        if (load_key_file(argv[4], file_key) != 0) {
+            return 1;
+        }
+        int ret;
+        if (strcmp(argv[1], "--encrypt-file") == 0) {
+            ret = aes_cbc_encrypt_file(argv[2], argv[3], file_key);
+            printf("%s\n", ret == 0 ? "✓ 암호화 완료" : "✗ 암호화 실패");
+        } else {
+            double seconds = 0;
+            ret = aes_cbc_decrypt_file(argv[2], argv[3], file_key,
+                                       (argc > 5) ? atoi(argv[5]) : 0, &seconds);
+            if (ret == 0) {
+                printf("✓ 복호화 완료 (%.3f초)\n", seconds);
+            } else {
+                printf("✗ 복호화 실패 (잘못된 키, 손상된 암호문 또는 패딩 오류)\n");
+            }
+        }
+        OPENSSL_cleanse(file_key, sizeof(file_key));
+        return (ret == 0) ? 0 : 1;
+    }
+    
     printf("=== AES-256-CBC 암호화/복호화 데모 ===\n\n");
     
     // 키와 IV 생성 (실제로는 안전하게 생성/저장해야 함)
@@ -0,0 +1,569 @@
+/**
+ * cipher_bench.c - 암호 운용 모드 처리량 벤치마크 (JSON 출력, 회귀 비교)
+ *
+ * ECB/CBC/CTR/GCM(AES-128/256)과 ChaCha20-Poly1305를 16B~64MB 메시지 크기,
+ * 단일/다중 스레드로 측정하여 MB/s, cycles/byte, 메시지당 지연 백분위수를
+ * 보고한다. 결과는 JSON으로 저장하고, compare 명령으로 두 실행 결과를 비교해
+ * 회귀를 표시한다 (OTA 백엔드 서버 용량 산정, 서버 SKU/빌드 간 비교용).
+ *
+ * 측정 방법 (측정점마다):
+ *   1. 처리량 구간: 스레드마다 키 핸들(cipher_key.h) 하나로 메시지를 반복
+ *      암호화한다. 메시지마다 IV/nonce만 재설정한다 (AEAD는 봉인 + 태그).
+ *   2. 지연 구간: 같은 부하에서 메시지마다 시간을 재어 p50/p90/p99/p99.9/최대를
+ *      구한다 (시계 호출 비용이 처리량에 섞이지 않도록 구간을 나눈다).
+ *   cycles/byte는 x86 TSC 기준(코어당)이며, 다른 아키텍처에서는 null이다.
+ *
+ * 빌드: make
+ * 실행: ./bin/cipher_bench run [-o 결과.json] [-t 스레드] [-d 초] [-m 최대크기KB]
+ *                              [-c 이름 필터] [--quick]
+ *       ./bin/cipher_bench compare <기준.json> <새 결과.json> [-r 처리량 허용 %] [-l 지연 허용 %]
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include "cipher_key.h"
+#include "cpu_features.h"
+
+#if defined(CPU_FEATURES_X86)
+#include <x86intrin.h>
+#endif
+
+#define BENCH_MAX_THREADS 64
+#define BENCH_DEFAULT_SECONDS 0.2
+#define BENCH_QUICK_SECONDS 0.05
+#define BENCH_MIN_SIZE 16
+#define BENCH_MAX_SIZE (64u * 1024 * 1024)
+#define BENCH_QUICK_MAX_SIZE (1024u * 1024)
+#define LATENCY_SAMPLES 20000            // 스레드당 지연 표본 상한
+#define DEFAULT_REGRESSION_PCT 5.0        // 처리량 허용 하락 (%)
+#define DEFAULT_LATENCY_PCT 20.0          // p99 지연 허용 증가 (%, 처리량보다 잡음이 큼)
+#define MAX_RESULTS 1024
+
+/**
+ * 측정 대상 암호 (OpenSSL 이름)
+ */
+static const char *const bench_ciphers[] = {
+    "AES-128-ECB", "AES-256-ECB",
+    "AES-128-CBC", "AES-256-CBC",
+    "AES-128-CTR", "AES-256-CTR",
+    "AES-128-GCM", "AES-256-GCM",
+    "ChaCha20-Poly1305",
+};
+
+/**
+ * 측정점 하나의 결과 (JSON 한 줄에 대응)
+ */
+typedef struct {
+    char cipher[CIPHER_KEY_NAME_MAX];
+    int key_bits;
+    size_t size;
+    int threads;
+    uint64_t ops;
+    double mb_per_s;
+    double cycles_per_byte;              // TSC가 없으면 음수
+    double p50, p90, p99, p999, max;     // 메시지당 지연 (ns)
+} BenchResult;
+
+/**
+ * 측정점 하나에서 스레드들이 공유하는 설정
+ */
+typedef struct {
+    const CipherKey *key;                // 스레드마다 복제할 원본 핸들
+    const unsigned char *input;          // 읽기 전용 공유 평문
+    size_t size;
+    double seconds;
+    pthread_barrier_t *barrier;
+} BenchPoint;
+
+typedef struct {
+    const BenchPoint *point;
+    unsigned char *output;               // 스레드 전용 출력 버퍼
+    uint64_t ops;
+    uint64_t bytes;
+    double elapsed;
+    uint64_t cycles;
+    double *latencies;                   // 지연 표본 (ns)
+    size_t samples;
+    int failed;
+} BenchWorker;
+
+/**
+ * 단조 증가 시계를 초 단위로 반환한다.
+ */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t read_cycles(void) {
+#if defined(CPU_FEATURES_X86)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * 메시지 하나를 암호화한다 (AEAD는 봉인, 그 외는 패딩 없는 암호화).
+ */
+static int encrypt_one(CipherKey *k, const unsigned char *iv, const unsigned char *in,
+                       size_t len, unsigned char *out) {
+    unsigned char tag[CIPHER_KEY_TAG_SIZE];
+    size_t out_len;
+
+    if (k->aead) {
+        return cipher_key_seal(k, iv, NULL, 0, in, len, out, tag);
+    }
+    return cipher_key_encrypt(k, iv, in, len, out, &out_len);
+}
+
+static void *bench_worker(void *arg) {
+    BenchWorker *w = (BenchWorker *)arg;
+    const BenchPoint *p = w->point;
+    unsigned char iv[16] = { 0 };
+    CipherKey k;
+
+    if (cipher_key_clone(&k, p->key) != 0) {
+        w->failed = 1;
+        pthread_barrier_wait(p->barrier);
+        return NULL;
+    }
+    // 첫 접근 페이지 폴트와 콜드 캐시를 측정 밖으로
+    memset(w->output, 0, p->size);
+    w->failed |= encrypt_one(&k, iv, p->input, p->size, w->output) != 0;
+    pthread_barrier_wait(p->barrier);
+
+    // 1. 처리량 구간: 작은 메시지는 묶어서 시계를 확인한다
+    uint64_t batch = (p->size >= 65536) ? 1 : 65536 / p->size;
+    uint64_t c0 = read_cycles();
+    double start = now_seconds(), elapsed;
+    do {
+        for (uint64_t i = 0; i < batch; i++) {
+            memcpy(iv, &w->ops, sizeof(w->ops));   // 메시지마다 다른 IV/nonce
+            w->failed |= encrypt_one(&k, iv, p->input, p->size, w->output) != 0;
+            w->ops++;
+        }
+        elapsed = now_seconds() - start;
+    } while (elapsed < p->seconds);
+    w->cycles = read_cycles() - c0;
+    w->elapsed = elapsed;
+    w->bytes = w->ops * p->size;
+
+    // 2. 지연 구간: 다른 스레드도 아직 부하를 걸고 있는 동안 메시지별로 잰다
+    double deadline = now_seconds() + p->seconds / 2;
+    double t0 = now_seconds();
+    while (w->samples < LATENCY_SAMPLES) {
+        memcpy(iv, &w->samples, sizeof(w->samples));
+        iv[15] = 0xff;
+        w->failed |= encrypt_one(&k, iv, p->input, p->size, w->output) != 0;
+        double t1 = now_seconds();
+        w->latencies[w->samples++] = (t1 - t0) * 1e9;
+        if (t1 >= deadline) {
+            break;
+        }
+        t0 = t1;
+    }
+    cipher_key_free(&k);
+    return NULL;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, size_t n, double q) {
+    size_t index = (size_t)(q * (double)(n - 1) + 0.5);
+    return sorted[index < n ? index : n - 1];
+}
+
+/**
+ * 측정점 하나(암호, 크기, 스레드 수)를 측정한다.
+ *
+ * @param input   size 바이트 이상의 공유 평문
+ * @param outputs 스레드별 size 바이트 출력 버퍼
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int bench_point(const CipherKey *key, const unsigned char *input,
+                       unsigned char **outputs, size_t size, int threads,
+                       double seconds, BenchResult *r) {
+    BenchWorker workers[BENCH_MAX_THREADS];
+    pthread_t tids[BENCH_MAX_THREADS];
+    pthread_barrier_t barrier;
+    double *latencies = malloc((size_t)threads * LATENCY_SAMPLES * sizeof(double));
+    int failed = 0;
+
+    if (latencies == NULL) {
+        return -1;
+    }
+    BenchPoint point = { key, input, size, seconds, &barrier };
+    pthread_barrier_init(&barrier, NULL, (unsigned)threads);
+    for (int i = 0; i < threads; i++) {
+        workers[i] = (BenchWorker){ .point = &point, .output = outputs[i],
+                                    .latencies = latencies + (size_t)i * LATENCY_SAMPLES };
+        pthread_create(&tids[i], NULL, bench_worker, &workers[i]);
+    }
+
+    uint64_t ops = 0, bytes = 0, cycles = 0;
+    double elapsed = 0;
+    size_t samples = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        failed |= workers[i].failed;
+        ops += workers[i].ops;
+        bytes += workers[i].bytes;
+        cycles += workers[i].cycles;
+        if (workers[i].elapsed > elapsed) {
+            elapsed = workers[i].elapsed;
+        }
+        // 표본을 앞으로 모은다
+        memmove(latencies + samples, workers[i].latencies,
+                workers[i].samples * sizeof(double));
+        samples += workers[i].samples;
+    }
+    pthread_barrier_destroy(&barrier);
+
+    if (!failed && samples > 0) {
+        qsort(latencies, samples, sizeof(double), compare_double);
+        r->size = size;
+        r->threads = threads;
+        r->ops = ops;
+        r->mb_per_s = (double)bytes / (1024.0 * 1024.0) / elapsed;
+        r->cycles_per_byte = (read_cycles() != 0) ? (double)cycles / (double)bytes : -1.0;
+        r->p50 = percentile(latencies, samples, 0.50);
+        r->p90 = percentile(latencies, samples, 0.90);
+        r->p99 = percentile(latencies, samples, 0.99);
+        r->p999 = percentile(latencies, samples, 0.999);
+        r->max = latencies[samples - 1];
+    }
+    free(latencies);
+    return failed ? -1 : 0;
+}
+
+static void format_size(size_t size, char *buf, size_t buf_len) {
+    if (size >= 1024 * 1024) {
+        snprintf(buf, buf_len, "%zuMB", size / (1024 * 1024));
+    } else if (size >= 1024) {
+        snprintf(buf, buf_len, "%zuKB", size / 1024);
+    } else {
+        snprintf(buf, buf_len, "%zuB", size);
+    }
+}
+
+/**
+ * 결과 한 건을 JSON 한 줄로 쓴다. compare가 이 형식을 그대로 읽는다.
+ */
+static void write_result_json(FILE *f, const BenchResult *r, int last) {
+    fprintf(f, "    {\"cipher\": \"%s\", \"key_bits\": %d, \"size\": %zu, \"threads\": %d, "
+               "\"ops\": %llu, \"mb_per_s\": %.2f, ",
+            r->cipher, r->key_bits, r->size, r->threads, (unsigned long long)r->ops,
+            r->mb_per_s);
+    if (r->cycles_per_byte >= 0) {
+        fprintf(f, "\"cycles_per_byte\": %.3f, ", r->cycles_per_byte);
+    } else {
+        fprintf(f, "\"cycles_per_byte\": null, ");
+    }
+    fprintf(f, "\"latency_ns\": {\"p50\": %.0f, \"p90\": %.0f, \"p99\": %.0f, "
+               "\"p999\": %.0f, \"max\": %.0f}}%s\n",
+            r->p50, r->p90, r->p99, r->p999, r->max, last ? "" : ",");
+}
+
+static int write_json(const char *path, const BenchResult *results, size_t count,
+                      int max_threads, double seconds) {
+    const CpuFeatures *cpu = cpu_features_get();
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        perror("결과 파일 열기 실패");
+        return -1;
+    }
+    fprintf(f, "{\n  \"tool\": \"cipher_bench\",\n  \"format\": 1,\n");
+    fprintf(f, "  \"openssl\": \"%s\",\n", OpenSSL_version(OPENSSL_VERSION));
+    fprintf(f, "  \"cpu\": {\"aesni\": %d, \"vaes\": %d, \"pclmulqdq\": %d, \"avx2\": %d, "
+               "\"avx512f\": %d, \"arm_aes\": %d, \"forced_generic\": %d},\n",
+            cpu->aesni, cpu->vaes, cpu->pclmulqdq, cpu->avx2, cpu->avx512f, cpu->arm_aes,
+            cpu->forced_generic);
+    fprintf(f, "  \"max_threads\": %d,\n  \"seconds_per_point\": %.3f,\n", max_threads, seconds);
+    fprintf(f, "  \"mb\": 1048576,\n  \"results\": [\n");
+    for (size_t i = 0; i < count; i++) {
+        write_result_json(f, &results[i], i + 1 == count);
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+static int cmd_run(const char *out_path, int max_threads, double seconds, size_t max_size,
+                   const char *filter) {
+    BenchResult *results = calloc(MAX_RESULTS, sizeof(BenchResult));
+    unsigned char *outputs[BENCH_MAX_THREADS] = { 0 };
+    unsigned char key[32];
+    size_t count = 0;
+    int failed = 0;
+
+    unsigned char *input = malloc(max_size);
+    int ok = (results != NULL && input != NULL);
+    for (int i = 0; ok && i < max_threads; i++) {
+        outputs[i] = malloc(max_size);
+        ok = (outputs[i] != NULL);
+    }
+    if (!ok) {
+        fprintf(stderr, "메모리 부족 (스레드 %d개 x %zu바이트)\n", max_threads, max_size);
+        failed = 1;
+        goto cleanup;
+    }
+    RAND_bytes(key, sizeof(key));
+    RAND_bytes(input, (int)(max_size < 65536 ? max_size : 65536));
+    for (size_t off = 65536; off < max_size; off += 65536) {
+        memcpy(input + off, input, (max_size - off < 65536) ? max_size - off : 65536);
+    }
+
+    printf("=== 암호 운용 모드 처리량 (스레드 1/%d, 측정점당 %.2f초) ===\n\n",
+           max_threads, seconds);
+    printf("%-18s %6s %4s %12s %10s %12s %12s %12s\n", "암호", "크기", "스레드", "MB/s",
+           "cycles/B", "p50 ns", "p99 ns", "p99.9 ns");
+
+    for (size_t c = 0; c < sizeof(bench_ciphers) / sizeof(bench_ciphers[0]); c++) {
+        if (filter != NULL && strstr(bench_ciphers[c], filter) == NULL) {
+            continue;
+        }
+        CipherKey handle;
+        if (cipher_key_init(&handle, bench_ciphers[c], key) != 0) {
+            printf("%-18s (이 OpenSSL 빌드에서 사용할 수 없음)\n", bench_ciphers[c]);
+            continue;
+        }
+        // ECB/CBC는 패딩 없이 블록 배수 메시지만 측정한다
+        EVP_CIPHER_CTX_set_padding(handle.enc, 0);
+        int key_bits = EVP_CIPHER_CTX_get_key_length(handle.enc) * 8;
+
+        for (size_t size = BENCH_MIN_SIZE; size <= max_size; size *= 4) {
+            int thread_counts[2] = { 1, max_threads };
+            for (int t = 0; t < (max_threads > 1 ? 2 : 1) && count < MAX_RESULTS; t++) {
+                BenchResult *r = &results[count];
+                memset(r, 0, sizeof(*r));
+                snprintf(r->cipher, sizeof(r->cipher), "%s", bench_ciphers[c]);
+                r->key_bits = key_bits;
+                if (bench_point(&handle, input, outputs, size, thread_counts[t], seconds, r) != 0) {
+                    printf("%-18s 측정 실패\n", bench_ciphers[c]);
+                    failed = 1;
+                    continue;
+                }
+                char label[24], cpb[16];
+                format_size(size, label, sizeof(label));
+                if (r->cycles_per_byte >= 0) {
+                    snprintf(cpb, sizeof(cpb), "%.2f", r->cycles_per_byte);
+                } else {
+                    snprintf(cpb, sizeof(cpb), "-");
+                }
+                printf("%-18s %6s %4d %12.1f %10s %12.0f %12.0f %12.0f\n", r->cipher, label,
+                       r->threads, r->mb_per_s, cpb, r->p50, r->p99, r->p999);
+                fflush(stdout);
+                count++;
+            }
+        }
+        cipher_key_free(&handle);
+    }
+
+    if (count > 0 && write_json(out_path, results, count, max_threads, seconds) == 0) {
+        printf("\n✓ 결과 %zu건 저장: %s\n", count, out_path);
+    } else {
+        failed = 1;
+    }
+
+cleanup:
+    OPENSSL_cleanse(key, sizeof(key));
+    for (int i = 0; i < max_threads; i++) {
+        free(outputs[i]);
+    }
+    free(input);
+    free(results);
+    return failed ? 1 : 0;
+}
+
+/**
+ * 이 도구가 쓴 JSON 파일에서 결과 줄을 읽는다 (결과 한 건이 한 줄).
+ *
+ * @return 읽은 결과 수, 파일을 열 수 없으면 -1
+ */
+static int load_results(const char *path, BenchResult *results, int max) {
+    FILE *f = fopen(path, "r");
+    char line[1024];
+    int count = 0;
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    while (count < max && fgets(line, sizeof(line), f) != NULL) {
+        BenchResult *r = &results[count];
+        unsigned long long ops;
+        const char *p = strstr(line, "{\"cipher\": \"");
+        if (p == NULL ||
+            sscanf(p, "{\"cipher\": \"%31[^\"]\", \"key_bits\": %d, \"size\": %zu, "
+                      "\"threads\": %d, \"ops\": %llu, \"mb_per_s\": %lf",
+                   r->cipher, &r->key_bits, &r->size, &r->threads, &ops, &r->mb_per_s) != 6) {
+            continue;
+        }
+        r->ops = ops;
+        const char *lat = strstr(line, "\"p99\": ");
+        r->p99 = (lat != NULL) ? strtod(lat + 7, NULL) : 0.0;
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+/**
+ * 두 실행 결과를 비교한다. 처리량이 허용치보다 떨어지거나 p99 지연이
+ * 허용치보다 늘어난 측정점을 회귀로 표시한다.
+ *
+ * @return 회귀가 없으면 0, 있으면 1 (CI에서 실패 처리용)
+ */
+static int cmd_compare(const char *base_path, const char *new_path, double threshold_pct,
+                       double latency_pct) {
+    BenchResult *base = calloc(MAX_RESULTS, sizeof(BenchResult));
+    BenchResult *cur = calloc(MAX_RESULTS, sizeof(BenchResult));
+    int regressions = 0, improvements = 0, matched = 0;
+
+    if (base == NULL || cur == NULL) {
+        free(base);
+        free(cur);
+        return 1;
+    }
+    int nb = load_results(base_path, base, MAX_RESULTS);
+    int nc = load_results(new_path, cur, MAX_RESULTS);
+    if (nb <= 0 || nc <= 0) {
+        fprintf(stderr, "결과를 읽을 수 없습니다 (cipher_bench run이 쓴 JSON 파일인지 확인)\n");
+        free(base);
+        free(cur);
+        return 1;
+    }
+
+    printf("=== 회귀 비교 (처리량 -%.1f%%, p99 지연 +%.1f%% 초과 시 회귀) ===\n",
+           threshold_pct, latency_pct);
+    printf("기준: %s (%d건)\n새 결과: %s (%d건)\n\n", base_path, nb, new_path, nc);
+    printf("%-18s %6s %4s %10s %10s %8s %10s %10s %8s  %s\n", "암호", "크기", "스레드",
+           "기준 MB/s", "새 MB/s", "변화", "기준 p99", "새 p99", "변화", "판정");
+
+    for (int i = 0; i < nc; i++) {
+        const BenchResult *n = &cur[i];
+        const BenchResult *b = NULL;
+        for (int j = 0; j < nb && b == NULL; j++) {
+            if (strcmp(base[j].cipher, n->cipher) == 0 && base[j].size == n->size &&
+                base[j].threads == n->threads) {
+                b = &base[j];
+            }
+        }
+        if (b == NULL || b->mb_per_s <= 0 || b->p99 <= 0) {
+            continue;
+        }
+        matched++;
+        double d_rate = (n->mb_per_s / b->mb_per_s - 1.0) * 100.0;
+        double d_p99 = (n->p99 / b->p99 - 1.0) * 100.0;
+        const char *verdict = "";
+        if (d_rate < -threshold_pct || d_p99 > latency_pct) {
+            verdict = "✗ 회귀";
+            regressions++;
+        } else if (d_rate > threshold_pct) {
+            verdict = "↑ 개선";
+            improvements++;
+        }
+        char label[24];
+        format_size(n->size, label, sizeof(label));
+        printf("%-18s %6s %4d %10.1f %10.1f %+7.1f%% %10.0f %10.0f %+7.1f%%  %s\n", n->cipher,
+               label, n->threads, b->mb_per_s, n->mb_per_s, d_rate, b->p99, n->p99, d_p99,
+               verdict);
+    }
+    printf("\n비교 %d건: 회귀 %d건, 개선 %d건\n", matched, regressions, improvements);
+    free(base);
+    free(cur);
+    return (matched > 0 && regressions == 0) ? 0 : 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "사용법:\n");
+    fprintf(stderr, "  %s run [-o 결과.json] [-t 스레드] [-d 초] [-m 최대크기KB] "
+                    "[-c 이름 필터] [--quick]\n", prog);
+    fprintf(stderr, "  %s compare <기준.json> <새 결과.json> [-r 처리량 허용 %%] "
+                    "[-l 지연 허용 %%]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    const char *out_path = "cipher_bench.json";
+    const char *filter = NULL;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    // 기본값은 코어 수이되 상한을 넘지 않게 한다 (상한 초과 오류는 명시한 -t에만)
+    int threads = (cores <= 0) ? 1 : (cores > BENCH_MAX_THREADS) ? BENCH_MAX_THREADS : (int)cores;
+    double seconds = BENCH_DEFAULT_SECONDS;
+    double threshold = DEFAULT_REGRESSION_PCT;
+    double latency_threshold = DEFAULT_LATENCY_PCT;
+    size_t max_size = BENCH_MAX_SIZE;
+    int quick = 0;
+
+    cpu_features_apply_override(argv);
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // 옵션 파싱 (위치 인자 뒤)
+    int positional = 1;
+    while (positional < argc && argv[positional][0] != '-') {
+        positional++;
+    }
+    for (int i = positional; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            quick = 1;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-o") == 0) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0) {
+            max_size = (size_t)strtoull(argv[++i], NULL, 10) * 1024;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-l") == 0) {
+            latency_threshold = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (quick) {
+        seconds = BENCH_QUICK_SECONDS;
+        if (max_size > BENCH_QUICK_MAX_SIZE) {
+            max_size = BENCH_QUICK_MAX_SIZE;
+        }
+    }
+    if (threads < 1 || threads > BENCH_MAX_THREADS || seconds <= 0 ||
+        max_size < BENCH_MIN_SIZE || max_size > BENCH_MAX_SIZE) {
+        fprintf(stderr, "스레드 1~%d, 시간 > 0, 최대 크기 %d바이트~%uMB\n",
+                BENCH_MAX_THREADS, BENCH_MIN_SIZE, BENCH_MAX_SIZE / (1024 * 1024));
+        return 1;
+    }
+
+    const char *cmd = argv[1];
+    if (strcmp(cmd, "run") == 0 && positional == 2) {
+        return cmd_run(out_path, threads, seconds, max_size, filter);
+    } else if (strcmp(cmd, "compare") == 0 && positional == 4) {
+        return cmd_compare(argv[2], argv[3], threshold, latency_threshold);
+    }
+    usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,233 @@
+/**
+ * cipher_key.h - 키 스케줄을 한 번만 확장하는 암호 핸들 (메시지마다 IV/nonce만 재설정)
+ *
+ * aes_cbc_encrypt(), aes_gcm_encrypt()/aes_gcm_decrypt()는 메시지마다
+ * EVP_CIPHER_CTX를 새로 만들고 AES 키를 다시 확장하며, EVP_aes_256_gcm() 같은
+ * 레거시 핸들로 알고리즘을 암묵적으로 다시 찾는다. 수십 바이트 메시지에서는 이
+ * 설정 비용이 암호화 자체보다 크다.
+ *
+ * CipherKey는
+ *   - 알고리즘을 이름별로 한 번만 fetch하여 캐시하고 (cipher_key_fetch()),
+ *   - 암호화용/복호화용 컨텍스트에 키를 한 번씩만 설정한 뒤,
+ *   - 메시지마다 EVP_CipherInit_ex(ctx, NULL, NULL, NULL, iv, -1)로 IV만 바꾼다.
+ *
+ * 핸들은 내부 상태를 바꾸므로 스레드 간에 공유할 수 없다. 스레드마다 하나씩
+ * 두되, cipher_key_clone()으로 복제하면 키를 다시 확장하지 않고 확장된 키
+ * 스케줄을 그대로 복사한다. 핸들 사이에 공유되는 것은 읽기 전용 알고리즘
+ * 캐시뿐이다 (뮤텍스로 보호).
+ *
+ * 사용 예:
+ *   CipherKey k;
+ *   cipher_key_init(&k, "AES-256-GCM", key);
+ *   for (...) cipher_key_seal(&k, nonce, aad, aad_len, pt, len, ct, tag);
+ *   cipher_key_free(&k);
+ */
+
+#ifndef CIPHER_KEY_H
+#define CIPHER_KEY_H
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <openssl/evp.h>
+
+#define CIPHER_KEY_CACHE_MAX 16          // 캐시할 수 있는 알고리즘 이름 수
+#define CIPHER_KEY_NAME_MAX 32
+#define CIPHER_KEY_TAG_SIZE 16           // AEAD 태그 (GCM, ChaCha20-Poly1305)
+#define CIPHER_KEY_AEAD_IV_SIZE 12       // AEAD nonce (96비트)
+
+typedef struct {
+    char name[CIPHER_KEY_NAME_MAX];
+    EVP_CIPHER *cipher;
+} CipherCacheEntry;
+
+/**
+ * 키가 설정된 암호 핸들
+ */
+typedef struct {
+    EVP_CIPHER_CTX *enc;                 // 암호화 방향 (키 확장 완료)
+    EVP_CIPHER_CTX *dec;                 // 복호화 방향 (CBC는 복호화 키 스케줄이 따로 필요)
+    int aead;                            // GCM/ChaCha20-Poly1305이면 1
+    int block_size;                      // CBC/ECB 패딩 단위 (스트림/AEAD는 1)
+    int iv_len;
+} CipherKey;
+
+static pthread_mutex_t cipher_key_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static CipherCacheEntry cipher_key_cache[CIPHER_KEY_CACHE_MAX];
+static int cipher_key_cache_count = 0;
+
+/**
+ * 알고리즘 이름(예: "AES-256-GCM", "AES-256-CBC", "ChaCha20-Poly1305")의
+ * EVP_CIPHER를 한 번만 fetch하여 반환한다. 반환값은 프로세스 수명 동안 유효하다.
+ *
+ * @return 성공 시 EVP_CIPHER, 알 수 없는 이름이거나 캐시가 가득 차면 NULL
+ */
+static inline const EVP_CIPHER *cipher_key_fetch(const char *name) {
+    const EVP_CIPHER *found = NULL;
+
+    if (strlen(name) >= CIPHER_KEY_NAME_MAX) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cipher_key_cache_lock);
+    for (int i = 0; i < cipher_key_cache_count; i++) {
+        if (strcmp(cipher_key_cache[i].name, name) == 0) {
+            found = cipher_key_cache[i].cipher;
+            break;
+        }
+    }
+    if (found == NULL && cipher_key_cache_count < CIPHER_KEY_CACHE_MAX) {
+        EVP_CIPHER *cipher = EVP_CIPHER_fetch(NULL, name, NULL);
+        if (cipher != NULL) {
+            CipherCacheEntry *entry = &cipher_key_cache[cipher_key_cache_count++];
+            snprintf(entry->name, sizeof(entry->name), "%s", name);
+            entry->cipher = cipher;
+            found = cipher;
+        }
+    }
+    pthread_mutex_unlock(&cipher_key_cache_lock);
+    return found;
+}
+
+/**
+ * 핸들을 해제한다 (키 스케줄은 EVP_CIPHER_CTX_free가 지운다).
+ */
+static inline void cipher_key_free(CipherKey *k) {
+    EVP_CIPHER_CTX_free(k->enc);
+    EVP_CIPHER_CTX_free(k->dec);
+    k->enc = NULL;
+    k->dec = NULL;
+}
+
+/**
+ * 알고리즘 이름과 키로 핸들을 만든다 (키 확장은 여기서만 수행).
+ *
+ * @param key 알고리즘의 키 길이만큼의 키
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int cipher_key_init(CipherKey *k, const char *name, const unsigned char *key) {
+    const EVP_CIPHER *cipher = cipher_key_fetch(name);
+
+    memset(k, 0, sizeof(*k));
+    if (cipher == NULL) {
+        return -1;
+    }
+    k->enc = EVP_CIPHER_CTX_new();
+    k->dec = EVP_CIPHER_CTX_new();
+    if (k->enc == NULL || k->dec == NULL ||
+        EVP_EncryptInit_ex(k->enc, cipher, NULL, key, NULL) != 1 ||
+        EVP_DecryptInit_ex(k->dec, cipher, NULL, key, NULL) != 1) {
+        cipher_key_free(k);
+        return -1;
+    }
+    k->aead = (EVP_CIPHER_get_flags(cipher) & EVP_CIPH_FLAG_AEAD_CIPHER) != 0;
+    k->block_size = EVP_CIPHER_get_block_size(cipher);
+    k->iv_len = EVP_CIPHER_get_iv_length(cipher);
+    return 0;
+}
+
+/**
+ * 다른 스레드에서 쓸 복제본을 만든다 (키를 다시 확장하지 않음).
+ *
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int cipher_key_clone(CipherKey *dst, const CipherKey *src) {
+    *dst = *src;
+    dst->enc = EVP_CIPHER_CTX_new();
+    dst->dec = EVP_CIPHER_CTX_new();
+    if (dst->enc == NULL || dst->dec == NULL ||
+        EVP_CIPHER_CTX_copy(dst->enc, src->enc) != 1 ||
+        EVP_CIPHER_CTX_copy(dst->dec, src->dec) != 1) {
+        cipher_key_free(dst);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * AEAD 봉인: 암호문(평문과 같은 길이)과 16바이트 태그를 만든다.
+ *
+ * @param nonce 96비트 nonce (같은 키로 절대 재사용 금지)
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int cipher_key_seal(CipherKey *k, const unsigned char *nonce,
+                                  const unsigned char *aad, size_t aad_len,
+                                  const unsigned char *plaintext, size_t len,
+                                  unsigned char *ciphertext, unsigned char *tag) {
+    int outl;
+
+    if (!k->aead ||
+        EVP_EncryptInit_ex(k->enc, NULL, NULL, NULL, nonce) != 1 ||
+        (aad_len > 0 && EVP_EncryptUpdate(k->enc, NULL, &outl, aad, (int)aad_len) != 1) ||
+        (len > 0 && EVP_EncryptUpdate(k->enc, ciphertext, &outl, plaintext, (int)len) != 1) ||
+        EVP_EncryptFinal_ex(k->enc, ciphertext + len, &outl) != 1 ||
+        EVP_CIPHER_CTX_ctrl(k->enc, EVP_CTRL_AEAD_GET_TAG, CIPHER_KEY_TAG_SIZE, tag) != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * AEAD 열기: 태그를 검증하고 평문을 복원한다.
+ *
+ * @return 성공 시 0, 실패 시 -1, 인증 실패 시 -2 (aes_gcm_decrypt()와 같은 규약)
+ */
+static inline int cipher_key_open(CipherKey *k, const unsigned char *nonce,
+                                  const unsigned char *aad, size_t aad_len,
+                                  const unsigned char *ciphertext, size_t len,
+                                  const unsigned char *tag, unsigned char *plaintext) {
+    int outl;
+
+    if (!k->aead ||
+        EVP_DecryptInit_ex(k->dec, NULL, NULL, NULL, nonce) != 1 ||
+        (aad_len > 0 && EVP_DecryptUpdate(k->dec, NULL, &outl, aad, (int)aad_len) != 1) ||
+        (len > 0 && EVP_DecryptUpdate(k->dec, plaintext, &outl, ciphertext, (int)len) != 1) ||
+        EVP_CIPHER_CTX_ctrl(k->dec, EVP_CTRL_AEAD_SET_TAG, CIPHER_KEY_TAG_SIZE,
+                            (void *)tag) != 1) {
+        return -1;
+    }
+    return (EVP_DecryptFinal_ex(k->dec, plaintext + len, &outl) == 1) ? 0 : -2;
+}
+
+/**
+ * 비 AEAD 암호화 (CBC는 PKCS#7 패딩 포함).
+ *
+ * @param out 출력 (최소 len + block_size 바이트)
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int cipher_key_encrypt(CipherKey *k, const unsigned char *iv,
+                                     const unsigned char *in, size_t len,
+                                     unsigned char *out, size_t *out_len) {
+    int l1 = 0, l2 = 0;
+
+    if (k->aead ||
+        EVP_EncryptInit_ex(k->enc, NULL, NULL, NULL, iv) != 1 ||
+        EVP_EncryptUpdate(k->enc, out, &l1, in, (int)len) != 1 ||
+        EVP_EncryptFinal_ex(k->enc, out + l1, &l2) != 1) {
+        return -1;
+    }
+    *out_len = (size_t)l1 + (size_t)l2;
+    return 0;
+}
+
+/**
+ * 비 AEAD 복호화 (CBC는 패딩 검사 포함).
+ *
+ * @return 성공 시 0, 실패/패딩 오류 시 -1
+ */
+static inline int cipher_key_decrypt(CipherKey *k, const unsigned char *iv,
+                                     const unsigned char *in, size_t len,
+                                     unsigned char *out, size_t *out_len) {
+    int l1 = 0, l2 = 0;
+
+    if (k->aead ||
+        EVP_DecryptInit_ex(k->dec, NULL, NULL, NULL, iv) != 1 ||
+        EVP_DecryptUpdate(k->dec, out, &l1, in, (int)len) != 1 ||
+        EVP_DecryptFinal_ex(k->dec, out + l1, &l2) != 1) {
+        return -1;
+    }
+    *out_len = (size_t)l1 + (size_t)l2;
+    return 0;
+}
+
+#endif /* CIPHER_KEY_H */
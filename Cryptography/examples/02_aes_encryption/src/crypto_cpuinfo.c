@@ -0,0 +1,216 @@
+/**
+ * crypto_cpuinfo.c - CPU 암호 가속 기능 및 구현 선택 보고
+ *
+ * 실행 중인 CPU에서 AES-NI, VAES, PCLMULQDQ, SHA-NI, AVX2/AVX-512 등의
+ * 가속 기능을 탐지하고, OpenSSL이 각 프리미티브(SHA-256, AES-256-GCM,
+ * ChaCha20-Poly1305)에 대해 어떤 구현을 선택하는지 보고한다.
+ * 마지막으로 1MB 버퍼 처리량을 측정하여 실제 효과를 확인한다.
+ *
+ * CRYPTO_FORCE_GENERIC=1로 실행하면 가속 경로를 모두 끈 상태로 보고/측정하므로,
+ * 서버 SKU마다 두 번 실행하여 가속 효과를 비교할 수 있다.
+ *
+ * 빌드: make
+ * 실행: ./bin/crypto_cpuinfo
+ *       CRYPTO_FORCE_GENERIC=1 ./bin/crypto_cpuinfo
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include "cpu_features.h"
+
+#define BENCH_BUFFER_SIZE (1024 * 1024)
+#define BENCH_SECONDS 0.3
+
+/**
+ * 단조 증가 시계를 초 단위로 반환한다.
+ */
+double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void print_feature(const char *name, int detected, int enabled) {
+    const char *state = !detected ? "-" : (enabled ? "✓ 사용" : "✓ 탐지 (강제로 끔)");
+    printf("  %-12s %s\n", name, state);
+}
+
+/**
+ * OpenSSL 3.x 어셈블리 디스패치 규칙에 따라 SHA-256 구현을 추정한다.
+ */
+const char *resolve_sha256(const CpuFeatures *f) {
+#if defined(CPU_FEATURES_X86)
+    if (f->sha_ni) return "SHA-NI (sha256_block_data_order_shaext)";
+    if (f->avx2 && f->bmi1 && f->bmi2) return "AVX2 + BMI (sha256_block_data_order_avx2)";
+    if (f->avx) return "AVX (sha256_block_data_order_avx)";
+    if (f->ssse3) return "SSSE3 (sha256_block_data_order_ssse3)";
+    return "x86_64 일반 (sha256_block_data_order)";
+#elif defined(CPU_FEATURES_ARM64)
+    if (f->arm_sha2) return "ARMv8 SHA2 명령 (sha256_block_armv8)";
+    return "NEON / 일반 (sha256_block_neon)";
+#else
+    (void)f;
+    return "C 일반 구현";
+#endif
+}
+
+/**
+ * OpenSSL 3.x 어셈블리 디스패치 규칙에 따라 AES-256-GCM 구현을 추정한다.
+ */
+const char *resolve_aes_gcm(const CpuFeatures *f) {
+#if defined(CPU_FEATURES_X86)
+    if (f->aesni && f->pclmulqdq && f->vaes && f->vpclmulqdq &&
+        f->avx512f && f->avx512bw && f->avx512vl && OpenSSL_version_num() >= 0x30100000L) {
+        return "VAES + VPCLMULQDQ AVX-512 (ossl_aes_gcm_*_avx512)";
+    }
+    if (f->aesni && f->pclmulqdq && f->avx && f->movbe) {
+        return "AES-NI + PCLMULQDQ, AVX 스티치 (aesni_gcm_encrypt)";
+    }
+    if (f->aesni && f->pclmulqdq) return "AES-NI + PCLMULQDQ (aesni_ctr32 + gcm_ghash_clmul)";
+    if (f->aesni) return "AES-NI + 4비트 테이블 GHASH";
+    if (f->ssse3) return "vpaes (SSSE3 상수 시간) + 4비트 테이블 GHASH";
+    return "테이블 AES + 4비트 테이블 GHASH (일반)";
+#elif defined(CPU_FEATURES_ARM64)
+    if (f->arm_aes && f->arm_pmull) return "ARMv8 AES + PMULL (aes_v8 + gcm_ghash_v8)";
+    if (f->arm_aes) return "ARMv8 AES + NEON GHASH";
+    return "vpaes (NEON) + 4비트 테이블 GHASH";
+#else
+    (void)f;
+    return "C 일반 구현";
+#endif
+}
+
+/**
+ * OpenSSL 3.x 어셈블리 디스패치 규칙에 따라 ChaCha20-Poly1305 구현을 추정한다.
+ */
+const char *resolve_chacha20_poly1305(const CpuFeatures *f) {
+#if defined(CPU_FEATURES_X86)
+    if (f->avx512f && f->avx512vl) return "AVX-512VL ChaCha20 + AVX-512 Poly1305";
+    if (f->avx512f) return "AVX-512F ChaCha20 + AVX-512 Poly1305";
+    if (f->avx2) return "AVX2 ChaCha20 + AVX2 Poly1305";
+    if (f->ssse3) return "SSSE3 ChaCha20 + base2_64 Poly1305";
+    return "x86_64 일반 ChaCha20 + base2_64 Poly1305";
+#elif defined(CPU_FEATURES_ARM64)
+    return "NEON ChaCha20 + NEON Poly1305";
+#else
+    (void)f;
+    return "C 일반 구현";
+#endif
+}
+
+/**
+ * EVP 다이제스트의 1MB 버퍼 처리량(MB/s)을 측정한다.
+ */
+double bench_digest(const EVP_MD *md, const unsigned char *buffer) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    size_t rounds = 0;
+    double start = now_seconds(), elapsed;
+    do {
+        EVP_Digest(buffer, BENCH_BUFFER_SIZE, digest, NULL, md, NULL);
+        rounds++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < BENCH_SECONDS);
+    return (double)rounds / elapsed;
+}
+
+/**
+ * EVP AEAD 암호화의 1MB 버퍼 처리량(MB/s)을 측정한다.
+ */
+double bench_aead(const EVP_CIPHER *cipher, const unsigned char *buffer,
+                  unsigned char *output) {
+    static const unsigned char key[32] = { 0 };
+    static const unsigned char iv[12] = { 0 };
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    if (ctx == NULL) {
+        return 0.0;
+    }
+
+    int len;
+    size_t rounds = 0;
+    double start = now_seconds(), elapsed;
+    do {
+        EVP_EncryptInit_ex(ctx, cipher, NULL, key, iv);
+        EVP_EncryptUpdate(ctx, output, &len, buffer, BENCH_BUFFER_SIZE);
+        EVP_EncryptFinal_ex(ctx, output + len, &len);
+        rounds++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < BENCH_SECONDS);
+
+    EVP_CIPHER_CTX_free(ctx);
+    return (double)rounds / elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    cpu_features_apply_override(argv);
+
+    CpuFeatures detected;
+    cpu_features_detect(&detected);
+    const CpuFeatures *f = cpu_features_get();
+
+    printf("=== CPU 암호 가속 기능 ===\n\n");
+    printf("OpenSSL: %s\n", OpenSSL_version(OPENSSL_VERSION));
+    if (f->forced_generic) {
+        printf("모드:    일반 경로 강제 (%s)\n", CPU_FORCE_GENERIC_ENV);
+        const char *cap = getenv("OPENSSL_ia32cap");
+        if (cap == NULL) cap = getenv("OPENSSL_armcap");
+        printf("         OpenSSL 기능 마스크: %s\n", cap ? cap : "(설정 실패)");
+    } else {
+        printf("모드:    하드웨어 기본 (%s=1로 일반 경로 강제 가능)\n", CPU_FORCE_GENERIC_ENV);
+    }
+    printf("\n");
+
+#if defined(CPU_FEATURES_X86)
+    printf("[x86]\n");
+    print_feature("SSSE3", detected.ssse3, f->ssse3);
+    print_feature("AES-NI", detected.aesni, f->aesni);
+    print_feature("PCLMULQDQ", detected.pclmulqdq, f->pclmulqdq);
+    print_feature("MOVBE", detected.movbe, f->movbe);
+    print_feature("POPCNT", detected.popcnt, f->popcnt);
+    print_feature("AVX", detected.avx, f->avx);
+    print_feature("AVX2", detected.avx2, f->avx2);
+    print_feature("BMI1/BMI2", detected.bmi1 && detected.bmi2, f->bmi1 && f->bmi2);
+    print_feature("SHA-NI", detected.sha_ni, f->sha_ni);
+    print_feature("AVX-512F", detected.avx512f, f->avx512f);
+    print_feature("AVX-512BW", detected.avx512bw, f->avx512bw);
+    print_feature("AVX-512VL", detected.avx512vl, f->avx512vl);
+    print_feature("VAES", detected.vaes, f->vaes);
+    print_feature("VPCLMULQDQ", detected.vpclmulqdq, f->vpclmulqdq);
+#elif defined(CPU_FEATURES_ARM64)
+    printf("[ARMv8]\n");
+    print_feature("NEON", detected.neon, f->neon);
+    print_feature("AES", detected.arm_aes, f->arm_aes);
+    print_feature("PMULL", detected.arm_pmull, f->arm_pmull);
+    print_feature("SHA2", detected.arm_sha2, f->arm_sha2);
+#else
+    printf("이 아키텍처에서는 기능 탐지를 지원하지 않습니다.\n");
+#endif
+
+    printf("\n=== 프리미티브별 구현 (OpenSSL 디스패치 규칙 기준) ===\n\n");
+    printf("  %-20s %s\n", "SHA-256", resolve_sha256(f));
+    printf("  %-20s %s\n", "AES-256-GCM", resolve_aes_gcm(f));
+    printf("  %-20s %s\n", "ChaCha20-Poly1305", resolve_chacha20_poly1305(f));
+
+    unsigned char *buffer = calloc(1, BENCH_BUFFER_SIZE);
+    unsigned char *output = malloc(BENCH_BUFFER_SIZE + 32);
+    if (buffer == NULL || output == NULL) {
+        free(buffer);
+        free(output);
+        return 1;
+    }
+
+    printf("\n=== 처리량 측정 (1MB 버퍼, 단일 스레드) ===\n\n");
+    printf("  %-20s %10.1f MB/s\n", "SHA-256", bench_digest(EVP_sha256(), buffer));
+    printf("  %-20s %10.1f MB/s\n", "AES-256-GCM",
+           bench_aead(EVP_aes_256_gcm(), buffer, output));
+    printf("  %-20s %10.1f MB/s\n", "ChaCha20-Poly1305",
+           bench_aead(EVP_chacha20_poly1305(), buffer, output));
+
+    free(buffer);
+    free(output);
+    return 0;
+}
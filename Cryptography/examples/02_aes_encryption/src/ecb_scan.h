@@ -0,0 +1,365 @@
+/**
+ * ecb_scan.h - 스트리밍 반복 블록(ECB 패턴) 탐지기
+ *
+ * ecb_vs_cbc.c는 하드코딩한 블록 4개를 memcmp로 비교하여 ECB 누출을 보여 준다.
+ * 실제 공급사 바이너리에서는 같은 평문 블록(0 패딩, 테이블, 반복 구조체)이
+ * ECB로 암호화되면 같은 암호문 블록으로 나타나므로, 파일 전체에서 16바이트
+ * 정렬 블록의 반복을 찾으면 된다. CBC/CTR/GCM 암호문이나 압축 데이터에서는
+ * 16바이트 블록이 우연히 반복될 확률이 사실상 0이다.
+ *
+ * 이 헤더는 수 GB 이미지를 한 번 훑으며(조각 단위 입력, 메모리 상한 고정)
+ *   - 블록마다 64비트 지문을 만들어 캐시 라인 크기 버킷(4슬롯)의 해시 테이블에서
+ *     찾고, 없으면 버킷에서 가장 오래 보지 못한 슬롯을 밀어내고 넣는다 (LRU).
+ *   - 한 번에 ECB_SCAN_BATCH개 블록의 지문을 먼저 계산하여 버킷을 미리 불러오고
+ *     (prefetch) 입력도 ECB_SCAN_READ_AHEAD만큼 앞서 불러와, 블록마다 생기는
+ *     테이블 임의 접근의 지연을 서로 겹치게 한다.
+ *   - 모든 바이트가 같은 블록(0x00/0xFF 채움)은 반복이 아니라 "채움"으로 따로 센다.
+ *     평문 패딩과 구분하기 위함이며, 채움 블록은 암호문에서는 나타나지 않는다.
+ *   - 창(기본 64KB) 단위로 반복 밀도(반복 블록 / 블록)를 계산하여 임계값을 넘는
+ *     연속 창을 구간으로 묶어 콜백으로 알린다.
+ *
+ * 테이블이 기억하는 블록 수는 슬롯 수(기본 16MB / 16B = 1M개, 16MB 거리)로 제한된다.
+ * 그보다 가까운 거리의 반복은 거의 모두 잡고, 먼 거리의 반복은 그 사이에
+ * 밀려나지 않은 경우에만 잡는다 (ECB 누출은 보통 패딩/테이블 구간에 몰려 있다).
+ * 지문이 64비트이므로 서로 다른 블록을 반복으로 잘못 볼 확률은 조회당 약 2^-62이다.
+ *
+ * 사용 예:
+ *   EcbScanner sc;
+ *   ecb_scan_init(&sc, 16 << 20, 4096, 0.01, on_region, arg);
+ *   while ((n = read(fd, buf, sizeof(buf))) > 0) ecb_scan_update(&sc, buf, n);
+ *   ecb_scan_final(&sc);
+ *   ecb_scan_free(&sc);
+ */
+
+#ifndef ECB_SCAN_H
+#define ECB_SCAN_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define ECB_SCAN_BLOCK 16
+#define ECB_SCAN_WAYS 4                          // 버킷당 슬롯 (지문 4개 + 위치 4개 = 캐시 라인 하나)
+#define ECB_SCAN_BATCH 64                        // 미리 불러올 블록 수
+#define ECB_SCAN_READ_AHEAD 16384                // 입력을 미리 불러올 거리 (바이트)
+#define ECB_SCAN_DEFAULT_TABLE (16u << 20)       // 16MB = 1M 슬롯
+#define ECB_SCAN_MIN_TABLE (64u << 10)
+#define ECB_SCAN_HUGE_PAGE (2u << 20)
+#define ECB_SCAN_DEFAULT_WINDOW 4096             // 창 = 4096블록 = 64KB
+#define ECB_SCAN_DEFAULT_THRESHOLD 0.01          // 반복 밀도 1%
+
+/**
+ * 테이블 버킷: 지문(0은 빈 슬롯)과 마지막으로 본 블록 번호.
+ * 슬롯 0이 가장 최근에 본 블록이며, 가득 차면 슬롯 3(가장 오래 보지 못한 것)을 밀어낸다.
+ */
+typedef struct {
+    uint64_t fp[ECB_SCAN_WAYS];
+    uint64_t last[ECB_SCAN_WAYS];
+} EcbScanBucket;
+
+/**
+ * 반복 밀도가 임계값을 넘은 연속 구간
+ */
+typedef struct {
+    uint64_t start;                      // 바이트 오프셋 (포함)
+    uint64_t end;                        // 바이트 오프셋 (제외)
+    uint64_t blocks;
+    uint64_t repeats;                    // 앞에서 이미 본 블록 수
+    uint64_t fills;                      // 모든 바이트가 같은 블록 수
+    double max_density;                  // 구간 안 창의 최대 반복 밀도
+    int has_sample;
+    uint64_t sample_offset;              // 구간의 첫 반복 블록
+    uint64_t sample_prev_offset;         // 그 블록을 마지막으로 본 위치
+    unsigned char sample[ECB_SCAN_BLOCK];
+} EcbRegion;
+
+typedef void (*EcbRegionFn)(const EcbRegion *region, void *arg);
+
+/**
+ * 스캐너 상태 (스레드 하나 전용)
+ */
+typedef struct {
+    EcbScanBucket *table;
+    uint64_t buckets;
+    int shift;                           // 버킷 번호 = 지문 >> shift
+    uint64_t block;                      // 다음 블록 번호
+    unsigned char partial[ECB_SCAN_BLOCK];
+    size_t partial_len;
+    uint32_t window_blocks;
+    double threshold;
+    EcbRegionFn fn;
+    void *arg;
+    // 현재 창
+    uint64_t win_blocks, win_repeats, win_fills;
+    int win_has_sample;
+    uint64_t win_sample_offset, win_sample_prev;
+    unsigned char win_sample[ECB_SCAN_BLOCK];
+    // 열린 구간
+    EcbRegion region;
+    int region_open;
+    // 전체 통계
+    uint64_t total_blocks, total_repeats, total_fills;
+    uint64_t regions;
+    uint64_t evictions;                  // 기억하던 블록을 밀어낸 횟수
+    uint64_t tail_bytes;                 // 마지막 16바이트 미만 조각
+} EcbScanner;
+
+/**
+ * 16바이트 블록의 64비트 지문 (곱셈 두 번 + 섞기)
+ */
+static inline uint64_t ecb_scan_hash(uint64_t lo, uint64_t hi) {
+    uint64_t h = (lo ^ (hi * 0x9e3779b97f4a7c15ULL)) * 0xc2b2ae3d27d4eb4fULL;
+    h ^= h >> 29;
+    h *= 0x165667b19e3779f9ULL;
+    h ^= h >> 32;
+    return h | 1;                        // 0은 빈 슬롯 표시
+}
+
+static inline int ecb_scan_is_fill(uint64_t lo, uint64_t hi) {
+    return lo == hi && lo == (lo & 0xff) * 0x0101010101010101ULL;
+}
+
+/**
+ * 블록 n개의 지문 (채움 블록은 0)
+ */
+static inline void ecb_scan_hash_batch(const unsigned char *p, size_t n, uint64_t *fps) {
+    for (size_t i = 0; i < n; i++) {
+        uint64_t lo, hi;
+        memcpy(&lo, p + i * ECB_SCAN_BLOCK, 8);
+        memcpy(&hi, p + i * ECB_SCAN_BLOCK + 8, 8);
+        fps[i] = ecb_scan_is_fill(lo, hi) ? 0 : ecb_scan_hash(lo, hi);
+    }
+}
+
+/**
+ * 스캐너를 만든다.
+ *
+ * @param table_bytes   테이블 메모리 상한 (2의 거듭제곱 버킷 수로 내림, 최소 64KB)
+ * @param window_blocks 반복 밀도를 계산하는 창 크기 (블록 수)
+ * @param threshold     구간으로 보고할 창 반복 밀도 (0~1)
+ * @param fn            구간 콜백 (NULL 가능)
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int ecb_scan_init(EcbScanner *sc, size_t table_bytes, uint32_t window_blocks,
+                                double threshold, EcbRegionFn fn, void *arg) {
+    size_t bucket_bytes = sizeof(EcbScanBucket);
+    uint64_t buckets = 1;
+    int bits = 0;
+
+    memset(sc, 0, sizeof(*sc));
+    if (table_bytes < ECB_SCAN_MIN_TABLE || window_blocks == 0) {
+        return -1;
+    }
+    while (buckets * 2 * bucket_bytes <= table_bytes) {
+        buckets *= 2;
+        bits++;
+    }
+    size_t bytes = buckets * bucket_bytes;
+    size_t align = (bytes >= ECB_SCAN_HUGE_PAGE) ? ECB_SCAN_HUGE_PAGE : 64;
+    sc->table = aligned_alloc(align, bytes);
+    if (sc->table == NULL) {
+        return -1;
+    }
+#ifdef MADV_HUGEPAGE
+    if (align == ECB_SCAN_HUGE_PAGE) {
+        madvise(sc->table, bytes, MADV_HUGEPAGE);   // 임의 접근의 TLB 미스 줄이기
+    }
+#endif
+    memset(sc->table, 0, bytes);
+    sc->buckets = buckets;
+    sc->shift = 64 - bits;
+    sc->window_blocks = window_blocks;
+    sc->threshold = threshold;
+    sc->fn = fn;
+    sc->arg = arg;
+    return 0;
+}
+
+static inline void ecb_scan_free(EcbScanner *sc) {
+    free(sc->table);
+    sc->table = NULL;
+}
+
+/**
+ * 열린 구간을 닫아 콜백으로 넘긴다.
+ */
+static inline void ecb_scan_close_region(EcbScanner *sc) {
+    if (!sc->region_open) {
+        return;
+    }
+    sc->regions++;
+    if (sc->fn != NULL) {
+        sc->fn(&sc->region, sc->arg);
+    }
+    sc->region_open = 0;
+}
+
+/**
+ * 창 하나를 마감하고, 밀도가 임계값 이상이면 구간에 붙인다.
+ */
+static inline void ecb_scan_close_window(EcbScanner *sc) {
+    if (sc->win_blocks == 0) {
+        return;
+    }
+    uint64_t start = (sc->block - sc->win_blocks) * ECB_SCAN_BLOCK;
+    double density = (double)sc->win_repeats / (double)sc->win_blocks;
+
+    if (sc->win_repeats > 0 && density >= sc->threshold) {
+        EcbRegion *r = &sc->region;
+        if (!sc->region_open) {
+            memset(r, 0, sizeof(*r));
+            r->start = start;
+            sc->region_open = 1;
+        }
+        r->end = sc->block * ECB_SCAN_BLOCK;
+        r->blocks += sc->win_blocks;
+        r->repeats += sc->win_repeats;
+        r->fills += sc->win_fills;
+        if (density > r->max_density) {
+            r->max_density = density;
+        }
+        if (!r->has_sample && sc->win_has_sample) {
+            r->has_sample = 1;
+            r->sample_offset = sc->win_sample_offset;
+            r->sample_prev_offset = sc->win_sample_prev;
+            memcpy(r->sample, sc->win_sample, ECB_SCAN_BLOCK);
+        }
+    } else {
+        ecb_scan_close_region(sc);
+    }
+    sc->win_blocks = 0;
+    sc->win_repeats = 0;
+    sc->win_fills = 0;
+    sc->win_has_sample = 0;
+}
+
+/**
+ * 지문 하나를 버킷에서 찾아 맨 앞으로 옮기고, 없으면 맨 앞에 넣는다
+ * (맨 뒤 슬롯은 밀려난다).
+ *
+ * @return 반복이면 이전 블록 번호 + 1, 처음 본 블록이면 0
+ */
+static inline uint64_t ecb_scan_probe(EcbScanBucket *b, uint64_t fp, uint64_t block,
+                                      uint64_t *evictions) {
+    // ECB_SCAN_WAYS = 4 전제로 펼쳐 쓴다 (-O2의 루프는 분기 예측 실패가 잦다)
+    int hit = (b->fp[0] == fp) | (b->fp[1] == fp) | (b->fp[2] == fp) | (b->fp[3] == fp);
+    if (__builtin_expect(hit, 0)) {
+        int w = (b->fp[0] == fp) ? 0 : (b->fp[1] == fp) ? 1 : (b->fp[2] == fp) ? 2 : 3;
+        uint64_t prev = b->last[w];
+        for (; w > 0; w--) {                         // 맨 앞으로 옮겨 자주 반복되는 블록을 유지
+            b->fp[w] = b->fp[w - 1];
+            b->last[w] = b->last[w - 1];
+        }
+        b->fp[0] = fp;
+        b->last[0] = block;
+        return prev + 1;
+    }
+    *evictions += (b->fp[3] != 0);
+    b->fp[3] = b->fp[2];
+    b->fp[2] = b->fp[1];
+    b->fp[1] = b->fp[0];
+    b->fp[0] = fp;
+    b->last[3] = b->last[2];
+    b->last[2] = b->last[1];
+    b->last[1] = b->last[0];
+    b->last[0] = block;
+    return 0;
+}
+
+/**
+ * 정렬된 블록 count개를 처리한다.
+ * 창 경계를 넘지 않는 ECB_SCAN_BATCH개씩 지문 계산 → 버킷 prefetch → 조회 순으로 진행한다.
+ */
+static inline void ecb_scan_blocks(EcbScanner *sc, const unsigned char *p, size_t count) {
+    uint64_t fps[ECB_SCAN_BATCH];
+
+    while (count > 0) {
+        size_t n = (count < ECB_SCAN_BATCH) ? count : ECB_SCAN_BATCH;
+        if (n > sc->window_blocks - sc->win_blocks) {
+            n = sc->window_blocks - sc->win_blocks;
+        }
+        ecb_scan_hash_batch(p, n, fps);
+        for (size_t i = 0; i < n; i++) {
+            __builtin_prefetch(&sc->table[fps[i] >> sc->shift], 1);
+        }
+        for (size_t off = 0; off < n * ECB_SCAN_BLOCK; off += 64) {
+            __builtin_prefetch(p + ECB_SCAN_READ_AHEAD + off, 0);
+        }
+
+        EcbScanBucket *table = sc->table;
+        int shift = sc->shift;
+        uint64_t fills = 0, repeats = 0, evictions = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (fps[i] == 0) {
+                fills++;
+                continue;
+            }
+            uint64_t prev = ecb_scan_probe(&table[fps[i] >> shift], fps[i], sc->block + i,
+                                           &evictions);
+            if (prev != 0) {
+                repeats++;
+                if (!sc->win_has_sample) {
+                    sc->win_has_sample = 1;
+                    sc->win_sample_offset = (sc->block + i) * ECB_SCAN_BLOCK;
+                    sc->win_sample_prev = (prev - 1) * ECB_SCAN_BLOCK;
+                    memcpy(sc->win_sample, p + i * ECB_SCAN_BLOCK, ECB_SCAN_BLOCK);
+                }
+            }
+        }
+        sc->evictions += evictions;
+        sc->block += n;
+        sc->win_blocks += n;
+        sc->win_repeats += repeats;
+        sc->win_fills += fills;
+        sc->total_blocks += n;
+        sc->total_repeats += repeats;
+        sc->total_fills += fills;
+        if (sc->win_blocks == sc->window_blocks) {
+            ecb_scan_close_window(sc);
+        }
+        p += n * ECB_SCAN_BLOCK;
+        count -= n;
+    }
+}
+
+/**
+ * 입력 조각을 넣는다. 조각 경계는 자유이며 결과는 한 번에 넣은 것과 같다.
+ */
+static inline void ecb_scan_update(EcbScanner *sc, const unsigned char *data, size_t len) {
+    if (sc->partial_len > 0) {
+        size_t take = ECB_SCAN_BLOCK - sc->partial_len;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(sc->partial + sc->partial_len, data, take);
+        sc->partial_len += take;
+        data += take;
+        len -= take;
+        if (sc->partial_len < ECB_SCAN_BLOCK) {
+            return;
+        }
+        ecb_scan_blocks(sc, sc->partial, 1);
+        sc->partial_len = 0;
+    }
+    size_t blocks = len / ECB_SCAN_BLOCK;
+    ecb_scan_blocks(sc, data, blocks);
+    data += blocks * ECB_SCAN_BLOCK;
+    len -= blocks * ECB_SCAN_BLOCK;
+    if (len > 0) {
+        memcpy(sc->partial, data, len);
+        sc->partial_len = len;
+    }
+}
+
+/**
+ * 마지막 창과 구간을 마감한다 (16바이트 미만 꼬리는 tail_bytes로만 센다).
+ */
+static inline void ecb_scan_final(EcbScanner *sc) {
+    sc->tail_bytes = sc->partial_len;
+    sc->partial_len = 0;
+    ecb_scan_close_window(sc);
+    ecb_scan_close_region(sc);
+}
+
+#endif /* ECB_SCAN_H */
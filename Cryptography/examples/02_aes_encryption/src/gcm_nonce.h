@@ -0,0 +1,172 @@
+/**
+ * gcm_nonce.h - 스레드별 고정 필드 + 카운터로 만드는 결정적 GCM nonce
+ *
+ * 메시지마다 RAND_bytes()로 96비트 IV를 뽑으면 스레드가 많을 때 메시지마다
+ * DRBG를 호출해야 하고, 충돌하지 않는다는 구조적 보장도 없다 (생일 경계상
+ * 같은 키로 2^32개를 넘기면 안 된다). 여기서는 NIST SP 800-38D 8.2.1의 결정적
+ * 구성을 사용한다.
+ *
+ *   nonce = 고정 필드 (32비트) || 호출 필드 (64비트, 빅엔디언)
+ *   고정 필드 = 소스 접두어 (16비트) || 스레드 번호 (16비트)
+ *
+ * - 스레드 번호는 gcm_nonce_thread_init()에서 원자적으로 하나씩 배정되므로
+ *   스레드마다 고정 필드가 다르고, 호출 필드는 스레드 안에서 단조 증가한다.
+ *   따라서 같은 소스(=같은 키)에서 나온 nonce는 결코 겹치지 않는다.
+ * - 키당 호출 한도는 공유 원자 카운터로 지킨다. 스레드는 메시지마다가 아니라
+ *   GCM_NONCE_RESERVE개 단위로 예약하므로 핫 패스에는 잠금도 원자적
+ *   읽기-수정-쓰기도 없다.
+ * - 예약량이 교체 임계값을 넘으면 GCM_NONCE_ROTATE를 돌려주어 키 교체를
+ *   알리고, 한도에 닿으면 -1을 돌려주어 더 이상 nonce를 내주지 않는다.
+ *
+ * 카운터는 메모리에만 있으므로 소스 하나는 키 하나의 수명과 같아야 한다.
+ * 재시작 후 같은 키를 다시 쓰면 안 된다 (세션마다 키를 새로 파생할 것).
+ *
+ * 사용 예:
+ *   GcmNonceSource src;
+ *   gcm_nonce_source_init(&src, prefix, GCM_NONCE_DEFAULT_LIMIT, 0);
+ *   // 스레드마다:
+ *   GcmNonceThread t;
+ *   gcm_nonce_thread_init(&t, &src);
+ *   if (gcm_nonce_next(&t, nonce) < 0) { 키 교체 }
+ */
+
+#ifndef GCM_NONCE_H
+#define GCM_NONCE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#define GCM_NONCE_SIZE 12
+#define GCM_NONCE_RESERVE 4096                    // 스레드가 한 번에 예약하는 호출 수
+#define GCM_NONCE_MAX_THREADS 65536               // 16비트 스레드 번호
+#define GCM_NONCE_DEFAULT_LIMIT (1ULL << 32)      // 키당 기본 호출 한도
+#define GCM_NONCE_ROTATE 1                        // nonce는 유효하지만 키 교체가 필요함
+
+/**
+ * 키 하나에 대응하는 nonce 소스 (스레드 간 공유)
+ */
+typedef struct {
+    _Atomic uint64_t reserved;           // 스레드들이 예약한 호출 수 합계
+    _Atomic uint32_t next_thread;        // 다음에 배정할 스레드 번호
+    _Atomic int rotate;                  // 교체 임계값을 넘으면 1
+    uint64_t limit;                      // 키당 호출 한도 (이후 -1)
+    uint64_t rotate_at;                  // 교체 신호 임계값
+    uint16_t prefix;                     // 고정 필드 상위 16비트 (장치/세션 구분)
+} GcmNonceSource;
+
+/**
+ * 스레드 전용 nonce 생성기 (공유 금지)
+ */
+typedef struct {
+    GcmNonceSource *src;
+    unsigned char fixed[4];              // 고정 필드 (접두어 || 스레드 번호)
+    uint64_t counter;                    // 다음 호출 필드
+    uint64_t remaining;                  // 예약 블록에 남은 호출 수
+    int thread_index;                    // 배정 실패 시 -1
+} GcmNonceThread;
+
+/**
+ * 소스를 초기화한다.
+ *
+ * @param prefix    같은 키를 여러 프로세스/장치가 공유할 때 서로 다른 값
+ * @param limit     키당 호출 한도 (0이면 GCM_NONCE_DEFAULT_LIMIT)
+ * @param rotate_at 교체 신호 임계값 (0이면 한도의 7/8)
+ */
+static inline void gcm_nonce_source_init(GcmNonceSource *src, uint16_t prefix,
+                                         uint64_t limit, uint64_t rotate_at) {
+    src->limit = (limit != 0) ? limit : GCM_NONCE_DEFAULT_LIMIT;
+    src->rotate_at = (rotate_at != 0 && rotate_at < src->limit) ? rotate_at
+                                                                : src->limit - src->limit / 8;
+    src->prefix = prefix;
+    atomic_init(&src->reserved, 0);
+    atomic_init(&src->next_thread, 0);
+    atomic_init(&src->rotate, 0);
+}
+
+/**
+ * 키 교체 신호를 확인한다 (어느 스레드에서든 호출 가능).
+ *
+ * @return 교체 임계값을 넘었으면 1
+ */
+static inline int gcm_nonce_needs_rotation(GcmNonceSource *src) {
+    return atomic_load_explicit(&src->rotate, memory_order_relaxed);
+}
+
+/**
+ * 스레드 생성기를 만들고 고정 필드를 배정한다.
+ *
+ * @return 성공 시 0, 스레드 번호가 바닥나면 -1
+ */
+static inline int gcm_nonce_thread_init(GcmNonceThread *t, GcmNonceSource *src) {
+    uint32_t index = atomic_fetch_add_explicit(&src->next_thread, 1, memory_order_relaxed);
+
+    memset(t, 0, sizeof(*t));
+    t->src = src;
+    t->thread_index = -1;
+    if (index >= GCM_NONCE_MAX_THREADS) {
+        return -1;
+    }
+    t->thread_index = (int)index;
+    t->fixed[0] = (unsigned char)(src->prefix >> 8);
+    t->fixed[1] = (unsigned char)src->prefix;
+    t->fixed[2] = (unsigned char)(index >> 8);
+    t->fixed[3] = (unsigned char)index;
+    return 0;
+}
+
+/**
+ * 공유 한도에서 다음 호출 블록을 예약한다 (GCM_NONCE_RESERVE개마다 한 번).
+ *
+ * @return 예약 성공 시 0 또는 GCM_NONCE_ROTATE, 한도 초과 시 -1
+ */
+static inline int gcm_nonce_reserve(GcmNonceThread *t) {
+    GcmNonceSource *src = t->src;
+    uint64_t start = atomic_fetch_add_explicit(&src->reserved, GCM_NONCE_RESERVE,
+                                               memory_order_relaxed);
+
+    if (start >= src->limit) {
+        atomic_store_explicit(&src->rotate, 1, memory_order_relaxed);
+        return -1;
+    }
+    // 한도 직전 블록은 남은 만큼만 쓴다 (초과 예약분은 버림)
+    t->remaining = (src->limit - start < GCM_NONCE_RESERVE) ? src->limit - start
+                                                            : GCM_NONCE_RESERVE;
+    if (start + t->remaining > src->rotate_at) {
+        atomic_store_explicit(&src->rotate, 1, memory_order_relaxed);
+    }
+    return gcm_nonce_needs_rotation(src) ? GCM_NONCE_ROTATE : 0;
+}
+
+/**
+ * 다음 nonce를 만든다.
+ *
+ * @param nonce 출력 (GCM_NONCE_SIZE 바이트)
+ * @return 성공 시 0, 성공했지만 키 교체가 필요하면 GCM_NONCE_ROTATE,
+ *         한도에 닿았거나 생성기가 무효이면 -1 (nonce를 쓰지 말 것)
+ */
+static inline int gcm_nonce_next(GcmNonceThread *t, unsigned char nonce[GCM_NONCE_SIZE]) {
+    int status = 0;
+
+    if (t->thread_index < 0) {
+        return -1;
+    }
+    if (t->remaining == 0) {
+        status = gcm_nonce_reserve(t);
+        if (status < 0) {
+            return -1;
+        }
+    } else if (gcm_nonce_needs_rotation(t->src)) {
+        status = GCM_NONCE_ROTATE;
+    }
+    t->remaining--;
+
+    uint64_t c = t->counter++;
+    memcpy(nonce, t->fixed, 4);
+    for (int i = 0; i < 8; i++) {
+        nonce[4 + i] = (unsigned char)(c >> (56 - 8 * i));
+    }
+    return status;
+}
+
+#endif /* GCM_NONCE_H */
@@ -5,16 +5,29 @@
  * 
  * 빌드: make
  * 실행: ./bin/key_derivation
+ *       ./bin/key_derivation --batch <입력|-> [반복] [키 길이] [스레드]
+ *           (입력 한 줄 = "비밀번호" 또는 "비밀번호<TAB>솔트hex", 출력 한 줄 = "솔트hex<TAB>키hex")
+ *       ./bin/key_derivation --batch-test   (배치 결과를 derive_key_pbkdf2()와 비교)
+ *       ./bin/key_derivation --batch-bench [개수] [반복]   (엔진/스레드별 derivations/s)
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include <openssl/evp.h>
 #include <openssl/rand.h>
+#include "cpu_features.h"
+#include "pbkdf2_batch.h"
 
 #define SALT_SIZE 16
 #define KEY_SIZE 32      // 256 bits
 #define ITERATIONS 100000 // PBKDF2 반복 횟수
+#define BATCH_MAX_LINE 1024
+#define BATCH_MAX_SALT 256
+#define BATCH_BENCH_COUNT 64
+#define BATCH_BENCH_ITERATIONS 20000
 
 /**
  * PBKDF2-HMAC-SHA256으로 키를 파생한다.
@@ -38,7 +51,359 @@ void print_hex(const char *label, const unsigned char *data, size_t len) {
     printf("\n");
 }
 
-int main(void) {
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int online_cores(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cores > 0) ? (int)cores : 1;
+}
+
+static int hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * hex 문자열을 바이트로 바꾼다. [0-9a-fA-F] 외의 문자(부호, 공백 등)는 거부한다.
+ */
+static int parse_hex(const char *hex, unsigned char *out, size_t max, size_t *out_len) {
+    size_t n = strlen(hex);
+    if (n % 2 != 0 || n / 2 > max) {
+        return -1;
+    }
+    for (size_t i = 0; i < n / 2; i++) {
+        int hi = hex_nibble(hex[2 * i]);
+        int lo = hex_nibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return -1;
+        }
+        out[i] = (unsigned char)(hi << 4 | lo);
+    }
+    *out_len = n / 2;
+    return 0;
+}
+
+static void fprint_hex(FILE *f, const unsigned char *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        fprintf(f, "%02x", data[i]);
+    }
+}
+
+/**
+ * 비밀번호 목록을 읽어 한꺼번에 파생한다 (프로비저닝용).
+ *
+ * 솔트가 없는 줄은 SALT_SIZE 바이트 난수 솔트를 만든다. 결과는 입력 순서대로
+ * stdout에, 처리량은 stderr에 쓴다.
+ */
+int run_batch_file(const char *path, int iterations, size_t key_len, int threads) {
+    FILE *in = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    char line[BATCH_MAX_LINE];
+    Pbkdf2Job *jobs = NULL;
+    char **passwords = NULL;
+    unsigned char *salts = NULL, *keys = NULL;
+    size_t count = 0, capacity = 0;
+    int ret = -1;
+    
+    if (in == NULL) {
+        perror("입력 열기 실패");
+        return -1;
+    }
+    while (fgets(line, sizeof(line), in) != NULL) {
+        size_t n = strcspn(line, "\r\n");
+        if (line[n] == '\0' && !feof(in)) {
+            fprintf(stderr, "✗ %zu번째 줄이 너무 깁니다 (최대 %d바이트)\n", count + 1,
+                    BATCH_MAX_LINE - 2);
+            goto cleanup;
+        }
+        line[n] = '\0';
+        if (n == 0) {
+            continue;
+        }
+        if (count == capacity) {
+            size_t cap = capacity ? capacity * 2 : 256;
+            Pbkdf2Job *j = realloc(jobs, cap * sizeof(*j));
+            if (j == NULL) goto cleanup;
+            jobs = j;
+            char **p = realloc(passwords, cap * sizeof(*p));
+            if (p == NULL) goto cleanup;
+            passwords = p;
+            unsigned char *sl = realloc(salts, cap * BATCH_MAX_SALT);
+            if (sl == NULL) goto cleanup;
+            salts = sl;
+            capacity = cap;
+        }
+        char *tab = strchr(line, '\t');
+        size_t salt_len = SALT_SIZE;
+        if (tab != NULL) {
+            *tab = '\0';
+            if (parse_hex(tab + 1, salts + count * BATCH_MAX_SALT, BATCH_MAX_SALT, &salt_len) != 0) {
+                fprintf(stderr, "✗ %zu번째 줄: 솔트 hex 오류\n", count + 1);
+                goto cleanup;
+            }
+        } else if (RAND_bytes(salts + count * BATCH_MAX_SALT, SALT_SIZE) != 1) {
+            goto cleanup;
+        }
+        passwords[count] = strdup(line);
+        if (passwords[count] == NULL) goto cleanup;
+        jobs[count].salt_len = salt_len;
+        jobs[count].iterations = iterations;
+        jobs[count].key_len = key_len;
+        count++;
+        OPENSSL_cleanse(line, sizeof(line));
+    }
+    
+    keys = malloc(count * key_len + 1);
+    if (keys == NULL) goto cleanup;
+    for (size_t i = 0; i < count; i++) {
+        jobs[i].password = passwords[i];
+        jobs[i].salt = salts + i * BATCH_MAX_SALT;
+        jobs[i].key = keys + i * key_len;
+    }
+    
+    double t0 = now_seconds();
+    if (pbkdf2_batch(jobs, count, threads) != 0) {
+        fprintf(stderr, "✗ 배치 파생 실패\n");
+        goto cleanup;
+    }
+    double elapsed = now_seconds() - t0;
+    
+    for (size_t i = 0; i < count; i++) {
+        fprint_hex(stdout, jobs[i].salt, jobs[i].salt_len);
+        putchar('\t');
+        fprint_hex(stdout, jobs[i].key, key_len);
+        putchar('\n');
+    }
+    fprintf(stderr, "%zu개 파생 (반복 %d, 키 %zu바이트, 스레드 %d): %.2f초, %.1f derivations/s\n",
+            count, iterations, key_len, threads > 0 ? threads : online_cores(), elapsed,
+            elapsed > 0 ? (double)count / elapsed : 0.0);
+    ret = 0;
+    
+cleanup:
+    if (in != stdin) {
+        fclose(in);
+    }
+    for (size_t i = 0; passwords != NULL && i < count; i++) {
+        OPENSSL_cleanse(passwords[i], strlen(passwords[i]));
+        free(passwords[i]);
+    }
+    if (keys != NULL) {
+        OPENSSL_cleanse(keys, count * key_len);
+    }
+    OPENSSL_cleanse(line, sizeof(line));
+    free(passwords);
+    free(salts);
+    free(keys);
+    free(jobs);
+    return ret;
+}
+
+/**
+ * 배치 결과가 derive_key_pbkdf2()와 같은지 엔진/스레드 수/경계 조건별로 확인한다.
+ */
+int run_batch_selftest(void) {
+    enum { N = 37 };                     // 레인 수의 배수가 아닌 개수
+    static const char *fixed[4] = { "", "a", "MySecretPassword123!",
+                                    "0123456789012345678901234567890123456789012345678901234567890123456789" };
+    char passwords[N][80];
+    unsigned char salts[N][40], keys[N][80], expect[N][80];
+    Pbkdf2Job jobs[N];
+    int failures = 0;
+    
+    printf("=== PBKDF2 배치 자체 테스트 (기준: derive_key_pbkdf2) ===\n\n");
+    
+    // 비밀번호 길이 0~70 (블록 크기 64를 넘는 키 포함), 솔트 0~39, 키 1~80바이트, 반복 1~300
+    for (int i = 0; i < N; i++) {
+        if (i < 4) {
+            snprintf(passwords[i], sizeof(passwords[i]), "%s", fixed[i]);
+        } else {
+            snprintf(passwords[i], sizeof(passwords[i]), "diag-tool-%04d-%.*s", i, (i * 7) % 60,
+                     "pqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZpqrstuvwxyzABCDEFGHIJKLMNOP");
+        }
+        size_t salt_len = (size_t)(i * 5) % 40;
+        RAND_bytes(salts[i], sizeof(salts[i]));
+        jobs[i].password = passwords[i];
+        jobs[i].salt = salts[i];
+        jobs[i].salt_len = salt_len;
+        jobs[i].iterations = (i % 5 == 0) ? 1 : 1 + (i * 37) % 300;
+        jobs[i].key_len = (i % 3 == 0) ? 32 : 1 + (size_t)(i * 13) % 80;
+        jobs[i].key = keys[i];
+        if (derive_key_pbkdf2(passwords[i], salts[i], salt_len, jobs[i].iterations,
+                              expect[i], jobs[i].key_len) != 1) {
+            printf("✗ 기준 파생 실패\n");
+            return -1;
+        }
+    }
+    
+    for (int e = SHA256_MB_SCALAR; e < SHA256_MB_ENGINE_COUNT; e++) {
+        if (!sha256_mb_engine_supported((Sha256MbEngine)e)) {
+            printf("[%-10s] - 이 CPU에서 지원하지 않음\n", sha256_mb_engine_name((Sha256MbEngine)e));
+            continue;
+        }
+        static const int thread_counts[3] = { 1, 3, 8 };
+        for (int t = 0; t < 3; t++) {
+            memset(keys, 0, sizeof(keys));
+            int rc = pbkdf2_batch_engine(jobs, N, thread_counts[t], (Sha256MbEngine)e);
+            int same = 0;
+            for (int i = 0; i < N; i++) {
+                same += (memcmp(keys[i], expect[i], jobs[i].key_len) == 0);
+            }
+            int ok = (rc == 0 && same == N);
+            printf("[%-10s] %s 스레드 %d: %d/%d 일치\n", sha256_mb_engine_name((Sha256MbEngine)e),
+                   ok ? "✓" : "✗", thread_counts[t], same, N);
+            failures += !ok;
+        }
+    }
+    
+    memset(keys, 0, sizeof(keys));
+    int same = 0;
+    int rc = pbkdf2_batch(jobs, N, 0);
+    for (int i = 0; i < N; i++) {
+        same += (memcmp(keys[i], expect[i], jobs[i].key_len) == 0);
+    }
+    printf("[자동      ] %s 모든 코어: %d/%d 일치\n", (rc == 0 && same == N) ? "✓" : "✗", same, N);
+    failures += !(rc == 0 && same == N);
+    
+    // 잘못된 입력
+    Pbkdf2Job bad = jobs[1];
+    bad.iterations = 0;
+    int rejected = (pbkdf2_batch(&bad, 1, 1) == -1);
+    bad = jobs[1];
+    bad.key_len = 0;
+    rejected = rejected && (pbkdf2_batch(&bad, 1, 1) == -1);
+    rejected = rejected && (pbkdf2_batch(jobs, 0, 1) == 0);
+    printf("%s 잘못된 작업 거부 (반복 0, 키 길이 0), 빈 배치 허용\n", rejected ? "✓" : "✗");
+    failures += !rejected;
+    
+    // 솔트 hex: 부분/부호/공백 입력은 거부
+    static const char *bad_hex[5] = { "0z", "+1", "-1", " 1", "0x" };
+    unsigned char salt_buf[4];
+    size_t salt_len;
+    rejected = (parse_hex("00aBfF", salt_buf, sizeof(salt_buf), &salt_len) == 0 &&
+                salt_len == 3 && salt_buf[0] == 0x00 && salt_buf[1] == 0xab &&
+                salt_buf[2] == 0xff);
+    for (int i = 0; i < 5; i++) {
+        rejected = rejected && (parse_hex(bad_hex[i], salt_buf, sizeof(salt_buf), &salt_len) != 0);
+    }
+    printf("%s 잘못된 솔트 hex 거부 (0z, +1, -1, 공백, 0x)\n", rejected ? "✓" : "✗");
+    failures += !rejected;
+    
+    printf("\n%s (실패 %d건)\n", failures == 0 ? "✓ 모든 테스트 통과" : "✗ 테스트 실패", failures);
+    return failures == 0 ? 0 : -1;
+}
+
+/**
+ * derive_key_pbkdf2()를 하나씩 부르는 경우와 배치 엔진/스레드 수별 derivations/s를 비교한다.
+ */
+int run_batch_benchmark(size_t count, int iterations) {
+    int cores = online_cores();
+    char (*passwords)[48] = malloc(count * sizeof(*passwords));
+    unsigned char (*salts)[SALT_SIZE] = malloc(count * sizeof(*salts));
+    unsigned char (*keys)[KEY_SIZE] = malloc(count * sizeof(*keys));
+    unsigned char (*expect)[KEY_SIZE] = malloc(count * sizeof(*expect));
+    Pbkdf2Job *jobs = malloc(count * sizeof(*jobs));
+    int failures = 0;
+    
+    if (passwords == NULL || salts == NULL || keys == NULL || expect == NULL || jobs == NULL) {
+        free(passwords);
+        free(salts);
+        free(keys);
+        free(expect);
+        free(jobs);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        snprintf(passwords[i], sizeof(passwords[i]), "diag-%06zu-%08x", i, (unsigned)rand());
+        RAND_bytes(salts[i], SALT_SIZE);
+        jobs[i].password = passwords[i];
+        jobs[i].salt = salts[i];
+        jobs[i].salt_len = SALT_SIZE;
+        jobs[i].iterations = iterations;
+        jobs[i].key = keys[i];
+        jobs[i].key_len = KEY_SIZE;
+    }
+    
+    printf("=== PBKDF2-HMAC-SHA256 배치 벤치마크 (%zu개, 반복 %d, 키 %d바이트, 코어 %d) ===\n\n",
+           count, iterations, KEY_SIZE, cores);
+    
+    double t0 = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        derive_key_pbkdf2(passwords[i], salts[i], SALT_SIZE, iterations, expect[i], KEY_SIZE);
+    }
+    double base = (double)count / (now_seconds() - t0);
+    printf("%-26s %8s %14s %8s\n", "방식", "스레드", "derivations/s", "배율");
+    printf("%-26s %8d %14.1f %7.2fx\n", "derive_key_pbkdf2 하나씩", 1, base, 1.0);
+    
+    for (int e = SHA256_MB_SCALAR; e < SHA256_MB_ENGINE_COUNT; e++) {
+        if (!sha256_mb_engine_supported((Sha256MbEngine)e)) {
+            continue;
+        }
+        int thread_list[2] = { 1, cores };
+        for (int ti = 0; ti < (cores > 1 ? 2 : 1); ti++) {
+            memset(keys, 0, count * sizeof(*keys));
+            t0 = now_seconds();
+            int rc = pbkdf2_batch_engine(jobs, count, thread_list[ti], (Sha256MbEngine)e);
+            double rate = (double)count / (now_seconds() - t0);
+            int ok = (rc == 0 && memcmp(keys, expect, count * sizeof(*keys)) == 0);
+            char label[40];
+            snprintf(label, sizeof(label), "배치 %s", sha256_mb_engine_name((Sha256MbEngine)e));
+            printf("%-26s %8d %14.1f %7.2fx%s\n", label, thread_list[ti], rate, rate / base,
+                   ok ? "" : "  ✗ 결과 불일치");
+            failures += !ok;
+        }
+    }
+    
+    memset(keys, 0, count * sizeof(*keys));
+    t0 = now_seconds();
+    int rc = pbkdf2_batch(jobs, count, 0);
+    double rate = (double)count / (now_seconds() - t0);
+    int ok = (rc == 0 && memcmp(keys, expect, count * sizeof(*keys)) == 0);
+    printf("%-26s %8d %14.1f %7.2fx%s\n", "배치 자동 선택", cores, rate, rate / base,
+           ok ? "" : "  ✗ 결과 불일치");
+    failures += !ok;
+    
+    OPENSSL_cleanse(keys, count * sizeof(*keys));
+    OPENSSL_cleanse(expect, count * sizeof(*expect));
+    free(passwords);
+    free(salts);
+    free(keys);
+    free(expect);
+    free(jobs);
+    return failures == 0 ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    cpu_features_apply_override(argv);
+    
+    if (argc > 2 && strcmp(argv[1], "--batch") == 0) {
+        int iterations = (argc > 3) ? atoi(argv[3]) : ITERATIONS;
+        long key_len = (argc > 4) ? atol(argv[4]) : KEY_SIZE;
+        int threads = (argc > 5) ? atoi(argv[5]) : 0;
+        if (iterations < 1 || key_len < 1 || key_len > 1024 || threads < 0) {
+            fprintf(stderr, "사용법: %s --batch <입력|-> [반복 ≥ 1] [키 길이 1~1024] [스레드]\n",
+                    argv[0]);
+            return 1;
+        }
+        return (run_batch_file(argv[2], iterations, (size_t)key_len, threads) == 0) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--batch-test") == 0) {
+        return (run_batch_selftest() == 0) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--batch-bench") == 0) {
+        long count = (argc > 2) ? atol(argv[2]) : BATCH_BENCH_COUNT;
+        int iterations = (argc > 3) ? atoi(argv[3]) : BATCH_BENCH_ITERATIONS;
+        if (count < 1 || iterations < 1) {
+            fprintf(stderr, "사용법: %s --batch-bench [개수] [반복]\n", argv[0]);
+            return 1;
+        }
+        return (run_batch_benchmark((size_t)count, iterations) == 0) ? 0 : 1;
+    }
+    
     printf("=== 키 파생 함수 (PBKDF2) 데모 ===\n\n");
     
     printf("PBKDF2 (Password-Based Key Derivation Function 2)\n");
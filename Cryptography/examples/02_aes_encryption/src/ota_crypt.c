@@ -0,0 +1,499 @@
+/**
+ * ota_crypt.c - 대용량 OTA 패키지 청크 단위 병렬 AES-256-GCM 암호화 도구
+ *
+ * gcm_stream.h의 otagcm-v1 형식으로 파일을 암호화/복호화하고,
+ * 임의 바이트 범위만 복호화하거나 변조/절단/재배열 탐지를 확인한다.
+ * 암호화 AEAD는 -a 정책(aead_select.h)으로 고르며 헤더에 기록되므로,
+ * 복호화 측은 옵션 없이 같은 알고리즘을 사용한다.
+ *
+ * 빌드: make
+ * 실행: ./bin/ota_crypt keygen <키 파일>
+ *       ./bin/ota_crypt encrypt <입력> <출력> <키 파일> [-c 청크KB] [-t 스레드]
+ *                               [-a auto|bench|gcm|chacha20]
+ *       ./bin/ota_crypt decrypt <입력> <출력> <키 파일> [-t 스레드]
+ *       ./bin/ota_crypt range <입력> <키 파일> <오프셋> <길이>   (평문을 표준 출력으로)
+ *       ./bin/ota_crypt test
+ *       ./bin/ota_crypt bench [-s 크기MB] [-c 청크KB] [-t 스레드] [-a 정책]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gcm_stream.h"
+
+#define DEFAULT_BENCH_MB 256
+
+/**
+ * 32바이트 원시 키 파일을 읽는다.
+ */
+static int load_key(const char *path, unsigned char *key) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror("키 파일 열기 실패");
+        return -1;
+    }
+    unsigned char extra;
+    size_t n = fread(key, 1, GCM_STREAM_KEY_SIZE, f);
+    int ok = (n == GCM_STREAM_KEY_SIZE && fread(&extra, 1, 1, f) == 0);
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "키 파일은 정확히 %d바이트여야 합니다\n", GCM_STREAM_KEY_SIZE);
+        OPENSSL_cleanse(key, GCM_STREAM_KEY_SIZE);
+        return -1;
+    }
+    return 0;
+}
+
+static int cmd_keygen(const char *path) {
+    unsigned char key[GCM_STREAM_KEY_SIZE];
+    if (RAND_bytes(key, sizeof(key)) != 1) {
+        return 1;
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+    int ok = fd >= 0 && write(fd, key, sizeof(key)) == (ssize_t)sizeof(key);
+    if (fd >= 0) close(fd);
+    OPENSSL_cleanse(key, sizeof(key));
+    if (!ok) {
+        perror("키 파일 쓰기 실패");
+        return 1;
+    }
+    printf("✓ 키 생성: %s\n", path);
+    return 0;
+}
+
+static void print_stats(const char *label, const GcmStreamStats *s) {
+    double mb = (double)s->bytes / (1024.0 * 1024.0);
+    printf("%s: %s, %.1f MB, 청크 %llu개, 작업자 %d, %.3f초 (%.1f MB/s)\n", label,
+           aead_alg_name(s->alg), mb, (unsigned long long)s->chunks, s->workers, s->seconds,
+           s->seconds > 0 ? mb / s->seconds : 0.0);
+}
+
+/**
+ * 정책으로 AEAD를 고르고 근거를 출력한다.
+ */
+static int select_alg(AeadPolicy policy) {
+    AeadSelection sel;
+    aead_select(policy, &sel);
+    if (policy == AEAD_POLICY_BENCH) {
+        printf("AEAD 선택: %s (%s: GCM %.0f MB/s, ChaCha20-Poly1305 %.0f MB/s)\n",
+               aead_alg_name(sel.alg), sel.reason, sel.gcm_mbps, sel.chacha_mbps);
+    } else {
+        printf("AEAD 선택: %s (%s)\n", aead_alg_name(sel.alg), sel.reason);
+    }
+    return sel.alg;
+}
+
+static const char *error_text(int ret) {
+    return (ret == -2) ? "인증 실패 (변조/절단/재배열 또는 잘못된 키)" : "처리 실패";
+}
+
+static int cmd_encrypt(const char *in, const char *out, const char *key_path,
+                       uint32_t chunk_size, int threads, AeadPolicy policy) {
+    unsigned char key[GCM_STREAM_KEY_SIZE];
+    if (load_key(key_path, key) != 0) {
+        return 1;
+    }
+    int alg = select_alg(policy);
+    GcmStreamStats stats;
+    int ret = gcm_stream_encrypt_file(in, out, key, chunk_size, alg, threads, &stats);
+    OPENSSL_cleanse(key, sizeof(key));
+    if (ret != 0) {
+        fprintf(stderr, "✗ 암호화 %s\n", error_text(ret));
+        return 1;
+    }
+    print_stats("✓ 암호화", &stats);
+    return 0;
+}
+
+static int cmd_decrypt(const char *in, const char *out, const char *key_path, int threads) {
+    unsigned char key[GCM_STREAM_KEY_SIZE];
+    if (load_key(key_path, key) != 0) {
+        return 1;
+    }
+    GcmStreamStats stats;
+    int ret = gcm_stream_decrypt_file(in, out, key, threads, &stats);
+    OPENSSL_cleanse(key, sizeof(key));
+    if (ret != 0) {
+        fprintf(stderr, "✗ 복호화 %s\n", error_text(ret));
+        return 1;
+    }
+    print_stats("✓ 복호화", &stats);
+    return 0;
+}
+
+static int cmd_range(const char *in, const char *key_path, uint64_t offset, size_t len) {
+    unsigned char key[GCM_STREAM_KEY_SIZE];
+    if (load_key(key_path, key) != 0) {
+        return 1;
+    }
+    unsigned char *buf = malloc(len > 0 ? len : 1);
+    if (buf == NULL) {
+        OPENSSL_cleanse(key, sizeof(key));
+        return 1;
+    }
+    uint64_t chunks = 0;
+    long long n = gcm_stream_read_range(in, key, offset, len, buf, &chunks);
+    OPENSSL_cleanse(key, sizeof(key));
+    if (n < 0) {
+        fprintf(stderr, "✗ 범위 복호화 %s\n", error_text((int)n));
+        free(buf);
+        return 1;
+    }
+    fwrite(buf, 1, (size_t)n, stdout);
+    fprintf(stderr, "✓ %lld바이트 복호화 (청크 %llu개만 읽음)\n", n, (unsigned long long)chunks);
+    OPENSSL_cleanse(buf, len);
+    free(buf);
+    return 0;
+}
+
+/* ===== 자체 테스트 / 벤치마크 ===== */
+
+/**
+ * 결정론적 테스트 데이터로 파일을 만든다.
+ */
+static int make_test_file(const char *path, uint64_t size) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return -1;
+    }
+    unsigned char block[65536];
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    uint64_t written = 0;
+    int ok = 1;
+    while (ok && written < size) {
+        for (size_t i = 0; i < sizeof(block); i += 8) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            memcpy(block + i, &x, 8);
+        }
+        size_t n = (size - written < sizeof(block)) ? (size_t)(size - written) : sizeof(block);
+        ok = fwrite(block, 1, n, f) == n;
+        written += n;
+    }
+    return (fclose(f) == 0 && ok) ? 0 : -1;
+}
+
+static int files_equal(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb"), *fb = fopen(b, "rb");
+    int equal = (fa != NULL && fb != NULL);
+    unsigned char ba[65536], bb[65536];
+    while (equal) {
+        size_t na = fread(ba, 1, sizeof(ba), fa);
+        size_t nb = fread(bb, 1, sizeof(bb), fb);
+        if (na != nb || memcmp(ba, bb, na) != 0) {
+            equal = 0;
+        }
+        if (na == 0) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return equal;
+}
+
+static int check(const char *name, int cond, int *failures) {
+    printf("  %s %s\n", cond ? "✓" : "✗", name);
+    if (!cond) (*failures)++;
+    return cond;
+}
+
+/**
+ * 왕복, 범위 복호화, 변조/절단/재배열/잘못된 키 탐지를 확인한다.
+ */
+static int cmd_test(void) {
+    char dir[] = "/tmp/ota_crypt_XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("임시 디렉터리 생성 실패");
+        return 1;
+    }
+    char plain[128], enc[128], dec[128];
+    snprintf(plain, sizeof(plain), "%s/plain", dir);
+    snprintf(enc, sizeof(enc), "%s/enc", dir);
+    snprintf(dec, sizeof(dec), "%s/dec", dir);
+
+    unsigned char key[GCM_STREAM_KEY_SIZE], wrong[GCM_STREAM_KEY_SIZE];
+    RAND_bytes(key, sizeof(key));
+    RAND_bytes(wrong, sizeof(wrong));
+    const uint32_t chunk = GCM_STREAM_MIN_CHUNK;
+    const uint64_t sizes[] = { 0, 1, chunk - 1, chunk, chunk + 1, 10 * chunk + 123 };
+    int failures = 0;
+
+    printf("=== otagcm-v1 자체 테스트 ===\n\n");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        char name[96];
+        snprintf(name, sizeof(name), "왕복 %llu바이트 (1/3 스레드)", (unsigned long long)sizes[i]);
+        int ok = make_test_file(plain, sizes[i]) == 0 &&
+                 gcm_stream_encrypt_file(plain, enc, key, chunk, AEAD_ALG_AES_256_GCM, 3, NULL) == 0 &&
+                 gcm_stream_decrypt_file(enc, dec, key, 1, NULL) == 0 &&
+                 files_equal(plain, dec) &&
+                 gcm_stream_decrypt_file(enc, dec, key, 3, NULL) == 0 &&
+                 files_equal(plain, dec);
+        check(name, ok, &failures);
+    }
+
+    // 범위 복호화: 청크 경계를 가로지르는 범위
+    uint64_t size = 10 * chunk + 123;
+    make_test_file(plain, size);
+    gcm_stream_encrypt_file(plain, enc, key, chunk, AEAD_ALG_AES_256_GCM, 0, NULL);
+    {
+        const uint64_t offsets[] = { 0, chunk - 10, 3 * chunk + 7, size - 50 };
+        const size_t lens[] = { 10, 20, 2 * chunk, 500 };
+        unsigned char expected[2 * GCM_STREAM_MIN_CHUNK], got[2 * GCM_STREAM_MIN_CHUNK];
+        int fd = open(plain, O_RDONLY);
+        for (size_t i = 0; i < 4; i++) {
+            size_t want = lens[i];
+            if (offsets[i] + want > size) want = (size_t)(size - offsets[i]);
+            uint64_t chunks = 0;
+            long long n = gcm_stream_read_range(enc, key, offsets[i], lens[i], got, &chunks);
+            int ok = fd >= 0 && gcm_stream_pread_full(fd, expected, want, offsets[i]) == 0 &&
+                     n == (long long)want && memcmp(expected, got, want) == 0;
+            char name[96];
+            snprintf(name, sizeof(name), "범위 복호화 오프셋 %llu 길이 %zu (청크 %llu개)",
+                     (unsigned long long)offsets[i], want, (unsigned long long)chunks);
+            check(name, ok, &failures);
+        }
+        if (fd >= 0) close(fd);
+    }
+
+    // 변조/절단/연장/재배열/헤더 변조/잘못된 키
+    uint64_t stride = chunk + GCM_STREAM_TAG_SIZE;
+    int r;
+
+    {
+        // 1바이트 변조
+        unsigned char b;
+        uint64_t pos = GCM_STREAM_HEADER_SIZE + 5 * stride + 100;
+        int fd = open(enc, O_RDWR);
+        gcm_stream_pread_full(fd, &b, 1, pos);
+        b ^= 0x01;
+        gcm_stream_pwrite_full(fd, &b, 1, pos);
+        r = gcm_stream_decrypt_file(enc, dec, key, 2, NULL);
+        check("암호문 1비트 변조 탐지 (출력 파일 삭제)", r == -2 && access(dec, F_OK) != 0, &failures);
+        b ^= 0x01;
+        gcm_stream_pwrite_full(fd, &b, 1, pos);
+
+        // 헤더 변조 (nonce_base)
+        gcm_stream_pread_full(fd, &b, 1, 45);
+        b ^= 0x80;
+        gcm_stream_pwrite_full(fd, &b, 1, 45);
+        r = gcm_stream_decrypt_file(enc, dec, key, 2, NULL);
+        check("헤더 변조 탐지", r == -2, &failures);
+        b ^= 0x80;
+        gcm_stream_pwrite_full(fd, &b, 1, 45);
+
+        // 마지막 청크를 경계에서 잘라냄
+        r = ftruncate(fd, (off_t)(GCM_STREAM_HEADER_SIZE + 10 * stride));
+        close(fd);
+        r = gcm_stream_decrypt_file(enc, dec, key, 2, NULL);
+        check("청크 절단 탐지", r == -2, &failures);
+    }
+
+    // 재배열: 청크 2와 3 교환
+    gcm_stream_encrypt_file(plain, enc, key, chunk, AEAD_ALG_AES_256_GCM, 0, NULL);
+    {
+        unsigned char *c2 = malloc(stride), *c3 = malloc(stride);
+        int fd = open(enc, O_RDWR);
+        gcm_stream_pread_full(fd, c2, stride, GCM_STREAM_HEADER_SIZE + 2 * stride);
+        gcm_stream_pread_full(fd, c3, stride, GCM_STREAM_HEADER_SIZE + 3 * stride);
+        gcm_stream_pwrite_full(fd, c3, stride, GCM_STREAM_HEADER_SIZE + 2 * stride);
+        gcm_stream_pwrite_full(fd, c2, stride, GCM_STREAM_HEADER_SIZE + 3 * stride);
+        close(fd);
+        free(c2);
+        free(c3);
+        r = gcm_stream_decrypt_file(enc, dec, key, 2, NULL);
+        check("청크 재배열 탐지", r == -2, &failures);
+    }
+
+    // 헤더 크기를 줄여 앞부분만 남긴 절단 (마지막 청크 final 표시 불일치)
+    gcm_stream_encrypt_file(plain, enc, key, chunk, AEAD_ALG_AES_256_GCM, 0, NULL);
+    {
+        unsigned char header[GCM_STREAM_HEADER_SIZE];
+        int fd = open(enc, O_RDWR);
+        gcm_stream_pread_full(fd, header, sizeof(header), 0);
+        gcm_stream_put_be64(header + 16, 4 * chunk);
+        gcm_stream_pwrite_full(fd, header, sizeof(header), 0);
+        r = ftruncate(fd, (off_t)(GCM_STREAM_HEADER_SIZE + 4 * stride));
+        close(fd);
+        r = gcm_stream_decrypt_file(enc, dec, key, 2, NULL);
+        check("헤더 크기 위조 + 절단 탐지", r == -2, &failures);
+    }
+
+    gcm_stream_encrypt_file(plain, enc, key, chunk, AEAD_ALG_AES_256_GCM, 0, NULL);
+    r = gcm_stream_decrypt_file(enc, dec, wrong, 2, NULL);
+    check("잘못된 키 거부", r == -2, &failures);
+    unsigned char tmp[16];
+    check("잘못된 키로 범위 복호화 거부",
+          gcm_stream_read_range(enc, wrong, 100, sizeof(tmp), tmp, NULL) == -2, &failures);
+
+    // ChaCha20-Poly1305: 헤더의 알고리즘 ID만으로 복호화, ID 변조/미지 ID 거부
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i += 2) {
+        char name[96];
+        snprintf(name, sizeof(name), "ChaCha20-Poly1305 왕복 %llu바이트",
+                 (unsigned long long)sizes[i]);
+        GcmStreamStats ds;
+        int ok = make_test_file(plain, sizes[i]) == 0 &&
+                 gcm_stream_encrypt_file(plain, enc, key, chunk, AEAD_ALG_CHACHA20_POLY1305,
+                                         2, NULL) == 0 &&
+                 gcm_stream_decrypt_file(enc, dec, key, 2, &ds) == 0 &&
+                 ds.alg == AEAD_ALG_CHACHA20_POLY1305 && files_equal(plain, dec);
+        check(name, ok, &failures);
+    }
+    {
+        unsigned char id;
+        int fd = open(enc, O_RDWR);
+        gcm_stream_pread_full(fd, &id, 1, GCM_STREAM_ALG_OFFSET);
+        id = AEAD_ALG_AES_256_GCM;
+        gcm_stream_pwrite_full(fd, &id, 1, GCM_STREAM_ALG_OFFSET);
+        r = gcm_stream_decrypt_file(enc, dec, key, 2, NULL);
+        check("알고리즘 ID 변조 탐지 (ChaCha20 → GCM)", r == -2, &failures);
+        id = 0x7f;
+        gcm_stream_pwrite_full(fd, &id, 1, GCM_STREAM_ALG_OFFSET);
+        close(fd);
+        r = gcm_stream_decrypt_file(enc, dec, key, 2, NULL);
+        check("알 수 없는 알고리즘 ID 거부", r == -1, &failures);
+    }
+
+    unlink(plain);
+    unlink(enc);
+    unlink(dec);
+    rmdir(dir);
+    OPENSSL_cleanse(key, sizeof(key));
+
+    printf("\n%s (실패 %d건)\n", failures == 0 ? "✓ 모든 테스트 통과" : "✗ 테스트 실패", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+/**
+ * 1 스레드와 N 스레드의 암호화/복호화 처리량을 비교하고 범위 복호화 지연을 잰다.
+ */
+static int cmd_bench(uint64_t size_mb, uint32_t chunk_size, int threads, AeadPolicy policy) {
+    char dir[] = "/tmp/ota_crypt_XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("임시 디렉터리 생성 실패");
+        return 1;
+    }
+    char plain[128], enc[128], dec[128];
+    snprintf(plain, sizeof(plain), "%s/plain", dir);
+    snprintf(enc, sizeof(enc), "%s/enc", dir);
+    snprintf(dec, sizeof(dec), "%s/dec", dir);
+
+    unsigned char key[GCM_STREAM_KEY_SIZE];
+    RAND_bytes(key, sizeof(key));
+    uint64_t size = size_mb * 1024 * 1024;
+    int failures = 0;
+
+    if (threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cores > 0) ? (int)cores : 1;
+    }
+
+    printf("=== otagcm-v1 벤치마크 (%llu MB, 청크 %u KB) ===\n\n",
+           (unsigned long long)size_mb, chunk_size / 1024);
+    if (make_test_file(plain, size) != 0) {
+        fprintf(stderr, "테스트 파일 생성 실패\n");
+        rmdir(dir);
+        return 1;
+    }
+
+    int alg = select_alg(policy);
+    const int counts[] = { 1, threads };
+    for (int i = 0; i < (threads > 1 ? 2 : 1); i++) {
+        GcmStreamStats es, ds;
+        int ok = gcm_stream_encrypt_file(plain, enc, key, chunk_size, alg, counts[i], &es) == 0 &&
+                 gcm_stream_decrypt_file(enc, dec, key, counts[i], &ds) == 0;
+        if (!ok) {
+            failures++;
+            continue;
+        }
+        print_stats("암호화", &es);
+        print_stats("복호화", &ds);
+    }
+    if (!files_equal(plain, dec)) {
+        printf("✗ 왕복 결과 불일치\n");
+        failures++;
+    }
+
+    // 범위 복호화: 파일 중간 4KB만 읽기
+    unsigned char buf[4096];
+    uint64_t chunks = 0;
+    double start = gcm_stream_now();
+    long long n = gcm_stream_read_range(enc, key, size / 2, sizeof(buf), buf, &chunks);
+    double elapsed = gcm_stream_now() - start;
+    printf("범위 복호화: 오프셋 %llu에서 %lld바이트, 청크 %llu개만 읽음, %.3f ms\n",
+           (unsigned long long)(size / 2), n, (unsigned long long)chunks, elapsed * 1000.0);
+    failures += (n != (long long)sizeof(buf) && size >= sizeof(buf));
+
+    unlink(plain);
+    unlink(enc);
+    unlink(dec);
+    rmdir(dir);
+    OPENSSL_cleanse(key, sizeof(key));
+    return failures == 0 ? 0 : 1;
+}
+
+static void usage(const char *prog) {
+    printf("사용법:\n");
+    printf("  %s keygen <키 파일>\n", prog);
+    printf("  %s encrypt <입력> <출력> <키 파일> [-c 청크KB] [-t 스레드] "
+           "[-a auto|bench|gcm|chacha20]\n", prog);
+    printf("  %s decrypt <입력> <출력> <키 파일> [-t 스레드]\n", prog);
+    printf("  %s range <입력> <키 파일> <오프셋> <길이>\n", prog);
+    printf("  %s test\n", prog);
+    printf("  %s bench [-s 크기MB] [-c 청크KB] [-t 스레드] [-a 정책]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t chunk_size = GCM_STREAM_DEFAULT_CHUNK;
+    uint64_t size_mb = DEFAULT_BENCH_MB;
+    int threads = 0;
+    AeadPolicy policy = AEAD_POLICY_AUTO;
+
+    cpu_features_apply_override(argv);
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // 옵션 파싱 (위치 인자 뒤)
+    int positional = 1;
+    while (positional < argc && argv[positional][0] != '-') {
+        positional++;
+    }
+    for (int i = positional; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-c") == 0) {
+            chunk_size = (uint32_t)strtoul(argv[++i], NULL, 10) * 1024;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            size_mb = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-a") == 0) {
+            if (aead_policy_parse(argv[++i], &policy) != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const char *cmd = argv[1];
+    if (strcmp(cmd, "keygen") == 0 && positional == 3) {
+        return cmd_keygen(argv[2]);
+    } else if (strcmp(cmd, "encrypt") == 0 && positional == 5) {
+        return cmd_encrypt(argv[2], argv[3], argv[4], chunk_size, threads, policy);
+    } else if (strcmp(cmd, "decrypt") == 0 && positional == 5) {
+        return cmd_decrypt(argv[2], argv[3], argv[4], threads);
+    } else if (strcmp(cmd, "range") == 0 && positional == 6) {
+        return cmd_range(argv[2], argv[3], strtoull(argv[4], NULL, 10),
+                         (size_t)strtoull(argv[5], NULL, 10));
+    } else if (strcmp(cmd, "test") == 0 && positional == 2) {
+        return cmd_test();
+    } else if (strcmp(cmd, "bench") == 0 && positional == 2) {
+        return cmd_bench(size_mb, chunk_size, threads, policy);
+    }
+    usage(argv[0]);
+    return 1;
+}
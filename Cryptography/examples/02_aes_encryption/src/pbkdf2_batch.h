@@ -0,0 +1,438 @@
+/**
+ * pbkdf2_batch.h - 여러 비밀번호/솔트의 PBKDF2-HMAC-SHA256 배치 파생
+ *
+ * PBKDF2 출력 블록 T_i = U_1 ^ U_2 ^ ... ^ U_c,
+ *   U_1 = HMAC(P, S || INT(i)), U_j = HMAC(P, U_{j-1})
+ * 는 블록마다 서로 독립이고, 한 블록 안의 반복은 앞 결과에 의존한다.
+ * 그래서 (비밀번호, 블록 번호) 하나를 SIMD 레인 하나에 두고 레인끼리 나란히 반복한다.
+ *
+ *   - U_j 계산은 HMAC 키 상태(inner/outer, hmac_key.h)에서 이어 가는 압축 두 번이다.
+ *     메시지는 32바이트 U와 고정 패딩(전체 96바이트)이라 블록 하나로 끝나므로,
+ *     sha256_mb.h의 워드 단위 압축(*_words)에 레인별 상태/워드 벡터를 그대로 넣고
+ *     반복 사이에 바이트 변환이나 메모리 왕복을 하지 않는다.
+ *   - 엔진은 sha256_mb.h와 같다 (avx512 x16 / avx2 x8 / vec x4 / sha-ni / scalar).
+ *     sha-ni 엔진은 명령 지연을 가리도록 독립 블록 PBKDF2_SHANI_LANES개를 번갈아 압축한다.
+ *   - 작업자 스레드가 코어마다 하나씩 공유 작업 번호를 원자적으로 가져가므로,
+ *     반복 횟수나 키 길이가 서로 달라도 레인과 코어가 쉬지 않는다.
+ *
+ * 결과는 derive_key_pbkdf2() (OpenSSL PKCS5_PBKDF2_HMAC, EVP_sha256)와 바이트 단위로 같다.
+ *
+ * 사용 예:
+ *   Pbkdf2Job jobs[N] = { { password, salt, 16, 100000, key, 32 }, ... };
+ *   pbkdf2_batch(jobs, N, 0);          // 0 = 모든 코어
+ */
+
+#ifndef PBKDF2_BATCH_H
+#define PBKDF2_BATCH_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hmac_key.h"
+#include "sha256_mb.h"
+
+#define PBKDF2_MAX_THREADS 256
+#define PBKDF2_SHANI_LANES 4             // sha-ni 엔진이 번갈아 압축하는 블록 수
+
+/**
+ * 파생 하나 (derive_key_pbkdf2()의 인자와 같다)
+ */
+typedef struct {
+    const char *password;                // NUL 종료 문자열 (strlen 길이를 쓴다)
+    const unsigned char *salt;
+    size_t salt_len;
+    int iterations;                      // 1 이상
+    unsigned char *key;                  // 출력
+    size_t key_len;                      // 1 이상
+} Pbkdf2Job;
+
+/**
+ * 레인별 상태 (워드 i의 레인들이 메모리에 연속)
+ */
+typedef struct {
+    Sha256MbState inner;                 // HMAC 내부 키 상태
+    Sha256MbState outer;                 // HMAC 외부 키 상태
+    Sha256MbState u;                     // 직전 U_j
+    Sha256MbState t;                     // U_1 ^ ... ^ U_j
+    uint32_t remaining[SHA256_MB_MAX_LANES];
+    size_t task[SHA256_MB_MAX_LANES];
+    int active[SHA256_MB_MAX_LANES];
+} Pbkdf2Lanes;
+
+/**
+ * 모든 레인에서 U_{j+1} = HMAC(P, U_j), T ^= U_{j+1}를 rounds번 반복하는 함수를 정의한다.
+ *
+ * HMAC 메시지 블록: U(8워드) || 0x80000000 || 0 ... || 비트 길이 (64 + 32) * 8
+ */
+#define PBKDF2_DEFINE_ITERATE(SUFFIX, VEC, ATTR)                                     \
+ATTR static void pbkdf2_iterate_##SUFFIX(Pbkdf2Lanes *ln, uint32_t rounds) {         \
+    VEC inner[8], outer[8], u[8], t[8];                                              \
+    VEC zero = { 0 };                                                                \
+    for (int i = 0; i < 8; i++) {                                                    \
+        memcpy(&inner[i], ln->inner[i], sizeof(VEC));                                \
+        memcpy(&outer[i], ln->outer[i], sizeof(VEC));                                \
+        memcpy(&u[i], ln->u[i], sizeof(VEC));                                        \
+        memcpy(&t[i], ln->t[i], sizeof(VEC));                                        \
+    }                                                                                \
+    for (uint32_t r = 0; r < rounds; r++) {                                          \
+        VEC w[16], s[8];                                                             \
+        for (int i = 0; i < 8; i++) {                                                \
+            w[i] = u[i];                                                             \
+            s[i] = inner[i];                                                         \
+            w[8 + i] = zero;                                                         \
+        }                                                                            \
+        w[8] = zero + 0x80000000u;                                                   \
+        w[15] = zero + (64 + 32) * 8;                                                \
+        sha256_mb_compress_##SUFFIX##_words(s, w);                                   \
+        for (int i = 0; i < 8; i++) {                                                \
+            w[i] = s[i];                                                             \
+            u[i] = outer[i];                                                         \
+            w[8 + i] = zero;                                                         \
+        }                                                                            \
+        w[8] = zero + 0x80000000u;                                                   \
+        w[15] = zero + (64 + 32) * 8;                                                \
+        sha256_mb_compress_##SUFFIX##_words(u, w);                                   \
+        for (int i = 0; i < 8; i++) {                                                \
+            t[i] ^= u[i];                                                            \
+        }                                                                            \
+    }                                                                                \
+    for (int i = 0; i < 8; i++) {                                                    \
+        memcpy(ln->u[i], &u[i], sizeof(VEC));                                        \
+        memcpy(ln->t[i], &t[i], sizeof(VEC));                                        \
+    }                                                                                \
+}
+
+PBKDF2_DEFINE_ITERATE(x1, sha256_mb_v1, )
+PBKDF2_DEFINE_ITERATE(x4, sha256_mb_v4, )
+#if defined(__x86_64__) || defined(__i386__)
+PBKDF2_DEFINE_ITERATE(x8, sha256_mb_v8, __attribute__((target("avx2"))))
+PBKDF2_DEFINE_ITERATE(x16, sha256_mb_v16, __attribute__((target("avx512f"))))
+
+/**
+ * SHA 확장 명령으로 레인 0..PBKDF2_SHANI_LANES-1을 반복한다.
+ *
+ * sha256rnds2는 지연이 길어 블록 하나만 압축하면 대부분 기다린다. 독립 블록 여러 개를
+ * sha256_mb_compress_shani()로 번갈아 압축하면 비순차 실행이 서로의 지연을 채운다.
+ */
+static void pbkdf2_iterate_shani(Pbkdf2Lanes *ln, uint32_t rounds) {
+    unsigned char block[PBKDF2_SHANI_LANES][64];
+    Sha256MbState st;
+
+    memset(block, 0, sizeof(block));
+    for (int l = 0; l < PBKDF2_SHANI_LANES; l++) {
+        block[l][32] = 0x80;
+        block[l][62] = ((64 + 32) * 8) >> 8;
+        block[l][63] = ((64 + 32) * 8) & 0xff;
+    }
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (int half = 0; half < 2; half++) {
+            const Sha256MbState *key = half ? &ln->outer : &ln->inner;
+            for (int l = 0; l < PBKDF2_SHANI_LANES; l++) {
+                const unsigned char *blocks[1] = { block[l] };
+                for (int i = 0; i < 8; i++) {
+                    uint32_t v = __builtin_bswap32(half ? st[i][l] : ln->u[i][l]);
+                    memcpy(block[l] + 4 * i, &v, 4);
+                }
+                Sha256MbState one;
+                for (int i = 0; i < 8; i++) {
+                    one[i][0] = (*key)[i][l];
+                }
+                sha256_mb_compress_shani(one, blocks);
+                for (int i = 0; i < 8; i++) {
+                    st[i][l] = one[i][0];
+                }
+            }
+        }
+        for (int i = 0; i < 8; i++) {
+            for (int l = 0; l < PBKDF2_SHANI_LANES; l++) {
+                ln->u[i][l] = st[i][l];
+                ln->t[i][l] ^= st[i][l];
+            }
+        }
+    }
+    hmac_key_wipe(block, sizeof(block));
+    hmac_key_wipe(st, sizeof(st));
+}
+#endif
+
+/**
+ * 엔진의 레인 수 (sha-ni는 번갈아 압축하는 블록 수)
+ */
+static inline int pbkdf2_engine_lanes(Sha256MbEngine engine) {
+    return engine == SHA256_MB_SHANI ? PBKDF2_SHANI_LANES : sha256_mb_engine_lanes(engine);
+}
+
+static inline void pbkdf2_iterate(Sha256MbEngine engine, Pbkdf2Lanes *ln, uint32_t rounds) {
+    switch (engine) {
+#if defined(__x86_64__) || defined(__i386__)
+    case SHA256_MB_AVX512: pbkdf2_iterate_x16(ln, rounds); break;
+    case SHA256_MB_AVX2:   pbkdf2_iterate_x8(ln, rounds);  break;
+    case SHA256_MB_SHANI:  pbkdf2_iterate_shani(ln, rounds); break;
+#endif
+    case SHA256_MB_VEC4:   pbkdf2_iterate_x4(ln, rounds);  break;
+    default:               pbkdf2_iterate_x1(ln, rounds);  break;
+    }
+}
+
+/* ===== 작업 분배 ===== */
+
+typedef struct {
+    size_t job;
+    uint32_t block;                      // 출력 블록 번호 i (1부터)
+} Pbkdf2Task;
+
+typedef struct {
+    const Pbkdf2Job *jobs;
+    const Pbkdf2Task *tasks;
+    size_t task_count;
+    size_t next_task;                    // 원자적으로 증가
+    Sha256MbEngine engine;
+} Pbkdf2Batch;
+
+typedef struct {
+    Pbkdf2Batch *batch;
+    unsigned char *msg;                  // S || INT(i) 임시 버퍼
+    size_t msg_capacity;
+    size_t derived;                      // 이 작업자가 끝낸 출력 블록 수
+    int failed;
+} Pbkdf2Worker;
+
+/**
+ * 레인 l에 작업을 배정하고 U_1을 계산한다.
+ *
+ * @return 성공 시 0, 메모리 부족 시 -1
+ */
+static inline int pbkdf2_lane_start(Pbkdf2Worker *w, Pbkdf2Lanes *ln, int l, size_t task) {
+    const Pbkdf2Task *tk = &w->batch->tasks[task];
+    const Pbkdf2Job *job = &w->batch->jobs[tk->job];
+    size_t len = job->salt_len + 4;
+    HmacSha256Key key;
+    unsigned char u1[HMAC_KEY_MAC_SIZE];
+
+    if (len > w->msg_capacity) {
+        unsigned char *msg = realloc(w->msg, len);
+        if (msg == NULL) {
+            return -1;
+        }
+        w->msg = msg;
+        w->msg_capacity = len;
+    }
+    if (job->salt_len > 0) {
+        memcpy(w->msg, job->salt, job->salt_len);
+    }
+    w->msg[job->salt_len] = (unsigned char)(tk->block >> 24);
+    w->msg[job->salt_len + 1] = (unsigned char)(tk->block >> 16);
+    w->msg[job->salt_len + 2] = (unsigned char)(tk->block >> 8);
+    w->msg[job->salt_len + 3] = (unsigned char)tk->block;
+
+    hmac_key_init(&key, (const unsigned char *)job->password, strlen(job->password));
+    hmac_key_mac(&key, w->msg, len, u1);
+    for (int i = 0; i < 8; i++) {
+        ln->inner[i][l] = key.inner[i];
+        ln->outer[i][l] = key.outer[i];
+        ln->u[i][l] = sha256_mb_load_be32(u1 + 4 * i);
+        ln->t[i][l] = ln->u[i][l];
+    }
+    ln->remaining[l] = (uint32_t)job->iterations - 1;
+    ln->task[l] = task;
+    ln->active[l] = 1;
+    hmac_key_clear(&key);
+    hmac_key_wipe(u1, sizeof(u1));
+    return 0;
+}
+
+/**
+ * 레인 l의 T_i를 출력 키의 해당 위치에 쓴다 (마지막 블록은 잘라 쓴다).
+ */
+static inline void pbkdf2_lane_finish(Pbkdf2Worker *w, Pbkdf2Lanes *ln, int l) {
+    const Pbkdf2Task *tk = &w->batch->tasks[ln->task[l]];
+    const Pbkdf2Job *job = &w->batch->jobs[tk->job];
+    size_t offset = (size_t)(tk->block - 1) * 32;
+    size_t n = job->key_len - offset < 32 ? job->key_len - offset : 32;
+    unsigned char out[32];
+
+    for (int i = 0; i < 8; i++) {
+        out[4 * i] = (unsigned char)(ln->t[i][l] >> 24);
+        out[4 * i + 1] = (unsigned char)(ln->t[i][l] >> 16);
+        out[4 * i + 2] = (unsigned char)(ln->t[i][l] >> 8);
+        out[4 * i + 3] = (unsigned char)ln->t[i][l];
+    }
+    memcpy(job->key + offset, out, n);
+    hmac_key_wipe(out, sizeof(out));
+    ln->active[l] = 0;
+    w->derived++;
+}
+
+static void *pbkdf2_worker(void *arg) {
+    Pbkdf2Worker *w = arg;
+    Pbkdf2Batch *b = w->batch;
+    int lanes = pbkdf2_engine_lanes(b->engine);
+    Pbkdf2Lanes ln;
+
+    memset(&ln, 0, sizeof(ln));
+    for (;;) {
+        // 빈 레인 채우기 (반복이 1회뿐인 작업은 바로 끝난다)
+        int active = 0;
+        for (int l = 0; l < lanes; l++) {
+            while (!ln.active[l]) {
+                size_t task = __atomic_fetch_add(&b->next_task, 1, __ATOMIC_RELAXED);
+                if (task >= b->task_count) {
+                    break;
+                }
+                if (pbkdf2_lane_start(w, &ln, l, task) != 0) {
+                    w->failed = 1;
+                    goto done;
+                }
+                if (ln.remaining[l] == 0) {
+                    pbkdf2_lane_finish(w, &ln, l);
+                }
+            }
+            active += ln.active[l];
+        }
+        if (active == 0) {
+            break;
+        }
+
+        // 가장 먼저 끝나는 레인까지 한꺼번에 반복 (빈 레인은 이전 값으로 헛돈다)
+        uint32_t rounds = UINT32_MAX;
+        for (int l = 0; l < lanes; l++) {
+            if (ln.active[l] && ln.remaining[l] < rounds) {
+                rounds = ln.remaining[l];
+            }
+        }
+        pbkdf2_iterate(b->engine, &ln, rounds);
+        for (int l = 0; l < lanes; l++) {
+            if (ln.active[l]) {
+                ln.remaining[l] -= rounds;
+                if (ln.remaining[l] == 0) {
+                    pbkdf2_lane_finish(w, &ln, l);
+                }
+            }
+        }
+    }
+done:
+    hmac_key_wipe(&ln, sizeof(ln));
+    if (w->msg != NULL) {
+        hmac_key_wipe(w->msg, w->msg_capacity);
+    }
+    free(w->msg);
+    w->msg = NULL;
+    return NULL;
+}
+
+/**
+ * 작업 수에 맞는 엔진: 스레드당 작업 수를 넘지 않는 레인 수 중 가장 넓은 지원 엔진
+ */
+static inline Sha256MbEngine pbkdf2_engine_for(size_t tasks_per_thread) {
+    Sha256MbEngine best = sha256_mb_best_engine();
+    while (best > SHA256_MB_SCALAR &&
+           (!sha256_mb_engine_supported(best) ||
+            (size_t)pbkdf2_engine_lanes(best) > tasks_per_thread)) {
+        best = (Sha256MbEngine)(best - 1);
+    }
+    return best;
+}
+
+/**
+ * 지정한 엔진과 스레드 수로 count개 파생을 계산한다.
+ *
+ * @param threads 작업자 수 (0 = 온라인 코어 수, 작업 수보다 많으면 줄인다)
+ * @param engine 사용할 엔진 (지원되지 않으면 스칼라로 대체)
+ * @return 성공 시 0, 잘못된 작업(반복 < 1, 키 길이 0, NULL 포인터) 또는 자원 부족 시 -1
+ */
+static inline int pbkdf2_batch_engine(Pbkdf2Job *jobs, size_t count, int threads,
+                                      Sha256MbEngine engine) {
+    Pbkdf2Batch batch;
+    size_t task_count = 0;
+    int ret = -1;
+
+    for (size_t j = 0; j < count; j++) {
+        if (jobs[j].password == NULL || jobs[j].key == NULL || jobs[j].key_len == 0 ||
+            jobs[j].iterations < 1 || (jobs[j].salt == NULL && jobs[j].salt_len > 0) ||
+            jobs[j].key_len > (size_t)UINT32_MAX * 32) {
+            return -1;
+        }
+        task_count += (jobs[j].key_len + 31) / 32;
+    }
+    if (task_count == 0) {
+        return 0;
+    }
+    if (!sha256_mb_engine_supported(engine)) {
+        engine = SHA256_MB_SCALAR;
+    }
+    if (threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cores > 0) ? (int)cores : 1;
+    }
+    if (threads > PBKDF2_MAX_THREADS) threads = PBKDF2_MAX_THREADS;
+    if ((size_t)threads > task_count) threads = (int)task_count;
+
+    Pbkdf2Task *tasks = malloc(task_count * sizeof(Pbkdf2Task));
+    Pbkdf2Worker *workers = calloc((size_t)threads, sizeof(Pbkdf2Worker));
+    pthread_t *tids = calloc((size_t)threads, sizeof(pthread_t));
+    if (tasks == NULL || workers == NULL || tids == NULL) {
+        goto cleanup;
+    }
+    size_t n = 0;
+    for (size_t j = 0; j < count; j++) {
+        for (uint32_t i = 1; (size_t)(i - 1) * 32 < jobs[j].key_len; i++) {
+            tasks[n].job = j;
+            tasks[n].block = i;
+            n++;
+        }
+    }
+    batch.jobs = jobs;
+    batch.tasks = tasks;
+    batch.task_count = task_count;
+    batch.next_task = 0;
+    batch.engine = engine;
+
+    int started = 0;
+    for (; started < threads; started++) {
+        workers[started].batch = &batch;
+        if (pthread_create(&tids[started], NULL, pbkdf2_worker, &workers[started]) != 0) {
+            break;
+        }
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    // 스레드를 하나도 못 만들면 여기서 직접 처리한다
+    if (started == 0) {
+        workers[0].batch = &batch;
+        pbkdf2_worker(&workers[0]);
+        started = 1;
+    }
+    size_t derived = 0;
+    int failed = 0;
+    for (int t = 0; t < started; t++) {
+        derived += workers[t].derived;
+        failed |= workers[t].failed;
+    }
+    ret = (!failed && derived == task_count) ? 0 : -1;
+
+cleanup:
+    free(tasks);
+    free(workers);
+    free(tids);
+    return ret;
+}
+
+/**
+ * 모든 코어(threads = 0)와 작업 수에 맞는 가장 넓은 엔진으로 count개 파생을 계산한다.
+ */
+static inline int pbkdf2_batch(Pbkdf2Job *jobs, size_t count, int threads) {
+    size_t tasks = 0;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int t = threads > 0 ? threads : (cores > 0 ? (int)cores : 1);
+
+    for (size_t j = 0; j < count; j++) {
+        tasks += (jobs[j].key_len + 31) / 32;
+    }
+    return pbkdf2_batch_engine(jobs, count, threads,
+                               pbkdf2_engine_for((tasks + (size_t)t - 1) / (size_t)t));
+}
+
+#endif /* PBKDF2_BATCH_H */
@@ -0,0 +1,742 @@
+/**
+ * secure_store.h - 섹터 단위 암호화/인증 저장소 (무결성 트리 포함)
+ *
+ * aes_cbc.c / aes_gcm.c는 데이터를 하나의 메시지로 다루므로 1바이트를 바꿔도
+ * 전체를 다시 암호화해야 한다. Critical Data Store처럼 작은 임의 쓰기가 잦은
+ * 영구 데이터에는 맞지 않는다. 이 엔진은 백업 파일 위에
+ *
+ *   - 4KB 섹터마다 독립적인 AES-256-GCM 봉인 (AAD = 섹터 번호)과
+ *   - 섹터 메타데이터(nonce, 태그)를 잎으로 하는 SHA-256 이진 해시 트리,
+ *   - 트리 루트를 HMAC-SHA256으로 인증하는 헤더를 둔다.
+ *
+ * 섹터 하나를 읽거나 쓰는 비용은 섹터 4KB의 AES-GCM과 트리 경로의 해시
+ * log2(n)개이다 (O(섹터 + log n)). 태그는 섹터 내용과 위치를, 트리는 각 섹터가
+ * "최신" 버전인지(옛 섹터 되돌리기 방지)를 보장한다.
+ *
+ * 파일 형식 (sstore-v2, 정수는 빅엔디언):
+ *   [0, 4096)          헤더: "SSTORE1\0" | u32 버전(2) | u32 섹터 크기 | u64 섹터 수
+ *                      | u64 세대 | u64 예약된 nonce 한계 | salt[16] | 루트[32]
+ *                      | HMAC[32] (앞 88바이트에 대한 HMAC-SHA256)
+ *   [4096, 20480)      저널 슬롯 2개 (8KB씩, 세대 g의 쓰기는 슬롯 g & 1):
+ *                      "SSJRNL1\0" | u64 세대 | u64 섹터 번호 | 메타[32] | 쓰기 후 루트[32]
+ *                      | HMAC[32] (앞 88바이트 || 암호문), 슬롯 +4096에 새 암호문 4096바이트
+ *   메타 영역          섹터마다 32바이트: nonce[12] | 태그[16] | 예약[4]
+ *   트리 영역          힙 배열 노드 1..2L-1 (32바이트씩, L = 2^k >= 섹터 수)
+ *                      잎 = SHA-256(0x00 | u64 섹터 번호 | nonce | 태그)
+ *                      내부 = SHA-256(0x01 | 왼쪽 | 오른쪽), 빈 잎은 0
+ *   데이터 영역        섹터 i의 암호문 4096바이트 (4KB 정렬)
+ *
+ *   키: K_data / K_mac = HKDF-SHA256(마스터 키, salt, "SSTORE1 data key" / "...mac key")
+ *   nonce = 0^4 | u64 쓰기 카운터 (저장소 전체에서 단조 증가)
+ *
+ * 보안상 주의:
+ *   - 쓰기는 먼저 기존 경로를 신뢰하는 루트로 검증한 뒤 형제 노드를 쓴다.
+ *     검증하지 않으면 변조된 형제 노드가 새 루트에 합법적으로 섞여 들어간다.
+ *   - nonce 카운터는 SSTORE_NONCE_RESERVE개씩 미리 헤더에 예약하고 fdatasync한
+ *     뒤에 사용하므로, 중간에 전원이 끊겨도 재시작 후 nonce를 재사용하지 않는다.
+ *   - 파일 전체를 옛 사본으로 되돌리는 공격은 파일 안에서는 막을 수 없다.
+ *     sstore_root()의 루트와 세대를 보안 NV 카운터 등 신뢰 저장소에 기록하라.
+ *   - 데이터, 메타/트리, 헤더는 제자리에서 고치므로 그 자체로는 원자적이지 않다.
+ *     그래서 쓰기마다 새 암호문과 메타, 쓰기 후 루트를 먼저 저널 슬롯에 기록하고
+ *     msync + fdatasync한 뒤(커밋) 제자리에 반영한다. 같은 동기화가 직전 쓰기의
+ *     제자리 반영도 디스크에 내리므로, 슬롯 두 개를 번갈아 쓰면 덮어쓰는 슬롯의
+ *     쓰기는 항상 이미 반영이 끝나 있다. 열 때 헤더 세대 g와 g + 1의 저널 기록을
+ *     확인하여, 반영이 덜 된 쪽을 마저 반영한다 (sstore_recover()). 따라서 전원이
+ *     끊겨도 저장소는 커밋된 마지막 쓰기 또는 그 직전 상태로 돌아온다.
+ *     저널 HMAC이 맞지 않는 기록(커밋 전에 끊긴 쓰기)은 무시한다.
+ *   - 핸들은 스레드 안전하지 않다 (호출자가 잠금).
+ *
+ * 반환 규약은 aes_gcm_decrypt()와 같다: 실패 -1, 인증 실패 -2.
+ */
+
+#ifndef SECURE_STORE_H
+#define SECURE_STORE_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/rand.h>
+#include "cipher_key.h"
+#include "digest_ctx.h"
+
+#define SSTORE_MAGIC "SSTORE1\0"
+#define SSTORE_VERSION 2
+#define SSTORE_SECTOR_SIZE 4096
+#define SSTORE_HEADER_SIZE 4096
+#define SSTORE_HEADER_MAC_OFFSET 88      // HMAC이 덮는 헤더 길이
+#define SSTORE_JOURNAL_MAGIC "SSJRNL1\0"
+#define SSTORE_JOURNAL_SLOT_SIZE 8192    // 기록 4KB + 암호문 4KB
+#define SSTORE_JOURNAL_SLOTS 2
+#define SSTORE_META_OFFSET (SSTORE_HEADER_SIZE + SSTORE_JOURNAL_SLOTS * SSTORE_JOURNAL_SLOT_SIZE)
+#define SSTORE_KEY_SIZE 32
+#define SSTORE_SALT_SIZE 16
+#define SSTORE_HASH_SIZE 32
+#define SSTORE_NONCE_SIZE 12
+#define SSTORE_TAG_SIZE 16
+#define SSTORE_META_SIZE 32
+#define SSTORE_NONCE_RESERVE 4096        // 헤더에 한 번에 예약하는 nonce 수
+#define SSTORE_MAX_SECTORS (UINT64_C(1) << 32)
+
+/**
+ * 섹터 메타데이터 (메타 영역에 그대로 저장)
+ */
+typedef struct {
+    unsigned char nonce[SSTORE_NONCE_SIZE];
+    unsigned char tag[SSTORE_TAG_SIZE];
+    unsigned char reserved[4];
+} SecureStoreMeta;
+
+/**
+ * 열린 저장소 핸들
+ */
+typedef struct {
+    int fd;
+    uint64_t sector_count;
+    uint64_t leaves;                     // L = 2^depth >= sector_count
+    int depth;
+    uint64_t generation;                 // 성공한 쓰기 수 (롤백 탐지용으로 외부에 기록)
+    uint64_t next_nonce;                 // 다음에 쓸 nonce 카운터
+    uint64_t nonce_reserved;             // 헤더에 기록된 예약 한계 (next_nonce < 이 값)
+    unsigned char salt[SSTORE_SALT_SIZE];
+    unsigned char root[SSTORE_HASH_SIZE];        // 신뢰하는 루트 (헤더 HMAC 검증 후)
+    EVP_MAC_CTX *header_mac;             // K_mac로 초기화된 HMAC (쓰기마다 재사용)
+    CipherKey data_key;                  // AES-256-GCM, 키 확장은 열 때 한 번
+    unsigned char *map;                  // 메타 + 트리 영역 mmap
+    size_t map_len;
+    SecureStoreMeta *meta;
+    unsigned char (*tree)[SSTORE_HASH_SIZE];
+    uint64_t data_offset;
+    int recovered;                       // 열 때 저널에서 마저 반영한 쓰기 수
+} SecureStore;
+
+static inline void sstore_put_be32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(v >> (24 - 8 * i));
+    }
+}
+
+static inline void sstore_put_be64(unsigned char *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)(v >> (56 - 8 * i));
+    }
+}
+
+static inline uint32_t sstore_get_be32(const unsigned char *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t sstore_get_be64(const unsigned char *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline uint64_t sstore_round_page(uint64_t n) {
+    return (n + 4095) & ~(uint64_t)4095;
+}
+
+/**
+ * 섹터 수로부터 트리 크기와 영역 배치를 정한다.
+ */
+static inline void sstore_layout(SecureStore *s, uint64_t sector_count) {
+    s->sector_count = sector_count;
+    s->leaves = 1;
+    s->depth = 0;
+    while (s->leaves < sector_count) {
+        s->leaves <<= 1;
+        s->depth++;
+    }
+    uint64_t meta_len = sstore_round_page(sector_count * SSTORE_META_SIZE);
+    uint64_t tree_len = sstore_round_page(2 * s->leaves * SSTORE_HASH_SIZE);
+    s->map_len = (size_t)(meta_len + tree_len);
+    s->data_offset = SSTORE_META_OFFSET + meta_len + tree_len;
+}
+
+/**
+ * 마스터 키와 salt로 데이터 키와 MAC 키를 파생한다.
+ */
+static inline int sstore_derive_keys(SecureStore *s, const unsigned char *master_key) {
+    static const char *const infos[2] = { "SSTORE1 data key", "SSTORE1 mac key" };
+    unsigned char data_key[SSTORE_KEY_SIZE], mac_key[SSTORE_KEY_SIZE];
+    unsigned char *outs[2] = { data_key, mac_key };
+    EVP_KDF *kdf = EVP_KDF_fetch(NULL, "HKDF", NULL);
+    int ok = (kdf != NULL);
+
+    for (int i = 0; ok && i < 2; i++) {
+        EVP_KDF_CTX *kctx = EVP_KDF_CTX_new(kdf);
+        OSSL_PARAM params[5];
+        params[0] = OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST, "SHA256", 0);
+        params[1] = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_KEY,
+                                                      (void *)master_key, SSTORE_KEY_SIZE);
+        params[2] = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_SALT,
+                                                      s->salt, SSTORE_SALT_SIZE);
+        params[3] = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_INFO,
+                                                      (void *)infos[i], strlen(infos[i]));
+        params[4] = OSSL_PARAM_construct_end();
+        ok = kctx != NULL && EVP_KDF_derive(kctx, outs[i], SSTORE_KEY_SIZE, params) == 1;
+        EVP_KDF_CTX_free(kctx);
+    }
+    EVP_KDF_free(kdf);
+    ok = ok && cipher_key_init(&s->data_key, "AES-256-GCM", data_key) == 0;
+
+    // HMAC 컨텍스트는 한 번만 fetch/키 설정하고, 헤더마다 키 없이 다시 초기화한다
+    EVP_MAC *mac = ok ? EVP_MAC_fetch(NULL, "HMAC", NULL) : NULL;
+    OSSL_PARAM mac_params[2] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, "SHA256", 0),
+        OSSL_PARAM_construct_end(),
+    };
+    s->header_mac = (mac != NULL) ? EVP_MAC_CTX_new(mac) : NULL;
+    ok = s->header_mac != NULL &&
+         EVP_MAC_init(s->header_mac, mac_key, SSTORE_KEY_SIZE, mac_params) == 1;
+    EVP_MAC_free(mac);
+    OPENSSL_cleanse(data_key, sizeof(data_key));
+    OPENSSL_cleanse(mac_key, sizeof(mac_key));
+    return ok ? 0 : -1;
+}
+
+/**
+ * 헤더 앞 88바이트의 HMAC-SHA256
+ */
+static inline int sstore_header_mac(const SecureStore *s, const unsigned char *header,
+                                    unsigned char *out) {
+    size_t out_len = 0;
+    return (EVP_MAC_init(s->header_mac, NULL, 0, NULL) == 1 &&
+            EVP_MAC_update(s->header_mac, header, SSTORE_HEADER_MAC_OFFSET) == 1 &&
+            EVP_MAC_final(s->header_mac, out, &out_len, SSTORE_HASH_SIZE) == 1 &&
+            out_len == SSTORE_HASH_SIZE) ? 0 : -1;
+}
+
+/**
+ * 현재 상태(세대, nonce 예약, 루트)로 헤더를 쓴다.
+ *
+ * @param sync 1이면 fdatasync까지 (nonce 예약 시)
+ */
+static inline int sstore_write_header(SecureStore *s, int sync) {
+    unsigned char header[SSTORE_HEADER_MAC_OFFSET + SSTORE_HASH_SIZE];
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, SSTORE_MAGIC, 8);
+    sstore_put_be32(header + 8, SSTORE_VERSION);
+    sstore_put_be32(header + 12, SSTORE_SECTOR_SIZE);
+    sstore_put_be64(header + 16, s->sector_count);
+    sstore_put_be64(header + 24, s->generation);
+    sstore_put_be64(header + 32, s->nonce_reserved);
+    memcpy(header + 40, s->salt, SSTORE_SALT_SIZE);
+    memcpy(header + 56, s->root, SSTORE_HASH_SIZE);
+    if (sstore_header_mac(s, header, header + SSTORE_HEADER_MAC_OFFSET) != 0 ||
+        pwrite(s->fd, header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        return -1;
+    }
+    return (sync && fdatasync(s->fd) != 0) ? -1 : 0;
+}
+
+/**
+ * 섹터 i의 잎 해시
+ */
+static inline int sstore_leaf_hash(uint64_t index, const SecureStoreMeta *m, unsigned char *out) {
+    unsigned char buf[1 + 8 + SSTORE_NONCE_SIZE + SSTORE_TAG_SIZE];
+    buf[0] = 0x00;
+    sstore_put_be64(buf + 1, index);
+    memcpy(buf + 9, m->nonce, SSTORE_NONCE_SIZE);
+    memcpy(buf + 9 + SSTORE_NONCE_SIZE, m->tag, SSTORE_TAG_SIZE);
+    return digest_sha256(buf, sizeof(buf), out);
+}
+
+static inline int sstore_node_hash(const unsigned char *left, const unsigned char *right,
+                                   unsigned char *out) {
+    unsigned char buf[1 + 2 * SSTORE_HASH_SIZE];
+    buf[0] = 0x01;
+    memcpy(buf + 1, left, SSTORE_HASH_SIZE);
+    memcpy(buf + 1 + SSTORE_HASH_SIZE, right, SSTORE_HASH_SIZE);
+    return digest_sha256(buf, sizeof(buf), out);
+}
+
+/**
+ * 잎 해시에서 출발해 저장된 형제 노드로 루트를 다시 계산하고, 신뢰하는
+ * 루트와 비교한다 (해시 depth개).
+ *
+ * @param siblings 검증된 형제 노드 사본 (NULL 가능, 쓰기 경로에서 재사용)
+ * @return 일치하면 0, 불일치 -2, 실패 -1
+ */
+static inline int sstore_verify_path(const SecureStore *s, uint64_t index,
+                                     const unsigned char *leaf,
+                                     unsigned char (*siblings)[SSTORE_HASH_SIZE]) {
+    unsigned char h[SSTORE_HASH_SIZE];
+    uint64_t node = s->leaves + index;
+
+    memcpy(h, leaf, SSTORE_HASH_SIZE);
+    for (int level = 0; node > 1; level++, node >>= 1) {
+        unsigned char sib[SSTORE_HASH_SIZE];
+        memcpy(sib, s->tree[node ^ 1], SSTORE_HASH_SIZE);   // 파일에서 한 번만 읽는다
+        if (siblings != NULL) {
+            memcpy(siblings[level], sib, SSTORE_HASH_SIZE);
+        }
+        int r = (node & 1) ? sstore_node_hash(sib, h, h) : sstore_node_hash(h, sib, h);
+        if (r != 0) {
+            return -1;
+        }
+    }
+    return (CRYPTO_memcmp(h, s->root, SSTORE_HASH_SIZE) == 0) ? 0 : -2;
+}
+
+/**
+ * 섹터 메타 m으로 잎부터 루트까지 경로 노드를 계산한다.
+ *
+ * @param siblings 검증된 형제 노드 (NULL이면 트리에서 읽음)
+ * @param nodes 결과: nodes[0] = 잎, nodes[depth] = 루트
+ */
+static inline int sstore_path_nodes(const SecureStore *s, uint64_t index, const SecureStoreMeta *m,
+                                    unsigned char (*siblings)[SSTORE_HASH_SIZE],
+                                    unsigned char (*nodes)[SSTORE_HASH_SIZE]) {
+    uint64_t node = s->leaves + index;
+
+    if (sstore_leaf_hash(index, m, nodes[0]) != 0) {
+        return -1;
+    }
+    for (int level = 0; node > 1; level++, node >>= 1) {
+        const unsigned char *sib = (siblings != NULL) ? siblings[level] : s->tree[node ^ 1];
+        int r = (node & 1) ? sstore_node_hash(sib, nodes[level], nodes[level + 1])
+                           : sstore_node_hash(nodes[level], sib, nodes[level + 1]);
+        if (r != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 계산한 경로를 메타/트리(mmap)와 메모리의 루트에 반영한다.
+ */
+static inline void sstore_apply_path(SecureStore *s, uint64_t index, const SecureStoreMeta *m,
+                                     unsigned char (*nodes)[SSTORE_HASH_SIZE]) {
+    uint64_t node = s->leaves + index;
+
+    memcpy(&s->meta[index], m, sizeof(*m));
+    for (int level = 0; level <= s->depth; level++, node >>= 1) {
+        memcpy(s->tree[node], nodes[level], SSTORE_HASH_SIZE);
+    }
+    memcpy(s->root, nodes[s->depth], SSTORE_HASH_SIZE);
+}
+
+/**
+ * 저널 기록(앞 88바이트)과 새 암호문에 대한 HMAC-SHA256
+ */
+static inline int sstore_journal_mac(const SecureStore *s, const unsigned char *record,
+                                     const unsigned char *ct, unsigned char *out) {
+    size_t out_len = 0;
+    return (EVP_MAC_init(s->header_mac, NULL, 0, NULL) == 1 &&
+            EVP_MAC_update(s->header_mac, record, SSTORE_HEADER_MAC_OFFSET) == 1 &&
+            EVP_MAC_update(s->header_mac, ct, SSTORE_SECTOR_SIZE) == 1 &&
+            EVP_MAC_final(s->header_mac, out, &out_len, SSTORE_HASH_SIZE) == 1 &&
+            out_len == SSTORE_HASH_SIZE) ? 0 : -1;
+}
+
+static inline off_t sstore_journal_offset(uint64_t generation) {
+    return (off_t)(SSTORE_HEADER_SIZE + (generation & 1) * SSTORE_JOURNAL_SLOT_SIZE);
+}
+
+/**
+ * 섹터를 nonce 카운터로 봉인한다. 예약 한계에 닿으면 먼저 헤더에 다음 구간을
+ * 예약하고 디스크에 반영한다.
+ */
+static inline int sstore_seal_sector(SecureStore *s, uint64_t index, const unsigned char *plain,
+                                     unsigned char *ct, SecureStoreMeta *m) {
+    unsigned char aad[8];
+
+    if (s->next_nonce >= s->nonce_reserved) {
+        s->nonce_reserved = s->next_nonce + SSTORE_NONCE_RESERVE;
+        if (sstore_write_header(s, 1) != 0) {
+            return -1;
+        }
+    }
+    memset(m, 0, sizeof(*m));
+    sstore_put_be64(m->nonce + 4, s->next_nonce++);
+    sstore_put_be64(aad, index);
+    return cipher_key_seal(&s->data_key, m->nonce, aad, sizeof(aad), plain,
+                           SSTORE_SECTOR_SIZE, ct, m->tag);
+}
+
+static inline int sstore_map(SecureStore *s) {
+    void *p = mmap(NULL, s->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, s->fd,
+                   SSTORE_META_OFFSET);
+    if (p == MAP_FAILED) {
+        return -1;
+    }
+    s->map = (unsigned char *)p;
+    s->meta = (SecureStoreMeta *)s->map;
+    s->tree = (unsigned char (*)[SSTORE_HASH_SIZE])(s->map + s->map_len -
+                                                    sstore_round_page(2 * s->leaves *
+                                                                      SSTORE_HASH_SIZE));
+    return 0;
+}
+
+/**
+ * 핸들을 닫는다 (메타/트리 변경은 munmap으로 파일에 반영됨).
+ */
+static inline void sstore_close(SecureStore *s) {
+    if (s->map != NULL) {
+        munmap(s->map, s->map_len);
+    }
+    if (s->fd >= 0) {
+        close(s->fd);
+    }
+    cipher_key_free(&s->data_key);
+    EVP_MAC_CTX_free(s->header_mac);
+    memset(s, 0, sizeof(*s));
+    s->fd = -1;
+}
+
+/**
+ * 모든 메타/트리(mmap)와 pwrite한 데이터/저널/헤더를 디스크에 반영한다.
+ */
+static inline int sstore_flush(SecureStore *s) {
+    return (msync(s->map, s->map_len, MS_SYNC) == 0 && fdatasync(s->fd) == 0) ? 0 : -1;
+}
+
+/**
+ * 새 저장소를 만든다. 모든 섹터를 0으로 채워 봉인하고 트리를 세운다 (O(n), 한 번).
+ *
+ * @param sector_count 섹터 수 (1 ~ 2^32)
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int sstore_create(const char *path, const unsigned char *master_key,
+                                uint64_t sector_count) {
+    static const unsigned char zero[SSTORE_SECTOR_SIZE];
+    unsigned char ct[SSTORE_SECTOR_SIZE];
+    SecureStore s;
+    int ok;
+
+    memset(&s, 0, sizeof(s));
+    s.fd = -1;
+    if (sector_count == 0 || sector_count > SSTORE_MAX_SECTORS) {
+        fprintf(stderr, "섹터 수는 1 ~ %llu\n", (unsigned long long)SSTORE_MAX_SECTORS);
+        return -1;
+    }
+    sstore_layout(&s, sector_count);
+    s.next_nonce = 1;
+    s.fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    ok = s.fd >= 0 && RAND_bytes(s.salt, SSTORE_SALT_SIZE) == 1 &&
+         sstore_derive_keys(&s, master_key) == 0 &&
+         ftruncate(s.fd, (off_t)(s.data_offset + sector_count * SSTORE_SECTOR_SIZE)) == 0 &&
+         sstore_map(&s) == 0;
+
+    // 섹터 봉인 + 잎
+    for (uint64_t i = 0; ok && i < sector_count; i++) {
+        ok = sstore_seal_sector(&s, i, zero, ct, &s.meta[i]) == 0 &&
+             pwrite(s.fd, ct, SSTORE_SECTOR_SIZE,
+                    (off_t)(s.data_offset + i * SSTORE_SECTOR_SIZE)) == SSTORE_SECTOR_SIZE &&
+             sstore_leaf_hash(i, &s.meta[i], s.tree[s.leaves + i]) == 0;
+    }
+    // 내부 노드 (빈 잎은 ftruncate로 이미 0)
+    for (uint64_t node = s.leaves - 1; ok && node >= 1; node--) {
+        ok = sstore_node_hash(s.tree[2 * node], s.tree[2 * node + 1], s.tree[node]) == 0;
+    }
+    if (ok) {
+        memcpy(s.root, s.tree[1], SSTORE_HASH_SIZE);
+        ok = sstore_write_header(&s, 0) == 0 && sstore_flush(&s) == 0;
+    }
+    sstore_close(&s);
+    if (!ok) {
+        unlink(path);
+    }
+    return ok ? 0 : -1;
+}
+
+/**
+ * 세대 generation의 저널 기록을 확인하고, 제자리 반영이 덜 되었으면 마저 반영한다.
+ *
+ * 기록의 HMAC이 맞고, 기록의 메타와 현재 트리의 형제 노드로 계산한 루트가 기록된
+ * 쓰기 후 루트와 같을 때만 반영한다. 이미 반영된 기록이면 아무것도 쓰지 않는다.
+ *
+ * @return 반영했으면 1, 반영할 것이 없으면 0, 실패 시 -1
+ */
+static inline int sstore_replay(SecureStore *s, uint64_t generation) {
+    unsigned char record[SSTORE_HEADER_MAC_OFFSET + SSTORE_HASH_SIZE];
+    unsigned char ct[SSTORE_SECTOR_SIZE], disk[SSTORE_SECTOR_SIZE], mac[SSTORE_HASH_SIZE];
+    unsigned char nodes[65][SSTORE_HASH_SIZE];
+    SecureStoreMeta m;
+    off_t slot = sstore_journal_offset(generation);
+
+    if (pread(s->fd, record, sizeof(record), slot) != (ssize_t)sizeof(record) ||
+        pread(s->fd, ct, sizeof(ct), slot + SSTORE_HEADER_SIZE) != (ssize_t)sizeof(ct)) {
+        return -1;
+    }
+    uint64_t index = sstore_get_be64(record + 16);
+    if (memcmp(record, SSTORE_JOURNAL_MAGIC, 8) != 0 ||
+        sstore_get_be64(record + 8) != generation || index >= s->sector_count ||
+        sstore_journal_mac(s, record, ct, mac) != 0 ||
+        CRYPTO_memcmp(mac, record + SSTORE_HEADER_MAC_OFFSET, SSTORE_HASH_SIZE) != 0) {
+        return 0;   // 빈 슬롯, 덮어쓴 옛 기록, 커밋 전에 끊긴 기록
+    }
+    memcpy(&m, record + 24, sizeof(m));
+    if (sstore_path_nodes(s, index, &m, NULL, nodes) != 0) {
+        return -1;
+    }
+    if (CRYPTO_memcmp(nodes[s->depth], record + 56, SSTORE_HASH_SIZE) != 0) {
+        return 0;   // 형제 노드가 기록과 맞지 않음: 반영하지 않고 읽기 검증에 맡긴다
+    }
+
+    // 이 쓰기에서 쓴 nonce는 예약 한계와 무관하게 다시 쓰지 않는다
+    uint64_t counter = sstore_get_be64(m.nonce + 4);
+    if (counter >= s->next_nonce) {
+        s->next_nonce = counter + 1;
+    }
+
+    uint64_t node = s->leaves + index;
+    int applied = generation == s->generation &&
+                  memcmp(s->root, nodes[s->depth], SSTORE_HASH_SIZE) == 0 &&
+                  memcmp(&s->meta[index], &m, sizeof(m)) == 0 &&
+                  pread(s->fd, disk, sizeof(disk),
+                        (off_t)(s->data_offset + index * SSTORE_SECTOR_SIZE)) ==
+                      (ssize_t)sizeof(disk) &&
+                  memcmp(disk, ct, sizeof(ct)) == 0;
+    for (int level = 0; applied && level <= s->depth; level++, node >>= 1) {
+        applied = memcmp(s->tree[node], nodes[level], SSTORE_HASH_SIZE) == 0;
+    }
+    if (applied) {
+        return 0;
+    }
+
+    if (pwrite(s->fd, ct, SSTORE_SECTOR_SIZE,
+               (off_t)(s->data_offset + index * SSTORE_SECTOR_SIZE)) != SSTORE_SECTOR_SIZE) {
+        return -1;
+    }
+    sstore_apply_path(s, index, &m, nodes);
+    s->generation = generation;
+    return 1;
+}
+
+/**
+ * 중단된 쓰기를 복구한다: 헤더 세대 g의 기록(헤더는 썼지만 데이터/트리가 덜
+ * 내려갔을 수 있음)과 g + 1의 기록(커밋 후 헤더까지 가지 못함)을 차례로 반영하고
+ * 디스크에 내린다.
+ *
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int sstore_recover(SecureStore *s) {
+    uint64_t next_nonce = s->next_nonce;
+    int replayed = 0;
+
+    for (uint64_t g = s->generation; g <= s->generation + 1; g++) {
+        if (g == 0) {
+            continue;   // 생성 직후에는 기록이 없다
+        }
+        int r = sstore_replay(s, g);
+        if (r < 0) {
+            return -1;
+        }
+        replayed += r;
+    }
+    if (s->next_nonce > next_nonce) {
+        s->nonce_reserved = s->next_nonce;   // 다음 쓰기에서 새 구간을 예약하게 함
+    }
+    s->recovered = replayed;
+    if (replayed == 0 && s->next_nonce == next_nonce) {
+        return 0;
+    }
+    return (sstore_write_header(s, 0) == 0 && sstore_flush(s) == 0) ? 0 : -1;
+}
+
+/**
+ * 저장소를 연다. 헤더 HMAC을 검증하고 (O(1)), 저널로 중단된 쓰기를 복구한다
+ * (섹터 하나). 섹터와 트리는 접근할 때 검증한다.
+ *
+ * @return 성공 시 0, 실패 시 -1, 헤더 인증 실패(변조/잘못된 키) 시 -2
+ */
+static inline int sstore_open(SecureStore *s, const char *path, const unsigned char *master_key) {
+    unsigned char header[SSTORE_HEADER_MAC_OFFSET + SSTORE_HASH_SIZE];
+    unsigned char mac[SSTORE_HASH_SIZE];
+    struct stat st;
+
+    memset(s, 0, sizeof(*s));
+    s->fd = open(path, O_RDWR);
+    if (s->fd < 0 || fstat(s->fd, &st) != 0 ||
+        pread(s->fd, header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        memcmp(header, SSTORE_MAGIC, 8) != 0 || sstore_get_be32(header + 8) != SSTORE_VERSION ||
+        sstore_get_be32(header + 12) != SSTORE_SECTOR_SIZE ||
+        sstore_get_be64(header + 16) == 0 || sstore_get_be64(header + 16) > SSTORE_MAX_SECTORS) {
+        sstore_close(s);
+        return -1;
+    }
+    memcpy(s->salt, header + 40, SSTORE_SALT_SIZE);
+    if (sstore_derive_keys(s, master_key) != 0 || sstore_header_mac(s, header, mac) != 0) {
+        sstore_close(s);
+        return -1;
+    }
+    if (CRYPTO_memcmp(mac, header + SSTORE_HEADER_MAC_OFFSET, SSTORE_HASH_SIZE) != 0) {
+        sstore_close(s);
+        return -2;
+    }
+    sstore_layout(s, sstore_get_be64(header + 16));
+    s->generation = sstore_get_be64(header + 24);
+    s->nonce_reserved = sstore_get_be64(header + 32);
+    s->next_nonce = s->nonce_reserved;   // 이전 예약 구간의 나머지는 버린다
+    memcpy(s->root, header + 56, SSTORE_HASH_SIZE);
+    if ((uint64_t)st.st_size != s->data_offset + s->sector_count * SSTORE_SECTOR_SIZE ||
+        sstore_map(s) != 0) {
+        sstore_close(s);
+        return -2;   // 크기가 헤더와 맞지 않음 (절단/연장)
+    }
+    if (sstore_recover(s) != 0) {
+        sstore_close(s);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * 섹터 하나를 읽는다: 경로 검증(해시 log n개) + 섹터 복호화.
+ *
+ * @param out 4096바이트 평문 (인증 실패 시 0으로 지움)
+ * @return 성공 시 0, 실패 시 -1, 인증 실패 시 -2
+ */
+static inline int sstore_read(SecureStore *s, uint64_t index, unsigned char *out) {
+    unsigned char ct[SSTORE_SECTOR_SIZE], leaf[SSTORE_HASH_SIZE], aad[8];
+    SecureStoreMeta m;
+
+    if (index >= s->sector_count ||
+        pread(s->fd, ct, SSTORE_SECTOR_SIZE,
+              (off_t)(s->data_offset + index * SSTORE_SECTOR_SIZE)) != SSTORE_SECTOR_SIZE) {
+        return -1;
+    }
+    memcpy(&m, &s->meta[index], sizeof(m));   // 검증과 복호화에 같은 사본을 쓴다
+    if (sstore_leaf_hash(index, &m, leaf) != 0) {
+        return -1;
+    }
+    int r = sstore_verify_path(s, index, leaf, NULL);
+    if (r == 0) {
+        sstore_put_be64(aad, index);
+        r = cipher_key_open(&s->data_key, m.nonce, aad, sizeof(aad), ct, SSTORE_SECTOR_SIZE,
+                            m.tag, out);
+    }
+    if (r != 0) {
+        OPENSSL_cleanse(out, SSTORE_SECTOR_SIZE);
+    }
+    return r;
+}
+
+/**
+ * 섹터 하나를 쓴다: 기존 경로 검증 → 봉인 → 새 경로 계산(해시 log n개) →
+ * 저널 기록 + 동기화(커밋) → 데이터/메타/트리/헤더 제자리 반영.
+ *
+ * 동기화는 쓰기마다 한 번(msync + fdatasync)이며, 반환 시 쓰기는 커밋되어 있다.
+ *
+ * @param data 4096바이트 평문
+ * @return 성공 시 0, 실패 시 -1, 기존 경로 인증 실패 시 -2 (아무것도 쓰지 않음)
+ */
+static inline int sstore_write(SecureStore *s, uint64_t index, const unsigned char *data) {
+    unsigned char ct[SSTORE_SECTOR_SIZE], h[SSTORE_HASH_SIZE];
+    unsigned char siblings[64][SSTORE_HASH_SIZE], nodes[65][SSTORE_HASH_SIZE];
+    unsigned char record[SSTORE_HEADER_MAC_OFFSET + SSTORE_HASH_SIZE];
+    SecureStoreMeta old, m;
+
+    if (index >= s->sector_count) {
+        return -1;
+    }
+    memcpy(&old, &s->meta[index], sizeof(old));
+    if (sstore_leaf_hash(index, &old, h) != 0) {
+        return -1;
+    }
+    int r = sstore_verify_path(s, index, h, siblings);
+    if (r != 0) {
+        return r;
+    }
+    // 검증된 형제 노드로 새 경로를 계산한다
+    if (sstore_seal_sector(s, index, data, ct, &m) != 0 ||
+        sstore_path_nodes(s, index, &m, siblings, nodes) != 0) {
+        return -1;
+    }
+
+    // 커밋: 저널 기록을 쓰고, 이 기록과 직전 쓰기의 제자리 반영을 함께 디스크에 내린다
+    uint64_t generation = s->generation + 1;
+    off_t slot = sstore_journal_offset(generation);
+    memset(record, 0, sizeof(record));
+    memcpy(record, SSTORE_JOURNAL_MAGIC, 8);
+    sstore_put_be64(record + 8, generation);
+    sstore_put_be64(record + 16, index);
+    memcpy(record + 24, &m, sizeof(m));
+    memcpy(record + 56, nodes[s->depth], SSTORE_HASH_SIZE);
+    if (sstore_journal_mac(s, record, ct, record + SSTORE_HEADER_MAC_OFFSET) != 0 ||
+        pwrite(s->fd, ct, SSTORE_SECTOR_SIZE, slot + SSTORE_HEADER_SIZE) != SSTORE_SECTOR_SIZE ||
+        pwrite(s->fd, record, sizeof(record), slot) != (ssize_t)sizeof(record) ||
+        sstore_flush(s) != 0) {
+        return -1;
+    }
+
+    // 제자리 반영 (여기서 끊기면 다음 열기에서 저널로 마저 반영)
+    if (pwrite(s->fd, ct, SSTORE_SECTOR_SIZE,
+               (off_t)(s->data_offset + index * SSTORE_SECTOR_SIZE)) != SSTORE_SECTOR_SIZE) {
+        return -1;
+    }
+    sstore_apply_path(s, index, &m, nodes);
+    s->generation = generation;
+    return sstore_write_header(s, 0);
+}
+
+/**
+ * 외부 신뢰 저장소에 기록할 루트와 세대 (파일 전체 롤백 탐지용)
+ */
+static inline void sstore_root(const SecureStore *s, unsigned char *root, uint64_t *generation) {
+    memcpy(root, s->root, SSTORE_HASH_SIZE);
+    if (generation != NULL) {
+        *generation = s->generation;
+    }
+}
+
+/**
+ * 전체 검사 (O(n)): 트리를 잎부터 다시 세워 루트와 비교하고 모든 섹터를 연다.
+ *
+ * @param bad_sectors 인증에 실패한 섹터 수 (NULL 가능)
+ * @return 모두 정상이면 0, 하나라도 실패하면 -2, 실패 시 -1
+ */
+static inline int sstore_verify_all(SecureStore *s, uint64_t *bad_sectors) {
+    size_t tree_bytes = (size_t)(2 * s->leaves * SSTORE_HASH_SIZE);
+    unsigned char (*tree)[SSTORE_HASH_SIZE] = calloc(1, tree_bytes);
+    unsigned char ct[SSTORE_SECTOR_SIZE], pt[SSTORE_SECTOR_SIZE], aad[8];
+    uint64_t bad = 0;
+    int ret = 0;
+
+    if (tree == NULL) {
+        return -1;
+    }
+    for (uint64_t i = 0; i < s->sector_count && ret == 0; i++) {
+        SecureStoreMeta m;
+        memcpy(&m, &s->meta[i], sizeof(m));
+        sstore_put_be64(aad, i);
+        if (sstore_leaf_hash(i, &m, tree[s->leaves + i]) != 0 ||
+            pread(s->fd, ct, SSTORE_SECTOR_SIZE,
+                  (off_t)(s->data_offset + i * SSTORE_SECTOR_SIZE)) != SSTORE_SECTOR_SIZE) {
+            ret = -1;
+        } else if (cipher_key_open(&s->data_key, m.nonce, aad, sizeof(aad), ct,
+                                   SSTORE_SECTOR_SIZE, m.tag, pt) != 0) {
+            bad++;
+        }
+    }
+    for (uint64_t node = s->leaves - 1; ret == 0 && node >= 1; node--) {
+        if (sstore_node_hash(tree[2 * node], tree[2 * node + 1], tree[node]) != 0) {
+            ret = -1;
+        }
+    }
+    if (ret == 0 && (bad > 0 || CRYPTO_memcmp(tree[1], s->root, SSTORE_HASH_SIZE) != 0)) {
+        ret = -2;
+    }
+    OPENSSL_cleanse(pt, sizeof(pt));
+    free(tree);
+    if (bad_sectors != NULL) {
+        *bad_sectors = bad;
+    }
+    return ret;
+}
+
+#endif /* SECURE_STORE_H */
@@ -0,0 +1,792 @@
+/**
+ * telemetry_log.c - 추가 전용 암호화 텔레메트리 로그 도구
+ *
+ * telemetry_log.h의 tlog-v2 형식으로 레코드를 세그먼트 단위로 봉인하여 쌓고,
+ * 시간 범위 질의는 색인으로 겹치는 세그먼트만 복호화한다. 추가 처리량과
+ * 시간 범위 질의 지연(수 GB 로그)을 레코드별 봉인/전체 복호화와 비교한다.
+ *
+ * 빌드: make
+ * 실행: ./bin/telemetry_log keygen <키 파일>
+ *       ./bin/telemetry_log append <로그> <키 파일> [-g 세그먼트KB]   (표준 입력 "<시각> <내용>" 줄)
+ *       ./bin/telemetry_log query <로그> <키 파일> <시작 시각> <끝 시각>
+ *       ./bin/telemetry_log info <로그> <키 파일>
+ *       ./bin/telemetry_log test
+ *       ./bin/telemetry_log bench [-s 크기MB] [-r 레코드B] [-g 세그먼트KB] [-q 질의 수]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "telemetry_log.h"
+
+#define DEFAULT_BENCH_MB 2048
+#define DEFAULT_BENCH_RECORD 64
+#define DEFAULT_BENCH_QUERIES 200
+#define LINE_MAX_BYTES 4096
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t xorshift64(uint64_t *x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+/**
+ * 32바이트 원시 키 파일을 읽는다.
+ */
+static int load_key(const char *path, unsigned char *key) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror("키 파일 열기 실패");
+        return -1;
+    }
+    unsigned char extra;
+    size_t n = fread(key, 1, TLOG_KEY_SIZE, f);
+    int ok = (n == TLOG_KEY_SIZE && fread(&extra, 1, 1, f) == 0);
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "키 파일은 정확히 %d바이트여야 합니다\n", TLOG_KEY_SIZE);
+        OPENSSL_cleanse(key, TLOG_KEY_SIZE);
+        return -1;
+    }
+    return 0;
+}
+
+static int cmd_keygen(const char *path) {
+    unsigned char key[TLOG_KEY_SIZE];
+    if (RAND_bytes(key, sizeof(key)) != 1) {
+        return 1;
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+    int ok = fd >= 0 && write(fd, key, sizeof(key)) == (ssize_t)sizeof(key);
+    if (fd >= 0) close(fd);
+    OPENSSL_cleanse(key, sizeof(key));
+    if (!ok) {
+        perror("키 파일 쓰기 실패");
+        return 1;
+    }
+    printf("✓ 키 생성: %s\n", path);
+    return 0;
+}
+
+static const char *error_text(int ret) {
+    return (ret == -2) ? "인증 실패 (변조/재배열 또는 잘못된 키)" : "처리 실패";
+}
+
+/**
+ * 키를 읽고 로그를 연다.
+ */
+static int open_log(TelemetryLog *log, const char *path, const char *key_path, int mode,
+                    uint32_t segment_size) {
+    unsigned char key[TLOG_KEY_SIZE];
+    if (load_key(key_path, key) != 0) {
+        return -1;
+    }
+    int r = tlog_open(log, path, key, mode, segment_size);
+    OPENSSL_cleanse(key, sizeof(key));
+    if (r != 0) {
+        fprintf(stderr, "✗ 로그 열기 %s\n", error_text(r));
+    }
+    return r;
+}
+
+static int cmd_append(const char *path, const char *key_path, uint32_t segment_size) {
+    TelemetryLog log;
+    int mode = (access(path, F_OK) == 0) ? TLOG_OPEN_WRITE : TLOG_OPEN_CREATE;
+    if (open_log(&log, path, key_path, mode, segment_size) != 0) {
+        return 1;
+    }
+    char line[LINE_MAX_BYTES];
+    unsigned long long appended = 0;
+    int ok = 1;
+    while (ok && fgets(line, sizeof(line), stdin) != NULL) {
+        char *end;
+        long long ts = strtoll(line, &end, 10);
+        if (end == line) {
+            continue;   // 시각이 없는 줄은 건너뛴다
+        }
+        if (*end == ' ') end++;
+        size_t len = strcspn(end, "\n");
+        if (tlog_append(&log, ts, end, len) != 0) {
+            fprintf(stderr, "✗ 레코드 추가 실패 (시각 %lld: 단조 증가가 아니거나 너무 김)\n", ts);
+            ok = 0;
+        } else {
+            appended++;
+        }
+    }
+    ok = (tlog_close(&log) == 0) && ok;
+    fprintf(stderr, "%s 레코드 %llu개 추가\n", ok ? "✓" : "✗", appended);
+    return ok ? 0 : 1;
+}
+
+static int print_record(int64_t ts, const unsigned char *data, size_t len, void *arg) {
+    (void)arg;
+    printf("%lld %.*s\n", (long long)ts, (int)len, (const char *)data);
+    return 0;
+}
+
+static int cmd_query(const char *path, const char *key_path, int64_t from, int64_t to) {
+    TelemetryLog log;
+    if (open_log(&log, path, key_path, TLOG_OPEN_READ, 0) != 0) {
+        return 1;
+    }
+    TlogQueryStats stats;
+    double t0 = now_seconds();
+    long long n = tlog_query(&log, from, to, print_record, NULL, &stats);
+    double elapsed = now_seconds() - t0;
+    if (n < 0) {
+        fprintf(stderr, "✗ 질의 %s\n", error_text((int)n));
+    } else {
+        fprintf(stderr, "✓ 레코드 %lld개 (세그먼트 %llu/%llu개 복호화, 색인 검증 %llu개, %.3f ms)\n",
+                n, (unsigned long long)stats.segments_read,
+                (unsigned long long)tlog_segment_count(&log),
+                (unsigned long long)stats.entries_verified, elapsed * 1e3);
+    }
+    tlog_close(&log);
+    return n < 0 ? 1 : 0;
+}
+
+static int cmd_info(const char *path, const char *key_path) {
+    TelemetryLog log;
+    if (open_log(&log, path, key_path, TLOG_OPEN_READ, 0) != 0) {
+        return 1;
+    }
+    uint64_t records = 0;
+    for (size_t i = 0; i < log.seg_count; i++) {
+        records += log.segs[i].records;
+    }
+    printf("로그: %s\n", path);
+    printf("  세그먼트 크기 %u KB, 세그먼트 %llu개, 레코드 %llu개, %.1f MB\n",
+           log.segment_size / 1024, (unsigned long long)log.seg_count,
+           (unsigned long long)records, (double)log.end_offset / (1024.0 * 1024.0));
+    if (log.seg_count > 0) {
+        printf("  시각 범위 %lld ~ %lld\n", (long long)log.segs[0].first_ts,
+               (long long)log.segs[log.seg_count - 1].last_ts);
+    }
+    tlog_close(&log);
+    return 0;
+}
+
+/* ===== 자체 테스트 / 벤치마크 ===== */
+
+static int check(const char *name, int cond, int *failures) {
+    printf("  %s %s\n", cond ? "✓" : "✗", name);
+    if (!cond) (*failures)++;
+    return cond;
+}
+
+/**
+ * 결정론적 테스트 레코드 i (길이 0~300, 시각은 0~3씩 증가하여 중복 포함)
+ */
+static size_t test_record(uint64_t i, unsigned char *buf) {
+    size_t len = (size_t)((i * 37) % 301);
+    for (size_t j = 0; j < len; j++) {
+        buf[j] = (unsigned char)(i + j * 7);
+    }
+    return len;
+}
+
+typedef struct {
+    uint64_t hash;
+    uint64_t count;
+} Digest;
+
+static void digest_record(Digest *d, int64_t ts, const unsigned char *data, size_t len) {
+    d->hash = (d->hash ^ (uint64_t)ts) * 0x100000001b3ULL;
+    for (size_t i = 0; i < len; i++) {
+        d->hash = (d->hash ^ data[i]) * 0x100000001b3ULL;
+    }
+    d->hash = (d->hash ^ len) * 0x100000001b3ULL;
+    d->count++;
+}
+
+static int digest_cb(int64_t ts, const unsigned char *data, size_t len, void *arg) {
+    digest_record((Digest *)arg, ts, data, len);
+    return 0;
+}
+
+/**
+ * 기대값: 레코드를 처음부터 훑어 범위에 든 것만 요약한다.
+ */
+static Digest expected_range(const int64_t *ts, uint64_t count, int64_t from, int64_t to) {
+    unsigned char buf[512];
+    Digest d = { 0xcbf29ce484222325ULL, 0 };
+    for (uint64_t i = 0; i < count; i++) {
+        if (ts[i] >= from && ts[i] <= to) {
+            size_t len = test_record(i, buf);
+            digest_record(&d, ts[i], buf, len);
+        }
+    }
+    return d;
+}
+
+static int query_matches(TelemetryLog *log, const int64_t *ts, uint64_t count,
+                         int64_t from, int64_t to, TlogQueryStats *stats) {
+    Digest got = { 0xcbf29ce484222325ULL, 0 };
+    Digest want = expected_range(ts, count, from, to);
+    long long n = tlog_query(log, from, to, digest_cb, &got, stats);
+    return n == (long long)want.count && got.count == want.count && got.hash == want.hash;
+}
+
+static int append_range(const char *path, const unsigned char *key, int mode,
+                        const int64_t *ts, uint64_t begin, uint64_t end) {
+    TelemetryLog log;
+    unsigned char buf[512];
+    if (tlog_open(&log, path, key, mode, TLOG_MIN_SEGMENT) != 0) {
+        return -1;
+    }
+    int ok = 1;
+    for (uint64_t i = begin; ok && i < end; i++) {
+        size_t len = test_record(i, buf);
+        ok = tlog_append(&log, ts[i], buf, len) == 0;
+    }
+    return (tlog_close(&log) == 0 && ok) ? 0 : -1;
+}
+
+/**
+ * 열기 + 전체 범위 질의 결과 코드
+ */
+static long long reopen_query_all(const char *path, const unsigned char *key, const int64_t *ts,
+                                  uint64_t count, int *matches) {
+    TelemetryLog log;
+    int r = tlog_open(&log, path, key, TLOG_OPEN_READ, 0);
+    if (r != 0) {
+        return r;
+    }
+    TlogQueryStats stats;
+    Digest got = { 0xcbf29ce484222325ULL, 0 };
+    long long n = tlog_query(&log, INT64_MIN, INT64_MAX, digest_cb, &got, &stats);
+    if (matches != NULL) {
+        Digest want = expected_range(ts, count, INT64_MIN, INT64_MAX);
+        *matches = n >= 0 && got.count == want.count && got.hash == want.hash;
+    }
+    tlog_close(&log);
+    return n;
+}
+
+static int flip_byte(const char *path, uint64_t offset) {
+    unsigned char b;
+    int fd = open(path, O_RDWR);
+    int ok = fd >= 0 && tlog_pread_full(fd, &b, 1, offset) == 0;
+    b ^= 0x01;
+    ok = ok && tlog_pwrite_full(fd, &b, 1, offset) == 0;
+    if (fd >= 0) close(fd);
+    return ok ? 0 : -1;
+}
+
+/**
+ * 왕복, 무작위 범위 질의(전수 비교), 이어 쓰기, 색인 재구성, 끊긴 꼬리 복구,
+ * 변조/색인 위조/색인 손상/잘못된 키를 확인한다.
+ */
+static int cmd_test(void) {
+    char dir[] = "/tmp/telemetry_log_XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("임시 디렉터리 생성 실패");
+        return 1;
+    }
+    char path[128], index_path[160];
+    snprintf(path, sizeof(path), "%s/log", dir);
+    snprintf(index_path, sizeof(index_path), "%s.idx", path);
+
+    const uint64_t first = 20000, total = 26000;
+    int64_t *ts = malloc((total + 1) * sizeof(*ts));   // 마지막은 같은 시각 레코드용
+    unsigned char key[TLOG_KEY_SIZE], wrong[TLOG_KEY_SIZE];
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    TelemetryLog log;
+    TlogQueryStats stats;
+    int failures = 0, ok, matches = 0;
+    long long n;
+
+    if (ts == NULL) {
+        rmdir(dir);
+        return 1;
+    }
+    ts[0] = -1000;   // 음수 시각도 허용
+    for (uint64_t i = 1; i < total; i++) {
+        ts[i] = ts[i - 1] + (int64_t)(xorshift64(&x) % 4);
+    }
+    ts[total] = ts[total - 1];
+    RAND_bytes(key, sizeof(key));
+    RAND_bytes(wrong, sizeof(wrong));
+    printf("=== tlog-v2 자체 테스트 ===\n\n");
+
+    // 왕복
+    ok = append_range(path, key, TLOG_OPEN_CREATE, ts, 0, first) == 0;
+    n = ok ? reopen_query_all(path, key, ts, first, &matches) : -1;
+    check("레코드 20000개 추가 후 전체 질의 일치", n == (long long)first && matches, &failures);
+
+    // 무작위 범위 질의를 전수 비교
+    ok = tlog_open(&log, path, key, TLOG_OPEN_READ, 0) == 0;
+    uint64_t segments = ok ? tlog_segment_count(&log) : 0, max_read = 0;
+    for (int q = 0; ok && q < 300; q++) {
+        int64_t a = ts[0] - 5 + (int64_t)(xorshift64(&x) % (uint64_t)(ts[first - 1] - ts[0] + 10));
+        int64_t width = (q % 3 == 0) ? 0 : (int64_t)(xorshift64(&x) % 200);
+        ok = query_matches(&log, ts, first, a, a + width, &stats);
+        if (width <= 20 && stats.segments_read > max_read) {
+            max_read = stats.segments_read;
+        }
+    }
+    check("무작위 범위 질의 300개가 전수 검색과 일치", ok, &failures);
+    {
+        char name[128];
+        snprintf(name, sizeof(name), "좁은 범위는 세그먼트 %llu개 중 최대 %llu개만 복호화",
+                 (unsigned long long)segments, (unsigned long long)max_read);
+        check(name, ok && segments > 100 && max_read <= 3, &failures);
+    }
+    ok = ok && tlog_query(&log, 10, 5, NULL, NULL, &stats) == 0 &&
+         tlog_query(&log, INT64_MIN, ts[0] - 1, NULL, NULL, &stats) == 0 &&
+         tlog_query(&log, ts[first - 1] + 1, INT64_MAX, NULL, NULL, &stats) == 0 &&
+         stats.segments_read == 0;
+    check("빈 범위/로그 밖 범위는 0개, 세그먼트를 읽지 않음", ok, &failures);
+    ok = ok && tlog_append(&log, ts[first], "x", 1) == -1;
+    check("읽기 모드에서 추가 거부", ok, &failures);
+    tlog_close(&log);
+
+    // 이어 쓰기 + 단조 위반 거부
+    ok = append_range(path, key, TLOG_OPEN_WRITE, ts, first, total) == 0;
+    n = ok ? reopen_query_all(path, key, ts, total, &matches) : -1;
+    check("다시 열어 이어 쓰기 (26000개) 후 전체 질의 일치", n == (long long)total && matches,
+          &failures);
+    {
+        unsigned char buf[512];
+        size_t len = test_record(total, buf);
+        ok = tlog_open(&log, path, key, TLOG_OPEN_WRITE, 0) == 0 &&
+             tlog_append(&log, ts[total] - 1, "x", 1) == -1 &&
+             tlog_append(&log, ts[total], buf, len) == 0;
+        tlog_close(&log);
+    }
+    check("시각이 줄어드는 레코드 거부 (같은 시각은 허용)", ok, &failures);
+
+    // 색인 삭제 → 로그에서 재구성
+    unlink(index_path);
+    n = reopen_query_all(path, key, ts, total + 1, &matches);
+    ok = (n == (long long)total + 1) && matches && access(index_path, F_OK) != 0;
+    ok = ok && tlog_open(&log, path, key, TLOG_OPEN_WRITE, 0) == 0;
+    if (ok) {
+        segments = tlog_segment_count(&log);
+        tlog_close(&log);
+    }
+    struct stat st;
+    ok = ok && stat(index_path, &st) == 0 &&
+         (uint64_t)st.st_size == segments * TLOG_INDEX_ENTRY_SIZE;
+    check("색인 파일 삭제 → 로그 헤더 태그로 재구성", ok, &failures);
+
+    // 색인 중간 항목 삭제 → 끊긴 지점 이후를 로그에서 복구
+    {
+        int fd = open(index_path, O_RDWR);
+        unsigned char *rest = malloc((size_t)st.st_size);
+        uint64_t cut = 10 * TLOG_INDEX_ENTRY_SIZE;
+        ok = fd >= 0 && rest != NULL &&
+             tlog_pread_full(fd, rest, (size_t)st.st_size - cut - TLOG_INDEX_ENTRY_SIZE,
+                             cut + TLOG_INDEX_ENTRY_SIZE) == 0 &&
+             tlog_pwrite_full(fd, rest, (size_t)st.st_size - cut - TLOG_INDEX_ENTRY_SIZE,
+                              cut) == 0 &&
+             ftruncate(fd, st.st_size - TLOG_INDEX_ENTRY_SIZE) == 0;
+        if (fd >= 0) close(fd);
+        free(rest);
+        n = ok ? reopen_query_all(path, key, ts, total + 1, &matches) : -1;
+        check("색인 중간 항목 삭제 → 순번 불일치로 버리고 로그에서 복구",
+              n == (long long)total + 1 && matches, &failures);
+    }
+
+    // 끊긴 꼬리: 마지막 세그먼트 중간에서 잘림
+    uint64_t end_before = 0, last_records = 0;
+    if (tlog_open(&log, path, key, TLOG_OPEN_READ, 0) == 0) {
+        end_before = log.end_offset;
+        last_records = log.segs[log.seg_count - 1].records;
+        tlog_close(&log);
+    }
+    ok = truncate(path, (off_t)(end_before - 10)) == 0 &&
+         tlog_open(&log, path, key, TLOG_OPEN_WRITE, 0) == 0;
+    if (ok) {
+        ok = tlog_segment_count(&log) == segments - 1;
+        tlog_close(&log);
+    }
+    ok = ok && stat(path, &st) == 0 && (uint64_t)st.st_size < end_before - 10;
+    n = reopen_query_all(path, key, ts, total + 1 - last_records, &matches);
+    check("끊긴 꼬리 세그먼트를 잘라내고 나머지 복구", ok && matches, &failures);
+    segments--;
+
+    // 색인이 로그보다 앞섬 (로그 쓰기 전에 끊김)
+    if (tlog_open(&log, path, key, TLOG_OPEN_READ, 0) == 0) {
+        end_before = log.segs[log.seg_count - 1].offset;
+        last_records += log.segs[log.seg_count - 1].records;
+        tlog_close(&log);
+    }
+    ok = truncate(path, (off_t)end_before) == 0;
+    n = ok ? reopen_query_all(path, key, ts, total + 1 - last_records, &matches) : -1;
+    check("색인이 로그보다 앞서면 로그 끝까지만 사용", n >= 0 && matches, &failures);
+    uint64_t remaining = total + 1 - last_records;
+
+    // 암호문 변조: 해당 세그먼트를 읽는 질의만 실패
+    ok = tlog_open(&log, path, key, TLOG_OPEN_READ, 0) == 0;
+    TlogSegment target = { 0 };
+    if (ok) {
+        target = log.segs[50];
+        tlog_close(&log);
+    }
+    ok = ok && flip_byte(path, target.offset + TLOG_SEG_PREFIX + 10) == 0 &&
+         tlog_open(&log, path, key, TLOG_OPEN_READ, 0) == 0;
+    if (ok) {
+        ok = tlog_query(&log, target.first_ts, target.last_ts, NULL, NULL, NULL) == -2 &&
+             query_matches(&log, ts, remaining, ts[0], ts[100], &stats);
+        tlog_close(&log);
+    }
+    check("세그먼트 암호문 변조 탐지 (다른 범위 질의는 정상)", ok, &failures);
+    flip_byte(path, target.offset + TLOG_SEG_PREFIX + 10);
+
+    // 색인 위조: 구조상 그럴듯한 값(레코드 수)으로 바꿔도 헤더 태그 불일치
+    ok = flip_byte(index_path, 50 * TLOG_INDEX_ENTRY_SIZE + 7) == 0;
+    n = reopen_query_all(path, key, ts, remaining, NULL);
+    check("색인 항목 위조 탐지", ok && n == -2, &failures);
+    flip_byte(index_path, 50 * TLOG_INDEX_ENTRY_SIZE + 7);
+
+    // 로그 세그먼트 헤더 위조 (색인 없이 재구성하는 중)
+    unlink(index_path);
+    ok = flip_byte(path, target.offset + 4) == 0;   // 레코드 수
+    check("로그 세그먼트 헤더 위조 탐지 (색인 재구성 중)",
+          ok && tlog_open(&log, path, key, TLOG_OPEN_READ, 0) == -2, &failures);
+    flip_byte(path, target.offset + 4);
+
+    // 파일 헤더 변조 / 잘못된 키
+    flip_byte(path, 20);   // salt
+    check("파일 헤더(salt) 변조 탐지", tlog_open(&log, path, key, TLOG_OPEN_READ, 0) == -2,
+          &failures);
+    flip_byte(path, 20);
+    check("잘못된 키 거부", tlog_open(&log, path, wrong, TLOG_OPEN_READ, 0) == -2, &failures);
+    n = reopen_query_all(path, key, ts, remaining, &matches);
+    check("복원 후 전체 질의 일치", n >= 0 && matches, &failures);
+
+    // 색인 항목의 암호문 길이 손상 → 색인 끝이 어긋나도 세그먼트를 잘라내지 않음
+    {
+        unsigned char buf[512], field[4];
+        uint64_t size_before = 0;
+        int fd;
+        ok = tlog_open(&log, path, key, TLOG_OPEN_WRITE, 0) == 0;   // 색인 재구성
+        if (ok) {
+            segments = tlog_segment_count(&log);
+            ok = tlog_close(&log) == 0 && stat(path, &st) == 0;
+            size_before = (uint64_t)st.st_size;
+        }
+        fd = ok ? open(index_path, O_RDWR) : -1;
+        ok = fd >= 0 &&
+             tlog_pread_full(fd, field, 4, 2 * TLOG_INDEX_ENTRY_SIZE + 32) == 0;
+        if (ok) {
+            tlog_put_be32(field, tlog_get_be32(field) - 16);
+            ok = tlog_pwrite_full(fd, field, 4, 2 * TLOG_INDEX_ENTRY_SIZE + 32) == 0;
+        }
+        if (fd >= 0) close(fd);
+        size_t len = test_record(remaining, buf);
+        ok = ok && tlog_open(&log, path, key, TLOG_OPEN_WRITE, 0) == 0;
+        if (ok) {
+            ok = tlog_append(&log, ts[remaining], buf, len) == 0;
+            ok = tlog_close(&log) == 0 && ok;
+        }
+        ok = ok && stat(path, &st) == 0 && (uint64_t)st.st_size > size_before &&
+             tlog_open(&log, path, key, TLOG_OPEN_READ, 0) == 0;
+        if (ok) {
+            ok = tlog_segment_count(&log) == segments + 1;
+            tlog_close(&log);
+        }
+        n = ok ? reopen_query_all(path, key, ts, remaining + 1, &matches) : -1;
+        check("색인 항목 길이 손상 → 색인을 다시 만들고 세그먼트 보존", n >= 0 && matches,
+              &failures);
+    }
+
+    // 잘라낸 꼬리와 같은 순번을 다시 써도 세션이 달라 keystream이 겹치지 않음
+    {
+        unsigned char a[3000], b[3000], c[3000], lost_ct[64], new_ct[64];
+        TlogSegment lost = { 0 }, again = { 0 };
+        memset(a, 'A', sizeof(a));
+        memset(b, 'B', sizeof(b));
+        memset(c, 'C', sizeof(c));
+        ok = tlog_open(&log, path, key, TLOG_OPEN_CREATE, TLOG_MIN_SEGMENT) == 0 &&
+             tlog_append(&log, 1, a, sizeof(a)) == 0 && tlog_close(&log) == 0 &&
+             tlog_open(&log, path, key, TLOG_OPEN_WRITE, 0) == 0 &&
+             tlog_append(&log, 2, b, sizeof(b)) == 0 && tlog_close(&log) == 0 &&
+             tlog_open(&log, path, key, TLOG_OPEN_READ, 0) == 0 && log.seg_count == 2;
+        if (ok) {
+            lost = log.segs[1];
+            ok = tlog_pread_full(log.fd, lost_ct, sizeof(lost_ct),
+                                 lost.offset + TLOG_SEG_PREFIX) == 0 &&
+                 stat(path, &st) == 0;
+            tlog_close(&log);
+        }
+        ok = ok && truncate(path, st.st_size - 5) == 0 &&
+             tlog_open(&log, path, key, TLOG_OPEN_WRITE, 0) == 0 &&
+             tlog_append(&log, 2, c, sizeof(c)) == 0 && tlog_close(&log) == 0 &&
+             tlog_open(&log, path, key, TLOG_OPEN_READ, 0) == 0 && log.seg_count == 2;
+        if (ok) {
+            again = log.segs[1];
+            ok = tlog_pread_full(log.fd, new_ct, sizeof(new_ct),
+                                 again.offset + TLOG_SEG_PREFIX) == 0 &&
+                 tlog_query(&log, 2, 2, NULL, NULL, NULL) == 1;
+            tlog_close(&log);
+        }
+        // 평문 앞 12바이트(시각, 길이)는 같으므로 keystream이 같다면 암호문도 같다
+        ok = ok && again.seq == lost.seq && again.session != lost.session &&
+             memcmp(lost_ct, new_ct, TLOG_RECORD_HEADER) != 0;
+        check("잘라낸 꼬리 순번을 다시 써도 nonce 재사용 없음 (세션별 nonce)", ok, &failures);
+    }
+
+    unlink(path);
+    unlink(index_path);
+    rmdir(dir);
+    free(ts);
+    OPENSSL_cleanse(key, sizeof(key));
+
+    printf("\n%s (실패 %d건)\n", failures == 0 ? "✓ 모든 테스트 통과" : "✗ 테스트 실패", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * 시간 폭 하나의 무작위 질의 지연을 잰다.
+ *
+ * @param cold 1이면 질의마다 로그의 페이지 캐시를 비우고 (POSIX_FADV_DONTNEED),
+ *             0이면 같은 질의를 한 번 먼저 실행하여 캐시에 올린 뒤 잰다
+ */
+static int bench_queries(TelemetryLog *log, int64_t span, int64_t width, int queries, int cold,
+                         uint64_t *x, const char *label) {
+    double *lat = malloc((size_t)queries * sizeof(double));
+    uint64_t segments = 0, records = 0;
+    int failures = 0;
+
+    if (lat == NULL) {
+        return 1;
+    }
+    for (int q = 0; q < queries; q++) {
+        int64_t from = (int64_t)(xorshift64(x) % (uint64_t)(span > width ? span - width : 1));
+        TlogQueryStats stats;
+        if (cold) {
+            posix_fadvise(log->fd, 0, 0, POSIX_FADV_DONTNEED);
+        } else {
+            tlog_query(log, from, from + width - 1, NULL, NULL, &stats);   // 페이지 캐시 채우기
+        }
+        double t0 = now_seconds();
+        failures += tlog_query(log, from, from + width - 1, NULL, NULL, &stats) < 0;
+        lat[q] = (now_seconds() - t0) * 1e3;
+        segments += stats.segments_read;
+        records += stats.records;
+    }
+    qsort(lat, (size_t)queries, sizeof(double), compare_double);
+    printf("  %-12s %-6s %9.3f %9.3f %9.3f %8.1f %10.0f\n", label, cold ? "cold" : "warm",
+           lat[queries / 2], lat[queries * 99 / 100], lat[queries - 1],
+           (double)segments / queries, (double)records / queries);
+    free(lat);
+    return failures;
+}
+
+/**
+ * 수 GB 로그에 1ms 간격 레코드를 추가하고, 시간 폭별 질의 지연을 잰다.
+ */
+static int cmd_bench(uint64_t size_mb, size_t record_size, uint32_t segment_size, int queries) {
+    char dir[] = "/tmp/telemetry_log_XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("임시 디렉터리 생성 실패");
+        return 1;
+    }
+    char path[128], index_path[160];
+    snprintf(path, sizeof(path), "%s/log", dir);
+    snprintf(index_path, sizeof(index_path), "%s.idx", path);
+
+    unsigned char key[TLOG_KEY_SIZE], record[65536];
+    uint64_t target = size_mb * 1024 * 1024;
+    uint64_t records = target / (record_size + TLOG_RECORD_HEADER);
+    uint64_t x = 0x2545f4914f6cdd1dULL;
+    TelemetryLog log;
+    int failures = 0;
+    double t0, t;
+
+    RAND_bytes(key, sizeof(key));
+    for (size_t i = 0; i < record_size; i++) {
+        record[i] = (unsigned char)xorshift64(&x);
+    }
+    printf("=== tlog-v2 벤치마크 (%llu MB, 레코드 %zu B × %llu개, 세그먼트 %u KB) ===\n\n",
+           (unsigned long long)size_mb, record_size, (unsigned long long)records,
+           segment_size / 1024);
+
+    // 추가 (1ms 간격 시각)
+    if (tlog_open(&log, path, key, TLOG_OPEN_CREATE, segment_size) != 0) {
+        rmdir(dir);
+        return 1;
+    }
+    t0 = now_seconds();
+    for (uint64_t i = 0; i < records; i++) {
+        memcpy(record, &i, sizeof(i));
+        if (tlog_append(&log, (int64_t)i, record, record_size) != 0) {
+            failures++;
+            break;
+        }
+    }
+    failures += tlog_flush(&log) != 0;
+    t = now_seconds() - t0;
+    uint64_t log_bytes = log.end_offset;
+    uint64_t segments = tlog_segment_count(&log);
+    tlog_close(&log);
+    printf("추가 (fdatasync 포함): %.2f초, %.0f MB/s, %.2f M records/s\n", t,
+           (double)log_bytes / (1024.0 * 1024.0) / t, (double)records / t / 1e6);
+    printf("  로그 %.1f MB (세그먼트 %llu개), 색인 %.1f KB, 저장 오버헤드 %.4f%%\n",
+           (double)log_bytes / (1024.0 * 1024.0), (unsigned long long)segments,
+           (double)segments * TLOG_INDEX_ENTRY_SIZE / 1024.0,
+           100.0 * (double)(log_bytes - records * (record_size + TLOG_RECORD_HEADER)) /
+               (double)(records * (record_size + TLOG_RECORD_HEADER)));
+
+    // 암호 연산만 비교: 세그먼트 봉인 vs 레코드마다 따로 봉인 (처음 100만 개)
+    {
+        CipherKey k;
+        unsigned char nonce[TLOG_NONCE_SIZE] = { 0 }, tag[TLOG_TAG_SIZE];
+        unsigned char *out = malloc(segment_size);
+        uint64_t count = records < 1000000 ? records : 1000000;
+        uint64_t per_segment = segment_size / (record_size + TLOG_RECORD_HEADER);
+        if (out != NULL && cipher_key_init(&k, "AES-256-GCM", key) == 0) {
+            t0 = now_seconds();
+            for (uint64_t i = 0; i < count; i += per_segment) {
+                tlog_put_be64(nonce + 4, i);
+                failures += cipher_key_seal(&k, nonce, NULL, 0, out,
+                                            per_segment * (record_size + TLOG_RECORD_HEADER),
+                                            out, tag) != 0;
+            }
+            t = now_seconds() - t0;
+            printf("암호 연산만: 세그먼트 봉인 %.2f M records/s", (double)count / t / 1e6);
+            t0 = now_seconds();
+            for (uint64_t i = 0; i < count; i++) {
+                tlog_put_be64(nonce + 4, i);
+                failures += cipher_key_seal(&k, nonce, NULL, 0, record, record_size, out, tag) != 0;
+            }
+            t = now_seconds() - t0;
+            printf(", 레코드별 봉인 %.2f M records/s\n", (double)count / t / 1e6);
+            printf("  레코드별 봉인은 레코드마다 nonce + 태그 %d B (오버헤드 %.1f%%)\n",
+                   TLOG_NONCE_SIZE + TLOG_TAG_SIZE,
+                   100.0 * (TLOG_NONCE_SIZE + TLOG_TAG_SIZE) / (double)record_size);
+            cipher_key_free(&k);
+        }
+        free(out);
+    }
+
+    // 열기 (색인 로드)
+    t0 = now_seconds();
+    if (tlog_open(&log, path, key, TLOG_OPEN_READ, 0) != 0) {
+        failures++;
+    } else {
+        printf("열기 (색인 로드): %.2f ms\n\n", (now_seconds() - t0) * 1e3);
+        const int64_t widths[] = { 1000, 60 * 1000, 3600 * 1000 };
+        const char *labels[] = { "1초", "1분", "1시간" };
+        int64_t span = (int64_t)records;
+        printf("시간 범위 질의 (시각 1ms 간격, 무작위 시작점 %d회):\n", queries);
+        printf("  %-10s %-6s %9s %9s %9s %8s %10s\n", "범위", "캐시", "p50 ms", "p99 ms",
+               "max ms", "세그먼트", "레코드");
+        for (int w = 0; w < 3; w++) {
+            if (widths[w] > span) {
+                continue;
+            }
+            int n = (widths[w] >= 3600 * 1000) ? (queries + 9) / 10 : queries;
+            failures += bench_queries(&log, span, widths[w], n, 0, &x, labels[w]);
+            failures += bench_queries(&log, span, widths[w], n, 1, &x, labels[w]);
+        }
+
+        // 기준: 한 번에 봉인한 로그는 어떤 질의든 전체를 복호화해야 한다 (캐시에 올린 뒤)
+        TlogQueryStats stats;
+        tlog_query(&log, INT64_MIN, INT64_MAX, NULL, NULL, &stats);
+        t0 = now_seconds();
+        failures += tlog_query(&log, INT64_MIN, INT64_MAX, NULL, NULL, &stats) !=
+                    (long long)records;
+        t = now_seconds() - t0;
+        printf("\n기준: 전체 복호화 (단일 메시지 설계의 질의 1회): %.1f ms (%.0f MB/s)\n",
+               t * 1e3, (double)stats.bytes_read / (1024.0 * 1024.0) / t);
+        tlog_close(&log);
+    }
+
+    unlink(path);
+    unlink(index_path);
+    rmdir(dir);
+    OPENSSL_cleanse(key, sizeof(key));
+    if (failures > 0) {
+        printf("\n✗ 벤치마크 중 오류 %d건\n", failures);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "사용법:\n"
+            "  %s keygen <키 파일>\n"
+            "  %s append <로그> <키 파일> [-g 세그먼트KB]   (표준 입력: \"<시각> <내용>\" 줄)\n"
+            "  %s query <로그> <키 파일> <시작 시각> <끝 시각>\n"
+            "  %s info <로그> <키 파일>\n"
+            "  %s test\n"
+            "  %s bench [-s 크기MB] [-r 레코드B] [-g 세그먼트KB] [-q 질의 수]\n",
+            prog, prog, prog, prog, prog, prog);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    const char *cmd = argv[1];
+
+    if (strcmp(cmd, "keygen") == 0 && argc == 3) {
+        return cmd_keygen(argv[2]);
+    }
+    if (strcmp(cmd, "append") == 0 && (argc == 4 || argc == 6)) {
+        uint32_t segment_kb = TLOG_DEFAULT_SEGMENT / 1024;
+        if (argc == 6) {
+            if (strcmp(argv[4], "-g") != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            segment_kb = (uint32_t)strtoul(argv[5], NULL, 10);
+        }
+        return cmd_append(argv[2], argv[3], segment_kb * 1024);
+    }
+    if (strcmp(cmd, "query") == 0 && argc == 6) {
+        return cmd_query(argv[2], argv[3], strtoll(argv[4], NULL, 10), strtoll(argv[5], NULL, 10));
+    }
+    if (strcmp(cmd, "info") == 0 && argc == 4) {
+        return cmd_info(argv[2], argv[3]);
+    }
+    if (strcmp(cmd, "test") == 0) {
+        return cmd_test();
+    }
+    if (strcmp(cmd, "bench") == 0) {
+        uint64_t size_mb = DEFAULT_BENCH_MB;
+        size_t record_size = DEFAULT_BENCH_RECORD;
+        uint32_t segment_kb = TLOG_DEFAULT_SEGMENT / 1024;
+        int queries = DEFAULT_BENCH_QUERIES;
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+                size_mb = strtoull(argv[++i], NULL, 10);
+            } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+                record_size = (size_t)strtoul(argv[++i], NULL, 10);
+            } else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+                segment_kb = (uint32_t)strtoul(argv[++i], NULL, 10);
+            } else if (strcmp(argv[i], "-q") == 0 && i + 1 < argc) {
+                queries = atoi(argv[++i]);
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        if (size_mb == 0 || record_size < 8 || record_size > 65536 || queries <= 0 ||
+            segment_kb * 1024 < TLOG_MIN_SEGMENT || segment_kb * 1024 > TLOG_MAX_SEGMENT ||
+            record_size + TLOG_RECORD_HEADER > segment_kb * 1024) {
+            usage(argv[0]);
+            return 1;
+        }
+        return cmd_bench(size_mb, record_size, segment_kb * 1024, queries);
+    }
+    usage(argv[0]);
+    return 1;
+}
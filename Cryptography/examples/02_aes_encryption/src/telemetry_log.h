@@ -0,0 +1,778 @@
+/**
+ * telemetry_log.h - 추가 전용 암호화 텔레메트리 로그 (시간 색인 포함)
+ *
+ * 차량은 텔레메트리를 업로드 전까지 로컬에 쌓는다. aes_gcm_encrypt()로는
+ * 레코드마다 따로 봉인하거나(느리고 레코드마다 nonce + 태그 28바이트가 붙음)
+ * 전체를 한 번에 봉인할(시간 범위만 꺼낼 수 없음) 수밖에 없다. 이 헤더는
+ * 레코드를 세그먼트(기본 1MB)로 묶어 AES-256-GCM으로 봉인하고, 세그먼트마다
+ * 시간 범위와 파일 오프셋을 담은 작은 색인을 둔다. 시간 범위 질의는 색인을
+ * 이진 탐색하여 겹치는 세그먼트만 읽고 복호화한다.
+ *
+ * 로그 파일 (tlog-v2, 정수는 빅엔디언):
+ *   파일 헤더 64B   "TLOG1\0\0\0" | u32 버전 | u32 세그먼트 크기 | salt[16] | 0
+ *   세그먼트 반복   세그먼트 헤더 48B | 헤더 태그 16B | 암호문 | 태그 16B
+ *     세그먼트 헤더 "TSEG" | u32 레코드 수 | u64 순번 | i64 첫 시각 | i64 끝 시각
+ *                   | u32 암호문 길이 | u32 0 | u64 세션 (최상위 비트 0)
+ *     평문          레코드 반복: i64 시각 | u32 길이 | 데이터
+ * 색인 파일 (<로그>.idx): 세그먼트마다 72B = 세그먼트 헤더 | u64 오프셋 | 헤더 태그
+ *
+ *   키    = HKDF-SHA256(마스터 키, salt, "TLOG1 segment key")
+ *   nonce = u64 (도메인 << 63 | 세션) | u32 순번
+ *   헤더 태그 = GMAC(nonce 도메인 1, AAD = 파일 헤더 | 세그먼트 헤더 | 오프셋)
+ *   본문      = AES-256-GCM(nonce 도메인 0, AAD = 파일 헤더 | 세그먼트 헤더)
+ *
+ * 순번은 세그먼트 위치이므로 끊긴 꼬리를 잘라내거나 로그보다 앞선 색인 항목을
+ * 버리면 같은 순번을 다시 쓴다. 그래서 쓰기로 열 때마다 63비트 난수 세션을 새로
+ * 뽑아 nonce에 넣는다. 잃어버린 세그먼트와 같은 순번의 새 세그먼트도 세션이
+ * 다르므로 (키, nonce)가 겹치지 않는다 (세션 충돌 확률은 세션 수^2 / 2^64).
+ *
+ * 색인은 로그에서 언제든 다시 만들 수 있는 사본이며, 항목마다 헤더 태그가
+ * 있으므로 색인을 믿지 않아도 된다. 질의는 이진 탐색이 들여다본 항목과 읽을
+ * 세그먼트의 헤더 태그만 검증한다 (O(log n)). 순번과 오프셋이 끊김 없이
+ * 이어지는지 확인하므로 색인에서 세그먼트를 빼거나 바꿔 끼우면 드러난다.
+ *
+ * 쓰는 도중 끊기면 로그 끝에 불완전한 세그먼트가 남는다. 쓰기로 다시 열 때
+ * 색인의 마지막 항목을 로그와 대조하고(다르면 색인을 버리고 다시 만듦), 그 뒤의
+ * 세그먼트를 헤더 태그로 확인하여 색인에 붙이고, 불완전한 꼬리만 잘라낸다.
+ * 꼬리 세그먼트를 통째로 지우는 공격은 로그 안에서는 알 수 없으므로 필요하면
+ * tlog_segment_count()를 업로드 서버 등 외부에 기록하라.
+ *
+ * 시각은 단조 증가(같은 값 허용)해야 하며 단위는 호출자가 정한다 (예: ms).
+ * 봉인되지 않은 버퍼의 레코드는 tlog_flush() 전까지 질의에 보이지 않는다.
+ * 핸들은 스레드 안전하지 않으며 로그 하나에 쓰는 프로세스는 하나여야 한다.
+ *
+ * 반환 규약은 aes_gcm_decrypt()와 같다: 실패 -1, 인증 실패 -2.
+ */
+
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/rand.h>
+#include "cipher_key.h"
+
+#define TLOG_MAGIC "TLOG1\0\0\0"
+#define TLOG_VERSION 2
+#define TLOG_KEY_SIZE 32
+#define TLOG_SALT_SIZE 16
+#define TLOG_NONCE_SIZE 12
+#define TLOG_TAG_SIZE 16
+#define TLOG_FILE_HEADER_SIZE 64
+#define TLOG_SEG_HEADER_SIZE 48
+#define TLOG_SEG_PREFIX (TLOG_SEG_HEADER_SIZE + TLOG_TAG_SIZE)   // 세그먼트 헤더 + 헤더 태그
+#define TLOG_INDEX_ENTRY_SIZE 72
+#define TLOG_RECORD_HEADER 12                                   // i64 시각 + u32 길이
+#define TLOG_DEFAULT_SEGMENT (1024 * 1024)
+#define TLOG_MIN_SEGMENT 4096
+#define TLOG_MAX_SEGMENT (64 * 1024 * 1024)
+#define TLOG_MAX_SEGMENTS (UINT64_C(1) << 32)                   // 키당 GCM 호출 한도
+
+#define TLOG_OPEN_READ 0
+#define TLOG_OPEN_WRITE 1                // 기존 로그에 이어 쓰기 (꼬리 복구 포함)
+#define TLOG_OPEN_CREATE 2               // 새 로그 (기존 파일을 덮어씀)
+
+/**
+ * 색인 항목 (메모리)
+ */
+typedef struct {
+    uint64_t seq;
+    uint64_t session;                    // 이 세그먼트를 쓴 세션 (nonce 앞부분)
+    uint64_t offset;                     // 로그 파일에서 세그먼트 헤더 위치
+    int64_t first_ts;
+    int64_t last_ts;
+    uint32_t records;
+    uint32_t ct_len;
+    unsigned char header_tag[TLOG_TAG_SIZE];
+    int verified;                        // 헤더 태그 검증 완료
+} TlogSegment;
+
+/**
+ * 질의 통계
+ */
+typedef struct {
+    uint64_t segments_read;              // 복호화한 세그먼트 수
+    uint64_t bytes_read;                 // 로그에서 읽은 바이트
+    uint64_t entries_verified;           // 헤더 태그를 검증한 색인 항목 수
+    uint64_t records;                    // 범위에 든 레코드 수
+} TlogQueryStats;
+
+/**
+ * 레코드 콜백. 0이 아닌 값을 돌려주면 질의를 멈춘다.
+ */
+typedef int (*TlogRecordFn)(int64_t ts, const unsigned char *data, size_t len, void *arg);
+
+/**
+ * 열린 로그 핸들
+ */
+typedef struct {
+    int fd;
+    int index_fd;
+    int writable;
+    uint64_t session;                    // 이번 쓰기 세션의 nonce 앞부분 (열 때마다 새 난수)
+    unsigned char file_header[TLOG_FILE_HEADER_SIZE];
+    uint32_t segment_size;               // 세그먼트 평문 최대 크기
+    CipherKey key;                       // AES-256-GCM, 키 확장은 열 때 한 번
+    TlogSegment *segs;
+    size_t seg_count;
+    size_t seg_cap;
+    uint64_t end_offset;                 // 마지막 완전한 세그먼트의 끝
+    int64_t last_ts;                     // 마지막으로 추가한 시각 (단조 검사)
+    int has_records;
+    // 쓰기 버퍼 (세그먼트 평문) 와 봉인/질의용 버퍼
+    unsigned char *plain;
+    size_t plain_len;
+    uint32_t plain_records;
+    int64_t plain_first_ts;
+    unsigned char *sealed;               // 세그먼트 헤더 | 헤더 태그 | 암호문 | 태그
+} TelemetryLog;
+
+static inline void tlog_put_be32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(v >> (24 - 8 * i));
+    }
+}
+
+static inline void tlog_put_be64(unsigned char *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)(v >> (56 - 8 * i));
+    }
+}
+
+static inline uint32_t tlog_get_be32(const unsigned char *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t tlog_get_be64(const unsigned char *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline int tlog_pread_full(int fd, void *buf, size_t len, uint64_t offset) {
+    unsigned char *p = (unsigned char *)buf;
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, (off_t)offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+static inline int tlog_pwrite_full(int fd, const void *buf, size_t len, uint64_t offset) {
+    const unsigned char *p = (const unsigned char *)buf;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, (off_t)offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+/**
+ * 마스터 키와 파일 헤더의 salt로 세그먼트 키를 파생한다.
+ */
+static inline int tlog_derive_key(TelemetryLog *log, const unsigned char *master_key) {
+    static const char info[] = "TLOG1 segment key";
+    unsigned char key[TLOG_KEY_SIZE];
+    EVP_KDF *kdf = EVP_KDF_fetch(NULL, "HKDF", NULL);
+    EVP_KDF_CTX *kctx = (kdf != NULL) ? EVP_KDF_CTX_new(kdf) : NULL;
+    OSSL_PARAM params[5];
+    int ok;
+
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST, "SHA256", 0);
+    params[1] = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_KEY,
+                                                  (void *)master_key, TLOG_KEY_SIZE);
+    params[2] = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_SALT,
+                                                  log->file_header + 16, TLOG_SALT_SIZE);
+    params[3] = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_INFO,
+                                                  (void *)info, sizeof(info) - 1);
+    params[4] = OSSL_PARAM_construct_end();
+    ok = kctx != NULL && EVP_KDF_derive(kctx, key, sizeof(key), params) == 1 &&
+         cipher_key_init(&log->key, "AES-256-GCM", key) == 0;
+    EVP_KDF_CTX_free(kctx);
+    EVP_KDF_free(kdf);
+    OPENSSL_cleanse(key, sizeof(key));
+    return ok ? 0 : -1;
+}
+
+#define TLOG_SESSION_MASK (~(UINT64_C(1) << 63))   // 최상위 비트는 nonce 도메인
+
+static inline void tlog_nonce(unsigned char *nonce, uint32_t domain, const TlogSegment *seg) {
+    tlog_put_be64(nonce, ((uint64_t)domain << 63) | seg->session);
+    tlog_put_be32(nonce + 8, (uint32_t)seg->seq);   // seq < TLOG_MAX_SEGMENTS = 2^32
+}
+
+static inline void tlog_encode_segment_header(const TlogSegment *seg, unsigned char *out) {
+    memcpy(out, "TSEG", 4);
+    tlog_put_be32(out + 4, seg->records);
+    tlog_put_be64(out + 8, seg->seq);
+    tlog_put_be64(out + 16, (uint64_t)seg->first_ts);
+    tlog_put_be64(out + 24, (uint64_t)seg->last_ts);
+    tlog_put_be32(out + 32, seg->ct_len);
+    tlog_put_be32(out + 36, 0);
+    tlog_put_be64(out + 40, seg->session);
+}
+
+static inline int tlog_decode_segment_header(const unsigned char *in, TlogSegment *seg) {
+    if (memcmp(in, "TSEG", 4) != 0 || tlog_get_be32(in + 36) != 0 ||
+        (tlog_get_be64(in + 40) & ~TLOG_SESSION_MASK) != 0) {
+        return -1;
+    }
+    memset(seg, 0, sizeof(*seg));
+    seg->records = tlog_get_be32(in + 4);
+    seg->seq = tlog_get_be64(in + 8);
+    seg->first_ts = (int64_t)tlog_get_be64(in + 16);
+    seg->last_ts = (int64_t)tlog_get_be64(in + 24);
+    seg->ct_len = tlog_get_be32(in + 32);
+    seg->session = tlog_get_be64(in + 40);
+    return 0;
+}
+
+/**
+ * 세그먼트 헤더 태그 (GMAC, 평문 없음)
+ */
+static inline int tlog_header_tag(TelemetryLog *log, const TlogSegment *seg, unsigned char *tag) {
+    unsigned char aad[TLOG_FILE_HEADER_SIZE + TLOG_SEG_HEADER_SIZE + 8];
+    unsigned char nonce[TLOG_NONCE_SIZE], unused[TLOG_TAG_SIZE];
+
+    memcpy(aad, log->file_header, TLOG_FILE_HEADER_SIZE);
+    tlog_encode_segment_header(seg, aad + TLOG_FILE_HEADER_SIZE);
+    tlog_put_be64(aad + TLOG_FILE_HEADER_SIZE + TLOG_SEG_HEADER_SIZE, seg->offset);
+    tlog_nonce(nonce, 1, seg);
+    return cipher_key_seal(&log->key, nonce, aad, sizeof(aad), NULL, 0, unused, tag);
+}
+
+/**
+ * 색인 항목의 헤더 태그를 검증한다 (항목마다 한 번).
+ *
+ * @return 성공 시 0, 인증 실패 시 -2
+ */
+static inline int tlog_verify_entry(TelemetryLog *log, TlogSegment *seg,
+                                    TlogQueryStats *stats) {
+    unsigned char tag[TLOG_TAG_SIZE];
+
+    if (seg->verified) {
+        return 0;
+    }
+    if (tlog_header_tag(log, seg, tag) != 0) {
+        return -1;
+    }
+    if (CRYPTO_memcmp(tag, seg->header_tag, TLOG_TAG_SIZE) != 0) {
+        return -2;
+    }
+    seg->verified = 1;
+    if (stats != NULL) {
+        stats->entries_verified++;
+    }
+    return 0;
+}
+
+/**
+ * 항목이 앞 항목에 끊김 없이 이어지는지 확인한다 (순번, 오프셋, 시각 순서).
+ */
+static inline int tlog_entry_follows(const TelemetryLog *log, const TlogSegment *seg) {
+    uint64_t expected_seq = log->seg_count;
+    uint64_t expected_offset = log->end_offset;
+    const TlogSegment *prev = (log->seg_count > 0) ? &log->segs[log->seg_count - 1] : NULL;
+
+    return seg->seq == expected_seq && seg->offset == expected_offset &&
+           seg->records > 0 && seg->ct_len <= log->segment_size &&
+           seg->first_ts <= seg->last_ts && (prev == NULL || prev->last_ts <= seg->first_ts);
+}
+
+static inline int tlog_push_segment(TelemetryLog *log, const TlogSegment *seg) {
+    if (log->seg_count == log->seg_cap) {
+        size_t cap = (log->seg_cap == 0) ? 1024 : log->seg_cap * 2;
+        TlogSegment *p = realloc(log->segs, cap * sizeof(*p));
+        if (p == NULL) {
+            return -1;
+        }
+        log->segs = p;
+        log->seg_cap = cap;
+    }
+    log->segs[log->seg_count++] = *seg;
+    log->end_offset = seg->offset + TLOG_SEG_PREFIX + seg->ct_len + TLOG_TAG_SIZE;
+    log->last_ts = seg->last_ts;
+    log->has_records = 1;
+    return 0;
+}
+
+static inline int tlog_write_index_entry(TelemetryLog *log, const TlogSegment *seg) {
+    unsigned char entry[TLOG_INDEX_ENTRY_SIZE];
+    tlog_encode_segment_header(seg, entry);
+    tlog_put_be64(entry + TLOG_SEG_HEADER_SIZE, seg->offset);
+    memcpy(entry + TLOG_SEG_HEADER_SIZE + 8, seg->header_tag, TLOG_TAG_SIZE);
+    return tlog_pwrite_full(log->index_fd, entry, sizeof(entry),
+                            seg->seq * TLOG_INDEX_ENTRY_SIZE);
+}
+
+/**
+ * 색인 파일을 읽는다. 끊김 없이 이어지는 앞부분만 받아들이고 나머지는 버린다
+ * (로그를 훑어 다시 만든다). 태그 검증은 질의할 때 필요한 항목만 한다.
+ */
+static inline int tlog_load_index(TelemetryLog *log) {
+    unsigned char entries[256 * TLOG_INDEX_ENTRY_SIZE];
+    uint64_t offset = 0;
+
+    for (;;) {
+        ssize_t n = pread(log->index_fd, entries, sizeof(entries), (off_t)offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -1;
+        size_t count = (size_t)n / TLOG_INDEX_ENTRY_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            const unsigned char *e = entries + i * TLOG_INDEX_ENTRY_SIZE;
+            TlogSegment seg;
+            if (tlog_decode_segment_header(e, &seg) != 0) {
+                return 0;
+            }
+            seg.offset = tlog_get_be64(e + TLOG_SEG_HEADER_SIZE);
+            memcpy(seg.header_tag, e + TLOG_SEG_HEADER_SIZE + 8, TLOG_TAG_SIZE);
+            if (!tlog_entry_follows(log, &seg)) {
+                return 0;
+            }
+            if (tlog_push_segment(log, &seg) != 0) {
+                return -1;
+            }
+        }
+        if (count * TLOG_INDEX_ENTRY_SIZE < sizeof(entries)) {
+            return 0;
+        }
+        offset += sizeof(entries);
+    }
+}
+
+/**
+ * 받아들인 색인의 마지막 항목을 로그의 세그먼트 헤더와 대조하고 태그를 검증한다.
+ * 색인 끝(end_offset)은 항목의 암호문 길이로 계산하므로, 이 항목이 로그와 다르면
+ * 색인 전체를 버리고 로그를 처음부터 훑어 다시 만든다.
+ *
+ * @return 성공 시 0 (색인을 버린 경우 포함), 실패 시 -1
+ */
+static inline int tlog_check_index_end(TelemetryLog *log) {
+    unsigned char prefix[TLOG_SEG_PREFIX];
+    TlogSegment *last, found;
+
+    if (log->seg_count == 0) {
+        return 0;
+    }
+    last = &log->segs[log->seg_count - 1];
+    if (tlog_pread_full(log->fd, prefix, sizeof(prefix), last->offset) != 0) {
+        return -1;
+    }
+    int matches = tlog_decode_segment_header(prefix, &found) == 0 &&
+                  found.seq == last->seq && found.records == last->records &&
+                  found.first_ts == last->first_ts && found.last_ts == last->last_ts &&
+                  found.ct_len == last->ct_len && found.session == last->session &&
+                  memcmp(prefix + TLOG_SEG_HEADER_SIZE, last->header_tag, TLOG_TAG_SIZE) == 0;
+    if (matches) {
+        int r = tlog_verify_entry(log, last, NULL);
+        if (r == -1) {
+            return -1;
+        }
+        matches = (r == 0);
+    }
+    if (!matches) {
+        log->seg_count = 0;
+        log->end_offset = TLOG_FILE_HEADER_SIZE;
+        log->has_records = 0;
+    }
+    return 0;
+}
+
+/**
+ * 색인 뒤에 남은 로그 세그먼트를 헤더 태그로 확인하여 색인에 붙인다.
+ * 쓰기 모드면 색인 파일에도 기록하고, 불완전한 꼬리는 로그와 색인에서 잘라낸다.
+ * 잘라내는 것은 헤더가 해석되지 않거나 세그먼트가 파일 끝에서 끊긴 경우뿐이다.
+ * 완전한 세그먼트가 색인에 이어지지 않으면 잘라내지 않고 실패한다.
+ *
+ * @return 성공 시 0, 실패 시 -1, 완전한 세그먼트의 헤더 인증 실패 또는 불일치 시 -2
+ */
+static inline int tlog_recover_tail(TelemetryLog *log, uint64_t file_size) {
+    while (log->end_offset + TLOG_SEG_PREFIX <= file_size) {
+        unsigned char prefix[TLOG_SEG_PREFIX];
+        TlogSegment seg;
+        if (tlog_pread_full(log->fd, prefix, sizeof(prefix), log->end_offset) != 0) {
+            return -1;
+        }
+        if (tlog_decode_segment_header(prefix, &seg) != 0) {
+            break;
+        }
+        seg.offset = log->end_offset;
+        memcpy(seg.header_tag, prefix + TLOG_SEG_HEADER_SIZE, TLOG_TAG_SIZE);
+        if (seg.offset + TLOG_SEG_PREFIX + (uint64_t)seg.ct_len + TLOG_TAG_SIZE > file_size) {
+            break;
+        }
+        // 완전한 세그먼트가 이어지지 않거나 태그가 틀리면 끊긴 꼬리가 아니라 변조이다
+        if (!tlog_entry_follows(log, &seg)) {
+            return -2;
+        }
+        int r = tlog_verify_entry(log, &seg, NULL);
+        if (r != 0) {
+            return r;
+        }
+        if (tlog_push_segment(log, &seg) != 0 ||
+            (log->writable && tlog_write_index_entry(log, &seg) != 0)) {
+            return -1;
+        }
+    }
+    if (log->writable &&
+        (ftruncate(log->fd, (off_t)log->end_offset) != 0 ||
+         ftruncate(log->index_fd, (off_t)(log->seg_count * TLOG_INDEX_ENTRY_SIZE)) != 0)) {
+        return -1;
+    }
+    return 0;
+}
+
+static inline int tlog_flush(TelemetryLog *log);
+
+/**
+ * 핸들을 닫는다. 쓰기 모드면 버퍼를 봉인하고 디스크에 반영한다.
+ */
+static inline int tlog_close(TelemetryLog *log) {
+    int ret = 0;
+    if (log->writable && log->fd >= 0) {
+        ret = tlog_flush(log);
+    }
+    if (log->fd >= 0) close(log->fd);
+    if (log->index_fd >= 0) close(log->index_fd);
+    cipher_key_free(&log->key);
+    if (log->plain != NULL) {
+        OPENSSL_cleanse(log->plain, log->segment_size);
+    }
+    free(log->plain);
+    free(log->sealed);
+    free(log->segs);
+    memset(log, 0, sizeof(*log));
+    log->fd = -1;
+    log->index_fd = -1;
+    return ret;
+}
+
+/**
+ * 로그를 연다.
+ *
+ * @param mode          TLOG_OPEN_READ / TLOG_OPEN_WRITE / TLOG_OPEN_CREATE
+ * @param segment_size  새 로그의 세그먼트 평문 크기 (0이면 1MB, 기존 로그는 헤더 값)
+ *
+ * 파일 헤더와 키는 첫 세그먼트의 헤더 태그로 확인하므로, 세그먼트가 없는
+ * 빈 로그는 잘못된 키로도 열린다 (이후 쓰는 세그먼트는 그 키에 묶인다).
+ *
+ * @return 성공 시 0, 실패 시 -1, 파일 헤더 인증 실패(변조/잘못된 키) 시 -2
+ */
+static inline int tlog_open(TelemetryLog *log, const char *path, const unsigned char *master_key,
+                            int mode, uint32_t segment_size) {
+    char index_path[4096];
+    struct stat st;
+    int flags = (mode == TLOG_OPEN_READ) ? O_RDONLY : O_RDWR;
+
+    memset(log, 0, sizeof(*log));
+    log->fd = -1;
+    log->index_fd = -1;
+    log->writable = (mode != TLOG_OPEN_READ);
+    if (snprintf(index_path, sizeof(index_path), "%s.idx", path) >= (int)sizeof(index_path)) {
+        return -1;
+    }
+    if (mode == TLOG_OPEN_CREATE) {
+        segment_size = (segment_size == 0) ? TLOG_DEFAULT_SEGMENT : segment_size;
+        if (segment_size < TLOG_MIN_SEGMENT || segment_size > TLOG_MAX_SEGMENT) {
+            fprintf(stderr, "세그먼트 크기는 %d ~ %d바이트\n", TLOG_MIN_SEGMENT, TLOG_MAX_SEGMENT);
+            return -1;
+        }
+        memcpy(log->file_header, TLOG_MAGIC, 8);
+        tlog_put_be32(log->file_header + 8, TLOG_VERSION);
+        tlog_put_be32(log->file_header + 12, segment_size);
+        log->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        log->index_fd = open(index_path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (log->fd < 0 || log->index_fd < 0 ||
+            RAND_bytes(log->file_header + 16, TLOG_SALT_SIZE) != 1 ||
+            tlog_pwrite_full(log->fd, log->file_header, TLOG_FILE_HEADER_SIZE, 0) != 0) {
+            tlog_close(log);
+            return -1;
+        }
+    } else {
+        log->fd = open(path, flags);
+        // 색인이 없으면 로그에서 다시 만든다
+        log->index_fd = open(index_path, log->writable ? (O_RDWR | O_CREAT) : O_RDONLY, 0600);
+        if (log->fd < 0 ||
+            tlog_pread_full(log->fd, log->file_header, TLOG_FILE_HEADER_SIZE, 0) != 0 ||
+            memcmp(log->file_header, TLOG_MAGIC, 8) != 0 ||
+            tlog_get_be32(log->file_header + 8) != TLOG_VERSION) {
+            tlog_close(log);
+            return -1;
+        }
+        segment_size = tlog_get_be32(log->file_header + 12);
+        if (segment_size < TLOG_MIN_SEGMENT || segment_size > TLOG_MAX_SEGMENT) {
+            tlog_close(log);
+            return -2;
+        }
+    }
+    // 같은 순번을 다시 쓰더라도 nonce가 겹치지 않도록 세션마다 새 nonce 앞부분
+    if (log->writable) {
+        if (RAND_bytes((unsigned char *)&log->session, sizeof(log->session)) != 1) {
+            tlog_close(log);
+            return -1;
+        }
+        log->session &= TLOG_SESSION_MASK;
+    }
+    log->segment_size = segment_size;
+    log->end_offset = TLOG_FILE_HEADER_SIZE;
+    log->plain = malloc(segment_size);
+    log->sealed = malloc((size_t)segment_size + TLOG_SEG_PREFIX + TLOG_TAG_SIZE);
+    if (log->plain == NULL || log->sealed == NULL || tlog_derive_key(log, master_key) != 0 ||
+        (log->index_fd >= 0 && tlog_load_index(log) != 0) || fstat(log->fd, &st) != 0) {
+        tlog_close(log);
+        return -1;
+    }
+    // 색인이 로그보다 앞서 있으면 (로그 쓰기 전에 끊김) 로그 크기까지만 받아들인다
+    while (log->seg_count > 0 && log->end_offset > (uint64_t)st.st_size) {
+        log->seg_count--;
+        log->end_offset = log->segs[log->seg_count].offset;
+    }
+    if (tlog_check_index_end(log) != 0) {
+        tlog_close(log);
+        return -1;
+    }
+    if (log->seg_count > 0) {
+        log->last_ts = log->segs[log->seg_count - 1].last_ts;
+    } else {
+        log->has_records = 0;
+    }
+    int r = tlog_recover_tail(log, (uint64_t)st.st_size);
+    if (r != 0) {
+        tlog_close(log);
+        return r;
+    }
+    // 파일 헤더는 모든 태그의 AAD이므로 첫 항목 하나로 키와 헤더를 확인한다
+    if (log->seg_count > 0) {
+        r = tlog_verify_entry(log, &log->segs[0], NULL);
+        if (r != 0) {
+            tlog_close(log);
+            return r;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 버퍼의 레코드를 세그먼트 하나로 봉인하여 로그와 색인 끝에 붙인다.
+ */
+static inline int tlog_seal_segment(TelemetryLog *log) {
+    unsigned char aad[TLOG_FILE_HEADER_SIZE + TLOG_SEG_HEADER_SIZE];
+    unsigned char nonce[TLOG_NONCE_SIZE];
+    TlogSegment seg;
+
+    if (log->plain_records == 0) {
+        return 0;
+    }
+    if (log->seg_count >= TLOG_MAX_SEGMENTS) {
+        fprintf(stderr, "세그먼트 수 한도 도달: 새 로그(새 salt)로 교체하라\n");
+        return -1;
+    }
+    memset(&seg, 0, sizeof(seg));
+    seg.seq = log->seg_count;
+    seg.session = log->session;
+    seg.offset = log->end_offset;
+    seg.first_ts = log->plain_first_ts;
+    seg.last_ts = log->last_ts;
+    seg.records = log->plain_records;
+    seg.ct_len = (uint32_t)log->plain_len;
+
+    unsigned char *out = log->sealed;
+    tlog_encode_segment_header(&seg, out);
+    memcpy(aad, log->file_header, TLOG_FILE_HEADER_SIZE);
+    memcpy(aad + TLOG_FILE_HEADER_SIZE, out, TLOG_SEG_HEADER_SIZE);
+    tlog_nonce(nonce, 0, &seg);
+    if (tlog_header_tag(log, &seg, seg.header_tag) != 0 ||
+        cipher_key_seal(&log->key, nonce, aad, sizeof(aad), log->plain, log->plain_len,
+                        out + TLOG_SEG_PREFIX, out + TLOG_SEG_PREFIX + log->plain_len) != 0) {
+        return -1;
+    }
+    memcpy(out + TLOG_SEG_HEADER_SIZE, seg.header_tag, TLOG_TAG_SIZE);
+    seg.verified = 1;
+
+    // 로그를 먼저 쓰고 색인을 쓴다 (색인이 앞서면 열 때 버린다)
+    if (tlog_pwrite_full(log->fd, out, TLOG_SEG_PREFIX + log->plain_len + TLOG_TAG_SIZE,
+                         seg.offset) != 0 ||
+        tlog_write_index_entry(log, &seg) != 0 || tlog_push_segment(log, &seg) != 0) {
+        return -1;
+    }
+    log->plain_len = 0;
+    log->plain_records = 0;
+    return 0;
+}
+
+/**
+ * 레코드를 추가한다. 버퍼가 세그먼트 크기에 닿으면 봉인한다.
+ *
+ * @param ts 시각 (직전 레코드보다 작으면 거부)
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int tlog_append(TelemetryLog *log, int64_t ts, const void *data, size_t len) {
+    if (!log->writable || len > log->segment_size - TLOG_RECORD_HEADER ||
+        (log->has_records && ts < log->last_ts)) {
+        return -1;
+    }
+    if (log->plain_len + TLOG_RECORD_HEADER + len > log->segment_size &&
+        tlog_seal_segment(log) != 0) {
+        return -1;
+    }
+    unsigned char *p = log->plain + log->plain_len;
+    tlog_put_be64(p, (uint64_t)ts);
+    tlog_put_be32(p + 8, (uint32_t)len);
+    if (len > 0) {
+        memcpy(p + TLOG_RECORD_HEADER, data, len);
+    }
+    if (log->plain_records == 0) {
+        log->plain_first_ts = ts;
+    }
+    log->plain_len += TLOG_RECORD_HEADER + len;
+    log->plain_records++;
+    log->last_ts = ts;
+    log->has_records = 1;
+    return 0;
+}
+
+/**
+ * 버퍼를 봉인하고 로그, 색인 순으로 디스크에 반영한다.
+ */
+static inline int tlog_flush(TelemetryLog *log) {
+    if (!log->writable) {
+        return 0;
+    }
+    return (tlog_seal_segment(log) == 0 && fdatasync(log->fd) == 0 &&
+            fdatasync(log->index_fd) == 0) ? 0 : -1;
+}
+
+static inline uint64_t tlog_segment_count(const TelemetryLog *log) {
+    return log->seg_count;
+}
+
+/**
+ * 세그먼트 하나를 읽어 복호화하고 범위에 든 레코드를 콜백으로 넘긴다.
+ *
+ * @return 멈춤 요청 시 1, 계속 0, 실패 -1, 인증 실패 -2
+ */
+static inline int tlog_read_segment(TelemetryLog *log, const TlogSegment *seg,
+                                    int64_t from, int64_t to, TlogRecordFn fn, void *arg,
+                                    TlogQueryStats *stats) {
+    unsigned char aad[TLOG_FILE_HEADER_SIZE + TLOG_SEG_HEADER_SIZE];
+    unsigned char nonce[TLOG_NONCE_SIZE];
+    unsigned char *ct = log->sealed;
+    size_t len = seg->ct_len;
+
+    if (tlog_pread_full(log->fd, ct, len + TLOG_TAG_SIZE, seg->offset + TLOG_SEG_PREFIX) != 0) {
+        return -1;
+    }
+    memcpy(aad, log->file_header, TLOG_FILE_HEADER_SIZE);
+    tlog_encode_segment_header(seg, aad + TLOG_FILE_HEADER_SIZE);
+    tlog_nonce(nonce, 0, seg);
+    int r = cipher_key_open(&log->key, nonce, aad, sizeof(aad), ct, len, ct + len, ct);
+    if (r != 0) {
+        OPENSSL_cleanse(ct, len);
+        return r;
+    }
+    stats->segments_read++;
+    stats->bytes_read += TLOG_SEG_PREFIX + len + TLOG_TAG_SIZE;
+
+    // 인증된 평문이지만 레코드 경계는 방어적으로 확인한다
+    size_t pos = 0;
+    uint32_t count = 0;
+    int ret = 0;
+    while (ret == 0 && pos + TLOG_RECORD_HEADER <= len) {
+        int64_t ts = (int64_t)tlog_get_be64(ct + pos);
+        uint32_t rec_len = tlog_get_be32(ct + pos + 8);
+        if (rec_len > len - pos - TLOG_RECORD_HEADER) {
+            ret = -1;
+            break;
+        }
+        if (ts > to) {
+            ret = 1;                     // 시각이 단조이므로 이후 레코드는 모두 범위 밖
+            break;
+        }
+        if (ts >= from) {
+            stats->records++;
+            if (fn != NULL && fn(ts, ct + pos + TLOG_RECORD_HEADER, rec_len, arg) != 0) {
+                ret = 1;
+            }
+        }
+        pos += TLOG_RECORD_HEADER + rec_len;
+        count++;
+    }
+    if (ret == 0 && (pos != len || count != seg->records)) {
+        ret = -1;
+    }
+    OPENSSL_cleanse(ct, len);
+    return ret;
+}
+
+/**
+ * 시각 [from, to] 범위의 레코드를 시간 순으로 콜백에 넘긴다.
+ * 색인을 이진 탐색하여(들여다본 항목만 헤더 태그 검증) 겹치는 세그먼트만 복호화한다.
+ *
+ * @param stats 질의 통계 (NULL 가능)
+ * @return 범위에 든 레코드 수, 실패 시 -1, 인증 실패 시 -2
+ */
+static inline long long tlog_query(TelemetryLog *log, int64_t from, int64_t to,
+                                   TlogRecordFn fn, void *arg, TlogQueryStats *stats) {
+    TlogQueryStats local;
+    size_t lo = 0, hi = log->seg_count;
+    int r;
+
+    if (stats == NULL) {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (from > to) {
+        return 0;
+    }
+    // last_ts >= from인 첫 세그먼트
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if ((r = tlog_verify_entry(log, &log->segs[mid], stats)) != 0) {
+            return r;
+        }
+        if (log->segs[mid].last_ts < from) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (size_t i = lo; i < log->seg_count; i++) {
+        TlogSegment *seg = &log->segs[i];
+        if ((r = tlog_verify_entry(log, seg, stats)) != 0) {
+            return r;
+        }
+        if (seg->first_ts > to) {
+            break;
+        }
+        r = tlog_read_segment(log, seg, from, to, fn, arg, stats);
+        if (r < 0) {
+            return r;
+        }
+        if (r == 1) {
+            break;
+        }
+    }
+    return (long long)stats->records;
+}
+
+#endif /* TELEMETRY_LOG_H */
@@ -0,0 +1,831 @@
+/**
+ * entropy_map.h - 펌웨어 이미지 엔트로피/바이트 분포 지도
+ *
+ * 서명 전에 페이로드 안을 들여다보아, 있어서는 안 될 것처럼 보이는 구간을 찾는다.
+ *   - 슬라이딩 창(기본 4KB, 1KB씩 이동)마다 바이트 히스토그램과 섀넌 엔트로피
+ *     H = log2(n) - Σ c·log2(c) / n (비트/바이트)를 계산하고, 창을 분류한다:
+ *       PAD    한 바이트 값이 90% 이상 (0x00/0xFF 채움)
+ *       TEXT   인쇄 가능한 ASCII가 90% 이상
+ *       DATA   코드/테이블/일반 데이터
+ *       RANDOM 같은 크기 균등 난수의 기대 엔트로피에 가까움 → 암호화/압축 데이터
+ *   - 창 엔트로피가 5비트/바이트 미만인 구간(채움/텍스트/단순 테이블)에서 32바이트
+ *     창(8바이트씩 이동)의 서로 다른 바이트 수가 임계값(기본 28) 이상인 곳을 묶어
+ *     "키 후보"로 보고한다. 무작위 32바이트는 평균 30.1가지 값을 가진다. x86 기계어는
+ *     32바이트만 보면 이 정도로 다양한 경우가 흔하므로 엔트로피가 높은 구간은 보지 않는다.
+ *
+ * 히스토그램 계산:
+ *   - 바이트 세기는 서로 다른 바이트가 같은 칸을 갱신하는 산포(scatter)라 SIMD로
+ *     직접 세기 어렵다. 그래서 보조 히스토그램 4개에 번갈아 세어 같은 칸 갱신의
+ *     저장→적재 의존을 끊고, 보조 히스토그램은 비우지 않고 누적한다.
+ *   - 이동 단위(step)마다 4개를 더한 누적 스냅숏을 고리 버퍼에 두면, 창의 히스토그램은
+ *     "지금 스냅숏 - 창 시작 스냅숏"이다 (uint32 순환 뺄셈이므로 넘쳐도 정확).
+ *     이 합산/뺄셈과 서로 다른 값 수/최댓값/인쇄 가능 합계는 256칸 벡터 연산이며,
+ *     실행 시 cpu_features.h로 AVX-512 → AVX2 → 128비트 벡터 중 가장 넓은 엔진을 고른다
+ *     (CRYPTO_FORCE_GENERIC=1이면 128비트).
+ *   - 창 목록을 연속 구간으로 나눠 코어마다 하나씩 맡는다. 각 작업자는 자기 첫 창을
+ *     위해 앞쪽 이동 단위 몇 개를 더 읽을 뿐 서로 공유하는 상태가 없다. 키 후보 검사는
+ *     이웃 구간의 분류도 보므로 모든 창이 끝난 뒤 같은 분할로 한 번 더 돌린다.
+ *
+ * 사용 예:
+ *   EntropyMapConfig cfg = { 0 };       // 기본값: 4KB 창, 1KB 이동, 모든 코어, 자동 엔진
+ *   EntropyMap map;
+ *   entropy_map_compute(image, len, &cfg, &map);
+ *   for (size_t i = 0; i < map.row_count; i++) ... map.rows[i].entropy ...
+ *   entropy_map_free(&map);
+ */
+
+#ifndef ENTROPY_MAP_H
+#define ENTROPY_MAP_H
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "cpu_features.h"
+
+#define EMAP_DEFAULT_WINDOW 4096
+#define EMAP_DEFAULT_STEP 1024
+#define EMAP_MAX_WINDOW 65536
+#define EMAP_MAX_TILES 64                // 창 / 이동 단위 최댓값
+#define EMAP_MAX_THREADS 256
+#define EMAP_KEY_WINDOW 32
+#define EMAP_KEY_STEP 8
+#define EMAP_DEFAULT_KEY_DISTINCT 28
+#define EMAP_KEY_CONTEXT 5.0             // 키 후보는 창 엔트로피가 이보다 낮은 곳에서만 찾는다
+#define EMAP_RANDOM_MARGIN 0.08          // 균등 난수 기대 엔트로피에서 뺀 RANDOM 임계
+#define EMAP_DOMINANT_SHARE 0.90         // PAD/TEXT 판정 비율
+#define EMAP_READ_AHEAD 8192              // 입력 소프트웨어 프리페치 거리 (바이트)
+
+/**
+ * 창 분류
+ */
+typedef enum {
+    EMAP_PAD = 0,
+    EMAP_TEXT,
+    EMAP_DATA,
+    EMAP_RANDOM,
+    EMAP_CLASS_COUNT
+} EntropyClass;
+
+/**
+ * 벡터 엔진 종류
+ */
+typedef enum {
+    EMAP_ENGINE_AUTO = 0,                // 설정에서만 사용: CPU에 맞게 선택
+    EMAP_ENGINE_VEC4,                    // 128비트 (x86-64 SSE2 / ARM NEON)
+    EMAP_ENGINE_AVX2,
+    EMAP_ENGINE_AVX512,
+    EMAP_ENGINE_COUNT
+} EntropyEngine;
+
+/**
+ * 설정 (0인 필드는 기본값)
+ */
+typedef struct {
+    uint32_t window;                     // 창 크기 (바이트, step의 배수, 최대 64KB)
+    uint32_t step;                       // 창 이동 단위 (바이트)
+    int threads;                         // 작업자 수 (0 = 온라인 코어 수)
+    double random_threshold;             // RANDOM 판정 엔트로피 (0 = 창 크기로 자동)
+    int key_distinct;                    // 키 후보 판정: 32바이트 창의 서로 다른 값 수 (0 = 28, 음수 = 끔)
+    EntropyEngine engine;                // 0 = 자동 (지원하지 않는 엔진을 지정하면 실패)
+} EntropyMapConfig;
+
+/**
+ * 창 하나의 요약 (창 시작 = 번호 × step)
+ */
+typedef struct {
+    uint64_t offset;
+    uint32_t length;                     // 마지막 창은 짧을 수 있다
+    float entropy;                       // 비트/바이트 (0~8)
+    uint32_t top_count;                  // 가장 많은 바이트 값의 개수
+    uint32_t printable;                  // 인쇄 가능한 ASCII + \t\n\r 개수
+    uint16_t distinct;                   // 나타난 바이트 값 수 (1~256)
+    uint8_t top_byte;
+    uint8_t cls;                         // EntropyClass
+} EntropyRow;
+
+/**
+ * 키 후보 구간 (겹치거나 맞닿은 32바이트 창을 합친 것)
+ */
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+    uint32_t max_distinct;
+} EntropyKeyCandidate;
+
+typedef struct {
+    EntropyRow *rows;
+    size_t row_count;
+    EntropyKeyCandidate *keys;
+    size_t key_count;
+    uint32_t window;
+    uint32_t step;
+    int threads;
+    double random_threshold;
+    EntropyEngine engine;
+} EntropyMap;
+
+typedef uint32_t emap_v4 __attribute__((vector_size(16)));
+typedef uint32_t emap_v8 __attribute__((vector_size(32)));
+typedef uint32_t emap_v16 __attribute__((vector_size(64)));
+typedef uint64_t emap_q2 __attribute__((vector_size(16)));
+typedef uint64_t emap_q4 __attribute__((vector_size(32)));
+typedef uint64_t emap_q8 __attribute__((vector_size(64)));
+typedef uint8_t emap_b2 __attribute__((vector_size(2)));
+typedef uint8_t emap_b4 __attribute__((vector_size(4)));
+typedef uint8_t emap_b8 __attribute__((vector_size(8)));
+
+/**
+ * 8바이트 묶음 겹침 검사 (SWAR, uint64_t와 uint64 벡터 모두에 쓴다)
+ *
+ * self: 같은 묶음 안 앞쪽 바이트와 값이 같은 바이트 (바이트 i와 i-k, k = 1..7)
+ * pair: self에 더해 바로 앞 묶음의 어느 바이트와 값이 같은 바이트 (앞 묶음을 8가지로 회전)
+ * 결과 마스크는 해당 바이트의 최상위 비트만 켠다.
+ */
+#define EMAP_LOW7 0x7f7f7f7f7f7f7f7fULL
+#define EMAP_ZERO_BYTES(x) (~((((x) & EMAP_LOW7) + EMAP_LOW7) | (x) | EMAP_LOW7))
+#define EMAP_SELF_ROUND(v, self, k) \
+    (self) |= EMAP_ZERO_BYTES((v) ^ ((v) << (k))) & (~0ULL << (k))
+#define EMAP_PAIR_ROUND(v, prev, pair, k) \
+    (pair) |= EMAP_ZERO_BYTES((v) ^ (((prev) << (k)) | ((prev) >> (64 - (k)))))
+#define EMAP_DUP_MASKS(v, prev, self, pair)                                              \
+    do {                                                                                 \
+        (self) = (v) ^ (v);                                                              \
+        EMAP_SELF_ROUND(v, self, 8);                                                     \
+        EMAP_SELF_ROUND(v, self, 16);                                                    \
+        EMAP_SELF_ROUND(v, self, 24);                                                    \
+        EMAP_SELF_ROUND(v, self, 32);                                                    \
+        EMAP_SELF_ROUND(v, self, 40);                                                    \
+        EMAP_SELF_ROUND(v, self, 48);                                                    \
+        EMAP_SELF_ROUND(v, self, 56);                                                    \
+        (pair) = (self) | EMAP_ZERO_BYTES((v) ^ (prev));                                 \
+        EMAP_PAIR_ROUND(v, prev, pair, 8);                                               \
+        EMAP_PAIR_ROUND(v, prev, pair, 16);                                              \
+        EMAP_PAIR_ROUND(v, prev, pair, 24);                                              \
+        EMAP_PAIR_ROUND(v, prev, pair, 32);                                              \
+        EMAP_PAIR_ROUND(v, prev, pair, 40);                                              \
+        EMAP_PAIR_ROUND(v, prev, pair, 48);                                              \
+        EMAP_PAIR_ROUND(v, prev, pair, 56);                                              \
+    } while (0)
+/* 마스크의 켜진 바이트 수 (레인마다) */
+#define EMAP_MASK_COUNT(m, c)                                                            \
+    do {                                                                                 \
+        (c) = (m) >> 7;                                                                  \
+        (c) += (c) >> 32;                                                                \
+        (c) += (c) >> 16;                                                                \
+        (c) += (c) >> 8;                                                                 \
+    } while (0)
+
+/**
+ * 묶음 i 하나의 겹침 수 (i = 0이면 앞 묶음이 없으므로 pair는 쓰지 않는다)
+ */
+static inline void emap_block_dups(const unsigned char *p, size_t i, uint8_t *self_out,
+                                   uint8_t *pair_out) {
+    uint64_t v, prev = 0, self, pair, c;
+    memcpy(&v, p + 8 * i, 8);
+    if (i > 0) {
+        memcpy(&prev, p + 8 * i - 8, 8);
+    }
+    EMAP_DUP_MASKS(v, prev, self, pair);
+    EMAP_MASK_COUNT(self, c);
+    self_out[i] = (uint8_t)c;
+    EMAP_MASK_COUNT(pair, c);
+    pair_out[i] = (uint8_t)c;
+}
+
+/**
+ * 256칸 히스토그램 커널 (엔진별로 벡터 폭만 다르다)
+ *
+ * merge: 누적 보조 히스토그램 4개의 합을 스냅숏으로 저장한다.
+ * stats: 창 히스토그램 = now - old를 저장하고, 서로 다른 값 수/최댓값/인쇄 가능 합계를 센다.
+ * dups:  연속한 8바이트 묶음마다 emap_block_dups를 레인당 하나씩 계산한다.
+ */
+#define EMAP_DEFINE_KERNELS(SUFFIX, VEC, VEC64, VEC8, ATTR)                          \
+ATTR static void emap_merge_##SUFFIX(uint32_t *snapshot, const uint32_t (*sub)[256]) { \
+    for (int i = 0; i < 256; i += (int)(sizeof(VEC) / 4)) {                          \
+        VEC a, b, c, d;                                                               \
+        memcpy(&a, sub[0] + i, sizeof(VEC));                                          \
+        memcpy(&b, sub[1] + i, sizeof(VEC));                                          \
+        memcpy(&c, sub[2] + i, sizeof(VEC));                                          \
+        memcpy(&d, sub[3] + i, sizeof(VEC));                                          \
+        a = (a + b) + (c + d);                                                        \
+        memcpy(snapshot + i, &a, sizeof(VEC));                                        \
+    }                                                                                 \
+}                                                                                     \
+                                                                                      \
+ATTR static void emap_stats_##SUFFIX(const uint32_t *now, const uint32_t *old,       \
+                                     const uint32_t *printable_mask, uint32_t *win,   \
+                                     uint32_t *distinct, uint32_t *top,               \
+                                     uint32_t *printable) {                           \
+    VEC dist = { 0 }, maxv = { 0 }, prn = { 0 };                                      \
+    for (int i = 0; i < 256; i += (int)(sizeof(VEC) / 4)) {                          \
+        VEC a, b, m;                                                                  \
+        memcpy(&a, now + i, sizeof(VEC));                                             \
+        memcpy(&b, old + i, sizeof(VEC));                                             \
+        memcpy(&m, printable_mask + i, sizeof(VEC));                                  \
+        VEC c = a - b;                                                                \
+        memcpy(win + i, &c, sizeof(VEC));                                             \
+        dist -= (VEC)(c != 0);           /* 참인 레인은 -1 */                          \
+        VEC gt = (VEC)(c > maxv);                                                     \
+        maxv = (c & gt) | (maxv & ~gt);                                               \
+        prn += c & m;                                                                 \
+    }                                                                                 \
+    uint32_t d = 0, mx = 0, p = 0;                                                    \
+    for (int l = 0; l < (int)(sizeof(VEC) / 4); l++) {                                \
+        d += dist[l];                                                                 \
+        mx = (maxv[l] > mx) ? maxv[l] : mx;                                           \
+        p += prn[l];                                                                  \
+    }                                                                                 \
+    *distinct = d;                                                                    \
+    *top = mx;                                                                        \
+    *printable = p;                                                                   \
+}                                                                                     \
+                                                                                      \
+ATTR static void emap_dups_##SUFFIX(const unsigned char *p, size_t blocks,            \
+                                    uint8_t *self_out, uint8_t *pair_out) {           \
+    const size_t lanes = sizeof(VEC8);                                                \
+    size_t i = 1;                                                                     \
+    if (blocks == 0) return;                                                          \
+    emap_block_dups(p, 0, self_out, pair_out);                                        \
+    for (; i + lanes <= blocks; i += lanes) {                                         \
+        VEC64 v, prev, self, pair, c;                                                 \
+        __builtin_prefetch(p + 8 * i + EMAP_READ_AHEAD);                              \
+        memcpy(&v, p + 8 * i, sizeof(VEC64));                                         \
+        memcpy(&prev, p + 8 * i - 8, sizeof(VEC64));                                  \
+        EMAP_DUP_MASKS(v, prev, self, pair);                                          \
+        EMAP_MASK_COUNT(self, c);                                                     \
+        VEC8 n = __builtin_convertvector(c & 0xff, VEC8);                             \
+        memcpy(self_out + i, &n, sizeof(VEC8));                                       \
+        EMAP_MASK_COUNT(pair, c);                                                     \
+        n = __builtin_convertvector(c & 0xff, VEC8);                                  \
+        memcpy(pair_out + i, &n, sizeof(VEC8));                                       \
+    }                                                                                 \
+    for (; i < blocks; i++) {                                                         \
+        emap_block_dups(p, i, self_out, pair_out);                                    \
+    }                                                                                 \
+}
+
+EMAP_DEFINE_KERNELS(x4, emap_v4, emap_q2, emap_b2, )
+#if defined(CPU_FEATURES_X86)
+EMAP_DEFINE_KERNELS(x8, emap_v8, emap_q4, emap_b4, __attribute__((target("avx2"))))
+EMAP_DEFINE_KERNELS(x16, emap_v16, emap_q8, emap_b8, __attribute__((target("avx512f"))))
+#endif
+
+static inline const char *entropy_engine_name(EntropyEngine engine) {
+    switch (engine) {
+    case EMAP_ENGINE_AVX512: return "avx512 x16";
+    case EMAP_ENGINE_AVX2:   return "avx2 x8";
+    default:                 return "vec x4";
+    }
+}
+
+static inline const char *entropy_class_name(int cls) {
+    static const char *names[EMAP_CLASS_COUNT] = { "pad", "text", "data", "random" };
+    return (cls >= 0 && cls < EMAP_CLASS_COUNT) ? names[cls] : "?";
+}
+
+/**
+ * 이 CPU에서 엔진을 사용할 수 있는지 확인한다.
+ */
+static inline int entropy_engine_supported(EntropyEngine engine) {
+    switch (engine) {
+    case EMAP_ENGINE_VEC4:
+        return 1;
+#if defined(CPU_FEATURES_X86)
+    case EMAP_ENGINE_AVX2:
+        return cpu_features_get()->avx2;
+    case EMAP_ENGINE_AVX512:
+        return cpu_features_get()->avx512f;
+#endif
+    default:
+        return 0;
+    }
+}
+
+/**
+ * 이 CPU에서 가장 넓은 엔진을 고른다.
+ */
+static inline EntropyEngine entropy_best_engine(void) {
+    for (int e = EMAP_ENGINE_COUNT - 1; e > EMAP_ENGINE_VEC4; e--) {
+        if (entropy_engine_supported((EntropyEngine)e)) {
+            return (EntropyEngine)e;
+        }
+    }
+    return EMAP_ENGINE_VEC4;
+}
+
+/**
+ * n바이트 균등 난수의 섀넌 엔트로피 기댓값 근사: 8 - 255 / (2 n ln 2)
+ */
+static inline double entropy_random_expectation(uint32_t n) {
+    return 8.0 - 255.0 / (2.0 * (double)n * log(2.0));
+}
+
+/**
+ * 창 개수: 마지막 창이 이미지 끝에 닿을 때까지 (이미지가 창보다 짧으면 1개)
+ */
+static inline size_t entropy_row_count(uint64_t len, uint32_t window, uint32_t step) {
+    if (len == 0) return 0;
+    if (len <= window) return 1;
+    return (size_t)((len - window + step - 1) / step) + 1;
+}
+
+/* ===== 작업자 ===== */
+
+typedef struct {
+    const unsigned char *data;
+    uint64_t len;
+    uint32_t window;
+    uint32_t step;
+    uint32_t tiles;                      // window / step
+    size_t row_count;
+    double random_threshold;
+    int key_distinct;
+    EntropyEngine engine;
+    const double *clog;                  // clog[c] = c·log2(c), c = 0..window
+    const uint32_t *printable_mask;      // 인쇄 가능 바이트 칸은 0xffffffff
+    EntropyRow *rows;
+} EntropyJob;
+
+typedef struct {
+    const EntropyJob *job;
+    size_t row_begin;
+    size_t row_end;
+    EntropyKeyCandidate *keys;
+    size_t key_count;
+    size_t key_capacity;
+    int failed;
+} EntropyWorker;
+
+/**
+ * 보조 히스토그램 4개에 번갈아 센다 (8바이트씩 읽어 4칸씩 두 번).
+ * 8바이트가 모두 같은 값이면 한 번에 8을 더한다.
+ */
+static inline void emap_count(uint32_t (*sub)[256], const unsigned char *p, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t v;
+        if ((i & 63) == 0) {
+            __builtin_prefetch(p + i + EMAP_READ_AHEAD);
+        }
+        memcpy(&v, p + i, 8);
+        if (v == (v & 0xff) * 0x0101010101010101ULL) {
+            sub[(i >> 3) & 3][v & 0xff] += 8;   // 채움: 같은 칸 8번 갱신의 의존 사슬을 피한다
+            continue;
+        }
+        sub[0][v & 0xff]++;
+        sub[1][(v >> 8) & 0xff]++;
+        sub[2][(v >> 16) & 0xff]++;
+        sub[3][(v >> 24) & 0xff]++;
+        sub[0][(v >> 32) & 0xff]++;
+        sub[1][(v >> 40) & 0xff]++;
+        sub[2][(v >> 48) & 0xff]++;
+        sub[3][v >> 56]++;
+    }
+    for (; i < n; i++) {
+        sub[i & 3][p[i]]++;
+    }
+}
+
+static inline void emap_dups(EntropyEngine engine, const unsigned char *p, size_t blocks,
+                             uint8_t *self_out, uint8_t *pair_out) {
+#if defined(CPU_FEATURES_X86)
+    if (engine == EMAP_ENGINE_AVX512) {
+        emap_dups_x16(p, blocks, self_out, pair_out);
+        return;
+    }
+    if (engine == EMAP_ENGINE_AVX2) {
+        emap_dups_x8(p, blocks, self_out, pair_out);
+        return;
+    }
+#endif
+    (void)engine;
+    emap_dups_x4(p, blocks, self_out, pair_out);
+}
+
+static inline void emap_merge(EntropyEngine engine, uint32_t *snapshot,
+                              const uint32_t (*sub)[256]) {
+#if defined(CPU_FEATURES_X86)
+    if (engine == EMAP_ENGINE_AVX512) {
+        emap_merge_x16(snapshot, sub);
+        return;
+    }
+    if (engine == EMAP_ENGINE_AVX2) {
+        emap_merge_x8(snapshot, sub);
+        return;
+    }
+#endif
+    (void)engine;
+    emap_merge_x4(snapshot, sub);
+}
+
+/**
+ * 창 히스토그램에서 행 하나를 채운다.
+ */
+static inline void emap_finish_row(const EntropyJob *job, size_t r, const uint32_t *now,
+                                   const uint32_t *old) {
+    uint32_t win[256] __attribute__((aligned(64)));
+    uint32_t distinct, top, printable;
+    EntropyRow *row = &job->rows[r];
+
+#if defined(CPU_FEATURES_X86)
+    if (job->engine == EMAP_ENGINE_AVX512) {
+        emap_stats_x16(now, old, job->printable_mask, win, &distinct, &top, &printable);
+    } else if (job->engine == EMAP_ENGINE_AVX2) {
+        emap_stats_x8(now, old, job->printable_mask, win, &distinct, &top, &printable);
+    } else
+#endif
+    {
+        emap_stats_x4(now, old, job->printable_mask, win, &distinct, &top, &printable);
+    }
+
+    uint64_t start = (uint64_t)r * job->step;
+    uint64_t end = start + job->window < job->len ? start + job->window : job->len;
+    uint32_t n = (uint32_t)(end - start);
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;  // 덧셈 지연 사슬을 넷으로 나눈다
+    for (int i = 0; i < 256; i += 4) {
+        s0 += job->clog[win[i]];
+        s1 += job->clog[win[i + 1]];
+        s2 += job->clog[win[i + 2]];
+        s3 += job->clog[win[i + 3]];
+    }
+    double sum = (s0 + s1) + (s2 + s3);
+    row->offset = start;
+    row->length = n;
+    row->entropy = (n > 0) ? (float)(log2((double)n) - sum / (double)n) : 0.0f;
+    row->distinct = (uint16_t)distinct;
+    row->top_count = top;
+    row->printable = printable;
+    row->top_byte = 0;
+    if (top * 2 > n) {                   // 과반인 값은 하나뿐이므로 그때만 찾는다
+        for (int i = 0; i < 256; i++) {
+            if (win[i] == top) {
+                row->top_byte = (uint8_t)i;
+                break;
+            }
+        }
+    }
+
+    // 창이 짧으면 같은 길이 난수의 기대값으로 비교한다
+    double random_threshold = (n == job->window)
+                                  ? job->random_threshold
+                                  : entropy_random_expectation(n) - EMAP_RANDOM_MARGIN;
+    if (top >= EMAP_DOMINANT_SHARE * n) {
+        row->cls = EMAP_PAD;
+    } else if (printable >= EMAP_DOMINANT_SHARE * n) {
+        row->cls = EMAP_TEXT;
+    } else if (n >= 256 && row->entropy >= random_threshold) {
+        row->cls = EMAP_RANDOM;
+    } else {
+        row->cls = EMAP_DATA;
+    }
+}
+
+static inline int emap_add_key(EntropyWorker *w, uint64_t start, uint32_t distinct) {
+    uint64_t end = start + EMAP_KEY_WINDOW;
+    if (w->key_count > 0 && w->keys[w->key_count - 1].end >= start) {
+        EntropyKeyCandidate *k = &w->keys[w->key_count - 1];
+        k->end = end;
+        if (distinct > k->max_distinct) k->max_distinct = distinct;
+        return 0;
+    }
+    if (w->key_count == w->key_capacity) {
+        size_t cap = w->key_capacity ? w->key_capacity * 2 : 64;
+        EntropyKeyCandidate *keys = realloc(w->keys, cap * sizeof(*keys));
+        if (keys == NULL) return -1;
+        w->keys = keys;
+        w->key_capacity = cap;
+    }
+    w->keys[w->key_count++] = (EntropyKeyCandidate){ start, end, distinct };
+    return 0;
+}
+
+/**
+ * 이동 단위 t를 덮는 창 중 엔트로피가 EMAP_KEY_CONTEXT 이상인 것이 있는지 확인한다.
+ */
+static inline int emap_tile_busy(const EntropyJob *job, uint64_t t) {
+    uint64_t first = (t + 1 >= job->tiles) ? t + 1 - job->tiles : 0;
+    uint64_t last = (t < job->row_count) ? t : job->row_count - 1;
+    for (uint64_t r = first; r <= last; r++) {
+        if (job->rows[r].entropy >= EMAP_KEY_CONTEXT) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 32바이트 창의 서로 다른 값 수 (비트맵)
+ */
+static inline uint32_t emap_key_distinct(const unsigned char *p) {
+    uint64_t seen[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < EMAP_KEY_WINDOW; i++) {
+        seen[p[i] >> 6] |= 1ULL << (p[i] & 63);
+    }
+    return (uint32_t)(__builtin_popcountll(seen[0]) + __builtin_popcountll(seen[1]) +
+                      __builtin_popcountll(seen[2]) + __builtin_popcountll(seen[3]));
+}
+
+/**
+ * 작업자의 창 구간 [row_begin, row_end)에서 32바이트 키 후보 창을 찾는다.
+ * 시작이나 끝이 고엔트로피 창(코드, 암호화/압축 데이터) 안에 있는 키 창은 건너뛴다.
+ * 다른 작업자의 행을 읽으므로 모든 행이 채워진 뒤에 실행한다.
+ *
+ * 키 창을 8바이트 묶음 4개로 보면, 첫 묶음의 self 겹침과 나머지 세 묶음의 pair 겹침은
+ * 모두 창 안에서 앞쪽에 같은 값이 있는 서로 다른 바이트다. 그래서 이 합은
+ * 32 - (서로 다른 값 수) 이하이고, 합이 32 - key_distinct 이하인 창만 정확히 센다.
+ * 겹침 수는 벡터 엔진으로 타일 전체를 한꺼번에 구하며, 채움/텍스트/단순 테이블은
+ * 대부분 여기서 걸러진다.
+ */
+static inline int emap_key_scan(EntropyWorker *w) {
+    const EntropyJob *job = w->job;
+    const unsigned char *p = job->data;
+    uint64_t stop = (w->row_end == job->row_count) ? job->len : (uint64_t)w->row_end * job->step;
+    uint32_t budget = EMAP_KEY_WINDOW - (uint32_t)job->key_distinct;
+    // 타일 하나(마지막 행은 창 하나 길이까지)의 키 창 + 뒤쪽 묶음 3개
+    size_t max_blocks = EMAP_MAX_WINDOW / EMAP_KEY_STEP + 8;
+    uint8_t *dups = malloc(2 * max_blocks);
+    uint8_t *pair = dups + max_blocks;
+
+    if (dups == NULL) {
+        return -1;
+    }
+    int next_busy = (job->len >= EMAP_KEY_WINDOW) ? emap_tile_busy(job, w->row_begin) : 1;
+    for (size_t r = w->row_begin; r < w->row_end && job->len >= EMAP_KEY_WINDOW; r++) {
+        uint64_t tile_start = (uint64_t)r * job->step;
+        uint64_t tile_end = (r + 1 == job->row_count) ? stop : tile_start + job->step;
+        uint64_t last = job->len - EMAP_KEY_WINDOW + 1;  // 키 창 시작 상한 (미포함)
+        uint64_t o_end = tile_end < last ? tile_end : last;
+        int busy = next_busy;
+        next_busy = emap_tile_busy(job, r + 1);
+        if (busy || o_end <= tile_start) {
+            continue;
+        }
+        size_t windows = (size_t)((o_end - tile_start + EMAP_KEY_STEP - 1) / EMAP_KEY_STEP);
+        emap_dups(job->engine, p + tile_start, windows + 3, dups, pair);
+        for (size_t j = 0; j < windows; j++) {
+            uint64_t o = tile_start + (uint64_t)j * EMAP_KEY_STEP;
+            uint32_t sum = (uint32_t)dups[j] + pair[j + 1] + pair[j + 2] + pair[j + 3];
+            if (sum > budget || (next_busy && o + EMAP_KEY_WINDOW > tile_end)) {
+                continue;
+            }
+            uint32_t distinct = emap_key_distinct(p + o);
+            if (distinct >= (uint32_t)job->key_distinct && emap_add_key(w, o, distinct) != 0) {
+                free(dups);
+                return -1;
+            }
+        }
+    }
+    free(dups);
+    return 0;
+}
+
+static void *emap_worker(void *arg) {
+    EntropyWorker *w = arg;
+    const EntropyJob *job = w->job;
+    uint32_t (*sub)[256] = aligned_alloc(64, 4 * 256 * sizeof(uint32_t));
+    uint32_t (*ring)[256] = aligned_alloc(64, (EMAP_MAX_TILES + 1) * 256 * sizeof(uint32_t));
+    uint32_t slots = job->tiles + 1;
+    uint64_t tile_count = (job->len + job->step - 1) / job->step;
+
+    if (sub == NULL || ring == NULL) {
+        free(sub);
+        free(ring);
+        w->failed = 1;
+        return NULL;
+    }
+    memset(sub, 0, 4 * 256 * sizeof(uint32_t));
+    memset(ring[w->row_begin % slots], 0, 256 * sizeof(uint32_t));
+
+    // 타일 k를 센 뒤의 누적값은 ring[(k + 1) % slots], 행 r의 창은 타일 r .. r + tiles - 1
+    size_t next_row = w->row_begin;
+    for (uint64_t k = w->row_begin; k < tile_count && next_row < w->row_end; k++) {
+        uint64_t start = k * job->step;
+        size_t n = (start + job->step <= job->len) ? job->step : (size_t)(job->len - start);
+        emap_count(sub, job->data + start, n);
+        emap_merge(job->engine, ring[(k + 1) % slots], (const uint32_t (*)[256])sub);
+        if (k + 1 >= (uint64_t)next_row + job->tiles || k + 1 == tile_count) {
+            emap_finish_row(job, next_row, ring[(k + 1) % slots], ring[next_row % slots]);
+            next_row++;
+        }
+    }
+    // 이미지 끝에 닿은 행 (마지막 행만 해당)
+    while (next_row < w->row_end) {
+        emap_finish_row(job, next_row, ring[tile_count % slots], ring[next_row % slots]);
+        next_row++;
+    }
+    free(sub);
+    free(ring);
+    return NULL;
+}
+
+static void *emap_key_worker(void *arg) {
+    EntropyWorker *w = arg;
+    if (emap_key_scan(w) != 0) {
+        w->failed = 1;
+    }
+    return NULL;
+}
+
+/**
+ * 작업자마다 스레드를 하나씩 실행하고 모두 기다린다.
+ *
+ * @return 모두 실행되었고 실패한 작업자가 없으면 0
+ */
+static inline int emap_run(EntropyWorker *workers, pthread_t *tids, int threads,
+                           void *(*fn)(void *)) {
+    int started = 0;
+    for (; started < threads; started++) {
+        if (pthread_create(&tids[started], NULL, fn, &workers[started]) != 0) {
+            break;
+        }
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    if (started < threads) {
+        return -1;
+    }
+    for (int t = 0; t < threads; t++) {
+        if (workers[t].failed) return -1;
+    }
+    return 0;
+}
+
+/**
+ * 이미지 전체의 엔트로피 지도를 만든다.
+ *
+ * @return 성공 시 0, 잘못된 설정 또는 할당/스레드 실패 시 -1
+ */
+static inline int entropy_map_compute(const unsigned char *data, uint64_t len,
+                                      const EntropyMapConfig *cfg, EntropyMap *map) {
+    EntropyJob job;
+    uint32_t window = cfg->window ? cfg->window : EMAP_DEFAULT_WINDOW;
+    uint32_t step = cfg->step ? cfg->step : (cfg->window ? window / 4 : EMAP_DEFAULT_STEP);
+    int threads = cfg->threads;
+    int ret = -1;
+
+    memset(map, 0, sizeof(*map));
+    if (step == 0 || window > EMAP_MAX_WINDOW || window % step != 0 ||
+        window / step > EMAP_MAX_TILES ||
+        (cfg->engine != EMAP_ENGINE_AUTO && !entropy_engine_supported(cfg->engine))) {
+        return -1;
+    }
+    if (threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cores > 0) ? (int)cores : 1;
+    }
+    if (threads > EMAP_MAX_THREADS) threads = EMAP_MAX_THREADS;
+
+    memset(&job, 0, sizeof(job));
+    job.data = data;
+    job.len = len;
+    job.window = window;
+    job.step = step;
+    job.tiles = window / step;
+    job.row_count = entropy_row_count(len, window, step);
+    job.random_threshold = cfg->random_threshold > 0.0
+                               ? cfg->random_threshold
+                               : entropy_random_expectation(window) - EMAP_RANDOM_MARGIN;
+    job.key_distinct = cfg->key_distinct == 0 ? EMAP_DEFAULT_KEY_DISTINCT : cfg->key_distinct;
+    job.engine = (cfg->engine != EMAP_ENGINE_AUTO) ? cfg->engine : entropy_best_engine();
+    if ((size_t)threads > job.row_count) {
+        threads = job.row_count > 0 ? (int)job.row_count : 1;
+    }
+
+    double *clog = malloc(((size_t)window + 1) * sizeof(double));
+    uint32_t *printable_mask = aligned_alloc(64, 256 * sizeof(uint32_t));
+    EntropyRow *rows = calloc(job.row_count ? job.row_count : 1, sizeof(EntropyRow));
+    EntropyWorker *workers = calloc((size_t)threads, sizeof(EntropyWorker));
+    pthread_t *tids = calloc((size_t)threads, sizeof(pthread_t));
+    if (clog == NULL || printable_mask == NULL || rows == NULL || workers == NULL ||
+        tids == NULL) {
+        goto cleanup;
+    }
+    clog[0] = 0.0;
+    for (uint32_t c = 1; c <= window; c++) {
+        clog[c] = (double)c * log2((double)c);
+    }
+    for (int b = 0; b < 256; b++) {
+        int print = (b >= 0x20 && b < 0x7f) || b == '\t' || b == '\n' || b == '\r';
+        printable_mask[b] = print ? 0xffffffffu : 0;
+    }
+    job.clog = clog;
+    job.printable_mask = printable_mask;
+    job.rows = rows;
+
+    for (int t = 0; t < threads; t++) {
+        workers[t].job = &job;
+        workers[t].row_begin = job.row_count * (size_t)t / (size_t)threads;
+        workers[t].row_end = job.row_count * (size_t)(t + 1) / (size_t)threads;
+    }
+    // 1단계: 창 통계와 분류, 2단계: 분류를 보고 키 후보 검사
+    if (emap_run(workers, tids, threads, emap_worker) != 0 ||
+        (job.key_distinct > 0 && emap_run(workers, tids, threads, emap_key_worker) != 0)) {
+        goto cleanup;
+    }
+
+    // 작업자별 키 후보를 이어 붙이고 경계에서 맞닿은 것은 합친다
+    size_t total = 0;
+    for (int t = 0; t < threads; t++) {
+        total += workers[t].key_count;
+    }
+    map->keys = malloc((total ? total : 1) * sizeof(EntropyKeyCandidate));
+    if (map->keys == NULL) {
+        goto cleanup;
+    }
+    for (int t = 0; t < threads; t++) {
+        for (size_t i = 0; i < workers[t].key_count; i++) {
+            EntropyKeyCandidate k = workers[t].keys[i];
+            if (map->key_count > 0 && map->keys[map->key_count - 1].end >= k.start) {
+                EntropyKeyCandidate *prev = &map->keys[map->key_count - 1];
+                prev->end = k.end > prev->end ? k.end : prev->end;
+                if (k.max_distinct > prev->max_distinct) prev->max_distinct = k.max_distinct;
+            } else {
+                map->keys[map->key_count++] = k;
+            }
+        }
+    }
+
+    map->rows = rows;
+    map->row_count = job.row_count;
+    map->window = window;
+    map->step = step;
+    map->threads = threads;
+    map->random_threshold = job.random_threshold;
+    map->engine = job.engine;
+    rows = NULL;
+    ret = 0;
+
+cleanup:
+    if (workers != NULL) {
+        for (int t = 0; t < threads; t++) {
+            free(workers[t].keys);
+        }
+    }
+    if (ret != 0) {
+        free(map->keys);
+        map->keys = NULL;
+        map->key_count = 0;
+    }
+    free(rows);
+    free(workers);
+    free(tids);
+    free(clog);
+    free(printable_mask);
+    return ret;
+}
+
+static inline void entropy_map_free(EntropyMap *map) {
+    free(map->rows);
+    free(map->keys);
+    memset(map, 0, sizeof(*map));
+}
+
+/**
+ * 같은 분류가 이어지는 구간
+ */
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+    int cls;
+    size_t rows;
+    double mean_entropy;
+    float min_entropy;
+    float max_entropy;
+} EntropyRegion;
+
+/**
+ * *pos 행부터 같은 분류의 연속 행을 하나의 구간으로 묶어 돌려준다.
+ *
+ * @return 구간이 있으면 1, 끝이면 0
+ */
+static inline int entropy_map_next_region(const EntropyMap *map, size_t *pos,
+                                          EntropyRegion *region) {
+    size_t i = *pos;
+    if (i >= map->row_count) {
+        return 0;
+    }
+    const EntropyRow *first = &map->rows[i];
+    double sum = 0.0;
+    memset(region, 0, sizeof(*region));
+    region->start = first->offset;
+    region->cls = first->cls;
+    region->min_entropy = first->entropy;
+    region->max_entropy = first->entropy;
+    for (; i < map->row_count && map->rows[i].cls == first->cls; i++) {
+        const EntropyRow *row = &map->rows[i];
+        sum += row->entropy;
+        if (row->entropy < region->min_entropy) region->min_entropy = row->entropy;
+        if (row->entropy > region->max_entropy) region->max_entropy = row->entropy;
+        region->end = row->offset + row->length;
+    }
+    region->rows = i - *pos;
+    region->mean_entropy = sum / (double)region->rows;
+    *pos = i;
+    return 1;
+}
+
+#endif /* ENTROPY_MAP_H */
@@ -0,0 +1,194 @@
+/**
+ * cpu_features.h - 실행 시 CPU 암호 가속 기능 탐지
+ *
+ * 예제 프로그램들이 공유하는 CPU 기능 탐지 헤더이다. x86에서는 CPUID와
+ * XGETBV(OS가 AVX/AVX-512 레지스터 상태를 저장하는지)를, ARM에서는
+ * getauxval(AT_HWCAP)을 확인한다.
+ *
+ * 환경 변수 CRYPTO_FORCE_GENERIC=1을 설정하면:
+ *   - cpu_features_get()이 모든 가속 기능을 "사용 안 함"으로 보고하므로
+ *     이 헤더로 분기하는 자체 엔진(예: sha256_mb.h)이 일반 경로를 사용하고,
+ *   - cpu_features_apply_override()가 OPENSSL_ia32cap / OPENSSL_armcap을
+ *     설정한 뒤 프로그램을 다시 실행하여 OpenSSL도 일반 경로를 사용하게 한다.
+ *     (OpenSSL은 라이브러리 적재 시점에 이 변수를 읽으므로 재실행이 필요하다)
+ *
+ * 같은 서버에서 설정 유무만 바꿔 실행하면 가속 경로의 효과를 측정할 수 있다.
+ */
+
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define CPU_FEATURES_X86 1
+#elif defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#define CPU_FEATURES_ARM64 1
+#endif
+
+#define CPU_FORCE_GENERIC_ENV "CRYPTO_FORCE_GENERIC"
+
+/**
+ * OpenSSL에서 가속 경로를 끄는 OPENSSL_ia32cap 값
+ * (AES-NI, PCLMULQDQ, SSSE3, AVX 비트와 CPUID leaf 7의 모든 비트를 지운다)
+ */
+#define CPU_OPENSSL_IA32CAP_GENERIC "~0x1200020200000000:~0xffffffffffffffff"
+
+/**
+ * 탐지된 CPU 기능 (1: 사용 가능, 0: 없음 또는 OS 미지원)
+ */
+typedef struct {
+    /* x86 */
+    int sse2;
+    int ssse3;
+    int aesni;
+    int pclmulqdq;
+    int movbe;
+    int popcnt;
+    int avx;
+    int avx2;
+    int bmi1;
+    int bmi2;
+    int sha_ni;
+    int avx512f;
+    int avx512bw;
+    int avx512vl;
+    int vaes;
+    int vpclmulqdq;
+    /* ARMv8 */
+    int neon;
+    int arm_aes;
+    int arm_pmull;
+    int arm_sha2;
+    /* CRYPTO_FORCE_GENERIC로 가속 기능을 끈 상태인지 */
+    int forced_generic;
+} CpuFeatures;
+
+/**
+ * CRYPTO_FORCE_GENERIC 환경 변수가 설정되어 있는지 확인한다 ("0"과 빈 값은 무시).
+ */
+static inline int cpu_features_force_generic(void) {
+    const char *value = getenv(CPU_FORCE_GENERIC_ENV);
+    return value != NULL && value[0] != '\0' && strcmp(value, "0") != 0;
+}
+
+/**
+ * 하드웨어가 실제로 제공하는 기능을 탐지한다 (강제 설정과 무관).
+ */
+static inline void cpu_features_detect(CpuFeatures *f) {
+    memset(f, 0, sizeof(*f));
+
+#if defined(CPU_FEATURES_X86)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return;
+    }
+    f->sse2 = (edx >> 26) & 1;
+    f->ssse3 = (ecx >> 9) & 1;
+    f->pclmulqdq = (ecx >> 1) & 1;
+    f->aesni = (ecx >> 25) & 1;
+    f->movbe = (ecx >> 22) & 1;
+    f->popcnt = (ecx >> 23) & 1;
+
+    // AVX 계열은 OS가 YMM/ZMM 상태를 저장할 때만 사용 가능 (OSXSAVE + XCR0)
+    int osxsave = (ecx >> 27) & 1;
+    int cpu_avx = (ecx >> 28) & 1;
+    unsigned long long xcr0 = 0;
+    if (osxsave) {
+        unsigned int lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        xcr0 = ((unsigned long long)hi << 32) | lo;
+    }
+    int os_avx = (xcr0 & 0x6) == 0x6;
+    int os_avx512 = (xcr0 & 0xe6) == 0xe6;
+    f->avx = cpu_avx && os_avx;
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        f->avx2 = f->avx && ((ebx >> 5) & 1);
+        f->bmi1 = (ebx >> 3) & 1;
+        f->bmi2 = (ebx >> 8) & 1;
+        f->sha_ni = (ebx >> 29) & 1;
+        f->avx512f = os_avx512 && ((ebx >> 16) & 1);
+        f->avx512bw = f->avx512f && ((ebx >> 30) & 1);
+        f->avx512vl = f->avx512f && ((ebx >> 31) & 1);
+        f->vaes = f->avx && ((ecx >> 9) & 1);
+        f->vpclmulqdq = f->avx && ((ecx >> 10) & 1);
+    }
+#elif defined(CPU_FEATURES_ARM64)
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    f->neon = 1;   // AArch64에서는 항상 제공
+#ifdef HWCAP_AES
+    f->arm_aes = (hwcap & HWCAP_AES) != 0;
+#endif
+#ifdef HWCAP_PMULL
+    f->arm_pmull = (hwcap & HWCAP_PMULL) != 0;
+#endif
+#ifdef HWCAP_SHA2
+    f->arm_sha2 = (hwcap & HWCAP_SHA2) != 0;
+#endif
+    (void)hwcap;
+#endif
+}
+
+/**
+ * 프로그램이 사용해야 할 CPU 기능을 반환한다 (처음 호출 시 탐지 후 캐시).
+ *
+ * CRYPTO_FORCE_GENERIC이 설정되어 있으면 SSE2/NEON 기본 기능만 남기고
+ * 모든 가속 기능을 0으로 보고한다. 여러 스레드가 동시에 처음 호출해도
+ * 모두 같은 값을 계산하므로 결과는 동일하다.
+ */
+static inline const CpuFeatures *cpu_features_get(void) {
+    static CpuFeatures features;
+    static int initialized = 0;
+
+    if (!__atomic_load_n(&initialized, __ATOMIC_ACQUIRE)) {
+        CpuFeatures detected;
+        cpu_features_detect(&detected);
+        if (cpu_features_force_generic()) {
+            memset(&features, 0, sizeof(features));
+            features.sse2 = detected.sse2;
+            features.neon = detected.neon;
+            features.forced_generic = 1;
+        } else {
+            features = detected;
+        }
+        __atomic_store_n(&initialized, 1, __ATOMIC_RELEASE);
+    }
+    return &features;
+}
+
+/**
+ * CRYPTO_FORCE_GENERIC이 설정되어 있으면 OpenSSL도 일반 경로를 쓰도록
+ * 환경을 설정하고 프로그램을 다시 실행한다.
+ *
+ * main() 시작 직후, OpenSSL을 사용하기 전에 호출해야 한다. 사용자가
+ * OPENSSL_ia32cap / OPENSSL_armcap을 직접 지정했다면 그 값을 존중한다.
+ * 재실행에 실패하면 자체 엔진만 일반 경로로 동작한다.
+ */
+static inline void cpu_features_apply_override(char *argv[]) {
+    if (!cpu_features_force_generic()) {
+        return;
+    }
+#if defined(CPU_FEATURES_X86) || defined(CPU_FEATURES_ARM64)
+#if defined(CPU_FEATURES_X86)
+    const char *var = "OPENSSL_ia32cap";
+    const char *value = CPU_OPENSSL_IA32CAP_GENERIC;
+#else
+    const char *var = "OPENSSL_armcap";
+    const char *value = "0";
+#endif
+    if (getenv(var) != NULL) {
+        return;   // 이미 설정됨 (재실행된 뒤이거나 사용자가 지정)
+    }
+    setenv(var, value, 1);
+    execv("/proc/self/exe", argv);
+#else
+    (void)argv;
+#endif
+}
+
+#endif /* CPU_FEATURES_H */
@@ -0,0 +1,205 @@
+/**
+ * digest_ctx.h - 알고리즘 캐시와 스레드별 재사용 컨텍스트를 갖춘 해시 모듈
+ *
+ * EVP_sha256() 같은 레거시 핸들로 EVP_DigestInit_ex()를 호출하면 OpenSSL 3.x는
+ * 매번 프로바이더에서 알고리즘을 다시 찾고(암묵적 fetch), 호출마다
+ * EVP_MD_CTX를 만들고 해제하면 그 할당 비용까지 더해진다. 짧은 메시지에서는
+ * 이 고정 비용이 압축 함수 자체보다 크다.
+ *
+ * 이 헤더는
+ *   - digest_fetch(): 알고리즘 이름별로 EVP_MD_fetch()를 한 번만 수행하여
+ *     프로세스 수명 동안 캐시하고,
+ *   - digest_thread_ctx(): 스레드마다 알고리즘별 EVP_MD_CTX를 하나씩 만들어
+ *     재사용하며 (스레드 종료 시 자동 해제),
+ *   - digest_oneshot() / digest_stream_*(): 위 둘을 이용해 호출 경로에서
+ *     EVP_MD_CTX 할당과 알고리즘 조회가 없는 한 번 호출 / 스트리밍 API를 제공한다.
+ *
+ * 참고: OpenSSL 3.0은 같은 컨텍스트를 재초기화할 때도 프로바이더 내부 상태를
+ * 한 번 새로 할당한다. 이 헤더가 없애는 것은 그 밖의 할당과 알고리즘 조회이다.
+ */
+
+#ifndef DIGEST_CTX_H
+#define DIGEST_CTX_H
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/evp.h>
+
+#define DIGEST_CACHE_MAX 16              // 캐시할 수 있는 알고리즘 이름 수
+#define DIGEST_NAME_MAX 32
+
+typedef struct {
+    char name[DIGEST_NAME_MAX];
+    EVP_MD *md;
+} DigestCacheEntry;
+
+typedef struct {
+    const EVP_MD *md;
+    EVP_MD_CTX *ctx;
+} DigestThreadSlot;
+
+/**
+ * 스레드별 컨텍스트 표. 스레드 종료 시 pthread 키 소멸자로 해제한다.
+ */
+typedef struct {
+    DigestThreadSlot slots[DIGEST_CACHE_MAX];
+    int count;
+} DigestThreadCache;
+
+static pthread_mutex_t digest_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static DigestCacheEntry digest_cache[DIGEST_CACHE_MAX];
+static int digest_cache_count = 0;
+
+static pthread_key_t digest_thread_key;
+static pthread_once_t digest_thread_once = PTHREAD_ONCE_INIT;
+static __thread DigestThreadCache *digest_thread_cache = NULL;
+
+/**
+ * 알고리즘 이름(예: "sha256", "sha3-256", "blake2b512")에 해당하는 EVP_MD를
+ * 한 번만 fetch하여 반환한다. 반환값은 프로세스가 끝날 때까지 유효하다.
+ *
+ * 호출 경로마다 이름으로 찾지 말고 반환된 포인터를 보관해 사용하라.
+ *
+ * @return 성공 시 EVP_MD, 알 수 없는 이름이거나 캐시가 가득 차면 NULL
+ */
+static inline const EVP_MD *digest_fetch(const char *name) {
+    const EVP_MD *found = NULL;
+
+    if (strlen(name) >= DIGEST_NAME_MAX) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&digest_cache_lock);
+    for (int i = 0; i < digest_cache_count; i++) {
+        if (strcmp(digest_cache[i].name, name) == 0) {
+            found = digest_cache[i].md;
+            break;
+        }
+    }
+    if (found == NULL && digest_cache_count < DIGEST_CACHE_MAX) {
+        EVP_MD *md = EVP_MD_fetch(NULL, name, NULL);
+        if (md != NULL) {
+            DigestCacheEntry *entry = &digest_cache[digest_cache_count++];
+            snprintf(entry->name, sizeof(entry->name), "%s", name);
+            entry->md = md;
+            found = md;
+        }
+    }
+    pthread_mutex_unlock(&digest_cache_lock);
+    return found;
+}
+
+/**
+ * 자주 쓰는 SHA-256 핸들 (첫 호출 시 fetch 후 캐시)
+ */
+static inline const EVP_MD *digest_sha256_md(void) {
+    static const EVP_MD *md = NULL;
+    const EVP_MD *cached = __atomic_load_n(&md, __ATOMIC_ACQUIRE);
+    if (cached == NULL) {
+        cached = digest_fetch("sha256");
+        __atomic_store_n(&md, cached, __ATOMIC_RELEASE);
+    }
+    return cached;
+}
+
+static inline void digest_thread_cache_free(void *arg) {
+    DigestThreadCache *cache = (DigestThreadCache *)arg;
+    for (int i = 0; i < cache->count; i++) {
+        EVP_MD_CTX_free(cache->slots[i].ctx);
+    }
+    free(cache);
+}
+
+static inline void digest_thread_key_create(void) {
+    pthread_key_create(&digest_thread_key, digest_thread_cache_free);
+}
+
+/**
+ * 현재 스레드의 md 전용 EVP_MD_CTX를 반환한다 (처음 한 번만 할당).
+ *
+ * 같은 스레드에서 같은 알고리즘의 스트림을 동시에 둘 이상 열 수 없다.
+ * 그런 경우에는 호출자가 EVP_MD_CTX를 직접 소유하여 재사용하라.
+ *
+ * @return 성공 시 컨텍스트, 할당 실패 시 NULL
+ */
+static inline EVP_MD_CTX *digest_thread_ctx(const EVP_MD *md) {
+    DigestThreadCache *cache = digest_thread_cache;
+
+    if (cache != NULL) {
+        for (int i = 0; i < cache->count; i++) {
+            if (cache->slots[i].md == md) {
+                return cache->slots[i].ctx;
+            }
+        }
+    } else {
+        pthread_once(&digest_thread_once, digest_thread_key_create);
+        cache = calloc(1, sizeof(*cache));
+        if (cache == NULL) {
+            return NULL;
+        }
+        digest_thread_cache = cache;
+        pthread_setspecific(digest_thread_key, cache);
+    }
+
+    if (cache->count == DIGEST_CACHE_MAX) {
+        return NULL;
+    }
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    if (ctx == NULL) {
+        return NULL;
+    }
+    cache->slots[cache->count].md = md;
+    cache->slots[cache->count].ctx = ctx;
+    cache->count++;
+    return ctx;
+}
+
+/**
+ * 스레드 컨텍스트로 스트리밍 해시를 시작한다.
+ *
+ * @return 초기화된 컨텍스트, 실패 시 NULL
+ */
+static inline EVP_MD_CTX *digest_stream_begin(const EVP_MD *md) {
+    EVP_MD_CTX *ctx = (md != NULL) ? digest_thread_ctx(md) : NULL;
+    if (ctx == NULL || EVP_DigestInit_ex(ctx, md, NULL) != 1) {
+        return NULL;
+    }
+    return ctx;
+}
+
+static inline int digest_stream_update(EVP_MD_CTX *ctx, const void *data, size_t len) {
+    return (EVP_DigestUpdate(ctx, data, len) == 1) ? 0 : -1;
+}
+
+/**
+ * @param out 결과 버퍼 (최소 EVP_MD_get_size(md) 바이트)
+ * @param out_len 결과 길이 (NULL 가능)
+ */
+static inline int digest_stream_final(EVP_MD_CTX *ctx, unsigned char *out, unsigned int *out_len) {
+    return (EVP_DigestFinal_ex(ctx, out, out_len) == 1) ? 0 : -1;
+}
+
+/**
+ * 데이터의 다이제스트를 한 번에 계산한다 (스레드 컨텍스트 재사용).
+ *
+ * @return 성공 시 0, 실패 시 -1
+ */
+static inline int digest_oneshot(const EVP_MD *md, const void *data, size_t len,
+                                 unsigned char *out, unsigned int *out_len) {
+    EVP_MD_CTX *ctx = digest_stream_begin(md);
+    if (ctx == NULL || digest_stream_update(ctx, data, len) != 0) {
+        return -1;
+    }
+    return digest_stream_final(ctx, out, out_len);
+}
+
+/**
+ * SHA-256 한 번 호출 (out: 32바이트)
+ */
+static inline int digest_sha256(const void *data, size_t len, unsigned char *out) {
+    return digest_oneshot(digest_sha256_md(), data, len, out, NULL);
+}
+
+#endif /* DIGEST_CTX_H */
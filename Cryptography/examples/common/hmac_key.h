@@ -0,0 +1,237 @@
+/**
+ * hmac_key.h - 키 스케줄을 미리 계산한 HMAC-SHA256 객체와 배치 MAC
+ *
+ * HMAC(K, m) = SHA256((K ^ opad) || SHA256((K ^ ipad) || m))
+ *
+ * (K ^ ipad)와 (K ^ opad)는 각각 정확히 한 블록(64바이트)이므로, 그 블록을
+ * 압축한 SHA-256 중간 상태(inner/outer)를 키 설정 시 한 번만 계산해 두면
+ * 메시지마다 키 블록 두 개를 다시 압축할 필요가 없다. 일회성 HMAC()은
+ * 호출마다 이 키 스케줄과 EVP 컨텍스트 세 개를 새로 만든다.
+ *
+ * 배치 호출은 sha256_mb.h의 다중 버퍼 엔진으로 내부 해시 N개를 SIMD 레인에
+ * 나누어 계산하고(시작 상태 = inner), 이어서 32바이트 내부 다이제스트 N개의
+ * 외부 해시를 같은 방식으로 계산한다(시작 상태 = outer).
+ *
+ * 사용 예:
+ *   HmacSha256Key key;
+ *   hmac_key_init(&key, secret, secret_len);
+ *   hmac_key_mac_batch(&key, frames, lens, macs, count);
+ *   hmac_key_clear(&key);
+ */
+
+#ifndef HMAC_KEY_H
+#define HMAC_KEY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "sha256_mb.h"
+
+#define HMAC_KEY_BLOCK_SIZE 64
+#define HMAC_KEY_MAC_SIZE 32
+#define HMAC_KEY_BATCH_CHUNK 256     // 배치 내부 처리 단위 (스택 임시 버퍼 크기)
+
+/**
+ * 키 설정 후의 HMAC-SHA256 상태 (키 자체는 보관하지 않는다)
+ */
+typedef struct {
+    uint32_t inner[8];               // SHA256 상태: (K ^ ipad) 한 블록 압축 후
+    uint32_t outer[8];               // SHA256 상태: (K ^ opad) 한 블록 압축 후
+} HmacSha256Key;
+
+/**
+ * 메모리를 컴파일러가 지우지 않도록 0으로 덮어쓴다.
+ */
+static inline void hmac_key_wipe(void *p, size_t len) {
+    volatile unsigned char *v = (volatile unsigned char *)p;
+    while (len-- > 0) {
+        *v++ = 0;
+    }
+}
+
+/**
+ * 키 패드 블록 하나를 압축하여 중간 상태를 구한다.
+ */
+static inline void hmac_key_pad_state(const unsigned char *key_block, unsigned char pad,
+                                      uint32_t out[8]) {
+    unsigned char block[HMAC_KEY_BLOCK_SIZE];
+    for (int i = 0; i < HMAC_KEY_BLOCK_SIZE; i++) {
+        block[i] = key_block[i] ^ pad;
+    }
+
+    Sha256MbState state;
+    const unsigned char *blocks[1] = { block };
+    for (int i = 0; i < 8; i++) {
+        state[i][0] = sha256_mb_iv[i];
+    }
+    sha256_mb_compress_x1(state, blocks);
+    for (int i = 0; i < 8; i++) {
+        out[i] = state[i][0];
+    }
+    hmac_key_wipe(block, sizeof(block));
+}
+
+/**
+ * 키로 내부/외부 중간 상태를 계산한다 (키당 한 번).
+ *
+ * 블록 크기(64바이트)보다 긴 키는 RFC 2104에 따라 SHA-256으로 줄인다.
+ *
+ * @return 성공 시 0
+ */
+static inline int hmac_key_init(HmacSha256Key *k, const unsigned char *key, size_t key_len) {
+    unsigned char key_block[HMAC_KEY_BLOCK_SIZE] = { 0 };
+
+    if (key_len > HMAC_KEY_BLOCK_SIZE) {
+        unsigned char digest[1][32];
+        sha256_mb_hash_engine(SHA256_MB_SCALAR, &key, &key_len, digest, 1);
+        memcpy(key_block, digest[0], 32);
+        hmac_key_wipe(digest, sizeof(digest));
+    } else if (key_len > 0) {
+        memcpy(key_block, key, key_len);
+    }
+
+    hmac_key_pad_state(key_block, 0x36, k->inner);
+    hmac_key_pad_state(key_block, 0x5c, k->outer);
+    hmac_key_wipe(key_block, sizeof(key_block));
+    return 0;
+}
+
+/**
+ * 키 상태를 지운다.
+ */
+static inline void hmac_key_clear(HmacSha256Key *k) {
+    hmac_key_wipe(k, sizeof(*k));
+}
+
+/**
+ * 메시지 수에 맞는 다중 버퍼 엔진을 고른다 (레인 수가 메시지 수를 넘지 않는 가장 넓은 엔진).
+ *
+ * 메시지가 레인 수보다 적으면 sha-ni x1까지 내려가며, 지원되지 않는 엔진은
+ * sha256_mb_hash_from_state()가 스칼라로 대체한다.
+ */
+static inline Sha256MbEngine hmac_key_engine_for(size_t count) {
+    Sha256MbEngine best = sha256_mb_best_engine();
+    while (best > SHA256_MB_SCALAR && (size_t)sha256_mb_engine_lanes(best) > count) {
+        best = (Sha256MbEngine)(best - 1);
+    }
+    return best;
+}
+
+/**
+ * 지정한 엔진으로 count개 메시지의 HMAC-SHA256을 계산한다.
+ *
+ * @param macs 결과 배열 (메시지당 32바이트)
+ * @return 성공 시 0
+ */
+static inline int hmac_key_mac_batch_engine(const HmacSha256Key *k, Sha256MbEngine engine,
+                                            const unsigned char *const *data, const size_t *lens,
+                                            unsigned char (*macs)[HMAC_KEY_MAC_SIZE],
+                                            size_t count) {
+    unsigned char inner[HMAC_KEY_BATCH_CHUNK][32];
+    const unsigned char *inner_ptrs[HMAC_KEY_BATCH_CHUNK];
+    size_t inner_lens[HMAC_KEY_BATCH_CHUNK];
+    size_t used = 0;
+
+    for (size_t first = 0; first < count; first += HMAC_KEY_BATCH_CHUNK) {
+        size_t n = count - first;
+        if (n > HMAC_KEY_BATCH_CHUNK) {
+            n = HMAC_KEY_BATCH_CHUNK;
+        }
+
+        // 1단계: 내부 해시 SHA256((K ^ ipad) || m)
+        sha256_mb_hash_from_state(engine, k->inner, HMAC_KEY_BLOCK_SIZE,
+                                  data + first, lens + first, inner, n);
+
+        // 2단계: 외부 해시 SHA256((K ^ opad) || 내부 다이제스트)
+        for (size_t i = 0; i < n; i++) {
+            inner_ptrs[i] = inner[i];
+            inner_lens[i] = 32;
+        }
+        sha256_mb_hash_from_state(engine, k->outer, HMAC_KEY_BLOCK_SIZE,
+                                  inner_ptrs, inner_lens, macs + first, n);
+        if (n > used) {
+            used = n;
+        }
+    }
+    hmac_key_wipe(inner, used * 32);   // 사용한 부분만 지운다
+    return 0;
+}
+
+/**
+ * count개 메시지의 HMAC-SHA256을 한 번에 계산한다 (가장 넓은 SIMD 엔진 사용).
+ */
+static inline int hmac_key_mac_batch(const HmacSha256Key *k,
+                                     const unsigned char *const *data, const size_t *lens,
+                                     unsigned char (*macs)[HMAC_KEY_MAC_SIZE], size_t count) {
+    return hmac_key_mac_batch_engine(k, hmac_key_engine_for(count), data, lens, macs, count);
+}
+
+/**
+ * 메시지 하나의 HMAC-SHA256을 계산한다 (SHA-NI가 있으면 사용, 없으면 스칼라).
+ */
+static inline int hmac_key_mac(const HmacSha256Key *k, const unsigned char *data, size_t len,
+                               unsigned char *mac) {
+    unsigned char out[1][HMAC_KEY_MAC_SIZE];
+    int ret = hmac_key_mac_batch_engine(k, hmac_key_engine_for(1), &data, &len, out, 1);
+    memcpy(mac, out[0], HMAC_KEY_MAC_SIZE);
+    return ret;
+}
+
+/**
+ * 두 MAC을 상수 시간으로 비교한다.
+ *
+ * @return 일치하면 0, 불일치하면 -1
+ */
+static inline int hmac_key_equal(const unsigned char *a, const unsigned char *b) {
+    unsigned char diff = 0;
+    for (int i = 0; i < HMAC_KEY_MAC_SIZE; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return (diff == 0) ? 0 : -1;
+}
+
+/**
+ * 메시지 하나의 MAC을 검증한다.
+ *
+ * @return 일치하면 0, 불일치하면 -1
+ */
+static inline int hmac_key_verify(const HmacSha256Key *k, const unsigned char *data, size_t len,
+                                  const unsigned char *expected) {
+    unsigned char mac[HMAC_KEY_MAC_SIZE];
+    hmac_key_mac(k, data, len, mac);
+    return hmac_key_equal(mac, expected);
+}
+
+/**
+ * count개 메시지의 MAC을 한 번에 검증한다.
+ *
+ * @param expected 기대 MAC 배열 (메시지당 32바이트)
+ * @param results 메시지별 결과 (0: 일치, -1: 불일치), NULL 가능
+ * @return 불일치한 메시지 수 (모두 일치하면 0)
+ */
+static inline size_t hmac_key_verify_batch(const HmacSha256Key *k,
+                                           const unsigned char *const *data, const size_t *lens,
+                                           const unsigned char (*expected)[HMAC_KEY_MAC_SIZE],
+                                           int *results, size_t count) {
+    unsigned char macs[HMAC_KEY_BATCH_CHUNK][HMAC_KEY_MAC_SIZE];
+    Sha256MbEngine engine = hmac_key_engine_for(count);
+    size_t failures = 0;
+
+    for (size_t first = 0; first < count; first += HMAC_KEY_BATCH_CHUNK) {
+        size_t n = count - first;
+        if (n > HMAC_KEY_BATCH_CHUNK) {
+            n = HMAC_KEY_BATCH_CHUNK;
+        }
+        hmac_key_mac_batch_engine(k, engine, data + first, lens + first, macs, n);
+        for (size_t i = 0; i < n; i++) {
+            int r = hmac_key_equal(macs[i], expected[first + i]);
+            if (results != NULL) {
+                results[first + i] = r;
+            }
+            failures += (r != 0);
+        }
+    }
+    return failures;
+}
+
+#endif /* HMAC_KEY_H */
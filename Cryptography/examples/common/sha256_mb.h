@@ -0,0 +1,425 @@
+/**
+ * sha256_mb.h - 다중 버퍼(multi-buffer) SHA-256 배치 해시
+ *
+ * 서로 독립적인 여러 메시지의 SHA-256을 SIMD 레인에 하나씩 배치하여
+ * 동시에 계산한다. 짧은 메시지 수백 개를 EVP 컨텍스트 하나씩으로 처리하면
+ * 컨텍스트 생성/초기화 비용과 비어 있는 SIMD 레인이 처리량을 제한한다.
+ *
+ * 엔진 (실행 시 cpu_features.h로 CPU 기능을 확인하여 가장 넓은 것을 선택,
+ * CRYPTO_FORCE_GENERIC=1이면 AVX2/AVX-512 엔진을 사용하지 않음):
+ *   - avx512 x16 : AVX-512F, 16개 메시지 동시 처리
+ *   - avx2 x8    : AVX2, 8개 메시지 동시 처리
+ *   - vec x4     : 128비트 SIMD (x86-64 SSE2 / ARM NEON), 4개 메시지 동시 처리
+ *   - sha-ni x1  : x86 SHA 확장 명령, 메시지 하나씩 (레인 수보다 메시지가 적을 때 유리)
+ *   - scalar x1  : 이식용 스칼라 대체 경로
+ *
+ * 레인마다 자기 메시지의 블록을 순서대로 처리하며, 메시지가 끝난 레인에는
+ * 즉시 다음 메시지를 채워 넣는다. 따라서 길이가 서로 달라도 레인이 쉬지 않는다.
+ *
+ * 사용 예:
+ *   const unsigned char *data[N]; size_t lens[N]; unsigned char digests[N][32];
+ *   sha256_mb_hash(data, lens, digests, N);
+ */
+
+#ifndef SHA256_MB_H
+#define SHA256_MB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "cpu_features.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#define SHA256_MB_MAX_LANES 16
+
+/**
+ * 다중 버퍼 엔진 종류
+ */
+typedef enum {
+    SHA256_MB_SCALAR = 0,
+    SHA256_MB_SHANI,
+    SHA256_MB_VEC4,
+    SHA256_MB_AVX2,
+    SHA256_MB_AVX512,
+    SHA256_MB_ENGINE_COUNT
+} Sha256MbEngine;
+
+static const uint32_t sha256_mb_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t sha256_mb_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+/**
+ * 레인별 상태 배열: state[i][lane] (같은 워드의 레인들이 메모리에 연속)
+ */
+typedef uint32_t Sha256MbState[8][SHA256_MB_MAX_LANES];
+
+typedef uint32_t sha256_mb_v1 __attribute__((vector_size(4)));
+typedef uint32_t sha256_mb_v4 __attribute__((vector_size(16)));
+typedef uint32_t sha256_mb_v8 __attribute__((vector_size(32)));
+typedef uint32_t sha256_mb_v16 __attribute__((vector_size(64)));
+
+static inline uint32_t sha256_mb_load_be32(const unsigned char *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+#define SHA256_MB_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/**
+ * LANES개 레인의 64바이트 블록 하나씩을 압축하는 함수를 정의한다.
+ *
+ * GCC 벡터 확장으로 한 번만 작성하고, 레인 폭과 target 속성만 바꿔
+ * 엔진별 함수를 생성한다 (AVX-512에서는 회전이 vprord 한 명령이 된다).
+ * NAME##_words는 상태와 메시지 워드가 이미 레인별 벡터에 있을 때 쓰는 본체로,
+ * PBKDF2처럼 다이제스트를 곧바로 다음 블록으로 넣는 반복 계산이 바이트 변환 없이
+ * 호출한다 (w는 메시지 확장에 덮어쓴다).
+ */
+#define SHA256_MB_DEFINE_COMPRESS(NAME, VEC, LANES, ATTR)                          \
+ATTR static inline void NAME##_words(VEC s[8], VEC w[16]) {                      \
+    VEC a = s[0], b = s[1], c = s[2], d = s[3];                                  \
+    VEC e = s[4], f = s[5], g = s[6], h = s[7];                                  \
+                                                                                 \
+    for (int t = 0; t < 64; t++) {                                               \
+        VEC wt;                                                                  \
+        if (t < 16) {                                                            \
+            wt = w[t];                                                           \
+        } else {                                                                 \
+            VEC w15 = w[(t - 15) & 15], w2 = w[(t - 2) & 15];                    \
+            VEC s0 = SHA256_MB_ROTR(w15, 7) ^ SHA256_MB_ROTR(w15, 18) ^ (w15 >> 3); \
+            VEC s1 = SHA256_MB_ROTR(w2, 17) ^ SHA256_MB_ROTR(w2, 19) ^ (w2 >> 10); \
+            wt = w[t & 15] + s0 + w[(t - 7) & 15] + s1;                          \
+            w[t & 15] = wt;                                                      \
+        }                                                                        \
+        VEC S1 = SHA256_MB_ROTR(e, 6) ^ SHA256_MB_ROTR(e, 11) ^ SHA256_MB_ROTR(e, 25); \
+        VEC ch = (e & f) ^ (~e & g);                                             \
+        VEC t1 = h + S1 + ch + sha256_mb_k[t] + wt;                              \
+        VEC S0 = SHA256_MB_ROTR(a, 2) ^ SHA256_MB_ROTR(a, 13) ^ SHA256_MB_ROTR(a, 22); \
+        VEC maj = (a & b) ^ (a & c) ^ (b & c);                                   \
+        VEC t2 = S0 + maj;                                                       \
+        h = g; g = f; f = e; e = d + t1;                                         \
+        d = c; c = b; b = a; a = t1 + t2;                                        \
+    }                                                                            \
+                                                                                 \
+    s[0] += a; s[1] += b; s[2] += c; s[3] += d;                                  \
+    s[4] += e; s[5] += f; s[6] += g; s[7] += h;                                  \
+}                                                                                \
+                                                                                 \
+ATTR static void NAME(Sha256MbState state, const unsigned char *const blocks[]) { \
+    VEC w[16];                                                                   \
+    for (int t = 0; t < 16; t++) {                                               \
+        for (int l = 0; l < (LANES); l++) {                                      \
+            w[t][l] = sha256_mb_load_be32(blocks[l] + 4 * t);                    \
+        }                                                                        \
+    }                                                                            \
+                                                                                 \
+    VEC s[8];                                                                    \
+    for (int i = 0; i < 8; i++) {                                                \
+        memcpy(&s[i], state[i], sizeof(VEC));                                   \
+    }                                                                            \
+    NAME##_words(s, w);                                                          \
+    for (int i = 0; i < 8; i++) {                                                \
+        memcpy(state[i], &s[i], sizeof(VEC));                                    \
+    }                                                                            \
+}
+
+SHA256_MB_DEFINE_COMPRESS(sha256_mb_compress_x1, sha256_mb_v1, 1, )
+SHA256_MB_DEFINE_COMPRESS(sha256_mb_compress_x4, sha256_mb_v4, 4, )
+#if defined(__x86_64__) || defined(__i386__)
+SHA256_MB_DEFINE_COMPRESS(sha256_mb_compress_x8, sha256_mb_v8, 8,
+                          __attribute__((target("avx2"))))
+SHA256_MB_DEFINE_COMPRESS(sha256_mb_compress_x16, sha256_mb_v16, 16,
+                          __attribute__((target("avx512f"))))
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * SHA 확장 명령(SHA-NI)으로 레인 0의 블록 하나를 압축한다.
+ *
+ * sha256rnds2가 요구하는 ABEF/CDGH 배치로 상태를 바꿔 넣고, 4라운드마다
+ * sha256msg1/sha256msg2로 다음 메시지 워드 4개를 만든다.
+ */
+__attribute__((target("sha,sse4.1")))
+static void sha256_mb_compress_shani(Sha256MbState state, const unsigned char *const blocks[]) {
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    uint32_t words[8];
+    for (int i = 0; i < 8; i++) {
+        words[i] = state[i][0];
+    }
+
+    __m128i tmp = _mm_loadu_si128((const __m128i *)&words[0]);      // DCBA
+    __m128i state1 = _mm_loadu_si128((const __m128i *)&words[4]);   // HGFE
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);                              // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);                        // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);                // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);                     // CDGH
+    __m128i abef_save = state0, cdgh_save = state1;
+
+    __m128i msg[4];
+    for (int j = 0; j < 4; j++) {
+        msg[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(blocks[0] + 16 * j)), mask);
+    }
+
+    for (int i = 0; i < 16; i++) {
+        __m128i wk = _mm_add_epi32(msg[i & 3], _mm_loadu_si128((const __m128i *)&sha256_mb_k[4 * i]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E));
+        if (i < 12) {
+            // W[t..t+3] = σ1(W[t-2]) + W[t-7] + σ0(W[t-15]) + W[t-16]
+            __m128i t = _mm_sha256msg1_epu32(msg[i & 3], msg[(i + 1) & 3]);
+            t = _mm_add_epi32(t, _mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4));
+            msg[i & 3] = _mm_sha256msg2_epu32(t, msg[(i + 3) & 3]);
+        }
+    }
+
+    state0 = _mm_add_epi32(state0, abef_save);
+    state1 = _mm_add_epi32(state1, cdgh_save);
+    tmp = _mm_shuffle_epi32(state0, 0x1B);                           // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);                        // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);                     // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);                        // HGFE
+    _mm_storeu_si128((__m128i *)&words[0], state0);
+    _mm_storeu_si128((__m128i *)&words[4], state1);
+    for (int i = 0; i < 8; i++) {
+        state[i][0] = words[i];
+    }
+}
+#endif
+
+/**
+ * 엔진 이름을 반환한다.
+ */
+static inline const char *sha256_mb_engine_name(Sha256MbEngine engine) {
+    switch (engine) {
+    case SHA256_MB_AVX512: return "avx512 x16";
+    case SHA256_MB_AVX2:   return "avx2 x8";
+    case SHA256_MB_VEC4:   return "vec x4";
+    case SHA256_MB_SHANI:  return "sha-ni x1";
+    default:               return "scalar x1";
+    }
+}
+
+/**
+ * 엔진의 레인 수를 반환한다.
+ */
+static inline int sha256_mb_engine_lanes(Sha256MbEngine engine) {
+    switch (engine) {
+    case SHA256_MB_AVX512: return 16;
+    case SHA256_MB_AVX2:   return 8;
+    case SHA256_MB_VEC4:   return 4;
+    default:               return 1;
+    }
+}
+
+/**
+ * 이 CPU에서 엔진을 사용할 수 있는지 확인한다.
+ */
+static inline int sha256_mb_engine_supported(Sha256MbEngine engine) {
+    switch (engine) {
+    case SHA256_MB_SCALAR:
+    case SHA256_MB_VEC4:
+        return 1;
+#if defined(__x86_64__) || defined(__i386__)
+    case SHA256_MB_SHANI:
+        return cpu_features_get()->sha_ni;
+    case SHA256_MB_AVX2:
+        return cpu_features_get()->avx2;
+    case SHA256_MB_AVX512:
+        return cpu_features_get()->avx512f;
+#endif
+    default:
+        return 0;
+    }
+}
+
+/**
+ * 이 CPU에서 가장 넓은 엔진을 반환한다.
+ */
+static inline Sha256MbEngine sha256_mb_best_engine(void) {
+    for (int e = SHA256_MB_ENGINE_COUNT - 1; e > SHA256_MB_SCALAR; e--) {
+        if (sha256_mb_engine_supported((Sha256MbEngine)e)) {
+            return (Sha256MbEngine)e;
+        }
+    }
+    return SHA256_MB_SCALAR;
+}
+
+/**
+ * 레인 하나에 배정된 메시지의 진행 상태
+ */
+typedef struct {
+    size_t job;                   // 메시지 번호
+    int active;
+    const unsigned char *next;    // 다음 전체 블록
+    size_t full_blocks;           // 남은 전체 블록 수
+    unsigned char tail[128];      // 마지막 데이터 + 패딩 + 길이 (1~2블록)
+    int tail_blocks;
+    int tail_done;
+} Sha256MbLane;
+
+static inline void sha256_mb_lane_start(Sha256MbLane *lane, size_t job,
+                                        const unsigned char *data, size_t len,
+                                        uint64_t prefix_len) {
+    lane->job = job;
+    lane->active = 1;
+    lane->next = data;
+    lane->full_blocks = len / 64;
+    lane->tail_done = 0;
+
+    size_t rem = len % 64;
+    memset(lane->tail, 0, sizeof(lane->tail));
+    if (rem > 0) {
+        memcpy(lane->tail, data + lane->full_blocks * 64, rem);
+    }
+    lane->tail[rem] = 0x80;
+    lane->tail_blocks = (rem < 56) ? 1 : 2;
+
+    uint64_t bits = (prefix_len + (uint64_t)len) * 8;
+    unsigned char *len_pos = lane->tail + lane->tail_blocks * 64 - 8;
+    for (int i = 0; i < 8; i++) {
+        len_pos[i] = (unsigned char)(bits >> (56 - 8 * i));
+    }
+}
+
+/**
+ * 지정한 엔진으로 count개 메시지의 SHA-256을 공통 중간 상태에서 이어 계산한다.
+ *
+ * 모든 메시지 앞에 같은 prefix_len 바이트(64의 배수)가 이미 압축되어
+ * init_state가 된 것으로 보고, 나머지 메시지만 압축한 뒤 전체 길이로 패딩한다.
+ * HMAC의 내부/외부 해시처럼 고정 키 블록 뒤에 메시지가 오는 경우에 쓴다.
+ *
+ * @param engine 사용할 엔진 (지원되지 않으면 스칼라로 대체)
+ * @param init_state 시작 상태 (8워드, 일반 SHA-256이면 sha256_mb_iv)
+ * @param prefix_len init_state까지 압축된 바이트 수 (64의 배수)
+ * @param data 메시지 포인터 배열
+ * @param lens 메시지 길이 배열
+ * @param digests 결과 다이제스트 배열 (메시지당 32바이트)
+ * @param count 메시지 수
+ * @return 성공 시 0
+ */
+static inline int sha256_mb_hash_from_state(Sha256MbEngine engine,
+                                            const uint32_t init_state[8],
+                                            uint64_t prefix_len,
+                                            const unsigned char *const *data,
+                                            const size_t *lens,
+                                            unsigned char (*digests)[32],
+                                            size_t count) {
+    if (!sha256_mb_engine_supported(engine)) {
+        engine = SHA256_MB_SCALAR;
+    }
+    int lanes = sha256_mb_engine_lanes(engine);
+
+    static const unsigned char idle_block[64] = { 0 };
+    Sha256MbLane lane[SHA256_MB_MAX_LANES];
+    Sha256MbState state;
+    const unsigned char *blocks[SHA256_MB_MAX_LANES];
+    size_t next_job = 0;
+
+    for (int l = 0; l < lanes; l++) {
+        lane[l].active = 0;
+    }
+
+    for (;;) {
+        // 빈 레인에 다음 메시지 채우기
+        int active = 0;
+        for (int l = 0; l < lanes; l++) {
+            if (!lane[l].active && next_job < count) {
+                sha256_mb_lane_start(&lane[l], next_job, data[next_job], lens[next_job],
+                                     prefix_len);
+                for (int i = 0; i < 8; i++) {
+                    state[i][l] = init_state[i];
+                }
+                next_job++;
+            }
+            active += lane[l].active;
+        }
+        if (active == 0) {
+            break;
+        }
+
+        for (int l = 0; l < lanes; l++) {
+            if (!lane[l].active) {
+                blocks[l] = idle_block;
+            } else if (lane[l].full_blocks > 0) {
+                blocks[l] = lane[l].next;
+            } else {
+                blocks[l] = lane[l].tail + lane[l].tail_done * 64;
+            }
+        }
+
+        switch (engine) {
+#if defined(__x86_64__) || defined(__i386__)
+        case SHA256_MB_AVX512: sha256_mb_compress_x16(state, blocks); break;
+        case SHA256_MB_AVX2:   sha256_mb_compress_x8(state, blocks);  break;
+        case SHA256_MB_SHANI:  sha256_mb_compress_shani(state, blocks); break;
+#endif
+        case SHA256_MB_VEC4:   sha256_mb_compress_x4(state, blocks);  break;
+        default:               sha256_mb_compress_x1(state, blocks);  break;
+        }
+
+        // 진행 및 완료된 레인의 다이제스트 출력
+        for (int l = 0; l < lanes; l++) {
+            if (!lane[l].active) {
+                continue;
+            }
+            if (lane[l].full_blocks > 0) {
+                lane[l].next += 64;
+                lane[l].full_blocks--;
+                continue;
+            }
+            if (++lane[l].tail_done < lane[l].tail_blocks) {
+                continue;
+            }
+            unsigned char *out = digests[lane[l].job];
+            for (int i = 0; i < 8; i++) {
+                out[4 * i]     = (unsigned char)(state[i][l] >> 24);
+                out[4 * i + 1] = (unsigned char)(state[i][l] >> 16);
+                out[4 * i + 2] = (unsigned char)(state[i][l] >> 8);
+                out[4 * i + 3] = (unsigned char)(state[i][l]);
+            }
+            lane[l].active = 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 지정한 엔진으로 count개 메시지의 SHA-256을 계산한다.
+ *
+ * @param engine 사용할 엔진 (지원되지 않으면 스칼라로 대체)
+ * @param data 메시지 포인터 배열
+ * @param lens 메시지 길이 배열
+ * @param digests 결과 다이제스트 배열 (메시지당 32바이트)
+ * @param count 메시지 수
+ * @return 성공 시 0
+ */
+static inline int sha256_mb_hash_engine(Sha256MbEngine engine,
+                                        const unsigned char *const *data,
+                                        const size_t *lens,
+                                        unsigned char (*digests)[32],
+                                        size_t count) {
+    return sha256_mb_hash_from_state(engine, sha256_mb_iv, 0, data, lens, digests, count);
+}
+
+/**
+ * 이 CPU에서 가장 빠른 엔진으로 count개 메시지의 SHA-256을 계산한다.
+ */
+static inline int sha256_mb_hash(const unsigned char *const *data, const size_t *lens,
+                                 unsigned char (*digests)[32], size_t count) {
+    return sha256_mb_hash_engine(sha256_mb_best_engine(), data, lens, digests, count);
+}
+
+#endif /* SHA256_MB_H */